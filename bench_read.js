@@ -0,0 +1,78 @@
+/*jslint devel:true nomen:true node:true */
+/**
+ * read throughput of mapped and positional archives by worker count.
+ * usage: node bench_read.js file.abc [fps]
+ * plays all frames of the file, reading each frame on the workers before decode.
+ */
+(function () {
+	"use strict";
+	var abcio = require('alembic'),
+		file = process.argv[2],
+		fps = Number(process.argv[3] || 30),
+		modes = ["mapped", "positional"],
+		worker_counts = [1, 2, 4, 8],
+		cache_budget = 1024 * 1024 * 1024;
+
+	function seconds(start) {
+		var elapsed = process.hrtime(start);
+		return elapsed[0] + elapsed[1] / 1e9;
+	}
+
+	/**
+	 * play all frames and return seconds taken
+	 */
+	function play(mode, worker_count) {
+		var time,
+			range,
+			frame_count = 0,
+			start,
+			elapsed;
+		abcio.set_worker_count(worker_count);
+		abcio.set_read_mode({ mode : mode, stream_count : worker_count });
+		// every run reads the archive, not samples cached by the previous run
+		abcio.set_cache_budget(0);
+		abcio.set_cache_budget(cache_budget);
+		if (!abcio.load(file)) {
+			throw new Error("Failed to load " + file);
+		}
+		range = abcio.get_total_time(file);
+		start = process.hrtime();
+		for (time = range.min; time <= range.max; time = time + 1000 / fps) {
+			abcio.set_time(file, time);
+			frame_count = frame_count + 1;
+		}
+		elapsed = seconds(start);
+		abcio.unload(file);
+		return { frame_count : frame_count, seconds : elapsed };
+	}
+
+	function bench() {
+		var i,
+			k,
+			result;
+		if (!file) {
+			console.log("usage: node bench_read.js file.abc [fps]");
+			return;
+		}
+		// read ahead on the playback thread would be measured with the frames
+		abcio.set_prefetch({ frame_count : 0, byte_budget : 0 });
+		// warm the file cache of the os, so all runs read from memory alike
+		play(modes[0], worker_counts[worker_counts.length - 1]);
+
+		console.log("mode\tworkers\tframes\tseconds\tfps");
+		for (i = 0; i < modes.length; i = i + 1) {
+			for (k = 0; k < worker_counts.length; k = k + 1) {
+				result = play(modes[i], worker_counts[k]);
+				console.log([
+					modes[i],
+					worker_counts[k],
+					result.frame_count,
+					result.seconds.toFixed(3),
+					(result.frame_count / result.seconds).toFixed(1)
+				].join("\t"));
+			}
+		}
+		abcio.set_worker_count(0);
+	}
+	bench();
+}());
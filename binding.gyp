@@ -84,25 +84,55 @@
 			]
 		],
 		"sources": [
+		"src/umabc/UMAbcArchiveSource.h",
+		"src/umabc/UMAbcBakedFile.cpp",
+		"src/umabc/UMAbcBakedFile.h",
 		"src/umabc/UMAbcCamera.cpp",
 		"src/umabc/UMAbcCamera.h",
 		"src/umabc/UMAbcConvert.h",
 		"src/umabc/UMAbcCurve.cpp",
 		"src/umabc/UMAbcCurve.h",
+		"src/umabc/UMAbcCurveTessellator.cpp",
+		"src/umabc/UMAbcCurveTessellator.h",
+		"src/umabc/UMAbcFileSystem.cpp",
+		"src/umabc/UMAbcFileSystem.h",
+		"src/umabc/UMAbcMappedFile.cpp",
+		"src/umabc/UMAbcMappedFile.h",
 		"src/umabc/UMAbcMesh.cpp",
 		"src/umabc/UMAbcMesh.h",
+		"src/umabc/UMAbcMeshBVH.cpp",
+		"src/umabc/UMAbcMeshBVH.h",
+		"src/umabc/UMAbcMeshGeometry.cpp",
+		"src/umabc/UMAbcMeshGeometry.h",
 		"src/umabc/UMAbcNode.h",
 		"src/umabc/UMAbcNurbsPatch.cpp",
 		"src/umabc/UMAbcNurbsPatch.h",
+		"src/umabc/UMAbcNurbsTessellator.cpp",
+		"src/umabc/UMAbcNurbsTessellator.h",
 		"src/umabc/UMAbcObject.cpp",
 		"src/umabc/UMAbcObject.h",
+		"src/umabc/UMAbcParallel.h",
 		"src/umabc/UMAbcPoint.cpp",
 		"src/umabc/UMAbcPoint.h",
+		"src/umabc/UMAbcPositionalFile.cpp",
+		"src/umabc/UMAbcPositionalFile.h",
+		"src/umabc/UMAbcPrefetcher.cpp",
+		"src/umabc/UMAbcPrefetcher.h",
+		"src/umabc/UMAbcSampleCache.cpp",
+		"src/umabc/UMAbcSampleCache.h",
 		"src/umabc/UMAbcScene.cpp",
 		"src/umabc/UMAbcScene.h",
+		"src/umabc/UMAbcSceneBVH.cpp",
+		"src/umabc/UMAbcSceneBVH.h",
+		"src/umabc/UMAbcSceneIndex.cpp",
+		"src/umabc/UMAbcSceneIndex.h",
 		"src/umabc/UMAbcSetting.h",
 		"src/umabc/UMAbcSoftwareIO.cpp",
 		"src/umabc/UMAbcSoftwareIO.h",
+		"src/umabc/UMAbcTranscodeCache.cpp",
+		"src/umabc/UMAbcTranscodeCache.h",
+		"src/umabc/UMAbcWriter.cpp",
+		"src/umabc/UMAbcWriter.h",
 		"src/umabc/UMAbcXform.cpp",
 		"src/umabc/UMAbcXform.h",
 		"src/umabc/UMMacro.h",
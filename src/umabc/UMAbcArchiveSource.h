@@ -0,0 +1,98 @@
+/**
+ * @file UMAbcArchiveSource.h
+ * file read by archive streams
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <istream>
+#include <streambuf>
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+class UMAbcArchiveSource;
+typedef std::shared_ptr<UMAbcArchiveSource> UMAbcArchiveSourcePtr;
+
+/**
+ * file opened outside of alembic. ogawa archives read it through istreams
+ * which live until this source is deleted.
+ */
+class UMAbcArchiveSource
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcArchiveSource);
+public:
+	virtual ~UMAbcArchiveSource() {}
+
+	/**
+	 * get file size
+	 */
+	virtual size_t size() const = 0;
+
+	/**
+	 * read bytes at the offset
+	 * @retval succsess or fail
+	 */
+	virtual bool read(unsigned long long offset, size_t size, void* data) const = 0;
+
+	/**
+	 * is ogawa archive or not
+	 */
+	bool is_ogawa() const
+	{
+		// magic, frozen flag and version
+		char header[5];
+		if (size() < 16 || !read(0, sizeof(header), header)) return false;
+		return header[0] == 'O' && header[1] == 'g' && header[2] == 'a'
+			&& header[3] == 'w' && header[4] == 'a';
+	}
+
+	/**
+	 * create streams reading this file
+	 * @param [in] count stream count
+	 */
+	std::vector<std::istream*> create_streams(size_t count)
+	{
+		std::vector<std::istream*> streams;
+		for (size_t i = 0; i < count; ++i)
+		{
+			std::shared_ptr<std::streambuf> buffer = create_buffer();
+			std::shared_ptr<std::istream> stream = std::make_shared<std::istream>(buffer.get());
+			buffers_.push_back(buffer);
+			streams_.push_back(stream);
+			streams.push_back(stream.get());
+		}
+		return streams;
+	}
+
+protected:
+	UMAbcArchiveSource() {}
+
+	/**
+	 * create buffer of a stream
+	 */
+	virtual std::shared_ptr<std::streambuf> create_buffer() = 0;
+
+	/**
+	 * delete streams. call this before closing the file.
+	 */
+	void clear_streams()
+	{
+		streams_.clear();
+		buffers_.clear();
+	}
+
+private:
+	std::vector<std::shared_ptr<std::streambuf> > buffers_;
+	std::vector<std::shared_ptr<std::istream> > streams_;
+};
+
+} // umabc
@@ -0,0 +1,622 @@
+/**
+ * @file UMAbcBakedFile.cpp
+ * sidecar file of triangulated mesh frames for playback
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcBakedFile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include "ImathMatrix.h"
+
+#include "UMAbcSoftwareIO.h"
+#include "UMAbcScene.h"
+#include "UMAbcMesh.h"
+#include "UMAbcParallel.h"
+#include "UMAbcFileSystem.h"
+
+namespace umabc
+{
+
+namespace
+{
+	const char kMagic[8] = { 'U', 'M', 'A', 'B', 'C', 'B', 'K', '\0' };
+	const unsigned int kVersion = 1;
+	const unsigned int kFlagQuantized = 1;
+	// blocks start on this boundary, so typed arrays of any element type can view them
+	const unsigned long long kAlignment = 16;
+
+	struct FileHeader
+	{
+		char magic[8];
+		unsigned int version;
+		unsigned int flags;
+		unsigned int mesh_count;
+		unsigned int frame_count;
+		double start_time;
+		double frame_time;
+		unsigned long long mesh_table_offset;
+		unsigned long long frame_table_offset; // frame_count * mesh_count records, frame major
+		unsigned long long file_size;
+	};
+
+	struct MeshHeader
+	{
+		unsigned long long path_offset;
+		unsigned int path_size;
+		unsigned int reserved;
+	};
+
+	struct FrameRecord
+	{
+		double global_transform[16];
+		unsigned long long topology_offset; // 0 is no topology
+		unsigned long long vertex_offset;
+		unsigned long long normal_offset;
+		unsigned int vertex_count;
+		unsigned int reserved;
+		float vertex_scale[3];
+		float vertex_offset_value[3];
+	};
+
+	struct TopologyHeader
+	{
+		unsigned int triangle_count;
+		unsigned int uv_count;
+		unsigned long long uv_offset; // from the header
+	};
+
+	unsigned long long align(unsigned long long offset)
+	{
+		return (offset + kAlignment - 1) / kAlignment * kAlignment;
+	}
+
+	/**
+	 * 64 bit hash of words of the data, to find repeated topology
+	 */
+	unsigned long long hash_bytes(const void* data, size_t size, unsigned long long hash)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			unsigned long long word;
+			std::memcpy(&word, bytes + i, 8);
+			hash = (hash ^ word) * 1099511628211ULL;
+			hash ^= hash >> 29;
+		}
+		for (; i < size; ++i)
+		{
+			hash = (hash ^ bytes[i]) * 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	/**
+	 * appends blocks to the baked file from the workers.
+	 * blocks go to a temporary file which replaces the baked file by rename on commit,
+	 * so mappings of the previous file keep their pages and a failed bake keeps it.
+	 */
+	class BakeOutput
+	{
+		DISALLOW_COPY_AND_ASSIGN(BakeOutput);
+	public:
+		/**
+		 * @param [in] path file path
+		 * @param [in] reserved_size bytes of tables at the start of the file
+		 */
+		BakeOutput(const std::string& path, unsigned long long reserved_size)
+			: path_(path)
+			, temporary_path_(UMAbcFileSystem::temporary_path(path))
+			, stream_(temporary_path_.c_str(), std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc)
+			, cursor_(reserved_size)
+			, is_committed_(false)
+		{}
+
+		~BakeOutput()
+		{
+			if (is_committed_) return;
+			stream_.close();
+			std::remove(temporary_path_.c_str());
+		}
+
+		bool is_valid()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return !!stream_;
+		}
+
+		/**
+		 * write the block at the end of the file
+		 * @retval offset of the block. 0 is fail.
+		 */
+		unsigned long long append(const void* data, size_t size)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return append_locked(data, size);
+		}
+
+		/**
+		 * write the topology unless the same topology is written
+		 * @retval offset of the topology. 0 is fail.
+		 */
+		unsigned long long append_topology(const std::vector<char>& topology)
+		{
+			const TopologyKey key(hash_bytes(topology.data(), topology.size(), 14695981039346656037ULL), topology.size());
+			std::lock_guard<std::mutex> lock(mutex_);
+			// topologies of same hash are compared with the written bytes
+			std::pair<TopologyMap::const_iterator, TopologyMap::const_iterator> range = topology_map_.equal_range(key);
+			for (TopologyMap::const_iterator it = range.first; it != range.second; ++it)
+			{
+				if (is_written_locked(it->second, topology)) return it->second;
+			}
+			const unsigned long long offset = append_locked(topology.data(), topology.size());
+			if (offset > 0)
+			{
+				topology_map_.insert(std::make_pair(key, offset));
+			}
+			return offset;
+		}
+
+		/**
+		 * write the block at the offset
+		 */
+		bool write(unsigned long long offset, const void* data, size_t size)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stream_.seekp(static_cast<std::streamoff>(offset));
+			stream_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			return !!stream_;
+		}
+
+		unsigned long long size()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			return cursor_;
+		}
+
+		/**
+		 * close and move the temporary file to the baked file path
+		 * @retval succsess or fail
+		 */
+		bool commit()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stream_.close();
+			if (stream_.fail()) return false;
+			is_committed_ = UMAbcFileSystem::replace(temporary_path_, path_);
+			return is_committed_;
+		}
+
+	private:
+		typedef std::pair<unsigned long long, size_t> TopologyKey;
+		typedef std::multimap<TopologyKey, unsigned long long> TopologyMap;
+
+		unsigned long long append_locked(const void* data, size_t size)
+		{
+			const unsigned long long offset = align(cursor_);
+			stream_.seekp(static_cast<std::streamoff>(offset));
+			stream_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			if (!stream_) return 0;
+			cursor_ = offset + size;
+			return offset;
+		}
+
+		/**
+		 * is the data written at the offset
+		 */
+		bool is_written_locked(unsigned long long offset, const std::vector<char>& data)
+		{
+			const size_t kChunkSize = 64 * 1024;
+			compare_buffer_.resize(kChunkSize);
+			stream_.seekg(static_cast<std::streamoff>(offset));
+			for (size_t i = 0, size = data.size(); i < size; i += kChunkSize)
+			{
+				const size_t chunk_size = std::min(kChunkSize, size - i);
+				if (!stream_.read(&compare_buffer_[0], static_cast<std::streamsize>(chunk_size)))
+				{
+					stream_.clear();
+					return false;
+				}
+				if (std::memcmp(&compare_buffer_[0], &data[i], chunk_size) != 0) return false;
+			}
+			return true;
+		}
+
+		std::mutex mutex_;
+		std::string path_;
+		std::string temporary_path_;
+		std::fstream stream_;
+		unsigned long long cursor_;
+		bool is_committed_;
+		TopologyMap topology_map_;
+		std::vector<char> compare_buffer_;
+	};
+
+	/**
+	 * bakes frames of meshes of one scene
+	 */
+	class FrameBaker
+	{
+		DISALLOW_COPY_AND_ASSIGN(FrameBaker);
+	public:
+		FrameBaker(BakeOutput& output, bool is_quantized)
+			: output_(output)
+			, is_quantized_(is_quantized)
+		{}
+
+		/**
+		 * write the mesh at the current time
+		 * @retval succsess or fail
+		 */
+		bool bake(UMAbcMeshPtr mesh, FrameRecord& record)
+		{
+			std::memset(&record, 0, sizeof(record));
+			for (int i = 0; i < 4; ++i)
+			{
+				for (int k = 0; k < 4; ++k)
+				{
+					record.global_transform[i * 4 + k] = mesh->global_transform()[i][k];
+				}
+			}
+			const unsigned int vertex_count = mesh->vertex_size();
+			if (vertex_count == 0) return true;
+			const Imath::V3f* vertex = mesh->vertex();
+			const std::vector<Imath::V3f>& normals = mesh->normals();
+			record.vertex_count = vertex_count;
+
+			// topology
+			const UMAbcMesh::IndexList& triangle_index = mesh->triangle_index();
+			const unsigned int uv_count = mesh->uv_size();
+			TopologyHeader header;
+			header.triangle_count = static_cast<unsigned int>(triangle_index.size());
+			header.uv_count = uv_count;
+			header.uv_offset = align(sizeof(TopologyHeader) + triangle_index.size() * sizeof(Imath::V3i));
+			topology_.assign(static_cast<size_t>(header.uv_offset + uv_count * sizeof(Imath::V2f)), 0);
+			std::memcpy(&topology_[0], &header, sizeof(header));
+			if (!triangle_index.empty())
+			{
+				std::memcpy(&topology_[sizeof(header)], &triangle_index[0], triangle_index.size() * sizeof(Imath::V3i));
+			}
+			// uvs are stored flipped as get_mesh returns them
+			Imath::V2f* uvs = reinterpret_cast<Imath::V2f*>(&topology_[static_cast<size_t>(header.uv_offset)]);
+			const Imath::V2f* uv = mesh->uv();
+			for (unsigned int i = 0; i < uv_count; ++i)
+			{
+				uvs[i] = Imath::V2f(uv[i].x, 1.0f - uv[i].y);
+			}
+			record.topology_offset = output_.append_topology(topology_);
+			if (record.topology_offset == 0) return false;
+
+			if (is_quantized_)
+			{
+				return bake_quantized(vertex, normals, record);
+			}
+			record.vertex_offset = output_.append(vertex, vertex_count * sizeof(Imath::V3f));
+			if (normals.size() == vertex_count)
+			{
+				record.normal_offset = output_.append(&normals[0], vertex_count * sizeof(Imath::V3f));
+				if (record.normal_offset == 0) return false;
+			}
+			return record.vertex_offset != 0;
+		}
+
+	private:
+		bool bake_quantized(const Imath::V3f* vertex, const std::vector<Imath::V3f>& normals, FrameRecord& record)
+		{
+			const unsigned int vertex_count = record.vertex_count;
+			Imath::V3f min_value = vertex[0];
+			Imath::V3f max_value = vertex[0];
+			for (unsigned int i = 1; i < vertex_count; ++i)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					min_value[k] = std::min(min_value[k], vertex[i][k]);
+					max_value[k] = std::max(max_value[k], vertex[i][k]);
+				}
+			}
+			Imath::V3f inverse_scale(0);
+			for (int k = 0; k < 3; ++k)
+			{
+				record.vertex_offset_value[k] = min_value[k];
+				record.vertex_scale[k] = (max_value[k] - min_value[k]) / 65535.0f;
+				if (record.vertex_scale[k] > 0)
+				{
+					inverse_scale[k] = 1.0f / record.vertex_scale[k];
+				}
+			}
+			quantized_vertex_.resize(vertex_count * 3);
+			for (unsigned int i = 0; i < vertex_count; ++i)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					const float value = (vertex[i][k] - min_value[k]) * inverse_scale[k] + 0.5f;
+					quantized_vertex_[i * 3 + k] = static_cast<unsigned short>(std::min(65535.0f, std::max(0.0f, value)));
+				}
+			}
+			record.vertex_offset = output_.append(&quantized_vertex_[0], quantized_vertex_.size() * sizeof(unsigned short));
+			if (record.vertex_offset == 0) return false;
+
+			if (normals.size() != vertex_count) return true;
+			quantized_normal_.resize(vertex_count * 3);
+			for (unsigned int i = 0; i < vertex_count; ++i)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					const float value = std::min(1.0f, std::max(-1.0f, normals[i][k])) * 127.0f;
+					quantized_normal_[i * 3 + k] = static_cast<signed char>(value < 0 ? value - 0.5f : value + 0.5f);
+				}
+			}
+			record.normal_offset = output_.append(&quantized_normal_[0], quantized_normal_.size());
+			return record.normal_offset != 0;
+		}
+
+		BakeOutput& output_;
+		bool is_quantized_;
+		// buffers reused between frames
+		std::vector<char> topology_;
+		std::vector<unsigned short> quantized_vertex_;
+		std::vector<signed char> quantized_normal_;
+	};
+
+	const FileHeader* file_header(const UMAbcMappedFile& file)
+	{
+		return reinterpret_cast<const FileHeader*>(file.data());
+	}
+
+	bool is_in_file(const UMAbcMappedFile& file, unsigned long long offset, unsigned long long size)
+	{
+		return offset <= file.size() && size <= file.size() - offset;
+	}
+} // anonymous namespace
+
+/**
+ * bake meshes of the archive
+ */
+bool UMAbcBakedFile::bake(
+	const std::string& path,
+	const std::string& out_path,
+	const UMAbcSetting& setting,
+	double frame_time,
+	bool is_quantized)
+{
+	if (!(frame_time > 0)) return false;
+	std::vector<std::string> mesh_path_list;
+	double start_time = 0;
+	unsigned int frame_count = 0;
+	{
+		UMAbcSoftwareIO abcio;
+		UMAbcScenePtr scene = abcio.load(path, setting);
+		if (!scene) return false;
+		mesh_path_list = scene->mesh_path_list();
+		start_time = scene->min_time();
+		const double max_time = std::max(scene->min_time(), scene->max_time());
+		frame_count = static_cast<unsigned int>(std::floor((max_time - start_time) / frame_time + 1e-6)) + 1;
+		scene->dispose();
+	}
+
+	// header, mesh table and frame records come first and blocks follow them
+	const size_t mesh_count = mesh_path_list.size();
+	const unsigned long long mesh_table_offset = align(sizeof(FileHeader));
+	const unsigned long long frame_table_offset = align(mesh_table_offset + mesh_count * sizeof(MeshHeader));
+	const unsigned long long frame_byte_size = mesh_count * sizeof(FrameRecord);
+	BakeOutput output(out_path, frame_table_offset + frame_byte_size * frame_count);
+	if (!output.is_valid()) return false;
+	std::mutex mutex;
+	bool is_failed = false;
+
+	// each chunk of frames reads its own scene, since objects keep one current time
+	const size_t grain = (frame_count + parallel_worker_count() - 1) / parallel_worker_count();
+	parallel_for(frame_count, grain, [&](size_t begin, size_t end) {
+		try
+		{
+			UMAbcSoftwareIO abcio;
+			UMAbcScenePtr scene = abcio.load(path, setting);
+			if (!scene) throw std::runtime_error("load");
+			std::vector<UMAbcMeshPtr> meshes(mesh_count);
+			for (size_t i = 0; i < mesh_count; ++i)
+			{
+				meshes[i] = std::dynamic_pointer_cast<UMAbcMesh>(scene->find_object(mesh_path_list[i]));
+			}
+			FrameBaker baker(output, is_quantized);
+			std::vector<FrameRecord> records(mesh_count);
+			for (size_t frame = begin; frame < end; ++frame)
+			{
+				scene->set_current_time(static_cast<unsigned long>(start_time + frame * frame_time + 0.5));
+				for (size_t i = 0; i < mesh_count; ++i)
+				{
+					if (!meshes[i])
+					{
+						std::memset(&records[i], 0, sizeof(FrameRecord));
+						continue;
+					}
+					if (!baker.bake(meshes[i], records[i])) throw std::runtime_error("write");
+				}
+				if (mesh_count > 0 && !output.write(
+					frame_table_offset + frame_byte_size * frame, &records[0], static_cast<size_t>(frame_byte_size)))
+				{
+					throw std::runtime_error("write");
+				}
+			}
+			scene->dispose();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			is_failed = true;
+		}
+	});
+	if (is_failed) return false;
+
+	std::vector<MeshHeader> mesh_headers(mesh_count);
+	for (size_t i = 0; i < mesh_count; ++i)
+	{
+		MeshHeader& header = mesh_headers[i];
+		header.path_size = static_cast<unsigned int>(mesh_path_list[i].size());
+		header.reserved = 0;
+		header.path_offset = output.append(mesh_path_list[i].c_str(), mesh_path_list[i].size() + 1);
+		if (header.path_offset == 0) return false;
+	}
+	if (mesh_count > 0 && !output.write(mesh_table_offset, &mesh_headers[0], mesh_count * sizeof(MeshHeader)))
+	{
+		return false;
+	}
+	FileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.flags = is_quantized ? kFlagQuantized : 0;
+	header.mesh_count = static_cast<unsigned int>(mesh_count);
+	header.frame_count = frame_count;
+	header.start_time = start_time;
+	header.frame_time = frame_time;
+	header.mesh_table_offset = mesh_table_offset;
+	header.frame_table_offset = frame_table_offset;
+	header.file_size = output.size();
+	// the header is written last, so an interrupted bake is not a valid file
+	if (!output.write(0, &header, sizeof(header))) return false;
+	return output.commit();
+}
+
+/**
+ * map the baked file
+ */
+UMAbcBakedFilePtr UMAbcBakedFile::open(const std::string& path)
+{
+	UMAbcMappedFilePtr file = UMAbcMappedFile::open(path, true);
+	if (!file || file->size() < sizeof(FileHeader)) return UMAbcBakedFilePtr();
+	const FileHeader* header = file_header(*file);
+	if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+		|| header->version != kVersion
+		|| header->file_size != file->size()
+		|| !is_in_file(*file, header->mesh_table_offset,
+			static_cast<unsigned long long>(header->mesh_count) * sizeof(MeshHeader))
+		|| !is_in_file(*file, header->frame_table_offset,
+			static_cast<unsigned long long>(header->mesh_count) * header->frame_count * sizeof(FrameRecord)))
+	{
+		return UMAbcBakedFilePtr();
+	}
+
+	UMAbcBakedFilePtr baked(new UMAbcBakedFile());
+	baked->file_ = file;
+	const MeshHeader* mesh_headers = reinterpret_cast<const MeshHeader*>(file->data() + header->mesh_table_offset);
+	for (unsigned int i = 0; i < header->mesh_count; ++i)
+	{
+		const MeshHeader& mesh_header = mesh_headers[i];
+		if (!is_in_file(*file, mesh_header.path_offset, mesh_header.path_size))
+		{
+			return UMAbcBakedFilePtr();
+		}
+		const std::string mesh_path(file->data() + mesh_header.path_offset, mesh_header.path_size);
+		baked->mesh_index_map_[mesh_path] = i;
+		baked->mesh_path_list_.push_back(mesh_path);
+	}
+	return baked;
+}
+
+/**
+ * get number of frames
+ */
+unsigned int UMAbcBakedFile::frame_count() const
+{
+	return file_header(*file_)->frame_count;
+}
+
+/**
+ * get time of frame 0
+ */
+double UMAbcBakedFile::start_time() const
+{
+	return file_header(*file_)->start_time;
+}
+
+/**
+ * get milliseconds per frame
+ */
+double UMAbcBakedFile::frame_time() const
+{
+	return file_header(*file_)->frame_time;
+}
+
+/**
+ * is quantized
+ */
+bool UMAbcBakedFile::is_quantized() const
+{
+	return (file_header(*file_)->flags & kFlagQuantized) != 0;
+}
+
+/**
+ * get nearest frame of the time
+ */
+unsigned int UMAbcBakedFile::frame_at(double time) const
+{
+	const unsigned int count = frame_count();
+	if (count == 0) return 0;
+	const double frame = std::floor((time - start_time()) / frame_time() + 0.5);
+	if (frame <= 0) return 0;
+	return static_cast<unsigned int>(std::min<double>(frame, count - 1));
+}
+
+/**
+ * get views of the mesh at the frame
+ */
+bool UMAbcBakedFile::mesh_frame(const std::string& mesh_path, unsigned int frame, MeshFrame& result) const
+{
+	std::memset(&result, 0, sizeof(result));
+	std::map<std::string, unsigned int>::const_iterator it = mesh_index_map_.find(mesh_path);
+	if (it == mesh_index_map_.end() || frame >= frame_count()) return false;
+
+	const FileHeader* header = file_header(*file_);
+	const FrameRecord& record = reinterpret_cast<const FrameRecord*>(
+		file_->data() + header->frame_table_offset)[static_cast<size_t>(frame) * header->mesh_count + it->second];
+	result.global_transform = record.global_transform;
+	for (int k = 0; k < 3; ++k)
+	{
+		result.vertex_scale[k] = record.vertex_scale[k];
+		result.vertex_offset[k] = record.vertex_offset_value[k];
+	}
+	if (record.vertex_count == 0) return true;
+
+	const bool quantized = is_quantized();
+	const unsigned long long vertex_byte_size = static_cast<unsigned long long>(record.vertex_count)
+		* (quantized ? 3 * sizeof(unsigned short) : sizeof(Imath::V3f));
+	const unsigned long long normal_byte_size = static_cast<unsigned long long>(record.vertex_count)
+		* (quantized ? 3 : sizeof(Imath::V3f));
+	if (!is_in_file(*file_, record.vertex_offset, vertex_byte_size)
+		|| (record.normal_offset != 0 && !is_in_file(*file_, record.normal_offset, normal_byte_size))
+		|| !is_in_file(*file_, record.topology_offset, sizeof(TopologyHeader)))
+	{
+		return false;
+	}
+	const TopologyHeader& topology = *reinterpret_cast<const TopologyHeader*>(file_->data() + record.topology_offset);
+	if (!is_in_file(*file_, record.topology_offset + sizeof(TopologyHeader),
+			static_cast<unsigned long long>(topology.triangle_count) * sizeof(Imath::V3i))
+		|| !is_in_file(*file_, record.topology_offset + topology.uv_offset,
+			static_cast<unsigned long long>(topology.uv_count) * sizeof(Imath::V2f)))
+	{
+		return false;
+	}
+	result.vertex = file_->data() + record.vertex_offset;
+	result.normal = record.normal_offset != 0 ? file_->data() + record.normal_offset : NULL;
+	result.vertex_count = record.vertex_count;
+	result.index = reinterpret_cast<const int*>(file_->data() + record.topology_offset + sizeof(TopologyHeader));
+	result.triangle_count = topology.triangle_count;
+	result.uv = topology.uv_count > 0
+		? reinterpret_cast<const float*>(file_->data() + record.topology_offset + topology.uv_offset)
+		: NULL;
+	result.uv_count = topology.uv_count;
+	return true;
+}
+
+} // umabc
@@ -0,0 +1,136 @@
+/**
+ * @file UMAbcBakedFile.h
+ * sidecar file of triangulated mesh frames for playback
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+#include "UMMacro.h"
+#include "UMAbcSetting.h"
+#include "UMAbcMappedFile.h"
+
+namespace umabc
+{
+
+class UMAbcBakedFile;
+typedef std::shared_ptr<UMAbcBakedFile> UMAbcBakedFilePtr;
+
+/**
+ * meshes of a scene baked at fixed frames, as get_mesh returns them.
+ * triangle indices and uvs are stored once per distinct topology, and each frame
+ * stores vertices, normals and the global transform of each mesh as aligned blocks,
+ * so a frame is served as views into the mapped file without decoding.
+ * quantized files store vertices as 16 bit units of the frame box and normals as 8 bit.
+ * the file is written in the byte order of the baking machine.
+ */
+class UMAbcBakedFile
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcBakedFile);
+public:
+
+	/**
+	 * views of a mesh at a frame. arrays are null when the mesh has no data at the frame.
+	 */
+	struct MeshFrame
+	{
+		const void* vertex; // float xyz, or uint16 xyz of quantized files
+		const void* normal; // float xyz, or int8 xyz of quantized files
+		unsigned int vertex_count;
+		const int* index; // xyz per triangle
+		unsigned int triangle_count;
+		const float* uv; // uv per vertex
+		unsigned int uv_count;
+		const double* global_transform; // 16 values
+		float vertex_scale[3]; // quantized vertex is offset + value * scale
+		float vertex_offset[3];
+	};
+
+	/**
+	 * bake meshes of the archive. frames are baked side by side,
+	 * each worker reading its own scene of the archive.
+	 * @param [in] path archive path
+	 * @param [in] out_path baked file path
+	 * @param [in] setting setting to load the archive with
+	 * @param [in] frame_time milliseconds per frame
+	 * @param [in] is_quantized quantize vertices and normals
+	 * @retval succsess or fail
+	 */
+	static bool bake(
+		const std::string& path,
+		const std::string& out_path,
+		const UMAbcSetting& setting,
+		double frame_time,
+		bool is_quantized);
+
+	/**
+	 * map the baked file
+	 * @retval opened file or null when it is not a valid baked file
+	 */
+	static UMAbcBakedFilePtr open(const std::string& path);
+
+	~UMAbcBakedFile() {}
+
+	/**
+	 * get mapped bytes. writable, written pages are private copies.
+	 */
+	char* data() const { return const_cast<char*>(file_->data()); }
+
+	/**
+	 * get file size
+	 */
+	size_t size() const { return file_->size(); }
+
+	/**
+	 * get mesh path list
+	 */
+	const std::vector<std::string>& mesh_path_list() const { return mesh_path_list_; }
+
+	/**
+	 * get number of frames
+	 */
+	unsigned int frame_count() const;
+
+	/**
+	 * get time of frame 0 in milliseconds
+	 */
+	double start_time() const;
+
+	/**
+	 * get milliseconds per frame
+	 */
+	double frame_time() const;
+
+	/**
+	 * is quantized
+	 */
+	bool is_quantized() const;
+
+	/**
+	 * get nearest frame of the time in milliseconds
+	 */
+	unsigned int frame_at(double time) const;
+
+	/**
+	 * get views of the mesh at the frame
+	 * @retval false when the mesh is not baked
+	 */
+	bool mesh_frame(const std::string& mesh_path, unsigned int frame, MeshFrame& result) const;
+
+private:
+	UMAbcBakedFile() {}
+
+	UMAbcMappedFilePtr file_;
+	std::vector<std::string> mesh_path_list_;
+	std::map<std::string, unsigned int> mesh_index_map_;
+};
+
+} // umabc
@@ -8,18 +8,77 @@
  * Licensed  under the MIT license. 
  *
  */
+#include <cmath>
 #include <algorithm>
 #include <Alembic/Abc/All.h>
 #include <Alembic/AbcGeom/All.h>
 #include <Alembic/AbcCoreFactory/All.h>
 
 #include "UMAbcCamera.h"
+#include "UMAbcXform.h"
 
 namespace umabc
 {
 	using namespace Alembic::Abc;
 	using namespace Alembic::AbcGeom;
 
+	namespace
+	{
+		/**
+		 * make view, projection and frustum planes from a camera sample
+		 */
+		void make_view(CameraSample& sample, const Imath::M44d& global_transform, UMAbcCamera::View& view)
+		{
+			view.global_transform = global_transform;
+			view.view_matrix = global_transform.inverse();
+			view.focal_length = sample.getFocalLength();
+			view.horizontal_aperture = sample.getHorizontalAperture();
+			view.vertical_aperture = sample.getVerticalAperture();
+			view.near_clipping = sample.getNearClippingPlane();
+			view.far_clipping = sample.getFarClippingPlane();
+			view.is_valid = view.focal_length > 0
+				&& view.horizontal_aperture > 0
+				&& view.far_clipping > view.near_clipping;
+			if (!view.is_valid) return;
+
+			view.field_of_view = sample.getFieldOfView();
+			double top, bottom, left, right;
+			sample.getScreenWindow(top, bottom, left, right);
+			view.screen_window = Imath::V4d(left, right, bottom, top);
+
+			// screen window is in units of tan(fov / 2) on the image plane.
+			const double s = 1.0 / std::tan(view.field_of_view * M_PI / 360.0);
+			const double n = view.near_clipping;
+			const double f = view.far_clipping;
+			Imath::M44d& p = view.projection_matrix;
+			p.makeIdentity();
+			p[0][0] = 2.0 * s / (right - left);
+			p[1][1] = 2.0 * s / (top - bottom);
+			p[2][0] = (right + left) / (right - left);
+			p[2][1] = (top + bottom) / (top - bottom);
+			p[2][2] = -(f + n) / (f - n);
+			p[2][3] = -1.0;
+			p[3][2] = -2.0 * f * n / (f - n);
+			p[3][3] = 0.0;
+
+			// planes from the columns of view projection
+			const Imath::M44d m = view.view_matrix * p;
+			for (int i = 0; i < 6; ++i)
+			{
+				const int axis = i / 2;
+				const double sign = (i % 2 == 0) ? 1.0 : -1.0;
+				Imath::V4d plane(
+					m[0][3] + sign * m[0][axis],
+					m[1][3] + sign * m[1][axis],
+					m[2][3] + sign * m[2][axis],
+					m[3][3] + sign * m[3][axis]);
+				const double length = Imath::V3d(plane.x, plane.y, plane.z).length();
+				if (length > 0) plane /= length;
+				view.planes[i] = plane;
+			}
+		}
+	} // anonymous namespace
+
 	class UMAbcCamera::Impl : public UMAbcObject
 	{
 		DISALLOW_COPY_AND_ASSIGN(Impl);
@@ -35,6 +94,15 @@ namespace umabc
 
 		void set_current_time(unsigned long time, bool recursive);
 
+		const View& view() const { return view_; }
+
+		void evaluate(const std::vector<unsigned long>& times, std::vector<View>& views);
+
+		/**
+		* add bytes held by this camera
+		*/
+		void memory_usage(UMAbcMemoryUsage& usage) const;
+
 		virtual UMAbcObjectPtr self_reference()
 		{
 			return self_reference_.lock();
@@ -43,8 +111,18 @@ namespace umabc
 		UMAbcCameraWeakPtr self_reference_;
 
 	private:
+		/**
+		 * get camera sample by index from the table
+		 */
+		CameraSample& sample_at(size_t index);
+
 		ICameraPtr camera_;
 		Alembic::AbcGeom::CameraSample sample_;
+		View view_;
+
+		// camera sample table by sample index
+		std::vector<CameraSample> sample_table_;
+		std::vector<bool> sample_loaded_;
 	};
 
 
@@ -75,6 +153,66 @@ bool UMAbcCamera::Impl::init(bool recursive)
 
 void UMAbcCamera::Impl::set_current_time(unsigned long time, bool recursive)
 {
+	if (!is_valid()) return;
+	ICameraSchema &schema = camera_->getSchema();
+	const size_t num_samples = schema.getNumSamples();
+	if (num_samples == 0) return;
+
+	const size_t index = schema.getTimeSampling()->getNearIndex(time / 1000.0, num_samples).first;
+	make_view(sample_at(index), self_reference()->global_transform(), view_);
+}
+
+/**
+ * get camera sample by index
+ */
+CameraSample& UMAbcCamera::Impl::sample_at(size_t index)
+{
+	ICameraSchema &schema = camera_->getSchema();
+	const size_t num_samples = schema.getNumSamples();
+	if (sample_table_.size() != num_samples)
+	{
+		sample_table_.assign(num_samples, CameraSample());
+		sample_loaded_.assign(num_samples, false);
+	}
+	if (!sample_loaded_[index])
+	{
+		schema.get(sample_table_[index], ISampleSelector(static_cast<index_t>(index)));
+		sample_loaded_[index] = true;
+	}
+	return sample_table_[index];
+}
+
+/**
+ * evaluate camera at many times
+ */
+void UMAbcCamera::Impl::evaluate(const std::vector<unsigned long>& times, std::vector<View>& views)
+{
+	views.clear();
+	views.resize(times.size());
+	if (!is_valid()) return;
+	ICameraSchema &schema = camera_->getSchema();
+	const size_t num_samples = schema.getNumSamples();
+	if (num_samples == 0) return;
+
+	// parent chain from the camera to the root
+	std::vector<UMAbcNodePtr> chain;
+	for (UMAbcNodePtr node = self_reference(); node; node = node->parent())
+	{
+		chain.push_back(node);
+	}
+
+	TimeSamplingPtr sampling = schema.getTimeSampling();
+	for (size_t i = 0, size = times.size(); i < size; ++i)
+	{
+		Imath::M44d global_transform;
+		for (size_t k = 0, ksize = chain.size(); k < ksize; ++k)
+		{
+			UMAbcXformPtr xform = std::dynamic_pointer_cast<UMAbcXform>(chain[k]);
+			global_transform = global_transform * (xform ? xform->local_transform_at(times[i]) : chain[k]->local_transform());
+		}
+		const size_t index = sampling->getNearIndex(times[i] / 1000.0, num_samples).first;
+		make_view(sample_at(index), global_transform, views[i]);
+	}
 }
 
 /**
@@ -118,8 +256,18 @@ bool UMAbcCamera::init(bool recursive, UMAbcObjectPtr parent)
 void UMAbcCamera::set_current_time(unsigned long time, bool recursive)
 {
 	if (!impl_->is_valid()) return;
-	impl_->set_current_time(time, recursive);
 	UMAbcObject::set_current_time(time, recursive);
+	impl_->set_current_time(time, recursive);
+}
+
+/**
+ * add bytes held by this camera
+ */
+void UMAbcCamera::Impl::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(Impl) - sizeof(UMAbcObject);
+	usage.sample += sample_table_.capacity() * sizeof(CameraSample) + sample_loaded_.capacity() / 8;
 }
 
 /**
@@ -129,6 +277,32 @@ void UMAbcCamera::update_box(bool recursive)
 {
 }
 
+/**
+ * add bytes held by this camera
+ */
+void UMAbcCamera::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(UMAbcCamera) - sizeof(UMAbcObject);
+	impl_->memory_usage(usage);
+}
+
+/**
+ * get camera evaluated at current time
+ */
+const UMAbcCamera::View& UMAbcCamera::view() const
+{
+	return impl_->view();
+}
+
+/**
+ * evaluate camera at many times
+ */
+void UMAbcCamera::evaluate(const std::vector<unsigned long>& times, std::vector<View>& views)
+{
+	impl_->evaluate(times, views);
+}
+
 UMAbcObjectPtr UMAbcCamera::self_reference()
 {
 	return impl_->self_reference();
@@ -11,8 +11,11 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "UMMacro.h"
+#include "ImathVec.h"
+#include "ImathMatrix.h"
 #include "UMAbcObject.h"
 
 namespace Alembic {
@@ -43,6 +46,39 @@ class UMAbcCamera : public UMAbcObject
 	DISALLOW_COPY_AND_ASSIGN(UMAbcCamera);
 public:
 
+	/**
+	 * evaluated camera.
+	 * matrices multiply row vectors. planes are in world space and
+	 * a point is inside when ax + by + cz + d >= 0.
+	 */
+	struct View
+	{
+		View()
+			: focal_length(0)
+			, horizontal_aperture(0)
+			, vertical_aperture(0)
+			, near_clipping(0)
+			, far_clipping(0)
+			, field_of_view(0)
+			, is_valid(false)
+		{}
+		Imath::M44d global_transform;
+		Imath::M44d view_matrix;
+		Imath::M44d projection_matrix;
+		// left, right, bottom, top, near, far
+		Imath::V4d planes[6];
+		// screen window. left, right, bottom, top
+		Imath::V4d screen_window;
+		double focal_length;
+		double horizontal_aperture;
+		double vertical_aperture;
+		double near_clipping;
+		double far_clipping;
+		// horizontal field of view in degrees
+		double field_of_view;
+		bool is_valid;
+	};
+
 	/**
 	 * crate instance
 	 */
@@ -69,6 +105,25 @@ public:
 	 * @param [in] recursive do children recursively
 	 */
 	virtual void update_box(bool recursive);
+
+	/**
+	 * add bytes held by this camera, without children
+	 * @param [out] usage memory usage
+	 */
+	virtual void memory_usage(UMAbcMemoryUsage& usage) const;
+
+	/**
+	 * get camera evaluated at current time
+	 */
+	const View& view() const;
+
+	/**
+	 * evaluate camera at many times without changing the current time.
+	 * camera samples and parent transforms are read once per sample index.
+	 * @param [in] times times in milliseconds
+	 * @param [out] views evaluated cameras
+	 */
+	void evaluate(const std::vector<unsigned long>& times, std::vector<View>& views);
 	
 protected:
 	UMAbcCamera(ICameraPtr camera);
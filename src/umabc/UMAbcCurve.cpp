@@ -14,6 +14,8 @@
 #include <Alembic/AbcCoreFactory/All.h>
 
 #include "UMAbcCurve.h"
+#include "UMAbcSampleCache.h"
+#include "UMAbcParallel.h"
 
 namespace umabc
 {
@@ -27,6 +29,13 @@ namespace umabc
 		Impl(ICurvesPtr curves)
 			: UMAbcObject(curves)
 			, curves_(curves)
+			, curve_count_(0)
+			, type_(kCubic)
+			, basis_(kBezierBasis)
+			, wrap_(kNonPeriodic)
+			, lod_fraction_(-1.0f)
+			, lod_has_key_(false)
+			, bounds_has_key_(false)
 		{}
 
 		/**
@@ -54,6 +63,27 @@ namespace umabc
 		*/
 		void update_curve_all();
 
+		/**
+		* tessellate curves
+		*/
+		const UMAbcCurveTessellator& tessellate(
+			const UMAbcCurveTessellator::Setting& setting,
+			const std::vector<unsigned int>* curve_index);
+
+		/**
+		* get per strand bounds
+		*/
+		const std::vector<Imath::Box3f>& strand_bounds(const Imath::M44d& matrix);
+
+		/**
+		* get reduced strand index list
+		*/
+		const std::vector<unsigned int>& reduced_curve_index(const ReduceSetting& setting);
+
+		/**
+		* add bytes held by this curve
+		*/
+		void memory_usage(UMAbcMemoryUsage& usage) const;
 
 		virtual UMAbcObjectPtr self_reference()
 		{
@@ -70,6 +100,8 @@ namespace umabc
 
 		const std::vector<int>& vertex_count_list() const { return vertex_count_list_; }
 
+		Alembic::AbcGeom::FloatArraySamplePtr widths() const { return widths_; }
+
 	private:
 		ICurvesPtr curves_;
 		Alembic::AbcGeom::P3fArraySamplePtr positions_;
@@ -79,6 +111,31 @@ namespace umabc
 
 		Alembic::AbcGeom::ICurvesSchema::Sample initial_sample_;
 
+		Alembic::AbcGeom::CurveType type_;
+		Alembic::AbcGeom::BasisType basis_;
+		Alembic::AbcGeom::CurvePeriodicity wrap_;
+		Alembic::AbcGeom::UcharArraySamplePtr orders_;
+		Alembic::AbcGeom::FloatArraySamplePtr knots_;
+		Alembic::AbcGeom::FloatArraySamplePtr weights_;
+		Alembic::AbcGeom::FloatArraySamplePtr widths_;
+
+		UMAbcCurveTessellator tessellator_;
+
+		// strand lod cache. valid while the strand topology is unchanged
+		float lod_fraction_;
+		bool lod_has_key_;
+		Alembic::AbcCoreAbstract::ArraySampleKey lod_topology_key_;
+		std::vector<unsigned int> lod_index_;
+
+		// strand bounds cache. valid for same positions digest and matrix
+		bool bounds_has_key_;
+		Alembic::AbcCoreAbstract::ArraySampleKey bounds_positions_key_;
+		Imath::M44d bounds_matrix_;
+		std::vector<Imath::Box3f> strand_bounds_;
+
+		std::vector<unsigned int> first_vertex_;
+		std::vector<unsigned int> reduced_index_;
+
 		std::vector<const Imath::V3f* > points_;
 	};
 
@@ -150,8 +207,236 @@ void UMAbcCurve::Impl::update_curve_all()
 	positions_ = sample.getPositions();
 	curve_count_ = sample.getNumCurves();
 	vertex_count_ = sample.getCurvesNumVertices();
-	vertex_count_list_.resize(vertex_count_->size());
-	memcpy(&(*vertex_count_list_.begin()), vertex_count_->getData(), vertex_count_->size() * 4);
+	vertex_count_list_.resize(vertex_count_ ? vertex_count_->size() : 0);
+	if (!vertex_count_list_.empty())
+	{
+		memcpy(&(*vertex_count_list_.begin()), vertex_count_->getData(), vertex_count_->size() * sizeof(int));
+	}
+
+	type_ = sample.getType();
+	basis_ = sample.getBasis();
+	wrap_ = sample.getWrap();
+	orders_ = sample.getOrders();
+	knots_ = sample.getKnots();
+	weights_ = sample.getPositionWeights();
+
+	widths_.reset();
+	IFloatGeomParam width_param = curves_->getSchema().getWidthsParam();
+	if (width_param && width_param.getNumSamples() > 0)
+	{
+		IFloatGeomParam::Sample width_sample;
+		width_param.getExpanded(width_sample, selector);
+		widths_ = width_sample.getVals();
+	}
+}
+
+/**
+ * tessellate curves
+ */
+const UMAbcCurveTessellator& UMAbcCurve::Impl::tessellate(
+	const UMAbcCurveTessellator::Setting& setting,
+	const std::vector<unsigned int>* curve_index)
+{
+	UMAbcCurveTessellator::Curves curves;
+	if (positions_ && vertex_count_)
+	{
+		curves.positions = positions_->get();
+		curves.position_size = positions_->size();
+		curves.vertex_counts = vertex_count_->get();
+		curves.curve_count = vertex_count_->size();
+	}
+	if (type_ == kLinear)
+	{
+		curves.basis = UMAbcCurveTessellator::kCurveLinear;
+	}
+	else if (type_ == kVariableOrder)
+	{
+		curves.basis = UMAbcCurveTessellator::kCurveVariableOrder;
+		curves.orders = orders_ ? orders_->get() : NULL;
+		curves.knots = knots_ ? knots_->get() : NULL;
+		curves.knot_size = knots_ ? knots_->size() : 0;
+		if (weights_ && positions_ && weights_->size() == positions_->size())
+		{
+			curves.weights = weights_->get();
+		}
+	}
+	else
+	{
+		switch (basis_)
+		{
+		case kBezierBasis: curves.basis = UMAbcCurveTessellator::kCurveBezier; break;
+		case kBsplineBasis: curves.basis = UMAbcCurveTessellator::kCurveBspline; break;
+		case kCatmullromBasis: curves.basis = UMAbcCurveTessellator::kCurveCatmullrom; break;
+		case kHermiteBasis: curves.basis = UMAbcCurveTessellator::kCurveHermite; break;
+		default: curves.basis = UMAbcCurveTessellator::kCurveLinear; break;
+		}
+	}
+	curves.is_periodic = wrap_ == kPeriodic;
+	if (widths_)
+	{
+		curves.widths = widths_->get();
+		curves.width_size = widths_->size();
+	}
+	if (curve_index)
+	{
+		if (curve_index->empty())
+		{
+			// nothing selected
+			curves.curve_count = 0;
+		}
+		else
+		{
+			curves.curve_index = &(*curve_index)[0];
+			curves.curve_index_size = curve_index->size();
+		}
+	}
+	tessellator_.tessellate(curves, setting);
+	return tessellator_;
+}
+
+/**
+ * get per strand bounds
+ */
+const std::vector<Imath::Box3f>& UMAbcCurve::Impl::strand_bounds(const Imath::M44d& matrix)
+{
+	// positions digest identifies the positions, while a freed sample's address may be reused.
+	ArraySampleKey positions_key;
+	bool has_key = false;
+	if (positions_ && curves_->getSchema().getNumSamples() > 0)
+	{
+		ISampleSelector selector(self_reference()->current_time(), ISampleSelector::kNearIndex);
+		has_key = curves_->getSchema().getPositionsProperty().getKey(positions_key, selector);
+	}
+	if (has_key
+		&& bounds_has_key_
+		&& bounds_positions_key_ == positions_key
+		&& matrix == bounds_matrix_
+		&& strand_bounds_.size() == vertex_count_list_.size())
+	{
+		return strand_bounds_;
+	}
+	bounds_has_key_ = has_key;
+	bounds_positions_key_ = positions_key;
+	bounds_matrix_ = matrix;
+
+	const Imath::V3f* positions = positions_ ? positions_->get() : NULL;
+
+	const size_t curve_count = vertex_count_list_.size();
+	const size_t position_size = positions_ ? positions_->size() : 0;
+	first_vertex_.resize(curve_count + 1);
+	first_vertex_[0] = 0;
+	for (size_t i = 0; i < curve_count; ++i)
+	{
+		first_vertex_[i + 1] = first_vertex_[i] + std::max(0, vertex_count_list_[i]);
+	}
+	strand_bounds_.resize(curve_count);
+	if (!positions || first_vertex_[curve_count] > position_size)
+	{
+		for (size_t i = 0; i < curve_count; ++i) strand_bounds_[i].makeEmpty();
+		return strand_bounds_;
+	}
+
+	const float* widths = widths_ ? widths_->get() : NULL;
+	const size_t width_size = widths_ ? widths_->size() : 0;
+	parallel_for(curve_count, 1024, [&](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; ++c)
+		{
+			Imath::Box3f& box = strand_bounds_[c];
+			box.makeEmpty();
+			float max_width = 0.0f;
+			for (unsigned int i = first_vertex_[c]; i < first_vertex_[c + 1]; ++i)
+			{
+				box.extendBy(positions[i] * matrix);
+				if (width_size == position_size) max_width = std::max(max_width, widths[i]);
+			}
+			if (width_size == curve_count) max_width = widths[c];
+			else if (width_size == 1) max_width = widths[0];
+			if (!box.isEmpty() && max_width > 0.0f)
+			{
+				const Imath::V3f pad(max_width * 0.5f);
+				box.min -= pad;
+				box.max += pad;
+			}
+		}
+	});
+	return strand_bounds_;
+}
+
+/**
+ * get reduced strand index list
+ */
+const std::vector<unsigned int>& UMAbcCurve::Impl::reduced_curve_index(const ReduceSetting& setting)
+{
+	const size_t curve_count = vertex_count_list_.size();
+	const float fraction = std::max(0.0f, std::min(1.0f, setting.fraction));
+
+	// keep a fraction of strands by their hashed index.
+	ArraySampleKey topology_key;
+	bool has_key = false;
+	if (curves_->getSchema().getNumSamples() > 0)
+	{
+		ISampleSelector selector(self_reference()->current_time(), ISampleSelector::kNearIndex);
+		has_key = curves_->getSchema().getNumVerticesProperty().getKey(topology_key, selector);
+	}
+	if (lod_fraction_ != fraction
+		|| lod_index_.size() > curve_count
+		|| lod_has_key_ != has_key
+		|| !has_key
+		|| !(lod_topology_key_ == topology_key))
+	{
+		lod_fraction_ = fraction;
+		lod_has_key_ = has_key;
+		lod_topology_key_ = topology_key;
+		lod_index_.clear();
+		const double threshold = fraction * 18446744073709551615.0;
+		for (size_t c = 0; c < curve_count; ++c)
+		{
+			if (fraction >= 1.0f || static_cast<double>(hash_index(c)) < threshold)
+			{
+				lod_index_.push_back(static_cast<unsigned int>(c));
+			}
+		}
+	}
+	if (!setting.is_box_cull && !setting.is_frustum_cull)
+	{
+		return lod_index_;
+	}
+
+	// cull by world bounds
+	const std::vector<Imath::Box3f>& bounds = strand_bounds(setting.matrix);
+	std::vector<unsigned char> is_visible(lod_index_.size());
+	parallel_for(lod_index_.size(), 4096, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Imath::Box3f& box = bounds[lod_index_[i]];
+			bool visible = !box.isEmpty();
+			if (visible && setting.is_box_cull)
+			{
+				visible = box.max.x >= setting.box.min.x && box.min.x <= setting.box.max.x
+					&& box.max.y >= setting.box.min.y && box.min.y <= setting.box.max.y
+					&& box.max.z >= setting.box.min.z && box.min.z <= setting.box.max.z;
+			}
+			if (visible && setting.is_frustum_cull)
+			{
+				for (size_t p = 0, psize = setting.planes.size(); p < psize && visible; ++p)
+				{
+					// farthest corner along the plane normal
+					const Imath::V4d& plane = setting.planes[p];
+					const double x = plane.x >= 0 ? box.max.x : box.min.x;
+					const double y = plane.y >= 0 ? box.max.y : box.min.y;
+					const double z = plane.z >= 0 ? box.max.z : box.min.z;
+					visible = plane.x * x + plane.y * y + plane.z * z + plane.w >= 0;
+				}
+			}
+			is_visible[i] = visible ? 1 : 0;
+		}
+	});
+	reduced_index_.clear();
+	for (size_t i = 0, size = lod_index_.size(); i < size; ++i)
+	{
+		if (is_visible[i]) reduced_index_.push_back(lod_index_[i]);
+	}
+	return reduced_index_;
 }
 
 /**
@@ -193,6 +478,28 @@ void UMAbcCurve::set_current_time(unsigned long time, bool recursive)
 	impl_->set_current_time(time, recursive);
 }
 
+/**
+ * add bytes held by this curve
+ */
+void UMAbcCurve::Impl::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(Impl) - sizeof(UMAbcObject);
+	UMAbcSampleCache::add_usage(usage, positions_);
+	UMAbcSampleCache::add_usage(usage, vertex_count_);
+	UMAbcSampleCache::add_usage(usage, orders_);
+	UMAbcSampleCache::add_usage(usage, knots_);
+	UMAbcSampleCache::add_usage(usage, weights_);
+	UMAbcSampleCache::add_usage(usage, widths_);
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getPositions());
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getCurvesNumVertices());
+	usage.derived += tessellator_.byte_size()
+		+ vertex_count_list_.capacity() * sizeof(int)
+		+ (lod_index_.capacity() + first_vertex_.capacity() + reduced_index_.capacity()) * sizeof(unsigned int)
+		+ points_.capacity() * sizeof(const Imath::V3f*);
+	usage.bvh += strand_bounds_.capacity() * sizeof(Imath::Box3f);
+}
+
 /**
 * update box
 * @param [in] recursive do children recursively
@@ -200,6 +507,17 @@ void UMAbcCurve::set_current_time(unsigned long time, bool recursive)
 void UMAbcCurve::update_box(bool recursive)
 {
 	impl_->update_box(recursive);
+	mutable_box() = impl_->box();
+}
+
+/**
+ * add bytes held by this curve
+ */
+void UMAbcCurve::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(UMAbcCurve) - sizeof(UMAbcObject);
+	impl_->memory_usage(usage);
 }
 
 /**
@@ -241,6 +559,28 @@ unsigned int UMAbcCurve::position_size() const
 }
 
 
+/**
+* get widths
+*/
+const float * UMAbcCurve::widths() const
+{
+	if (impl_->widths()) {
+		return impl_->widths()->get();
+	}
+	return NULL;
+}
+
+/**
+* get width size
+*/
+unsigned int UMAbcCurve::width_size() const
+{
+	if (impl_->widths()) {
+		return impl_->widths()->size();
+	}
+	return 0;
+}
+
 /**
 * update curve all
 */
@@ -249,6 +589,32 @@ void UMAbcCurve::update_curve_all()
 	impl_->update_curve_all();
 }
 
+/**
+* tessellate curves
+*/
+const UMAbcCurveTessellator& UMAbcCurve::tessellate(
+	const UMAbcCurveTessellator::Setting& setting,
+	const std::vector<unsigned int>* curve_index)
+{
+	return impl_->tessellate(setting, curve_index);
+}
+
+/**
+* get per strand bounds
+*/
+const std::vector<Imath::Box3f>& UMAbcCurve::strand_bounds(const Imath::M44d& matrix)
+{
+	return impl_->strand_bounds(matrix);
+}
+
+/**
+* get reduced strand index list
+*/
+const std::vector<unsigned int>& UMAbcCurve::reduced_curve_index(const ReduceSetting& setting)
+{
+	return impl_->reduced_curve_index(setting);
+}
+
 UMAbcObjectPtr UMAbcCurve::self_reference()
 {
 	return impl_->self_reference_.lock();
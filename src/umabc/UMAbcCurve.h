@@ -13,6 +13,8 @@
 #include <memory>
 #include "UMMacro.h"
 #include "UMAbcObject.h"
+#include "UMAbcCurveTessellator.h"
+#include "ImathBox.h"
 
 namespace Alembic
 {
@@ -43,6 +45,30 @@ class UMAbcCurve : public UMAbcObject
 	DISALLOW_COPY_AND_ASSIGN(UMAbcCurve);
 public:
 
+	/**
+	 * strand reduction setting
+	 */
+	struct ReduceSetting
+	{
+		ReduceSetting()
+			: fraction(1.0f)
+			, is_box_cull(false)
+			, is_frustum_cull(false)
+		{
+			matrix.makeIdentity();
+		}
+		// fraction of strands to keep
+		float fraction;
+		// cull strands outside of the box
+		bool is_box_cull;
+		Imath::Box3d box;
+		// cull strands outside of the planes. a point is inside when ax + by + cz + d >= 0
+		bool is_frustum_cull;
+		std::vector<Imath::V4d> planes;
+		// matrix for strand bounds. box and planes are in this space
+		Imath::M44d matrix;
+	};
+
 	/**
 	 * crate instance
 	 */
@@ -70,6 +96,12 @@ public:
 	 */
 	virtual void update_box(bool recursive);
 
+	/**
+	 * add bytes held by this curve, without children
+	 * @param [out] usage memory usage
+	 */
+	virtual void memory_usage(UMAbcMemoryUsage& usage) const;
+
 	/**
 	 * curve count
 	 */
@@ -89,12 +121,45 @@ public:
 	* get position size
 	*/
 	unsigned int position_size() const;
+
+	/**
+	* get widths
+	*/
+	const float * widths() const;
+
+	/**
+	* get width size
+	*/
+	unsigned int width_size() const;
 	
 	/**
 	 * update curve all
 	 */
 	void update_curve_all();
 
+	/**
+	 * tessellate curves by its type, basis, wrap, knots and widths.
+	 * @param [in] setting tessellation setting
+	 * @retval tessellator which holds packed polylines or ribbons
+	 */
+	const UMAbcCurveTessellator& tessellate(
+		const UMAbcCurveTessellator::Setting& setting,
+		const std::vector<unsigned int>* curve_index = NULL);
+
+	/**
+	 * get per strand bounds
+	 * @param [in] matrix bounds are transformed by this matrix
+	 */
+	const std::vector<Imath::Box3f>& strand_bounds(const Imath::M44d& matrix);
+
+	/**
+	 * get reduced strand index list.
+	 * a deterministic fraction of strands is kept while the strand topology is unchanged,
+	 * then strands outside of the box or frustum are culled.
+	 * @param [in] setting reduction setting
+	 */
+	const std::vector<unsigned int>& reduced_curve_index(const ReduceSetting& setting);
+
 protected:
 	UMAbcCurve(ICurvesPtr curves);
 	
@@ -0,0 +1,586 @@
+/**
+ * @file UMAbcCurveTessellator.cpp
+ * basis curve tessellator
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include <cmath>
+#include <algorithm>
+
+#include "UMAbcCurveTessellator.h"
+#include "UMAbcParallel.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define UMABC_USE_SSE
+#endif
+
+namespace umabc
+{
+
+namespace
+{
+	// maximum order of variable order curves
+	const int kMaxOrder = 16;
+
+	/**
+	 * get number of cubic segments and distance between their first control points
+	 */
+	int cubic_segment_count(UMAbcCurveTessellator::CurveBasis basis, int vertex_count, bool is_periodic, int& step)
+	{
+		switch (basis)
+		{
+		case UMAbcCurveTessellator::kCurveBezier:
+			step = 3;
+			if (is_periodic) return vertex_count >= 3 ? vertex_count / 3 : 0;
+			return vertex_count >= 4 ? (vertex_count - 1) / 3 : 0;
+		case UMAbcCurveTessellator::kCurveBspline:
+		case UMAbcCurveTessellator::kCurveCatmullrom:
+			step = 1;
+			if (is_periodic) return vertex_count >= 3 ? vertex_count : 0;
+			return vertex_count >= 4 ? vertex_count - 3 : 0;
+		case UMAbcCurveTessellator::kCurveHermite:
+			step = 2;
+			if (is_periodic) return vertex_count >= 4 ? vertex_count / 2 : 0;
+			return vertex_count >= 4 ? (vertex_count - 2) / 2 : 0;
+		default:
+			step = 1;
+			return 0;
+		}
+	}
+
+	/**
+	 * convert 4 control points to bezier form. w is width.
+	 */
+	void to_bezier(UMAbcCurveTessellator::CurveBasis basis, const Imath::V4f p[4], Imath::V4f b[4])
+	{
+		switch (basis)
+		{
+		case UMAbcCurveTessellator::kCurveBspline:
+			b[0] = (p[0] + p[1] * 4.0f + p[2]) / 6.0f;
+			b[1] = (p[1] * 2.0f + p[2]) / 3.0f;
+			b[2] = (p[1] + p[2] * 2.0f) / 3.0f;
+			b[3] = (p[1] + p[2] * 4.0f + p[3]) / 6.0f;
+			break;
+		case UMAbcCurveTessellator::kCurveCatmullrom:
+			b[0] = p[1];
+			b[1] = p[1] + (p[2] - p[0]) / 6.0f;
+			b[2] = p[2] - (p[3] - p[1]) / 6.0f;
+			b[3] = p[2];
+			break;
+		case UMAbcCurveTessellator::kCurveHermite:
+			// point, tangent, point, tangent
+			b[0] = p[0];
+			b[1] = p[0] + p[1] / 3.0f;
+			b[2] = p[2] - p[3] / 3.0f;
+			b[3] = p[2];
+			b[1].w = p[0].w;
+			b[2].w = p[2].w;
+			break;
+		default:
+			b[0] = p[0];
+			b[1] = p[1];
+			b[2] = p[2];
+			b[3] = p[3];
+			break;
+		}
+	}
+
+	/**
+	 * get number of samples which keeps chordal error under tolerance.
+	 * uses the second differences of the control polygon.
+	 */
+	int chordal_sample_count(const Imath::V3f* points, int count, float tolerance, int max_segments)
+	{
+		float max_diff = 0.0f;
+		for (int i = 1; i + 1 < count; ++i)
+		{
+			const Imath::V3f diff = points[i - 1] - points[i] * 2.0f + points[i + 1];
+			max_diff = std::max(max_diff, diff.length());
+		}
+		if (max_diff <= 0.0f) return 1;
+		const float n = std::ceil(std::sqrt(0.75f * max_diff / std::max(tolerance, 1.0e-6f)));
+		return std::max(1, std::min(max_segments, static_cast<int>(n)));
+	}
+
+	/**
+	 * evaluate bezier segment at t = i / n for i in [0, n)
+	 */
+	void evaluate_bezier(const Imath::V4f b[4], int n, Imath::V3f* out, float* out_width)
+	{
+#ifdef UMABC_USE_SSE
+		const __m128 inv_n = _mm_set1_ps(1.0f / n);
+		const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 three = _mm_set1_ps(3.0f);
+		__m128 cx[4], cy[4], cz[4], cw[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			cx[k] = _mm_set1_ps(b[k].x);
+			cy[k] = _mm_set1_ps(b[k].y);
+			cz[k] = _mm_set1_ps(b[k].z);
+			cw[k] = _mm_set1_ps(b[k].w);
+		}
+		float x[4], y[4], z[4], w[4];
+		for (int i = 0; i < n; i += 4)
+		{
+			const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lane), inv_n);
+			const __m128 u = _mm_sub_ps(one, t);
+			const __m128 uu = _mm_mul_ps(u, u);
+			const __m128 tt = _mm_mul_ps(t, t);
+			const __m128 b0 = _mm_mul_ps(uu, u);
+			const __m128 b1 = _mm_mul_ps(three, _mm_mul_ps(uu, t));
+			const __m128 b2 = _mm_mul_ps(three, _mm_mul_ps(u, tt));
+			const __m128 b3 = _mm_mul_ps(tt, t);
+			_mm_storeu_ps(x, _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, cx[0]), _mm_mul_ps(b1, cx[1])),
+				_mm_add_ps(_mm_mul_ps(b2, cx[2]), _mm_mul_ps(b3, cx[3]))));
+			_mm_storeu_ps(y, _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, cy[0]), _mm_mul_ps(b1, cy[1])),
+				_mm_add_ps(_mm_mul_ps(b2, cy[2]), _mm_mul_ps(b3, cy[3]))));
+			_mm_storeu_ps(z, _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, cz[0]), _mm_mul_ps(b1, cz[1])),
+				_mm_add_ps(_mm_mul_ps(b2, cz[2]), _mm_mul_ps(b3, cz[3]))));
+			_mm_storeu_ps(w, _mm_add_ps(_mm_add_ps(_mm_mul_ps(b0, cw[0]), _mm_mul_ps(b1, cw[1])),
+				_mm_add_ps(_mm_mul_ps(b2, cw[2]), _mm_mul_ps(b3, cw[3]))));
+			const int lanes = std::min(4, n - i);
+			for (int l = 0; l < lanes; ++l)
+			{
+				out[i + l] = Imath::V3f(x[l], y[l], z[l]);
+				out_width[i + l] = w[l];
+			}
+		}
+#else
+		for (int i = 0; i < n; ++i)
+		{
+			const float t = static_cast<float>(i) / n;
+			const float u = 1.0f - t;
+			const Imath::V4f p = b[0] * (u * u * u) + b[1] * (3.0f * u * u * t) + b[2] * (3.0f * u * t * t) + b[3] * (t * t * t);
+			out[i] = Imath::V3f(p.x, p.y, p.z);
+			out_width[i] = p.w;
+		}
+#endif
+	}
+
+	/**
+	 * evaluate rational b-spline by de boor's algorithm.
+	 * @param [in] span knot span which contains t
+	 */
+	Imath::V4f evaluate_deboor(const Imath::V4f* points, const float* knots, int order, int span, float t)
+	{
+		Imath::V4f d[kMaxOrder];
+		for (int j = 0; j < order; ++j)
+		{
+			d[j] = points[j + span - order + 1];
+		}
+		for (int r = 1; r < order; ++r)
+		{
+			for (int j = order - 1; j >= r; --j)
+			{
+				const int index = j + span - order + 1;
+				const float denom = knots[index + order - r] - knots[index];
+				const float alpha = denom > 0.0f ? (t - knots[index]) / denom : 0.0f;
+				d[j] = d[j - 1] * (1.0f - alpha) + d[j] * alpha;
+			}
+		}
+		return d[order - 1];
+	}
+
+	/**
+	 * get average scale of matrix
+	 */
+	float matrix_scale(const Imath::M44d& m)
+	{
+		const double sx = Imath::V3d(m[0][0], m[0][1], m[0][2]).length();
+		const double sy = Imath::V3d(m[1][0], m[1][1], m[1][2]).length();
+		const double sz = Imath::V3d(m[2][0], m[2][1], m[2][2]).length();
+		return static_cast<float>((sx + sy + sz) / 3.0);
+	}
+
+	/**
+	 * one strand of the source curves
+	 */
+	struct Strand
+	{
+		const Imath::V3f* points;
+		const float* weights;
+		const float* knots;
+		int vertex_count;
+		int order;
+		size_t curve;
+		size_t first_vertex;
+	};
+} // anonymous namespace
+
+/**
+ * width at a vertex
+ */
+static float source_width(const UMAbcCurveTessellator::Curves& curves, const UMAbcCurveTessellator::Setting& setting, size_t curve, size_t vertex)
+{
+	if (curves.widths)
+	{
+		if (curves.width_size == curves.position_size && vertex < curves.width_size) return curves.widths[vertex];
+		if (curves.width_size == curves.curve_count && curve < curves.width_size) return curves.widths[curve];
+		if (curves.width_size == 1) return curves.widths[0];
+	}
+	return setting.default_width;
+}
+
+/**
+ * get number of polyline points of a strand
+ */
+static unsigned int strand_point_count(
+	const UMAbcCurveTessellator::Curves& curves,
+	const UMAbcCurveTessellator::Setting& setting,
+	const Strand& strand)
+{
+	const int n = strand.vertex_count;
+	if (n < 2) return 0;
+
+	if (curves.basis == UMAbcCurveTessellator::kCurveVariableOrder && strand.knots)
+	{
+		const int order = strand.order;
+		unsigned int count = 0;
+		for (int span = order - 1; span < n; ++span)
+		{
+			if (strand.knots[span] < strand.knots[span + 1])
+			{
+				count += chordal_sample_count(&strand.points[span - order + 1], order, setting.tolerance, setting.max_segments);
+			}
+		}
+		return count > 0 ? count + 1 : 0;
+	}
+
+	int step = 1;
+	const int segments = cubic_segment_count(curves.basis, n, curves.is_periodic, step);
+	if (segments <= 0)
+	{
+		// linear
+		return static_cast<unsigned int>(curves.is_periodic ? n + 1 : n);
+	}
+
+	unsigned int count = 0;
+	for (int s = 0; s < segments; ++s)
+	{
+		Imath::V4f p[4];
+		Imath::V4f b[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			const Imath::V3f& v = strand.points[(s * step + k) % n];
+			p[k] = Imath::V4f(v.x, v.y, v.z, 0.0f);
+		}
+		to_bezier(curves.basis, p, b);
+		Imath::V3f bezier[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			bezier[k] = Imath::V3f(b[k].x, b[k].y, b[k].z);
+		}
+		count += chordal_sample_count(bezier, 4, setting.tolerance, setting.max_segments);
+	}
+	return count + 1;
+}
+
+/**
+ * write polyline points of a strand
+ */
+static void strand_evaluate(
+	const UMAbcCurveTessellator::Curves& curves,
+	const UMAbcCurveTessellator::Setting& setting,
+	const Strand& strand,
+	float width_scale,
+	Imath::V3f* out,
+	float* out_width)
+{
+	const int n = strand.vertex_count;
+	if (n < 2) return;
+
+	if (curves.basis == UMAbcCurveTessellator::kCurveVariableOrder && strand.knots)
+	{
+		const int order = strand.order;
+		Imath::V4f homogeneous[kMaxOrder];
+		const float t_min = strand.knots[order - 1];
+		const float t_max = strand.knots[n];
+		const float t_range = t_max > t_min ? t_max - t_min : 1.0f;
+		int last_span = order - 1;
+		int written = 0;
+		for (int span = order - 1; span < n; ++span)
+		{
+			const float t0 = strand.knots[span];
+			const float t1 = strand.knots[span + 1];
+			if (!(t0 < t1)) continue;
+			last_span = span;
+			const int first = span - order + 1;
+			for (int k = 0; k < order; ++k)
+			{
+				const Imath::V3f& v = strand.points[first + k];
+				const float w = strand.weights ? strand.weights[first + k] : 1.0f;
+				homogeneous[k] = Imath::V4f(v.x * w, v.y * w, v.z * w, w);
+			}
+			const int samples = chordal_sample_count(&strand.points[first], order, setting.tolerance, setting.max_segments);
+			for (int i = 0; i < samples; ++i)
+			{
+				const float t = t0 + (t1 - t0) * i / samples;
+				// homogeneous points are shifted so that span starts at order - 1
+				const Imath::V4f p = evaluate_deboor(homogeneous, &strand.knots[first], order, order - 1, t);
+				const float inv_w = p.w != 0.0f ? 1.0f / p.w : 1.0f;
+				out[written] = Imath::V3f(p.x * inv_w, p.y * inv_w, p.z * inv_w);
+				// widths follow the parameter linearly
+				const float param = (t - t_min) / t_range * (n - 1);
+				const int index = std::min(n - 2, static_cast<int>(param));
+				const float frac = param - index;
+				out_width[written] = width_scale * (
+					source_width(curves, setting, strand.curve, strand.first_vertex + index) * (1.0f - frac) +
+					source_width(curves, setting, strand.curve, strand.first_vertex + index + 1) * frac);
+				++written;
+			}
+		}
+		if (written > 0)
+		{
+			const int first = last_span - order + 1;
+			for (int k = 0; k < order; ++k)
+			{
+				const Imath::V3f& v = strand.points[first + k];
+				const float w = strand.weights ? strand.weights[first + k] : 1.0f;
+				homogeneous[k] = Imath::V4f(v.x * w, v.y * w, v.z * w, w);
+			}
+			const Imath::V4f p = evaluate_deboor(homogeneous, &strand.knots[first], order, order - 1, strand.knots[last_span + 1]);
+			const float inv_w = p.w != 0.0f ? 1.0f / p.w : 1.0f;
+			out[written] = Imath::V3f(p.x * inv_w, p.y * inv_w, p.z * inv_w);
+			out_width[written] = width_scale * source_width(curves, setting, strand.curve, strand.first_vertex + n - 1);
+		}
+		return;
+	}
+
+	int step = 1;
+	const int segments = cubic_segment_count(curves.basis, n, curves.is_periodic, step);
+	if (segments <= 0)
+	{
+		// linear
+		const int count = curves.is_periodic ? n + 1 : n;
+		for (int i = 0; i < count; ++i)
+		{
+			out[i] = strand.points[i % n];
+			out_width[i] = width_scale * source_width(curves, setting, strand.curve, strand.first_vertex + (i % n));
+		}
+		return;
+	}
+
+	int written = 0;
+	Imath::V4f b[4];
+	for (int s = 0; s < segments; ++s)
+	{
+		Imath::V4f p[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			const int index = (s * step + k) % n;
+			const Imath::V3f& v = strand.points[index];
+			p[k] = Imath::V4f(v.x, v.y, v.z,
+				width_scale * source_width(curves, setting, strand.curve, strand.first_vertex + index));
+		}
+		to_bezier(curves.basis, p, b);
+		Imath::V3f bezier[4];
+		for (int k = 0; k < 4; ++k)
+		{
+			bezier[k] = Imath::V3f(b[k].x, b[k].y, b[k].z);
+		}
+		const int samples = chordal_sample_count(bezier, 4, setting.tolerance, setting.max_segments);
+		evaluate_bezier(b, samples, &out[written], &out_width[written]);
+		written += samples;
+	}
+	// end point of the last segment
+	out[written] = Imath::V3f(b[3].x, b[3].y, b[3].z);
+	out_width[written] = b[3].w;
+}
+
+/**
+ * build camera facing ribbon of a strand
+ */
+static void strand_ribbon(
+	const Imath::V3f* points,
+	const float* widths,
+	unsigned int count,
+	const Imath::V3f& camera_position,
+	unsigned int first_vertex,
+	Imath::V3f* out_vertex,
+	Imath::V3f* out_normal,
+	Imath::V3i* out_index)
+{
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const Imath::V3f& prev = points[i > 0 ? i - 1 : i];
+		const Imath::V3f& next = points[i + 1 < count ? i + 1 : i];
+		const Imath::V3f tangent = next - prev;
+		const Imath::V3f view = camera_position - points[i];
+		Imath::V3f side = tangent.cross(view);
+		if (side.length2() <= 0.0f)
+		{
+			side = tangent.cross(Imath::V3f(0, 1, 0));
+			if (side.length2() <= 0.0f) side = Imath::V3f(1, 0, 0);
+		}
+		side.normalize();
+		Imath::V3f normal = side.cross(tangent);
+		if (normal.dot(view) < 0.0f) normal = -normal;
+		normal.normalize();
+
+		const Imath::V3f half = side * (widths[i] * 0.5f);
+		out_vertex[i * 2 + 0] = points[i] - half;
+		out_vertex[i * 2 + 1] = points[i] + half;
+		out_normal[i * 2 + 0] = normal;
+		out_normal[i * 2 + 1] = normal;
+	}
+	for (unsigned int i = 0; i + 1 < count; ++i)
+	{
+		const int a = static_cast<int>(first_vertex + i * 2);
+		out_index[i * 2 + 0] = Imath::V3i(a, a + 2, a + 1);
+		out_index[i * 2 + 1] = Imath::V3i(a + 1, a + 2, a + 3);
+	}
+}
+
+/**
+ * tessellate curves
+ */
+bool UMAbcCurveTessellator::tessellate(const Curves& curves, const Setting& setting)
+{
+	positions_.clear();
+	widths_.clear();
+	offsets_.clear();
+	ribbon_vertices_.clear();
+	ribbon_normals_.clear();
+	ribbon_triangle_index_.clear();
+
+	if (!curves.positions || !curves.vertex_counts) return false;
+
+	// first vertex and knot of each curve. knots are laid out by the authored orders
+	first_vertex_.resize(curves.curve_count + 1);
+	first_knot_.resize(curves.curve_count + 1);
+	first_vertex_[0] = 0;
+	first_knot_[0] = 0;
+	for (size_t i = 0; i < curves.curve_count; ++i)
+	{
+		const int count = std::max(0, curves.vertex_counts[i]);
+		const int order = curves.orders ? curves.orders[i] : 4;
+		first_vertex_[i + 1] = first_vertex_[i] + count;
+		first_knot_[i + 1] = first_knot_[i] + count + order;
+	}
+	if (first_vertex_[curves.curve_count] > curves.position_size) return false;
+	const bool has_knots = curves.basis == kCurveVariableOrder
+		&& curves.knots
+		&& first_knot_[curves.curve_count] <= curves.knot_size;
+
+	const size_t strand_count = curves.curve_index ? curves.curve_index_size : curves.curve_count;
+	world_positions_.resize(curves.position_size);
+	offsets_.resize(strand_count + 1);
+	offsets_[0] = 0;
+
+	const float width_scale = setting.width_scale * matrix_scale(setting.matrix);
+	std::vector<Strand> strands(strand_count);
+
+	// a curve listed twice is tessellated by its first strand only,
+	// so that workers never transform the same control points
+	std::vector<char> is_duplicated;
+	if (curves.curve_index)
+	{
+		is_duplicated.resize(strand_count, 0);
+		std::vector<char> is_listed(curves.curve_count, 0);
+		for (size_t s = 0; s < strand_count; ++s)
+		{
+			const size_t curve = curves.curve_index[s];
+			if (curve >= curves.curve_count) continue;
+			is_duplicated[s] = is_listed[curve];
+			is_listed[curve] = 1;
+		}
+	}
+
+	// transform control points and count samples per strand
+	parallel_for(strand_count, 256, [&](size_t begin, size_t end) {
+		for (size_t s = begin; s < end; ++s)
+		{
+			Strand& strand = strands[s];
+			const size_t curve = curves.curve_index ? curves.curve_index[s] : s;
+			if (curve >= curves.curve_count || (!is_duplicated.empty() && is_duplicated[s]))
+			{
+				strand.vertex_count = 0;
+				offsets_[s + 1] = 0;
+				continue;
+			}
+			strand.curve = curve;
+			strand.first_vertex = first_vertex_[curve];
+			strand.vertex_count = std::max(0, curves.vertex_counts[curve]);
+			// a curve above the maximum order does not match its knots once clamped,
+			// so it is drawn through its control points. other curves keep their knots.
+			const int order = curves.orders ? curves.orders[curve] : 4;
+			strand.order = std::min(order, kMaxOrder);
+			strand.points = &world_positions_[strand.first_vertex];
+			strand.weights = curves.weights ? &curves.weights[strand.first_vertex] : NULL;
+			strand.knots = has_knots && order <= kMaxOrder && strand.order >= 2 && strand.vertex_count >= strand.order
+				? &curves.knots[first_knot_[curve]] : NULL;
+			for (int i = 0; i < strand.vertex_count; ++i)
+			{
+				world_positions_[strand.first_vertex + i] = curves.positions[strand.first_vertex + i] * setting.matrix;
+			}
+			offsets_[s + 1] = strand_point_count(curves, setting, strand);
+		}
+	});
+
+	// prefix sum
+	for (size_t s = 0; s < strand_count; ++s)
+	{
+		offsets_[s + 1] += offsets_[s];
+	}
+	const unsigned int point_count = offsets_[strand_count];
+	positions_.resize(point_count);
+	widths_.resize(point_count);
+
+	// first triangle of each strand's ribbon
+	std::vector<unsigned int> segment_offsets;
+	if (setting.is_ribbon)
+	{
+		segment_offsets.resize(strand_count + 1);
+		segment_offsets[0] = 0;
+		for (size_t s = 0; s < strand_count; ++s)
+		{
+			const unsigned int count = offsets_[s + 1] - offsets_[s];
+			segment_offsets[s + 1] = segment_offsets[s] + (count > 0 ? count - 1 : 0);
+		}
+		ribbon_vertices_.resize(point_count * 2);
+		ribbon_normals_.resize(point_count * 2);
+		ribbon_triangle_index_.resize(segment_offsets[strand_count] * 2);
+	}
+
+	// evaluate
+	parallel_for(strand_count, 64, [&](size_t begin, size_t end) {
+		for (size_t s = begin; s < end; ++s)
+		{
+			const unsigned int first = offsets_[s];
+			const unsigned int count = offsets_[s + 1] - first;
+			if (count == 0) continue;
+			strand_evaluate(curves, setting, strands[s], width_scale, &positions_[first], &widths_[first]);
+			if (setting.is_ribbon)
+			{
+				strand_ribbon(
+					&positions_[first], &widths_[first], count,
+					setting.camera_position,
+					first * 2,
+					&ribbon_vertices_[first * 2],
+					&ribbon_normals_[first * 2],
+					count > 1 ? &ribbon_triangle_index_[segment_offsets[s] * 2] : NULL);
+			}
+		}
+	});
+	return true;
+}
+
+/**
+ * get allocated bytes
+ */
+size_t UMAbcCurveTessellator::byte_size() const
+{
+	return (world_positions_.capacity() + positions_.capacity()
+			+ ribbon_vertices_.capacity() + ribbon_normals_.capacity()) * sizeof(Imath::V3f)
+		+ (first_vertex_.capacity() + first_knot_.capacity() + offsets_.capacity()) * sizeof(unsigned int)
+		+ widths_.capacity() * sizeof(float)
+		+ ribbon_triangle_index_.capacity() * sizeof(Imath::V3i);
+}
+
+} // umabc
@@ -0,0 +1,168 @@
+/**
+ * @file UMAbcCurveTessellator.h
+ * basis curve tessellator
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "ImathVec.h"
+#include "ImathMatrix.h"
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+class UMAbcCurveTessellator;
+typedef std::shared_ptr<UMAbcCurveTessellator> UMAbcCurveTessellatorPtr;
+
+/**
+ * tessellates basis curves into world space polylines or camera facing ribbons.
+ * all strands are written into one packed buffer.
+ */
+class UMAbcCurveTessellator
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcCurveTessellator);
+public:
+	typedef std::vector<Imath::V3i > IndexList;
+
+	enum CurveBasis {
+		kCurveLinear,
+		kCurveBezier,
+		kCurveBspline,
+		kCurveCatmullrom,
+		kCurveHermite,
+		kCurveVariableOrder
+	};
+
+	/**
+	 * source curves. pointers are not owned.
+	 */
+	struct Curves
+	{
+		Curves()
+			: positions(NULL), position_size(0)
+			, vertex_counts(NULL), curve_count(0)
+			, weights(NULL)
+			, orders(NULL)
+			, knots(NULL), knot_size(0)
+			, widths(NULL), width_size(0)
+			, curve_index(NULL), curve_index_size(0)
+			, basis(kCurveLinear)
+			, is_periodic(false)
+		{}
+		const Imath::V3f* positions;
+		size_t position_size;
+		const int* vertex_counts;
+		size_t curve_count;
+		// per vertex weights of variable order curves. NULL means 1
+		const float* weights;
+		// per curve orders of variable order curves
+		const unsigned char* orders;
+		const float* knots;
+		size_t knot_size;
+		// constant, per curve or per vertex widths
+		const float* widths;
+		size_t width_size;
+		// strands to tessellate. NULL means all. a curve listed again gives an empty strand
+		const unsigned int* curve_index;
+		size_t curve_index_size;
+		CurveBasis basis;
+		bool is_periodic;
+	};
+
+	/**
+	 * tessellation setting
+	 */
+	struct Setting
+	{
+		Setting()
+			: tolerance(0.01f)
+			, max_segments(64)
+			, default_width(0.01f)
+			, width_scale(1.0f)
+			, is_ribbon(false)
+		{
+			matrix.makeIdentity();
+		}
+		// chordal error in world space
+		float tolerance;
+		// maximum samples per span
+		int max_segments;
+		// used when the curves have no widths
+		float default_width;
+		float width_scale;
+		// local to world matrix
+		Imath::M44d matrix;
+		// write camera facing ribbons
+		bool is_ribbon;
+		Imath::V3f camera_position;
+	};
+
+	UMAbcCurveTessellator() {}
+	~UMAbcCurveTessellator() {}
+
+	/**
+	 * tessellate curves
+	 * @param [in] curves source curves
+	 * @param [in] setting tessellation setting
+	 * @retval succsess or fail
+	 */
+	bool tessellate(const Curves& curves, const Setting& setting);
+
+	/**
+	 * get polyline points of all strands
+	 */
+	const std::vector<Imath::V3f>& positions() const { return positions_; }
+
+	/**
+	 * get widths of polyline points
+	 */
+	const std::vector<float>& widths() const { return widths_; }
+
+	/**
+	 * get first polyline point of each strand. the last element is the total point count.
+	 */
+	const std::vector<unsigned int>& offsets() const { return offsets_; }
+
+	/**
+	 * get ribbon vertices. two vertices per polyline point.
+	 */
+	const std::vector<Imath::V3f>& ribbon_vertices() const { return ribbon_vertices_; }
+
+	/**
+	 * get ribbon normals
+	 */
+	const std::vector<Imath::V3f>& ribbon_normals() const { return ribbon_normals_; }
+
+	/**
+	 * get ribbon triangle index list
+	 */
+	const IndexList& ribbon_triangle_index() const { return ribbon_triangle_index_; }
+
+	/**
+	 * get allocated bytes
+	 */
+	size_t byte_size() const;
+
+private:
+	std::vector<Imath::V3f> world_positions_;
+	std::vector<unsigned int> first_vertex_;
+	std::vector<unsigned int> first_knot_;
+
+	std::vector<Imath::V3f> positions_;
+	std::vector<float> widths_;
+	std::vector<unsigned int> offsets_;
+
+	std::vector<Imath::V3f> ribbon_vertices_;
+	std::vector<Imath::V3f> ribbon_normals_;
+	IndexList ribbon_triangle_index_;
+};
+
+} // umabc
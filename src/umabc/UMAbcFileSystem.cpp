@@ -0,0 +1,117 @@
+/**
+ * @file UMAbcFileSystem.cpp
+ * file status, temporary files and hashes of sidecar files
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcFileSystem.h"
+
+#include <cstdio>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace umabc
+{
+
+/**
+ * get size and modified time of a regular file
+ */
+bool UMAbcFileSystem::status(const std::string& path, unsigned long long& size, unsigned long long& time)
+{
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) return false;
+	if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) return false;
+	size = (static_cast<unsigned long long>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+	time = (static_cast<unsigned long long>(data.ftLastWriteTime.dwHighDateTime) << 32)
+		| data.ftLastWriteTime.dwLowDateTime;
+#else
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) return false;
+	size = static_cast<unsigned long long>(st.st_size);
+	// seconds would miss a file rewritten within the same second
+#ifdef __APPLE__
+	const struct timespec& modified = st.st_mtimespec;
+#else
+	const struct timespec& modified = st.st_mtim;
+#endif
+	time = static_cast<unsigned long long>(modified.tv_sec) * 1000000000ULL
+		+ static_cast<unsigned long long>(modified.tv_nsec);
+#endif
+	return true;
+}
+
+/**
+ * get path of the temporary file written before replacing the file
+ */
+std::string UMAbcFileSystem::temporary_path(const std::string& path)
+{
+	std::ostringstream temporary;
+#ifdef _WIN32
+	temporary << path << ".tmp" << GetCurrentProcessId();
+#else
+	temporary << path << ".tmp" << getpid();
+#endif
+	return temporary.str();
+}
+
+/**
+ * replace the file by the temporary file
+ */
+bool UMAbcFileSystem::replace(const std::string& temporary_path, const std::string& path)
+{
+#ifdef _WIN32
+	return !!MoveFileExA(temporary_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+	return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+#endif
+}
+
+/**
+ * create a directory
+ */
+void UMAbcFileSystem::create_directory(const std::string& path)
+{
+#ifdef _WIN32
+	CreateDirectoryA(path.c_str(), NULL);
+#else
+	mkdir(path.c_str(), 0755);
+#endif
+}
+
+/**
+ * 64 bit fnv-1a of the text
+ */
+unsigned long long UMAbcFileSystem::hash(const std::string& text)
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	for (size_t i = 0, size = text.size(); i < size; ++i)
+	{
+		hash ^= static_cast<unsigned char>(text[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/**
+ * get the hash as a file name
+ */
+std::string UMAbcFileSystem::hash_name(const std::string& text)
+{
+	char name[17];
+	std::snprintf(name, sizeof(name), "%016llx", hash(text));
+	return name;
+}
+
+} // umabc
@@ -0,0 +1,69 @@
+/**
+ * @file UMAbcFileSystem.h
+ * file status, temporary files and hashes of sidecar files
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <string>
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+/**
+ * file operations shared by the writers of archives and sidecar files.
+ * files are written to a temporary file of the process and replace the target by rename,
+ * so readers and mappings of the target never see a partly written file.
+ */
+class UMAbcFileSystem
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcFileSystem);
+public:
+
+	/**
+	 * get size and modified time of a regular file
+	 * @param [in] path file path
+	 * @param [out] size file size
+	 * @param [out] time modified time in 100ns units on windows and 1ns units elsewhere. only compared
+	 * @retval false when the file is missing or not a regular file
+	 */
+	static bool status(const std::string& path, unsigned long long& size, unsigned long long& time);
+
+	/**
+	 * get path of the temporary file written before replacing the file.
+	 * processes writing the same file write their own temporary files.
+	 */
+	static std::string temporary_path(const std::string& path);
+
+	/**
+	 * replace the file by the temporary file. the temporary file is kept on failure.
+	 * @retval succsess or fail
+	 */
+	static bool replace(const std::string& temporary_path, const std::string& path);
+
+	/**
+	 * create a directory. an existing directory is not an error.
+	 */
+	static void create_directory(const std::string& path);
+
+	/**
+	 * 64 bit fnv-1a of the text
+	 */
+	static unsigned long long hash(const std::string& text);
+
+	/**
+	 * get the hash as a file name of 16 hex digits
+	 */
+	static std::string hash_name(const std::string& text);
+
+private:
+	UMAbcFileSystem() {}
+};
+
+} // umabc
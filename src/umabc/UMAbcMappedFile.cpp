@@ -0,0 +1,181 @@
+/**
+ * @file UMAbcMappedFile.cpp
+ * read only file mapping served as istreams
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcMappedFile.h"
+
+#include <cstring>
+#include <streambuf>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace umabc
+{
+
+namespace
+{
+	/**
+	 * streambuf over the mapping. the whole file is the get area,
+	 * so reads are copies and seeks only move the get pointer.
+	 */
+	class MappedStreamBuf : public std::streambuf
+	{
+	public:
+		MappedStreamBuf(const char* data, size_t size)
+		{
+			char* begin = const_cast<char*>(data);
+			setg(begin, begin, begin + size);
+		}
+
+	protected:
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		{
+			if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+			off_type base = 0;
+			if (dir == std::ios_base::cur)
+			{
+				base = gptr() - eback();
+			}
+			else if (dir == std::ios_base::end)
+			{
+				base = egptr() - eback();
+			}
+			return seekpos(pos_type(base + off), which);
+		}
+
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+		{
+			const off_type offset = off_type(pos);
+			if (!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback())
+			{
+				return pos_type(off_type(-1));
+			}
+			setg(eback(), eback() + offset, egptr());
+			return pos;
+		}
+	};
+} // anonymous namespace
+
+UMAbcMappedFile::UMAbcMappedFile()
+	: data_(NULL)
+	, size_(0)
+{}
+
+/**
+ * map the file
+ */
+UMAbcMappedFilePtr UMAbcMappedFile::open(const std::string& path, bool is_copy_on_write)
+{
+	UMAbcMappedFilePtr file(new UMAbcMappedFile());
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return UMAbcMappedFilePtr();
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(handle);
+		return UMAbcMappedFilePtr();
+	}
+	HANDLE mapping = CreateFileMappingA(handle, NULL, is_copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(handle);
+	if (!mapping) return UMAbcMappedFilePtr();
+	// the view keeps the mapping alive
+	void* data = MapViewOfFile(mapping, is_copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!data) return UMAbcMappedFilePtr();
+	file->data_ = static_cast<const char*>(data);
+	file->size_ = static_cast<size_t>(size.QuadPart);
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return UMAbcMappedFilePtr();
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		::close(fd);
+		return UMAbcMappedFilePtr();
+	}
+	// the mapping keeps the file alive
+	void* data = is_copy_on_write
+		? mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+		: mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) return UMAbcMappedFilePtr();
+	file->data_ = static_cast<const char*>(data);
+	file->size_ = static_cast<size_t>(st.st_size);
+#endif
+	return file;
+}
+
+UMAbcMappedFile::~UMAbcMappedFile()
+{
+	clear_streams();
+	if (!data_) return;
+#ifdef _WIN32
+	UnmapViewOfFile(data_);
+#else
+	munmap(const_cast<char*>(data_), size_);
+#endif
+}
+
+/**
+ * copy bytes at the offset
+ */
+bool UMAbcMappedFile::read(unsigned long long offset, size_t size, void* data) const
+{
+	if (offset > size_ || size > size_ - offset) return false;
+	memcpy(data, data_ + offset, size);
+	return true;
+}
+
+/**
+ * hint the access pattern of the range to the kernel
+ */
+void UMAbcMappedFile::advise(Access access, size_t offset, size_t size) const
+{
+	if (!data_ || offset >= size_) return;
+	if (size == 0 || offset + size > size_)
+	{
+		size = size_ - offset;
+	}
+#ifdef _WIN32
+	// windows has no hints for a view
+	(void)access;
+#else
+	// madvise needs a page aligned address
+	const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t begin = offset - offset % page;
+	int advice = MADV_NORMAL;
+	switch (access)
+	{
+	case kAccessRandom: advice = MADV_RANDOM; break;
+	case kAccessSequential: advice = MADV_SEQUENTIAL; break;
+	case kAccessWillNeed: advice = MADV_WILLNEED; break;
+	default: break;
+	}
+	madvise(const_cast<char*>(data_) + begin, size + (offset - begin), advice);
+#endif
+}
+
+/**
+ * create buffer of a stream
+ */
+std::shared_ptr<std::streambuf> UMAbcMappedFile::create_buffer()
+{
+	return std::make_shared<MappedStreamBuf>(data_, size_);
+}
+
+} // umabc
@@ -0,0 +1,89 @@
+/**
+ * @file UMAbcMappedFile.h
+ * read only file mapping served as istreams
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include "UMMacro.h"
+#include "UMAbcArchiveSource.h"
+
+namespace umabc
+{
+
+class UMAbcMappedFile;
+typedef std::shared_ptr<UMAbcMappedFile> UMAbcMappedFilePtr;
+
+/**
+ * whole file mapped read only.
+ * streams read by copying from the mapping without system calls,
+ * so each stream only serializes the readers sharing it.
+ */
+class UMAbcMappedFile : public UMAbcArchiveSource
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcMappedFile);
+public:
+
+	/**
+	 * expected access pattern of the mapping
+	 */
+	enum Access
+	{
+		kAccessNormal,
+		kAccessRandom,
+		kAccessSequential,
+		kAccessWillNeed
+	};
+
+	/**
+	 * map the file
+	 * @param [in] path file path
+	 * @param [in] is_copy_on_write map pages writable. written pages are copied
+	 *   and never reach the file, so views handed out may be modified safely
+	 * @retval mapped file or null
+	 */
+	static UMAbcMappedFilePtr open(const std::string& path, bool is_copy_on_write = false);
+
+	virtual ~UMAbcMappedFile();
+
+	/**
+	 * get mapped bytes
+	 */
+	const char* data() const { return data_; }
+
+	/**
+	 * get file size
+	 */
+	virtual size_t size() const { return size_; }
+
+	/**
+	 * copy bytes at the offset
+	 */
+	virtual bool read(unsigned long long offset, size_t size, void* data) const;
+
+	/**
+	 * hint the access pattern of the range to the kernel
+	 * @param [in] access access pattern
+	 * @param [in] offset range offset
+	 * @param [in] size range size. 0 is to the end of file
+	 */
+	void advise(Access access, size_t offset = 0, size_t size = 0) const;
+
+protected:
+	virtual std::shared_ptr<std::streambuf> create_buffer();
+
+private:
+	UMAbcMappedFile();
+
+	const char* data_;
+	size_t size_;
+};
+
+} // umabc
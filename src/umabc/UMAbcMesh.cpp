@@ -12,9 +12,12 @@
 #include <Alembic/Abc/All.h>
 #include <Alembic/AbcGeom/All.h>
 #include <Alembic/AbcCoreFactory/All.h>
+#include <Alembic/AbcMaterial/All.h>
 
 #include "UMMacro.h"
 #include "UMAbcMesh.h"
+#include "UMAbcSampleCache.h"
+#include "UMAbcPrefetcher.h"
 
 namespace umabc
 {
@@ -22,6 +25,55 @@ namespace umabc
 	using namespace Alembic::Abc;
 	using namespace Alembic::AbcGeom;
 
+	namespace
+	{
+		/**
+		 * read array sample through the process wide sample cache
+		 */
+		template <class PROPERTY, class SAMPLE_PTR>
+		void read_cached(PROPERTY property, const ISampleSelector& selector, const char* tag, SAMPLE_PTR& result)
+		{
+			result = std::static_pointer_cast<typename SAMPLE_PTR::element_type>(
+				UMAbcSampleCache::instance().read(property, selector, tag));
+		}
+
+		/**
+		 * append geom param digests to the key
+		 */
+		template <class PARAM>
+		bool append_param_key(std::string& key, PARAM param, const ISampleSelector& selector)
+		{
+			if (!param.valid() || param.getNumSamples() == 0)
+			{
+				key.push_back('\0');
+				return true;
+			}
+			key.push_back(static_cast<char>(1 + param.getScope()));
+			ArraySampleKey sample_key;
+			if (param.isIndexed())
+			{
+				if (!param.getIndexProperty().getKey(sample_key, selector)) return false;
+				UMAbcSampleCache::append_key(key, sample_key);
+			}
+			if (!param.getValueProperty().getKey(sample_key, selector)) return false;
+			UMAbcSampleCache::append_key(key, sample_key);
+			return true;
+		}
+
+		/**
+		 * get memory size of strings
+		 */
+		size_t string_list_byte_size(const std::vector<std::string>& list)
+		{
+			size_t size = list.capacity() * sizeof(std::string);
+			for (size_t i = 0, count = list.size(); i < count; ++i)
+			{
+				size += list[i].capacity();
+			}
+			return size;
+		}
+	} // anonymous namespace
+
 	class UMAbcMesh::Impl : public UMAbcObject
 	{
 		DISALLOW_COPY_AND_ASSIGN(Impl);
@@ -29,6 +81,13 @@ namespace umabc
 		Impl(IPolyMeshPtr poly_mesh)
 			: UMAbcObject(poly_mesh)
 			, poly_mesh_(poly_mesh)
+			, revision_(0)
+			, topology_revision_(0)
+			, geometry_(new UMAbcMeshGeometry())
+			, triangle_faceset_revision_(0)
+			, bvh_has_key_(false)
+			, bvh_triangle_size_(0)
+			, is_released_(false)
 		{}
 
 		~Impl() {}
@@ -63,13 +122,78 @@ namespace umabc
 		*/
 		void update_mesh_all();
 
+		/**
+		* release derived buffers
+		*/
+		void release_buffers();
+
+		/**
+		* rebuild released buffers
+		*/
+		void restore_buffers() { if (is_released_) update_mesh_all(); }
+
+		/**
+		* get bytes of derived buffers owned by this mesh
+		*/
+		size_t buffer_byte_size() const;
+
+		/**
+		* add bytes held by this mesh
+		*/
+		void memory_usage(UMAbcMemoryUsage& usage) const;
+
+		/**
+		 * add animated array properties to the prefetcher
+		 */
+		void add_prefetch_properties(UMAbcPrefetcher& prefetcher) const;
+
 		Alembic::AbcGeom::P3fArraySamplePtr vertex() { return vertex_; }
 		Alembic::AbcGeom::Int32ArraySamplePtr vertex_index() { return vertex_index_; }
 		Alembic::AbcGeom::Int32ArraySamplePtr face_count() { return face_count_; }
 		Alembic::AbcGeom::IN3fGeomParam::Sample& normal() { return normal_; }
-		std::vector<Imath::V2f>& uv() { return original_uv_; }
-		IndexList& triangle_index() { return triangle_index_; }
-		std::vector<Imath::V3f>& normals() { return original_normal_; }
+		std::vector<Imath::V2f>& uv() { return geometry_->uvs; }
+		IndexList& triangle_index() { return geometry_->triangle_index; }
+		std::vector<Imath::V3f>& normals() { return geometry_->normals; }
+
+		/**
+		* get triangle bvh
+		*/
+		const UMAbcMeshBVH& bvh();
+
+		/**
+		* get face set index of each triangle
+		*/
+		const std::vector<int>& triangle_faceset();
+
+		/**
+		* get assigned material path
+		*/
+		const std::string& material_path() const { return material_path_; }
+
+		/**
+		* get assigned material path of each face set
+		*/
+		const std::vector<std::string>& faceset_material_path_list() const { return faceset_material_path_list_; }
+
+		/**
+		* get revision
+		*/
+		unsigned int revision() const { return revision_; }
+
+		/**
+		* get topology revision
+		*/
+		unsigned int topology_revision() const { return topology_revision_; }
+
+		/**
+		* get geometry
+		*/
+		UMAbcMeshGeometryPtr geometry() const { return geometry_; }
+
+		/**
+		* set geometry cache
+		*/
+		void set_geometry_cache(UMAbcMeshGeometryCachePtr cache) { geometry_cache_ = cache; }
 
 		/**
 		* get faceset name list
@@ -98,20 +222,45 @@ namespace umabc
 		*/
 		void update_uv();
 
+		/**
+		* arrays of a mesh sample
+		*/
+		struct MeshSample
+		{
+			Alembic::AbcGeom::P3fArraySamplePtr positions;
+			Alembic::AbcGeom::Int32ArraySamplePtr face_indices;
+			Alembic::AbcGeom::Int32ArraySamplePtr face_counts;
+		};
+
+		/**
+		* read mesh sample through the sample cache
+		*/
+		void read_sample(const ISampleSelector& selector, MeshSample& sample);
+
 		/**
 		* update vertex
 		*/
-		void update_vertex(Alembic::AbcGeom::IPolyMeshSchema::Sample& sample);
+		void update_vertex(const MeshSample& sample);
 
 		/**
 		* update vertex index
 		*/
-		void update_vertex_index(Alembic::AbcGeom::IPolyMeshSchema::Sample& sample);
+		void update_vertex_index(const MeshSample& sample);
+
+		/**
+		* add completed geometry to the cache
+		*/
+		void cache_geometry();
+
+		/**
+		* get digest key of samples which the geometry is made from. empty when not available.
+		*/
+		std::string geometry_key(const ISampleSelector& selector);
 
 		/**
 		* update vertex index
 		*/
-		void update_vertex_index_by_faceset(Alembic::AbcGeom::IPolyMeshSchema::Sample& sample);
+		void update_vertex_index_by_faceset(const MeshSample& sample);
 
 		IPolyMeshPtr poly_mesh_;
 		Alembic::AbcGeom::IPolyMeshSchema::Sample initial_sample_;
@@ -124,17 +273,39 @@ namespace umabc
 		Alembic::AbcGeom::IN3fGeomParam::Sample normal_;
 		Alembic::AbcGeom::IV2fGeomParam::Sample uv_;
 
-		std::vector<Imath::V3f> original_normal_;
-		std::vector<Imath::V2f> original_uv_;
 		std::map<std::string, Alembic::AbcGeom::IFaceSetSchema::Sample> faceset_;
 
-		IndexList triangle_index_;
-		IndexList triangle_index_number_;
 
 		std::vector<std::string> faceset_name_list_;
 		std::vector<std::string> faceset_names_;
 		std::vector<int> faceset_polycount_list_;
 		std::vector<int> faceset_original_polycount_list_;
+
+		// incremented when vertices or topology change
+		unsigned int revision_;
+		// incremented when face indices or face counts change
+		unsigned int topology_revision_;
+
+		UMAbcMeshGeometryPtr geometry_;
+		UMAbcMeshGeometryCachePtr geometry_cache_;
+		std::string geometry_key_;
+
+		std::vector<int> triangle_faceset_;
+		unsigned int triangle_faceset_revision_;
+		std::string material_path_;
+		std::vector<std::string> faceset_material_path_list_;
+
+		UMAbcMeshBVH bvh_;
+		bool bvh_has_key_;
+		Alembic::AbcCoreAbstract::ArraySampleKey bvh_index_key_;
+		Alembic::AbcCoreAbstract::ArraySampleKey bvh_count_key_;
+		Alembic::AbcGeom::Int32ArraySamplePtr bvh_vertex_index_;
+		Alembic::AbcGeom::Int32ArraySamplePtr bvh_face_count_;
+		size_t bvh_triangle_size_;
+		Alembic::AbcGeom::P3fArraySamplePtr bvh_vertex_;
+
+		// buffers are released until next update
+		bool is_released_;
 	};
 
 /**
@@ -184,8 +355,12 @@ bool UMAbcMesh::Impl::init(bool recursive)
 	}
 	
 	faceset_name_list_.clear();
+	faceset_material_path_list_.clear();
 	faceset_names_.clear();
 	poly_mesh_->getSchema().getFaceSetNames(faceset_names_);
+
+	material_path_.clear();
+	Alembic::AbcMaterial::getMaterialAssignmentPath(*poly_mesh_, material_path_);
 	
 	ISampleSelector selector(self_reference()->current_time(), ISampleSelector::kNearIndex);
 
@@ -201,7 +376,12 @@ bool UMAbcMesh::Impl::init(bool recursive)
 		Int32ArraySamplePtr faces = faceset_sample.getFaces();
 		size_t facesize = faces->size();
 		faceset_[name] = faceset_sample;
+
+		std::string faceset_material_path;
+		Alembic::AbcMaterial::getMaterialAssignmentPath(faceset, faceset_material_path);
+		faceset_material_path_list_.push_back(faceset_material_path);
 	}
+	triangle_faceset_revision_ = topology_revision_ - 1;
 	return true;
 }
 
@@ -250,26 +430,26 @@ void UMAbcMesh::Impl::update_normal()
 	{
 		// make vertex varying normals
 		is_vertex_varying = true;
-		original_normal_.resize(vertex_->size());
-		for (size_t i = 0, isize = original_normal_.size(); i < isize; ++i)
+		geometry_->normals.resize(vertex_->size());
+		for (size_t i = 0, isize = geometry_->normals.size(); i < isize; ++i)
 		{
-			original_normal_[i] = Imath::V3f(0);
+			geometry_->normals[i] = Imath::V3f(0);
 		}
-		for (size_t i = 0, isize = triangle_index_.size(); i < isize; ++i)
+		for (size_t i = 0, isize = geometry_->triangle_index.size(); i < isize; ++i)
 		{
-			const Imath::V3i& index = triangle_index_.at(i);
+			const Imath::V3i& index = geometry_->triangle_index.at(i);
 			const V3f& v0 = (*vertex_)[index[0]];
 			const V3f& v1 = (*vertex_)[index[1]];
 			const V3f& v2 = (*vertex_)[index[2]];
 			V3f normal = (v0-v1).cross(v2-v1);
-			original_normal_[index[0]] += normal;
-			original_normal_[index[1]] += normal;
-			original_normal_[index[2]] += normal;
+			geometry_->normals[index[0]] += normal;
+			geometry_->normals[index[1]] += normal;
+			geometry_->normals[index[2]] += normal;
 		}
 		// normalize
 		for (size_t i = 0, isize = vertex_->size(); i < isize; ++i)
 		{
-			original_normal_[i].normalize();
+			geometry_->normals[i].normalize();
 		}
 	}
 	else
@@ -281,52 +461,52 @@ void UMAbcMesh::Impl::update_normal()
 
 		if (is_face_varying)
 		{
-			original_normal_.resize(vertex_size);
+			geometry_->normals.assign(vertex_size, Imath::V3f(0));
 			const size_t vertex_index_size_ = vertex_index_->size();
 			for (size_t i = 0; i < vertex_index_size_; ++i)
 			{
 				const int index = (*vertex_index_)[i];
-				original_normal_[index] += normals[i];
+				geometry_->normals[index] += normals[i];
 			}
 			// normalize
 			for (size_t i = 0; i < vertex_size; ++i)
 			{
-				original_normal_[i].normalize();
+				geometry_->normals[i].normalize();
 			}
 		}
 		else if (is_vertex_varying)
 		{
-			original_normal_.resize(normal_size);
+			geometry_->normals.resize(normal_size);
 			for (size_t i = 0; i < normal_size; ++i)
 			{
-				original_normal_[i] = normals[i];
-				original_normal_[i].normalize();
+				geometry_->normals[i] = normals[i];
+				geometry_->normals[i].normalize();
 			}
 		}
 		else
 		{
 			// make vertex varying normals
 			is_vertex_varying = true;
-			original_normal_.resize(vertex_->size());
-			for (size_t i = 0, isize = original_normal_.size(); i < isize; ++i)
+			geometry_->normals.resize(vertex_->size());
+			for (size_t i = 0, isize = geometry_->normals.size(); i < isize; ++i)
 			{
-				original_normal_[i] = Imath::V3f(0);
+				geometry_->normals[i] = Imath::V3f(0);
 			}
-			for (size_t i = 0, isize = triangle_index_.size(); i < isize; ++i)
+			for (size_t i = 0, isize = geometry_->triangle_index.size(); i < isize; ++i)
 			{
-				const Imath::V3i& index = triangle_index_.at(i);
+				const Imath::V3i& index = geometry_->triangle_index.at(i);
 				const Imath::V3f& v0 = (*vertex_)[index[0]];
 				const Imath::V3f& v1 = (*vertex_)[index[1]];
 				const Imath::V3f& v2 = (*vertex_)[index[2]];
 				Imath::V3f normal = (v0 - v1).cross(v2 - v1);
-				original_normal_[index[0]] += normal;
-				original_normal_[index[1]] += normal;
-				original_normal_[index[2]] += normal;
+				geometry_->normals[index[0]] += normal;
+				geometry_->normals[index[1]] += normal;
+				geometry_->normals[index[2]] += normal;
 			}
 			// normalize
 			for (size_t i = 0, isize = vertex_->size(); i < isize; ++i)
 			{
-				original_normal_[i].normalize();
+				geometry_->normals[i].normalize();
 			}
 		}
 	}
@@ -362,37 +542,37 @@ void UMAbcMesh::Impl::update_uv()
 	Alembic::AbcGeom::UInt32ArraySamplePtr indices = uv_.getIndices();
 	if (indices && indices->size() > 0)
 	{
-		const int index_size = static_cast<int>(triangle_index_.size());
-		original_uv_.resize(index_size * 3);
+		const int index_size = static_cast<int>(geometry_->triangle_index.size());
+		geometry_->uvs.resize(index_size * 3);
 		for (size_t i = 0; i < index_size; ++i)
 		{
-			const Imath::V3i& index = triangle_index_number_[i];
-			original_uv_[i * 3 + 0] = uv_.getVals()->get()[indices->get()[index[0]]];
-			original_uv_[i * 3 + 1] = uv_.getVals()->get()[indices->get()[index[1]]];
-			original_uv_[i * 3 + 2] = uv_.getVals()->get()[indices->get()[index[2]]];
+			const Imath::V3i& index = geometry_->triangle_index_number[i];
+			geometry_->uvs[i * 3 + 0] = uv_.getVals()->get()[indices->get()[index[0]]];
+			geometry_->uvs[i * 3 + 1] = uv_.getVals()->get()[indices->get()[index[1]]];
+			geometry_->uvs[i * 3 + 2] = uv_.getVals()->get()[indices->get()[index[2]]];
 		}
 	}
 	else if (uv_.getVals())
 	{
-		const int index_size = static_cast<int>(triangle_index_.size());
+		const int index_size = static_cast<int>(geometry_->triangle_index.size());
 		if (index_size > 0)
 		{
-			original_uv_.resize(index_size * 3);
+			geometry_->uvs.resize(index_size * 3);
 			for (size_t i = 0; i < index_size; ++i)
 			{
-				const Imath::V3i& index = triangle_index_number_[i];
-				original_uv_[i * 3 + 0] = uv_.getVals()->get()[index[0]];
-				original_uv_[i * 3 + 1] = uv_.getVals()->get()[index[1]];
-				original_uv_[i * 3 + 2] = uv_.getVals()->get()[index[2]];
+				const Imath::V3i& index = geometry_->triangle_index_number[i];
+				geometry_->uvs[i * 3 + 0] = uv_.getVals()->get()[index[0]];
+				geometry_->uvs[i * 3 + 1] = uv_.getVals()->get()[index[1]];
+				geometry_->uvs[i * 3 + 2] = uv_.getVals()->get()[index[2]];
 			}
 		}
 		else if (uv_.getVals()->size() == vertex_->size())
 		{
 			const int vertex_size = static_cast<int>(vertex_->size());
-			original_uv_.resize(vertex_size);
+			geometry_->uvs.resize(vertex_size);
 			for (size_t i = 0; i < vertex_size; ++i)
 			{
-				original_uv_[i] = uv_.getVals()->get()[i];
+				geometry_->uvs[i] = uv_.getVals()->get()[i];
 			}
 		}
 	}
@@ -401,23 +581,24 @@ void UMAbcMesh::Impl::update_uv()
 /**
  * update vertex
  */
-void UMAbcMesh::Impl::update_vertex(IPolyMeshSchema::Sample& sample)
+void UMAbcMesh::Impl::update_vertex(const MeshSample& sample)
 {
 	if (!is_valid()) return;
 	
-	P3fArraySamplePtr vertex = sample.getPositions();
+	P3fArraySamplePtr vertex = sample.positions;
 
+	if (vertex != vertex_) ++revision_;
 	vertex_ = vertex;
 }
 
 /**
  * update vertex index
  */
-void UMAbcMesh::Impl::update_vertex_index_by_faceset(IPolyMeshSchema::Sample& sample)
+void UMAbcMesh::Impl::update_vertex_index_by_faceset(const MeshSample& sample)
 {
-	P3fArraySamplePtr vertex = sample.getPositions();
-	Int32ArraySamplePtr vertex_index = sample.getFaceIndices();
-	Int32ArraySamplePtr face_count = sample.getFaceCounts();
+	P3fArraySamplePtr vertex = sample.positions;
+	Int32ArraySamplePtr vertex_index = sample.face_indices;
+	Int32ArraySamplePtr face_count = sample.face_counts;
 	if (!vertex) return;
 	if (!vertex_index) return;
 	if (!face_count) return;
@@ -426,7 +607,7 @@ void UMAbcMesh::Impl::update_vertex_index_by_faceset(IPolyMeshSchema::Sample& sa
 	face_count_ = face_count;
 
 	// update index buffer
-	triangle_index_.clear();
+	geometry_->triangle_index.clear();
 	faceset_polycount_list_.clear();
 	faceset_name_list_.clear();
 	const size_t vertex_size = vertex->size();
@@ -469,7 +650,7 @@ void UMAbcMesh::Impl::update_vertex_index_by_faceset(IPolyMeshSchema::Sample& sa
 		Int32ArraySamplePtr faces = faceset_sample.getFaces();
 		size_t facesize = faces->size();
 		//Int32ArraySamplePtr faces = faceset_[name].getFaces();
-		int pre_polygon_count = static_cast<int>(triangle_index_.size());
+		int pre_polygon_count = static_cast<int>(geometry_->triangle_index.size());
 		
 		for (int k = 0; k < static_cast<int>(faces->size()); ++k)
 		{
@@ -492,7 +673,7 @@ void UMAbcMesh::Impl::update_vertex_index_by_faceset(IPolyMeshSchema::Sample& sa
 			if (count > 2)
 			{
 				// CW. this is alembic default.
-				triangle_index_.push_back(
+				geometry_->triangle_index.push_back(
 					Imath::V3i(
 					(*vertex_index_)[begin_index + 0],
 					(*vertex_index_)[begin_index + 1],
@@ -500,7 +681,7 @@ void UMAbcMesh::Impl::update_vertex_index_by_faceset(IPolyMeshSchema::Sample& sa
 
 				for (size_t n = 3; n < count; ++n)
 				{
-					triangle_index_.push_back(
+					geometry_->triangle_index.push_back(
 						Imath::V3i(
 							(*vertex_index_)[begin_index + 0],
 							(*vertex_index_)[begin_index + n-1],
@@ -508,7 +689,7 @@ void UMAbcMesh::Impl::update_vertex_index_by_faceset(IPolyMeshSchema::Sample& sa
 				}
 			}
 		}
-		faceset_polycount_list_.push_back(static_cast<int>(triangle_index_.size()) - pre_polygon_count);
+		faceset_polycount_list_.push_back(static_cast<int>(geometry_->triangle_index.size()) - pre_polygon_count);
 	}
 		
 	//update_material();
@@ -517,7 +698,7 @@ void UMAbcMesh::Impl::update_vertex_index_by_faceset(IPolyMeshSchema::Sample& sa
 /**
  * update vertex index
  */
-void UMAbcMesh::Impl::update_vertex_index(IPolyMeshSchema::Sample& sample)
+void UMAbcMesh::Impl::update_vertex_index(const MeshSample& sample)
 {
 	if (!is_valid()) return;
 
@@ -527,19 +708,25 @@ void UMAbcMesh::Impl::update_vertex_index(IPolyMeshSchema::Sample& sample)
 	//	return;
 	//}
 	
-	P3fArraySamplePtr vertex = sample.getPositions();
-	Int32ArraySamplePtr vertex_index = sample.getFaceIndices();
-	Int32ArraySamplePtr face_count = sample.getFaceCounts();
+	P3fArraySamplePtr vertex = sample.positions;
+	Int32ArraySamplePtr vertex_index = sample.face_indices;
+	Int32ArraySamplePtr face_count = sample.face_counts;
 	if (!vertex) return;
 	if (!vertex_index) return;
 	if (!face_count) return;
 	
+	if (vertex_index != vertex_index_ || face_count != face_count_)
+	{
+		++revision_;
+		++topology_revision_;
+	}
 	vertex_index_ = vertex_index;
 	face_count_ = face_count;
 
 	// update index buffer
-	triangle_index_.clear();
-	triangle_index_number_.clear();
+	geometry_->triangle_index.clear();
+	geometry_->triangle_index_number.clear();
+	geometry_->triangle_face.clear();
 	faceset_polycount_list_.clear();
 	const size_t vertex_size = vertex->size();
 	const size_t vertex_index_size_ = vertex_index_->size();
@@ -577,31 +764,33 @@ void UMAbcMesh::Impl::update_vertex_index(IPolyMeshSchema::Sample& sample)
 		if (count > 2)
 		{
 			// this is alembic default
-			triangle_index_.push_back(
+			geometry_->triangle_index.push_back(
 				Imath::V3i(
 				(*vertex_index_)[face_index_begin + 0],
 				(*vertex_index_)[face_index_begin + 1],
 				(*vertex_index_)[face_index_begin + 2]));
 
-			triangle_index_number_.push_back(
+			geometry_->triangle_index_number.push_back(
 				Imath::V3i(
 					face_index_begin + 0,
 					face_index_begin + 1,
 					face_index_begin + 2));
+			geometry_->triangle_face.push_back(static_cast<int>(face));
 
 			for (size_t i = 3; i < count; ++i)
 			{
-				triangle_index_.push_back(
+				geometry_->triangle_index.push_back(
 					Imath::V3i(
 						(*vertex_index_)[face_index_begin + 0],
 						(*vertex_index_)[face_index_begin + i-1],
 						(*vertex_index_)[face_index_begin + i]));
 
-				triangle_index_number_.push_back(
+				geometry_->triangle_index_number.push_back(
 					Imath::V3i(
 					face_index_begin + 0,
 					face_index_begin + i - 1,
 					face_index_begin + i));
+				geometry_->triangle_face.push_back(static_cast<int>(face));
 			}
 		}
 	}
@@ -612,24 +801,66 @@ void UMAbcMesh::Impl::update_vertex_index(IPolyMeshSchema::Sample& sample)
  */
 void UMAbcMesh::Impl::update_mesh_all()
 {
+	is_released_ = false;
 	ISampleSelector selector(self_reference()->current_time(), ISampleSelector::kNearIndex);
-	IPolyMeshSchema::Sample sample;
+	MeshSample sample;
 
 	if (poly_mesh_->getSchema().isConstant())
 	{
-		sample = initial_sample_;
+		sample.positions = initial_sample_.getPositions();
+		sample.face_indices = initial_sample_.getFaceIndices();
+		sample.face_counts = initial_sample_.getFaceCounts();
 	}
 	else if (poly_mesh_->getSchema().getNumSamples() > 0)
 	{
-		poly_mesh_->getSchema().get(sample, selector);
+		read_sample(selector, sample);
 	}
 
-	P3fArraySamplePtr vertex = sample.getPositions();
-	Int32ArraySamplePtr vertex_index = sample.getFaceIndices();
-	Int32ArraySamplePtr face_count = sample.getFaceCounts();
+	P3fArraySamplePtr vertex = sample.positions;
+	Int32ArraySamplePtr vertex_index = sample.face_indices;
+	Int32ArraySamplePtr face_count = sample.face_counts;
+
+	// geometry is same when all samples it is made from are same
+	const std::string key = geometry_key(selector);
+	if (!key.empty() && key == geometry_key_)
+	{
+		update_vertex(sample);
+		return;
+	}
+	if (!key.empty() && geometry_cache_)
+	{
+		if (UMAbcMeshGeometryPtr geometry = geometry_cache_->find(key))
+		{
+			// the record carries its own triangulation, which the batch groups by
+			if (geometry != geometry_ || vertex_index != vertex_index_ || face_count != face_count_)
+			{
+				++topology_revision_;
+			}
+			geometry_ = geometry;
+			geometry_key_ = key;
+			vertex_index_ = vertex_index;
+			face_count_ = face_count;
+			++revision_;
+			update_vertex(sample);
+			return;
+		}
+	}
+
+	// never modify a record shared with other meshes
+	const bool is_shared = geometry_.use_count() > 1;
+	if (is_shared)
+	{
+		geometry_ = UMAbcMeshGeometryPtr(new UMAbcMeshGeometry());
+		++revision_;
+	}
+	else if (geometry_cache_ && !geometry_key_.empty())
+	{
+		geometry_cache_->remove(geometry_key_, geometry_.get());
+	}
+	geometry_key_ = key;
 
 	// update same size buffer
-	if (vertex_ && vertex_index_ && face_count_)
+	if (!is_shared && vertex_ && vertex_index_ && face_count_)
 	{
 		if (vertex_->size() == vertex->size()
 			&& vertex_index_->size() == vertex_index->size()
@@ -651,6 +882,7 @@ void UMAbcMesh::Impl::update_mesh_all()
 				update_normal();
 				update_uv();
 			}
+			cache_geometry();
 			return;
 		}
 	}
@@ -661,6 +893,145 @@ void UMAbcMesh::Impl::update_mesh_all()
 	update_vertex(sample);
 	update_normal();
 	update_uv();
+	cache_geometry();
+}
+
+/**
+ * release derived buffers. samples are dropped too so that next update rebuilds all.
+ */
+void UMAbcMesh::Impl::release_buffers()
+{
+	if (is_released_) return;
+	is_released_ = true;
+
+	// the record stays alive while other meshes or the sample cache use it
+	geometry_ = UMAbcMeshGeometryPtr(new UMAbcMeshGeometry());
+	geometry_key_.clear();
+	vertex_.reset();
+	vertex_index_.reset();
+	face_count_.reset();
+	normal_.reset();
+	uv_.reset();
+
+	bvh_.clear();
+	bvh_has_key_ = false;
+	bvh_vertex_.reset();
+	bvh_vertex_index_.reset();
+	bvh_face_count_.reset();
+	bvh_triangle_size_ = 0;
+
+	std::vector<int>().swap(triangle_faceset_);
+	++revision_;
+	triangle_faceset_revision_ = topology_revision_ - 1;
+}
+
+/**
+ * get bytes of derived buffers owned by this mesh
+ */
+size_t UMAbcMesh::Impl::buffer_byte_size() const
+{
+	return bvh_.byte_size() + triangle_faceset_.capacity() * sizeof(int);
+}
+
+/**
+ * add animated array properties to the prefetcher. tags are same as read_sample.
+ */
+void UMAbcMesh::Impl::add_prefetch_properties(UMAbcPrefetcher& prefetcher) const
+{
+	IPolyMeshSchema& schema = poly_mesh_->getSchema();
+	if (schema.isConstant()) return;
+	if (!schema.getPositionsProperty().isConstant())
+	{
+		prefetcher.add_property(schema.getPositionsProperty(), "P");
+	}
+	if (!schema.getFaceIndicesProperty().isConstant())
+	{
+		prefetcher.add_property(schema.getFaceIndicesProperty(), "I");
+	}
+	if (!schema.getFaceCountsProperty().isConstant())
+	{
+		prefetcher.add_property(schema.getFaceCountsProperty(), "C");
+	}
+}
+
+/**
+ * add bytes held by this mesh. samples kept twice are counted once.
+ */
+void UMAbcMesh::Impl::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(Impl) - sizeof(UMAbcObject)
+		+ string_list_byte_size(faceset_name_list_)
+		+ string_list_byte_size(faceset_names_)
+		+ faceset_polycount_list_.capacity() * sizeof(int)
+		+ faceset_original_polycount_list_.capacity() * sizeof(int)
+		+ material_path_.capacity()
+		+ string_list_byte_size(faceset_material_path_list_)
+		+ geometry_key_.capacity();
+
+	UMAbcSampleCache::add_usage(usage, vertex_);
+	UMAbcSampleCache::add_usage(usage, vertex_index_);
+	UMAbcSampleCache::add_usage(usage, face_count_);
+	UMAbcSampleCache::add_usage(usage, normal_.getVals());
+	UMAbcSampleCache::add_usage(usage, normal_.getIndices());
+	UMAbcSampleCache::add_usage(usage, uv_.getVals());
+	UMAbcSampleCache::add_usage(usage, uv_.getIndices());
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getPositions());
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getFaceIndices());
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getFaceCounts());
+	std::map<std::string, IFaceSetSchema::Sample>::const_iterator it = faceset_.begin();
+	for (; it != faceset_.end(); ++it)
+	{
+		UMAbcSampleCache::add_usage(usage, it->second.getFaces());
+	}
+
+	usage.geometry += geometry_->byte_size();
+	usage.geometry_record = geometry_.get();
+	usage.bvh += bvh_.byte_size();
+	usage.derived += triangle_faceset_.capacity() * sizeof(int);
+}
+
+/**
+ * add completed geometry to the cache
+ */
+void UMAbcMesh::Impl::cache_geometry()
+{
+	if (!geometry_key_.empty() && geometry_cache_)
+	{
+		geometry_cache_->insert(geometry_key_, geometry_);
+	}
+}
+
+/**
+ * read mesh sample through the sample cache
+ */
+void UMAbcMesh::Impl::read_sample(const ISampleSelector& selector, MeshSample& sample)
+{
+	IPolyMeshSchema& schema = poly_mesh_->getSchema();
+	read_cached(schema.getPositionsProperty(), selector, "P", sample.positions);
+	read_cached(schema.getFaceIndicesProperty(), selector, "I", sample.face_indices);
+	read_cached(schema.getFaceCountsProperty(), selector, "C", sample.face_counts);
+}
+
+/**
+ * get digest key of samples which the geometry is made from
+ */
+std::string UMAbcMesh::Impl::geometry_key(const ISampleSelector& selector)
+{
+	IPolyMeshSchema& schema = poly_mesh_->getSchema();
+	if (schema.getNumSamples() == 0) return std::string();
+
+	std::string key;
+	ArraySampleKey sample_key;
+	if (!schema.getPositionsProperty().getKey(sample_key, selector)) return std::string();
+	UMAbcSampleCache::append_key(key, sample_key);
+	if (!schema.getFaceIndicesProperty().getKey(sample_key, selector)) return std::string();
+	UMAbcSampleCache::append_key(key, sample_key);
+	if (!schema.getFaceCountsProperty().getKey(sample_key, selector)) return std::string();
+	UMAbcSampleCache::append_key(key, sample_key);
+	if (!append_param_key(key, schema.getNormalsParam(), selector)) return std::string();
+	if (!append_param_key(key, schema.getUVsParam(), selector)) return std::string();
+	return key;
 }
 
 /**
@@ -689,12 +1060,97 @@ void UMAbcMesh::Impl::update_box(bool recursive)
 	}
 }
 
+/**
+ * get triangle bvh
+ */
+const UMAbcMeshBVH& UMAbcMesh::Impl::bvh()
+{
+	restore_buffers();
+	if (!vertex_ || geometry_->triangle_index.empty())
+	{
+		if (!bvh_.is_empty()) bvh_.build(NULL, 0, NULL, 0);
+		bvh_vertex_.reset();
+		bvh_has_key_ = false;
+		return bvh_;
+	}
+
+	// topology is same when the face index and face count samples are same
+	ArraySampleKey index_key;
+	ArraySampleKey count_key;
+	bool has_key = false;
+	if (poly_mesh_->getSchema().getNumSamples() > 0)
+	{
+		ISampleSelector selector(self_reference()->current_time(), ISampleSelector::kNearIndex);
+		has_key = poly_mesh_->getSchema().getFaceIndicesProperty().getKey(index_key, selector)
+			&& poly_mesh_->getSchema().getFaceCountsProperty().getKey(count_key, selector);
+	}
+	// without keys, fall back to the identity of the cached samples
+	const bool is_same_index = has_key
+		? (bvh_has_key_ && index_key == bvh_index_key_ && count_key == bvh_count_key_)
+		: (!bvh_has_key_ && bvh_vertex_index_ == vertex_index_ && bvh_face_count_ == face_count_);
+	const bool is_same_topology = is_same_index
+		&& !bvh_.is_empty()
+		&& bvh_triangle_size_ == geometry_->triangle_index.size();
+
+	if (is_same_topology)
+	{
+		if (bvh_vertex_ == vertex_) return bvh_;
+		if (bvh_.refit(vertex_->get(), vertex_->size()))
+		{
+			bvh_vertex_ = vertex_;
+			return bvh_;
+		}
+	}
+
+	bvh_.build(vertex_->get(), vertex_->size(), &geometry_->triangle_index[0], geometry_->triangle_index.size());
+	bvh_has_key_ = has_key;
+	bvh_index_key_ = index_key;
+	bvh_count_key_ = count_key;
+	bvh_vertex_index_ = vertex_index_;
+	bvh_face_count_ = face_count_;
+	bvh_triangle_size_ = geometry_->triangle_index.size();
+	bvh_vertex_ = vertex_;
+	return bvh_;
+}
+
+/**
+ * get face set index of each triangle. -1 is not in any face set.
+ */
+const std::vector<int>& UMAbcMesh::Impl::triangle_faceset()
+{
+	restore_buffers();
+	if (triangle_faceset_revision_ == topology_revision_) return triangle_faceset_;
+	triangle_faceset_revision_ = topology_revision_;
+
+	const size_t face_size = face_count_ ? face_count_->size() : 0;
+	std::vector<int> face_faceset(face_size, -1);
+	for (size_t i = 0, size = faceset_name_list_.size(); i < size; ++i)
+	{
+		Int32ArraySamplePtr faces = faceset_[faceset_name_list_[i]].getFaces();
+		if (!faces) continue;
+		for (size_t k = 0, ksize = faces->size(); k < ksize; ++k)
+		{
+			const int face = (*faces)[k];
+			if (face >= 0 && static_cast<size_t>(face) < face_size)
+			{
+				face_faceset[face] = static_cast<int>(i);
+			}
+		}
+	}
+	triangle_faceset_.resize(geometry_->triangle_face.size());
+	for (size_t i = 0, size = geometry_->triangle_face.size(); i < size; ++i)
+	{
+		triangle_faceset_[i] = face_faceset[geometry_->triangle_face[i]];
+	}
+	return triangle_faceset_;
+}
+
 /**
  * get polgon count
  */
 int UMAbcMesh::Impl::polygon_count() const
 {
-	return static_cast<int>(triangle_index_.size());
+	return static_cast<int>(geometry_->triangle_index.size());
 }
 
 /**
@@ -726,7 +1182,45 @@ void UMAbcMesh::set_current_time(unsigned long time, bool recursive)
  */
 void UMAbcMesh::update_box(bool recursive)
 {
+	impl_->restore_buffers();
 	impl_->update_box(recursive);
+	mutable_box() = impl_->box();
+}
+
+/**
+ * release triangulation, normals, uvs and bvh
+ * @param [in] recursive do children recursively
+ */
+void UMAbcMesh::release_buffers(bool recursive)
+{
+	if (impl_->is_valid()) impl_->release_buffers();
+	UMAbcObject::release_buffers(recursive);
+}
+
+/**
+ * add animated array properties of this mesh to the prefetcher
+ */
+void UMAbcMesh::add_prefetch_properties(UMAbcPrefetcher& prefetcher) const
+{
+	if (impl_->is_valid()) impl_->add_prefetch_properties(prefetcher);
+}
+
+/**
+ * add bytes held by this mesh
+ */
+void UMAbcMesh::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(UMAbcMesh) - sizeof(UMAbcObject);
+	impl_->memory_usage(usage);
+}
+
+/**
+ * get bytes of derived buffers owned by this mesh
+ */
+size_t UMAbcMesh::buffer_byte_size() const
+{
+	return impl_->buffer_byte_size();
 }
 
 /**
@@ -734,6 +1228,7 @@ void UMAbcMesh::update_box(bool recursive)
 */
 int UMAbcMesh::polygon_count() const
 {
+	impl_->restore_buffers();
 	return impl_->polygon_count();
 }
 
@@ -747,14 +1242,80 @@ void UMAbcMesh::update_mesh_all()
 
 UMAbcMesh::IndexList& UMAbcMesh::triangle_index()
 {
+	impl_->restore_buffers();
 	return impl_->triangle_index();
 }
 
 std::vector<Imath::V3f>& UMAbcMesh::normals()
 {
+	impl_->restore_buffers();
 	return impl_->normals();
 }
 
+/**
+ * get triangle bvh
+ */
+const UMAbcMeshBVH& UMAbcMesh::bvh()
+{
+	return impl_->bvh();
+}
+
+/**
+ * get face set index of each triangle
+ */
+const std::vector<int>& UMAbcMesh::triangle_faceset()
+{
+	return impl_->triangle_faceset();
+}
+
+/**
+ * get assigned material path
+ */
+const std::string& UMAbcMesh::material_path() const
+{
+	return impl_->material_path();
+}
+
+/**
+ * get assigned material path of each face set
+ */
+const std::vector<std::string>& UMAbcMesh::faceset_material_path_list() const
+{
+	return impl_->faceset_material_path_list();
+}
+
+/**
+ * get revision
+ */
+unsigned int UMAbcMesh::revision() const
+{
+	return impl_->revision();
+}
+
+/**
+ * get topology revision
+ */
+unsigned int UMAbcMesh::topology_revision() const
+{
+	return impl_->topology_revision();
+}
+
+/**
+ * get geometry record
+ */
+UMAbcMeshGeometryPtr UMAbcMesh::geometry() const
+{
+	return impl_->geometry();
+}
+
+/**
+ * set geometry cache
+ */
+void UMAbcMesh::set_geometry_cache(UMAbcMeshGeometryCachePtr cache)
+{
+	impl_->set_geometry_cache(cache);
+}
+
 /**
 * get faceset name list
 */
@@ -781,6 +1342,7 @@ UMAbcObjectPtr UMAbcMesh::self_reference()
 */
 const Imath::V3f * UMAbcMesh::vertex() const
 {
+	impl_->restore_buffers();
 	return impl_->vertex()->get();
 }
 
@@ -789,6 +1351,7 @@ const Imath::V3f * UMAbcMesh::vertex() const
  */
 unsigned int UMAbcMesh::vertex_size() const
 {
+	impl_->restore_buffers();
 	if (impl_->vertex())
 		return static_cast<unsigned int>(impl_->vertex()->size());
 	else
@@ -800,6 +1363,7 @@ unsigned int UMAbcMesh::vertex_size() const
 */
 const Imath::V2f * UMAbcMesh::uv() const
 {
+	impl_->restore_buffers();
 	return impl_->uv().data();
 }
 
@@ -808,6 +1372,7 @@ const Imath::V2f * UMAbcMesh::uv() const
  */
 unsigned int UMAbcMesh::uv_size() const
 {
+	impl_->restore_buffers();
 	return static_cast<unsigned int>(impl_->uv().size());
 }
 
@@ -14,6 +14,8 @@
 #include "ImathVec.h"
 #include "UMMacro.h"
 #include "UMAbcObject.h"
+#include "UMAbcMeshBVH.h"
+#include "UMAbcMeshGeometry.h"
 
 namespace Alembic
 {
@@ -72,6 +74,24 @@ public:
 	 */
 	virtual void update_box(bool recursive);
 
+	/**
+	 * release triangulation, normals, uvs and bvh. they are rebuilt on next access.
+	 * @param [in] recursive do children recursively
+	 */
+	virtual void release_buffers(bool recursive);
+
+	/**
+	 * add bytes held by this mesh, without children
+	 * @param [out] usage memory usage
+	 */
+	virtual void memory_usage(UMAbcMemoryUsage& usage) const;
+
+	/**
+	 * add animated array properties of this mesh to the prefetcher
+	 * @param [out] prefetcher prefetcher
+	 */
+	virtual void add_prefetch_properties(UMAbcPrefetcher& prefetcher) const;
+
 	///**
 	// * draw
 	// * @param [in] recursive do children recursively
@@ -124,15 +144,66 @@ public:
 	unsigned int uv_size() const;
 
 	/**
-	 * get triangle index list
+	 * get triangle index list. it may be shared with instances, so do not modify.
 	 */
 	IndexList& triangle_index();
 
 	/**
-	 * get normal
+	 * get normal. it may be shared with instances, so do not modify.
 	 */
 	std::vector<Imath::V3f>& normals();
 
+	/**
+	 * get triangle bvh of current vertices.
+	 * it is rebuilt when the topology changes and refitted when only vertices move.
+	 */
+	const UMAbcMeshBVH& bvh();
+
+	/**
+	 * get face set index of each triangle. -1 is not in any face set.
+	 * the index is into faceset_name_list.
+	 */
+	const std::vector<int>& triangle_faceset();
+
+	/**
+	 * get assigned material path. empty when not assigned.
+	 */
+	const std::string& material_path() const;
+
+	/**
+	 * get assigned material path of each face set. empty when not assigned.
+	 */
+	const std::vector<std::string>& faceset_material_path_list() const;
+
+	/**
+	 * get revision. it is incremented when vertices or topology change.
+	 */
+	unsigned int revision() const;
+
+	/**
+	 * get topology revision. it is incremented when face indices or face counts change,
+	 * and not by animated vertices.
+	 */
+	unsigned int topology_revision() const;
+
+	/**
+	 * get triangulated geometry record.
+	 * meshes with same sample digests share one record when they have same geometry cache.
+	 * the record is empty while buffers are released.
+	 */
+	UMAbcMeshGeometryPtr geometry() const;
+
+	/**
+	 * get bytes of derived buffers owned by this mesh.
+	 * geometry record is not included since it may be shared.
+	 */
+	size_t buffer_byte_size() const;
+
+	/**
+	 * set geometry cache to share records between meshes. call this before set_current_time.
+	 */
+	void set_geometry_cache(UMAbcMeshGeometryCachePtr cache);
+
 protected:
 	UMAbcMesh(IPolyMeshPtr poly_mesh);
 	
@@ -0,0 +1,712 @@
+/**
+ * @file UMAbcMeshBVH.cpp
+ * triangle bounding volume hierarchy
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+#include <mutex>
+
+#include "UMAbcMeshBVH.h"
+#include "UMAbcParallel.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define UMABC_USE_SSE
+#endif
+
+namespace umabc
+{
+
+namespace
+{
+	// number of SAH bins per axis
+	const int kBinCount = 16;
+
+	// ranges larger than this are binned in parallel
+	const size_t kParallelBinSize = 16384;
+
+	// traversal stack entries kept on the stack frame
+	const int kStackSize = 128;
+
+	/**
+	 * traversal stack. trees deeper than the local entries allow use a heap stack.
+	 */
+	class TraversalStack
+	{
+	public:
+		explicit TraversalStack(int depth)
+			: data_(local_)
+			, size_(0)
+		{
+			// popping a node and pushing its two children keeps at most depth + 1 entries
+			if (depth + 2 > kStackSize)
+			{
+				heap_.resize(depth + 2);
+				data_ = &heap_[0];
+			}
+		}
+
+		bool empty() const { return size_ == 0; }
+		void push(int node) { data_[size_++] = node; }
+		int pop() { return data_[--size_]; }
+
+	private:
+		int local_[kStackSize];
+		std::vector<int> heap_;
+		int* data_;
+		int size_;
+	};
+
+	struct Bin
+	{
+		Imath::Box3f box;
+		size_t count;
+	};
+
+	/**
+	 * half surface area
+	 */
+	float half_area(const Imath::Box3f& box)
+	{
+		if (box.isEmpty()) return 0.0f;
+		const Imath::V3f size = box.size();
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	/**
+	 * ray and box slab test
+	 */
+	bool intersect_box(
+		const Imath::V3f& min,
+		const Imath::V3f& max,
+		const Imath::V3f& origin,
+		const Imath::V3f& inv_direction,
+		float max_distance,
+		float& near_distance)
+	{
+		float t0 = 0.0f;
+		float t1 = max_distance;
+		for (int i = 0; i < 3; ++i)
+		{
+			float a = (min[i] - origin[i]) * inv_direction[i];
+			float b = (max[i] - origin[i]) * inv_direction[i];
+			if (a > b) std::swap(a, b);
+			t0 = a > t0 ? a : t0;
+			t1 = b < t1 ? b : t1;
+			if (t0 > t1) return false;
+		}
+		near_distance = t0;
+		return true;
+	}
+
+	/**
+	 * squared distance from the point to the box
+	 */
+	float box_distance2(const Imath::V3f& min, const Imath::V3f& max, const Imath::V3f& point)
+	{
+		float d2 = 0.0f;
+		for (int i = 0; i < 3; ++i)
+		{
+			const float d = point[i] < min[i] ? min[i] - point[i] : (point[i] > max[i] ? point[i] - max[i] : 0.0f);
+			d2 += d * d;
+		}
+		return d2;
+	}
+
+	/**
+	 * closest point on the triangle v0, v0 + e1, v0 + e2 as barycentric u, v
+	 */
+	void closest_on_triangle(
+		const Imath::V3f& p,
+		const Imath::V3f& v0,
+		const Imath::V3f& e1,
+		const Imath::V3f& e2,
+		float& u,
+		float& v)
+	{
+		const Imath::V3f ap = p - v0;
+		const float d1 = e1.dot(ap);
+		const float d2 = e2.dot(ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) { u = 0.0f; v = 0.0f; return; }
+
+		const Imath::V3f bp = ap - e1;
+		const float d3 = e1.dot(bp);
+		const float d4 = e2.dot(bp);
+		if (d3 >= 0.0f && d4 <= d3) { u = 1.0f; v = 0.0f; return; }
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		{
+			u = d1 / (d1 - d3);
+			v = 0.0f;
+			return;
+		}
+
+		const Imath::V3f cp = ap - e2;
+		const float d5 = e1.dot(cp);
+		const float d6 = e2.dot(cp);
+		if (d6 >= 0.0f && d5 <= d6) { u = 0.0f; v = 1.0f; return; }
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		{
+			u = 0.0f;
+			v = d2 / (d2 - d6);
+			return;
+		}
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		{
+			v = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			u = 1.0f - v;
+			return;
+		}
+
+		const float denom = va + vb + vc;
+		if (denom == 0.0f) { u = 0.0f; v = 0.0f; return; }
+		u = vb / denom;
+		v = vc / denom;
+	}
+
+} // anonymous namespace
+
+/**
+ * build
+ */
+bool UMAbcMeshBVH::build(
+	const Imath::V3f* vertices,
+	size_t vertex_size,
+	const Imath::V3i* triangles,
+	size_t triangle_size)
+{
+	triangles_.clear();
+	order_.clear();
+	nodes_.clear();
+	packets_.clear();
+	depth_ = 0;
+	if (!vertices || !triangles) return false;
+
+	// triangles with out of range indices are left out of the tree
+	triangles_.assign(triangles, triangles + triangle_size);
+	order_.reserve(triangle_size);
+	for (size_t i = 0; i < triangle_size; ++i)
+	{
+		const Imath::V3i& t = triangles[i];
+		if (t.x < 0 || t.y < 0 || t.z < 0) continue;
+		if (static_cast<size_t>(t.x) >= vertex_size
+			|| static_cast<size_t>(t.y) >= vertex_size
+			|| static_cast<size_t>(t.z) >= vertex_size) continue;
+		order_.push_back(static_cast<unsigned int>(i));
+	}
+	const size_t count = order_.size();
+	if (count == 0) return false;
+
+	// per triangle bounds and centroids
+	triangle_bounds_.resize(triangle_size);
+	centroids_.resize(triangle_size);
+	parallel_for(count, 4096, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			const unsigned int id = order_[i];
+			const Imath::V3i& t = triangles_[id];
+			Imath::Box3f box(vertices[t.x]);
+			box.extendBy(vertices[t.y]);
+			box.extendBy(vertices[t.z]);
+			triangle_bounds_[id] = box;
+			centroids_[id] = box.center();
+		}
+	});
+
+	nodes_.reserve(count / 2 + 1);
+	build_recursive(0, count, 0);
+
+	parallel_for(packets_.size(), 1024, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			update_packet(i, vertices);
+		}
+	});
+
+	// only needed while building
+	std::vector<Imath::Box3f>().swap(triangle_bounds_);
+	std::vector<Imath::V3f>().swap(centroids_);
+	return true;
+}
+
+/**
+ * build nodes for order_[begin, end)
+ */
+void UMAbcMeshBVH::build_recursive(size_t begin, size_t end, int depth)
+{
+	depth_ = std::max(depth_, depth);
+	const int index = static_cast<int>(nodes_.size());
+	nodes_.push_back(Node());
+
+	// bounds and centroid bounds
+	Imath::Box3f box;
+	Imath::Box3f centroid_box;
+	for (size_t i = begin; i < end; ++i)
+	{
+		box.extendBy(triangle_bounds_[order_[i]]);
+		centroid_box.extendBy(centroids_[order_[i]]);
+	}
+	nodes_[index].min = box.min;
+	nodes_[index].max = box.max;
+
+	const size_t count = end - begin;
+	if (count <= static_cast<size_t>(kLeafSize))
+	{
+		nodes_[index].offset = static_cast<int>(packets_.size());
+		nodes_[index].count = static_cast<int>(count);
+		Packet packet;
+		for (int lane = 0; lane < kLeafSize; ++lane)
+		{
+			packet.id[lane] = lane < static_cast<int>(count) ? static_cast<int>(order_[begin + lane]) : -1;
+		}
+		packets_.push_back(packet);
+		return;
+	}
+	nodes_[index].count = 0;
+
+	// bin centroids on all axes
+	const Imath::V3f extent = centroid_box.size();
+	Imath::V3f scale;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		scale[axis] = extent[axis] > 0.0f ? kBinCount / extent[axis] * 0.9999f : 0.0f;
+	}
+	Bin bins[3][kBinCount];
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		for (int b = 0; b < kBinCount; ++b)
+		{
+			bins[axis][b].box.makeEmpty();
+			bins[axis][b].count = 0;
+		}
+	}
+	std::mutex bin_mutex;
+	const size_t grain = count > kParallelBinSize ? kParallelBinSize / 4 : count;
+	parallel_for(count, grain, [&](size_t chunk_begin, size_t chunk_end) {
+		Bin local[3][kBinCount];
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			for (int b = 0; b < kBinCount; ++b)
+			{
+				local[axis][b].box.makeEmpty();
+				local[axis][b].count = 0;
+			}
+		}
+		for (size_t i = begin + chunk_begin; i < begin + chunk_end; ++i)
+		{
+			const unsigned int t = order_[i];
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const int b = static_cast<int>((centroids_[t][axis] - centroid_box.min[axis]) * scale[axis]);
+				local[axis][b].box.extendBy(triangle_bounds_[t]);
+				++local[axis][b].count;
+			}
+		}
+		std::lock_guard<std::mutex> lock(bin_mutex);
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			for (int b = 0; b < kBinCount; ++b)
+			{
+				bins[axis][b].box.extendBy(local[axis][b].box);
+				bins[axis][b].count += local[axis][b].count;
+			}
+		}
+	});
+
+	// sweep for the lowest SAH cost
+	int best_axis = -1;
+	int best_split = 0;
+	float best_cost = FLT_MAX;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (scale[axis] <= 0.0f) continue;
+		float right_area[kBinCount];
+		size_t right_count[kBinCount];
+		Imath::Box3f right_box;
+		size_t right_total = 0;
+		for (int b = kBinCount - 1; b > 0; --b)
+		{
+			right_box.extendBy(bins[axis][b].box);
+			right_total += bins[axis][b].count;
+			right_area[b] = half_area(right_box);
+			right_count[b] = right_total;
+		}
+		Imath::Box3f left_box;
+		size_t left_total = 0;
+		for (int b = 0; b < kBinCount - 1; ++b)
+		{
+			left_box.extendBy(bins[axis][b].box);
+			left_total += bins[axis][b].count;
+			if (left_total == 0 || right_count[b + 1] == 0) continue;
+			const float cost = half_area(left_box) * left_total + right_area[b + 1] * right_count[b + 1];
+			if (cost < best_cost)
+			{
+				best_cost = cost;
+				best_axis = axis;
+				best_split = b + 1;
+			}
+		}
+	}
+
+	size_t mid = begin + count / 2;
+	if (best_axis >= 0)
+	{
+		const int axis = best_axis;
+		const float axis_min = centroid_box.min[axis];
+		const float axis_scale = scale[axis];
+		mid = std::partition(order_.begin() + begin, order_.begin() + end, [&](unsigned int t) {
+			return static_cast<int>((centroids_[t][axis] - axis_min) * axis_scale) < best_split;
+		}) - order_.begin();
+	}
+	if (mid == begin || mid == end)
+	{
+		// all centroids are same. split by count
+		mid = begin + count / 2;
+	}
+
+	build_recursive(begin, mid, depth + 1);
+	nodes_[index].offset = static_cast<int>(nodes_.size());
+	build_recursive(mid, end, depth + 1);
+}
+
+/**
+ * update packed triangles of a leaf
+ */
+void UMAbcMeshBVH::update_packet(size_t packet, const Imath::V3f* vertices)
+{
+	Packet& p = packets_[packet];
+	for (int lane = 0; lane < kLeafSize; ++lane)
+	{
+		if (p.id[lane] < 0)
+		{
+			for (int k = 0; k < 3; ++k)
+			{
+				p.v0[k][lane] = 0.0f;
+				p.e1[k][lane] = 0.0f;
+				p.e2[k][lane] = 0.0f;
+			}
+			continue;
+		}
+		const Imath::V3i& t = triangles_[p.id[lane]];
+		const Imath::V3f& v0 = vertices[t.x];
+		const Imath::V3f e1 = vertices[t.y] - v0;
+		const Imath::V3f e2 = vertices[t.z] - v0;
+		for (int k = 0; k < 3; ++k)
+		{
+			p.v0[k][lane] = v0[k];
+			p.e1[k][lane] = e1[k];
+			p.e2[k][lane] = e2[k];
+		}
+	}
+}
+
+/**
+ * refit
+ */
+bool UMAbcMeshBVH::refit(const Imath::V3f* vertices, size_t vertex_size)
+{
+	if (nodes_.empty() || !vertices) return false;
+	for (size_t i = 0, size = order_.size(); i < size; ++i)
+	{
+		const Imath::V3i& t = triangles_[order_[i]];
+		if (static_cast<size_t>(std::max(t.x, std::max(t.y, t.z))) >= vertex_size) return false;
+	}
+
+	parallel_for(packets_.size(), 1024, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			update_packet(i, vertices);
+		}
+	});
+
+	// children are stored after their parent
+	for (size_t i = nodes_.size(); i > 0; --i)
+	{
+		Node& node = nodes_[i - 1];
+		Imath::Box3f box;
+		if (node.count > 0)
+		{
+			const Packet& p = packets_[node.offset];
+			for (int lane = 0; lane < node.count; ++lane)
+			{
+				const Imath::V3f v0(p.v0[0][lane], p.v0[1][lane], p.v0[2][lane]);
+				const Imath::V3f e1(p.e1[0][lane], p.e1[1][lane], p.e1[2][lane]);
+				const Imath::V3f e2(p.e2[0][lane], p.e2[1][lane], p.e2[2][lane]);
+				box.extendBy(v0);
+				box.extendBy(v0 + e1);
+				box.extendBy(v0 + e2);
+			}
+		}
+		else
+		{
+			const Node& left = nodes_[i];
+			const Node& right = nodes_[node.offset];
+			box.extendBy(Imath::Box3f(left.min, left.max));
+			box.extendBy(Imath::Box3f(right.min, right.max));
+		}
+		node.min = box.min;
+		node.max = box.max;
+	}
+	return true;
+}
+
+/**
+ * get nearest hit along the ray
+ */
+bool UMAbcMeshBVH::raycast(
+	const Imath::V3f& origin,
+	const Imath::V3f& direction,
+	float max_distance,
+	RayHit& hit) const
+{
+	if (nodes_.empty()) return false;
+
+	Imath::V3f inv_direction;
+	for (int i = 0; i < 3; ++i)
+	{
+		const float d = direction[i];
+		inv_direction[i] = std::fabs(d) > 1.0e-30f ? 1.0f / d : (d < 0.0f ? -1.0e30f : 1.0e30f);
+	}
+
+	float best = max_distance;
+	bool is_hit = false;
+	TraversalStack stack(depth_);
+	stack.push(0);
+
+#ifdef UMABC_USE_SSE
+	const __m128 ox = _mm_set1_ps(origin.x);
+	const __m128 oy = _mm_set1_ps(origin.y);
+	const __m128 oz = _mm_set1_ps(origin.z);
+	const __m128 dx = _mm_set1_ps(direction.x);
+	const __m128 dy = _mm_set1_ps(direction.y);
+	const __m128 dz = _mm_set1_ps(direction.z);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+#endif
+
+	while (!stack.empty())
+	{
+		const Node& node = nodes_[stack.pop()];
+		float near_distance;
+		if (!intersect_box(node.min, node.max, origin, inv_direction, best, near_distance)) continue;
+
+		if (node.count == 0)
+		{
+			// visit the nearer child first
+			const int left = static_cast<int>(&node - &nodes_[0]) + 1;
+			const int right = node.offset;
+			float left_distance = FLT_MAX;
+			float right_distance = FLT_MAX;
+			const bool is_left = intersect_box(nodes_[left].min, nodes_[left].max, origin, inv_direction, best, left_distance);
+			const bool is_right = intersect_box(nodes_[right].min, nodes_[right].max, origin, inv_direction, best, right_distance);
+			if (is_left && is_right)
+			{
+				stack.push(left_distance < right_distance ? right : left);
+				stack.push(left_distance < right_distance ? left : right);
+			}
+			else if (is_left)
+			{
+				stack.push(left);
+			}
+			else if (is_right)
+			{
+				stack.push(right);
+			}
+			continue;
+		}
+
+		const Packet& p = packets_[node.offset];
+		float t[kLeafSize];
+		float u[kLeafSize];
+		float v[kLeafSize];
+		int valid[kLeafSize];
+#ifdef UMABC_USE_SSE
+		{
+			const __m128 e1x = _mm_loadu_ps(p.e1[0]);
+			const __m128 e1y = _mm_loadu_ps(p.e1[1]);
+			const __m128 e1z = _mm_loadu_ps(p.e1[2]);
+			const __m128 e2x = _mm_loadu_ps(p.e2[0]);
+			const __m128 e2y = _mm_loadu_ps(p.e2[1]);
+			const __m128 e2z = _mm_loadu_ps(p.e2[2]);
+			// pvec = d x e2
+			const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+			const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+			const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+			const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+			const __m128 inv_det = _mm_div_ps(one, det);
+			// tvec = o - v0
+			const __m128 tx = _mm_sub_ps(ox, _mm_loadu_ps(p.v0[0]));
+			const __m128 ty = _mm_sub_ps(oy, _mm_loadu_ps(p.v0[1]));
+			const __m128 tz = _mm_sub_ps(oz, _mm_loadu_ps(p.v0[2]));
+			const __m128 uu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz)), inv_det);
+			// qvec = tvec x e1
+			const __m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+			const __m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+			const __m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+			const __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv_det);
+			const __m128 tt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv_det);
+			__m128 mask = _mm_cmpneq_ps(det, zero);
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(uu, zero));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(vv, zero));
+			mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(uu, vv), one));
+			mask = _mm_and_ps(mask, _mm_cmpge_ps(tt, zero));
+			mask = _mm_and_ps(mask, _mm_cmplt_ps(tt, _mm_set1_ps(best)));
+			_mm_storeu_ps(t, tt);
+			_mm_storeu_ps(u, uu);
+			_mm_storeu_ps(v, vv);
+			const int bits = _mm_movemask_ps(mask);
+			for (int lane = 0; lane < kLeafSize; ++lane)
+			{
+				valid[lane] = (bits >> lane) & 1;
+			}
+		}
+#else
+		for (int lane = 0; lane < kLeafSize; ++lane)
+		{
+			const Imath::V3f e1(p.e1[0][lane], p.e1[1][lane], p.e1[2][lane]);
+			const Imath::V3f e2(p.e2[0][lane], p.e2[1][lane], p.e2[2][lane]);
+			const Imath::V3f pvec = direction.cross(e2);
+			const float det = e1.dot(pvec);
+			valid[lane] = 0;
+			if (det == 0.0f) continue;
+			const float inv_det = 1.0f / det;
+			const Imath::V3f tvec = origin - Imath::V3f(p.v0[0][lane], p.v0[1][lane], p.v0[2][lane]);
+			const Imath::V3f qvec = tvec.cross(e1);
+			u[lane] = tvec.dot(pvec) * inv_det;
+			v[lane] = direction.dot(qvec) * inv_det;
+			t[lane] = e2.dot(qvec) * inv_det;
+			valid[lane] = u[lane] >= 0.0f && v[lane] >= 0.0f && u[lane] + v[lane] <= 1.0f
+				&& t[lane] >= 0.0f && t[lane] < best;
+		}
+#endif
+		for (int lane = 0; lane < node.count; ++lane)
+		{
+			if (valid[lane] && t[lane] < best)
+			{
+				best = t[lane];
+				hit.distance = t[lane];
+				hit.triangle = p.id[lane];
+				hit.u = u[lane];
+				hit.v = v[lane];
+				is_hit = true;
+			}
+		}
+	}
+	return is_hit;
+}
+
+/**
+ * get closest point on the triangles
+ */
+bool UMAbcMeshBVH::closest_point(
+	const Imath::V3f& point,
+	float max_distance,
+	ClosestHit& hit) const
+{
+	if (nodes_.empty()) return false;
+
+	float best2 = max_distance < FLT_MAX ? max_distance * max_distance : FLT_MAX;
+	bool is_found = false;
+	TraversalStack stack(depth_);
+	stack.push(0);
+	while (!stack.empty())
+	{
+		const Node& node = nodes_[stack.pop()];
+		if (box_distance2(node.min, node.max, point) > best2) continue;
+
+		if (node.count == 0)
+		{
+			// visit the nearer child first
+			const int left = static_cast<int>(&node - &nodes_[0]) + 1;
+			const int right = node.offset;
+			const float left_distance = box_distance2(nodes_[left].min, nodes_[left].max, point);
+			const float right_distance = box_distance2(nodes_[right].min, nodes_[right].max, point);
+			if (left_distance < right_distance)
+			{
+				if (right_distance <= best2) stack.push(right);
+				stack.push(left);
+			}
+			else
+			{
+				if (left_distance <= best2) stack.push(left);
+				stack.push(right);
+			}
+			continue;
+		}
+
+		const Packet& p = packets_[node.offset];
+		for (int lane = 0; lane < node.count; ++lane)
+		{
+			const Imath::V3f v0(p.v0[0][lane], p.v0[1][lane], p.v0[2][lane]);
+			const Imath::V3f e1(p.e1[0][lane], p.e1[1][lane], p.e1[2][lane]);
+			const Imath::V3f e2(p.e2[0][lane], p.e2[1][lane], p.e2[2][lane]);
+			float u;
+			float v;
+			closest_on_triangle(point, v0, e1, e2, u, v);
+			const Imath::V3f position = v0 + e1 * u + e2 * v;
+			const float d2 = (position - point).length2();
+			if (d2 <= best2)
+			{
+				best2 = d2;
+				hit.triangle = p.id[lane];
+				hit.u = u;
+				hit.v = v;
+				hit.position = position;
+				is_found = true;
+			}
+		}
+	}
+	if (is_found)
+	{
+		hit.distance = std::sqrt(best2);
+	}
+	return is_found;
+}
+
+/**
+ * get bounds of all triangles
+ */
+Imath::Box3f UMAbcMeshBVH::bounds() const
+{
+	if (nodes_.empty()) return Imath::Box3f();
+	return Imath::Box3f(nodes_[0].min, nodes_[0].max);
+}
+
+/**
+ * release all nodes and triangles
+ */
+void UMAbcMeshBVH::clear()
+{
+	std::vector<Imath::V3i>().swap(triangles_);
+	std::vector<unsigned int>().swap(order_);
+	std::vector<Imath::Box3f>().swap(triangle_bounds_);
+	std::vector<Imath::V3f>().swap(centroids_);
+	std::vector<Node>().swap(nodes_);
+	std::vector<Packet>().swap(packets_);
+	depth_ = 0;
+}
+
+/**
+ * get allocated bytes
+ */
+size_t UMAbcMeshBVH::byte_size() const
+{
+	return triangles_.capacity() * sizeof(Imath::V3i)
+		+ order_.capacity() * sizeof(unsigned int)
+		+ nodes_.capacity() * sizeof(Node)
+		+ packets_.capacity() * sizeof(Packet);
+}
+
+} // umabc
@@ -0,0 +1,170 @@
+/**
+ * @file UMAbcMeshBVH.h
+ * triangle bounding volume hierarchy
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "ImathVec.h"
+#include "ImathBox.h"
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+class UMAbcMeshBVH;
+typedef std::shared_ptr<UMAbcMeshBVH> UMAbcMeshBVHPtr;
+
+/**
+ * triangle bvh built with binned SAH.
+ * each leaf holds up to four triangles packed for 4 wide intersection tests.
+ */
+class UMAbcMeshBVH
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcMeshBVH);
+public:
+
+	/**
+	 * ray hit. position is (1 - u - v) * v0 + u * v1 + v * v2
+	 */
+	struct RayHit
+	{
+		RayHit() : distance(0), triangle(-1), u(0), v(0) {}
+		float distance;
+		int triangle;
+		float u;
+		float v;
+	};
+
+	/**
+	 * closest point on the mesh. position is (1 - u - v) * v0 + u * v1 + v * v2
+	 */
+	struct ClosestHit
+	{
+		ClosestHit() : distance(0), triangle(-1), u(0), v(0) {}
+		float distance;
+		int triangle;
+		float u;
+		float v;
+		Imath::V3f position;
+	};
+
+	UMAbcMeshBVH() : depth_(0) {}
+	~UMAbcMeshBVH() {}
+
+	/**
+	 * build
+	 * @param [in] vertices vertex list
+	 * @param [in] vertex_size vertex count
+	 * @param [in] triangles triangle index list
+	 * @param [in] triangle_size triangle count
+	 * @retval succsess or fail
+	 */
+	bool build(
+		const Imath::V3f* vertices,
+		size_t vertex_size,
+		const Imath::V3i* triangles,
+		size_t triangle_size);
+
+	/**
+	 * update bounds and packed triangles for moved vertices. topology must be same as build.
+	 * @retval succsess or fail
+	 */
+	bool refit(const Imath::V3f* vertices, size_t vertex_size);
+
+	/**
+	 * get nearest hit along the ray
+	 * @param [in] origin ray origin
+	 * @param [in] direction ray direction. distance is in units of its length
+	 * @param [in] max_distance maximum distance
+	 * @param [out] hit nearest hit
+	 * @retval hit or not
+	 */
+	bool raycast(
+		const Imath::V3f& origin,
+		const Imath::V3f& direction,
+		float max_distance,
+		RayHit& hit) const;
+
+	/**
+	 * get closest point on the triangles
+	 * @param [in] point query point
+	 * @param [in] max_distance maximum distance
+	 * @param [out] hit closest point
+	 * @retval found or not
+	 */
+	bool closest_point(
+		const Imath::V3f& point,
+		float max_distance,
+		ClosestHit& hit) const;
+
+	/**
+	 * is empty or not
+	 */
+	bool is_empty() const { return nodes_.empty(); }
+
+	/**
+	 * get triangle count
+	 */
+	size_t triangle_size() const { return triangles_.size(); }
+
+	/**
+	 * get bounds of all triangles
+	 */
+	Imath::Box3f bounds() const;
+
+	/**
+	 * release all nodes and triangles
+	 */
+	void clear();
+
+	/**
+	 * get allocated bytes
+	 */
+	size_t byte_size() const;
+
+private:
+	static const int kLeafSize = 4;
+
+	/**
+	 * node. leaf when count > 0. left child of an inner node is the next node.
+	 */
+	struct Node
+	{
+		Imath::V3f min;
+		int offset; // right child or first packet
+		Imath::V3f max;
+		int count;
+	};
+
+	/**
+	 * four triangles in SoA layout. empty lanes have zero edges.
+	 */
+	struct Packet
+	{
+		float v0[3][kLeafSize];
+		float e1[3][kLeafSize];
+		float e2[3][kLeafSize];
+		int id[kLeafSize];
+	};
+
+	void build_recursive(size_t begin, size_t end, int depth);
+	void update_packet(size_t packet, const Imath::V3f* vertices);
+
+	std::vector<Imath::V3i> triangles_;
+	std::vector<unsigned int> order_;
+	std::vector<Imath::Box3f> triangle_bounds_;
+	std::vector<Imath::V3f> centroids_;
+	std::vector<Node> nodes_;
+	std::vector<Packet> packets_;
+	int depth_; // edges from the root to the deepest node
+};
+
+} // umabc
@@ -0,0 +1,94 @@
+/**
+ * @file UMAbcMeshGeometry.cpp
+ * triangulated mesh geometry shared by instances
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcMeshGeometry.h"
+#include "UMAbcSampleCache.h"
+
+namespace umabc
+{
+
+namespace
+{
+	/**
+	 * key of the record in the process wide sample cache
+	 */
+	std::string retained_key(const std::string& key)
+	{
+		return "G" + key;
+	}
+} // anonymous namespace
+
+/**
+ * find geometry
+ */
+UMAbcMeshGeometryPtr UMAbcMeshGeometryCache::find(const std::string& key)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		GeometryMap::iterator it = geometry_map_.find(key);
+		if (it != geometry_map_.end())
+		{
+			if (UMAbcMeshGeometryPtr geometry = it->second.lock()) return geometry;
+			geometry_map_.erase(it);
+		}
+	}
+	// records no mesh holds any more, e.g. frames scrubbed back to
+	UMAbcMeshGeometryPtr geometry = std::static_pointer_cast<UMAbcMeshGeometry>(
+		UMAbcSampleCache::instance().find(retained_key(key)));
+	if (geometry)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		geometry_map_[key] = geometry;
+	}
+	return geometry;
+}
+
+/**
+ * add geometry
+ */
+void UMAbcMeshGeometryCache::insert(const std::string& key, UMAbcMeshGeometryPtr geometry)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		geometry_map_[key] = geometry;
+	}
+	UMAbcSampleCache::instance().insert(retained_key(key), geometry, geometry->byte_size());
+}
+
+/**
+ * remove geometry if the key has it
+ */
+void UMAbcMeshGeometryCache::remove(const std::string& key, const UMAbcMeshGeometry* geometry)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	GeometryMap::iterator it = geometry_map_.find(key);
+	if (it == geometry_map_.end()) return;
+	UMAbcMeshGeometryPtr current = it->second.lock();
+	if (!current || current.get() == geometry)
+	{
+		geometry_map_.erase(it);
+	}
+}
+
+/**
+ * get number of live records
+ */
+size_t UMAbcMeshGeometryCache::size()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	size_t count = 0;
+	for (GeometryMap::iterator it = geometry_map_.begin(); it != geometry_map_.end(); ++it)
+	{
+		if (!it->second.expired()) ++count;
+	}
+	return count;
+}
+
+} // umabc
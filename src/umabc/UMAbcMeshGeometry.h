@@ -0,0 +1,102 @@
+/**
+ * @file UMAbcMeshGeometry.h
+ * triangulated mesh geometry shared by instances
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include "ImathVec.h"
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+/**
+ * triangulated geometry with computed normals and uvs.
+ * meshes with same samples share one record, so it must not be modified after it is cached.
+ */
+struct UMAbcMeshGeometry
+{
+	typedef std::vector<Imath::V3i > IndexList;
+
+	IndexList triangle_index;
+	IndexList triangle_index_number;
+	std::vector<int> triangle_face;
+	std::vector<Imath::V3f> normals;
+	std::vector<Imath::V2f> uvs;
+
+	/**
+	 * get memory size
+	 */
+	size_t byte_size() const
+	{
+		return triangle_index.capacity() * sizeof(Imath::V3i)
+			+ triangle_index_number.capacity() * sizeof(Imath::V3i)
+			+ triangle_face.capacity() * sizeof(int)
+			+ normals.capacity() * sizeof(Imath::V3f)
+			+ uvs.capacity() * sizeof(Imath::V2f);
+	}
+};
+typedef std::shared_ptr<UMAbcMeshGeometry> UMAbcMeshGeometryPtr;
+typedef std::weak_ptr<UMAbcMeshGeometry> UMAbcMeshGeometryWeakPtr;
+
+class UMAbcMeshGeometryCache;
+typedef std::shared_ptr<UMAbcMeshGeometryCache> UMAbcMeshGeometryCachePtr;
+
+/**
+ * geometry records by sample digest key.
+ * records are weakly held here, and retained by the process wide sample cache
+ * within its byte budget, so that scrubbing back does not triangulate again.
+ * a retained record is shared, so meshes update records in place only
+ * while the sample cache does not retain them, e.g. with budget 0.
+ */
+class UMAbcMeshGeometryCache
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcMeshGeometryCache);
+public:
+	UMAbcMeshGeometryCache() {}
+	~UMAbcMeshGeometryCache() {}
+
+	/**
+	 * find geometry. records retained by the sample cache are found too.
+	 * @param [in] key sample digest key
+	 * @retval geometry or null
+	 */
+	UMAbcMeshGeometryPtr find(const std::string& key);
+
+	/**
+	 * add geometry and retain it in the sample cache. it must not be modified afterwards.
+	 * @param [in] key sample digest key
+	 * @param [in] geometry geometry
+	 */
+	void insert(const std::string& key, UMAbcMeshGeometryPtr geometry);
+
+	/**
+	 * remove geometry if the key has it
+	 * @param [in] key sample digest key
+	 * @param [in] geometry geometry
+	 */
+	void remove(const std::string& key, const UMAbcMeshGeometry* geometry);
+
+	/**
+	 * get number of live records
+	 */
+	size_t size();
+
+private:
+	typedef std::map<std::string, UMAbcMeshGeometryWeakPtr> GeometryMap;
+	std::mutex mutex_;
+	GeometryMap geometry_map_;
+};
+
+} // umabc
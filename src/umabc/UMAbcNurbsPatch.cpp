@@ -14,6 +14,7 @@
 #include <Alembic/AbcCoreFactory/All.h>
 
 #include "UMAbcNurbsPatch.h"
+#include "UMAbcSampleCache.h"
 
 namespace umabc
 {
@@ -61,6 +62,11 @@ namespace umabc
 		*/
 		void update_patch_all();
 
+		/**
+		* add bytes held by this nurbs patch
+		*/
+		void memory_usage(UMAbcMemoryUsage& usage) const;
+
 		virtual UMAbcObjectPtr self_reference()
 		{
 			return self_reference_.lock();
@@ -70,8 +76,10 @@ namespace umabc
 
 		Alembic::AbcGeom::P3fArraySamplePtr positions() const { return positions_; }
 
-		Alembic::AbcGeom::FloatArraySamplePtr u_knot_list() const { return v_knot_; }
-		Alembic::AbcGeom::FloatArraySamplePtr v_knot_list() const { return u_knot_; }
+		Alembic::AbcGeom::FloatArraySamplePtr u_knot_list() const { return u_knot_; }
+		Alembic::AbcGeom::FloatArraySamplePtr v_knot_list() const { return v_knot_; }
+
+		Alembic::AbcGeom::FloatArraySamplePtr weights() const { return weights_; }
 
 		unsigned int u_size() const { return u_size_; }
 		unsigned int v_size() const { return v_size_; }
@@ -79,6 +87,11 @@ namespace umabc
 		int u_order() const { return u_order_; }
 		int v_order() const { return v_order_; }
 
+		/**
+		* tessellate current sample
+		*/
+		const UMAbcNurbsTessellator& tessellate(const UMAbcNurbsTessellator::Setting& setting);
+
 	private:
 		INuPatchPtr patch_;
 		Alembic::AbcGeom::INuPatchSchema::Sample initial_sample_;
@@ -86,12 +99,15 @@ namespace umabc
 		Alembic::AbcGeom::P3fArraySamplePtr positions_;
 		Alembic::AbcGeom::FloatArraySamplePtr u_knot_;
 		Alembic::AbcGeom::FloatArraySamplePtr v_knot_;
+		Alembic::AbcGeom::FloatArraySamplePtr weights_;
 		size_t u_size_;
 		size_t v_size_;
 		int u_order_;
 		int v_order_;
 
 		std::vector<const Imath::V3f* > points_;
+
+		UMAbcNurbsTessellator tessellator_;
 	};
 /**
  * create
@@ -133,9 +149,10 @@ bool UMAbcNurbsPatch::Impl::init(bool recursive)
 			self_reference()->set_min_time(static_cast<unsigned long>(time->getSampleTime(0) * 1000));
 			self_reference()->set_max_time(static_cast<unsigned long>(time->getSampleTime(num_samples - 1) * 1000));
 		}
+		update_patch_all();
 	}
 
-	return false;
+	return true;
 }
 
 /**
@@ -164,6 +181,40 @@ void UMAbcNurbsPatch::Impl::update_patch_all()
 	v_size_ = sample.getNumV();
 	u_order_ = sample.getUOrder();
 	v_order_ = sample.getVOrder();
+	weights_ = sample.getPositionWeights();
+}
+
+/**
+ * tessellate current sample
+ */
+const UMAbcNurbsTessellator& UMAbcNurbsPatch::Impl::tessellate(const UMAbcNurbsTessellator::Setting& setting)
+{
+	UMAbcNurbsTessellator::Patch patch;
+	if (positions_)
+	{
+		patch.positions = positions_->get();
+		patch.position_size = positions_->size();
+	}
+	if (weights_ && positions_ && weights_->size() == positions_->size())
+	{
+		patch.weights = weights_->get();
+	}
+	patch.u_size = static_cast<int>(u_size_);
+	patch.v_size = static_cast<int>(v_size_);
+	patch.u_order = u_order_;
+	patch.v_order = v_order_;
+	if (u_knot_)
+	{
+		patch.u_knots = u_knot_->get();
+		patch.u_knot_size = u_knot_->size();
+	}
+	if (v_knot_)
+	{
+		patch.v_knots = v_knot_->get();
+		patch.v_knot_size = v_knot_->size();
+	}
+	tessellator_.tessellate(patch, setting);
+	return tessellator_;
 }
 
 /**
@@ -306,13 +357,53 @@ int UMAbcNurbsPatch::v_order() const
 	return impl_->v_order();
 }
 
+/**
+ * add bytes held by this nurbs patch
+ */
+void UMAbcNurbsPatch::Impl::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(Impl) - sizeof(UMAbcObject);
+	UMAbcSampleCache::add_usage(usage, positions_);
+	UMAbcSampleCache::add_usage(usage, u_knot_);
+	UMAbcSampleCache::add_usage(usage, v_knot_);
+	UMAbcSampleCache::add_usage(usage, weights_);
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getPositions());
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getUKnot());
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getVKnot());
+	UMAbcSampleCache::add_usage(usage, initial_sample_.getPositionWeights());
+	usage.derived += tessellator_.byte_size() + points_.capacity() * sizeof(const Imath::V3f*);
+}
+
 /**
 * update box
 * @param [in] recursive do children recursively
 */
 void UMAbcNurbsPatch::update_box(bool recursive)
 {
-	return impl_->update_box(recursive);
+	impl_->update_box(recursive);
+	mutable_box() = impl_->box();
+}
+
+/**
+ * add bytes held by this nurbs patch
+ */
+void UMAbcNurbsPatch::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(UMAbcNurbsPatch) - sizeof(UMAbcObject);
+	impl_->memory_usage(usage);
+}
+
+/**
+* get position weights
+*/
+const float * UMAbcNurbsPatch::position_weights() const
+{
+	if (impl_->weights()) {
+		return impl_->weights()->get();
+	}
+	return NULL;
 }
 
 /**
@@ -323,6 +414,14 @@ void UMAbcNurbsPatch::update_patch_all()
 	impl_->update_patch_all();
 }
 
+/**
+* tessellate current sample
+*/
+const UMAbcNurbsTessellator& UMAbcNurbsPatch::tessellate(const UMAbcNurbsTessellator::Setting& setting)
+{
+	return impl_->tessellate(setting);
+}
+
 UMAbcObjectPtr UMAbcNurbsPatch::self_reference()
 {
 	return impl_->self_reference_.lock();
@@ -14,6 +14,7 @@
 #include "UMMacro.h"
 #include "ImathVec.h"
 #include "UMAbcObject.h"
+#include "UMAbcNurbsTessellator.h"
 
 namespace Alembic {
 	namespace Abc {
@@ -70,6 +71,12 @@ public:
 	 */
 	virtual void update_box(bool recursive);
 
+	/**
+	 * add bytes held by this nurbs patch, without children
+	 * @param [out] usage memory usage
+	 */
+	virtual void memory_usage(UMAbcMemoryUsage& usage) const;
+
 	/**
 	* get position
 	*/
@@ -121,11 +128,23 @@ public:
 	int v_order() const;
 
 
+	/**
+	* get position weights. NULL if the patch is not rational
+	*/
+	const float * position_weights() const;
+
 	/**
 	 * update patch all
 	 */
 	void update_patch_all();
 
+	/**
+	 * tessellate current sample.
+	 * basis tables are reused while knots and orders are unchanged.
+	 * @param [in] setting tessellation setting
+	 */
+	const UMAbcNurbsTessellator& tessellate(const UMAbcNurbsTessellator::Setting& setting);
+
 protected:
 	UMAbcNurbsPatch(INuPatchPtr patch);
 
@@ -0,0 +1,316 @@
+/**
+ * @file UMAbcNurbsTessellator.cpp
+ * nurbs patch tessellator
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include <cmath>
+#include <algorithm>
+
+#include "UMAbcNurbsTessellator.h"
+#include "UMAbcParallel.h"
+
+namespace umabc
+{
+
+namespace
+{
+	// maximum order of patches
+	const int kMaxOrder = 16;
+
+	/**
+	 * evaluate non zero basis functions and their first derivatives at u.
+	 * (The NURBS Book A2.3, first derivative only)
+	 */
+	void basis_functions(const float* knots, int span, int degree, float u, float* values, float* derivs)
+	{
+		float ndu[kMaxOrder][kMaxOrder];
+		float left[kMaxOrder];
+		float right[kMaxOrder];
+		ndu[0][0] = 1.0f;
+		for (int j = 1; j <= degree; ++j)
+		{
+			left[j] = u - knots[span + 1 - j];
+			right[j] = knots[span + j] - u;
+			float saved = 0.0f;
+			for (int r = 0; r < j; ++r)
+			{
+				ndu[j][r] = right[r + 1] + left[j - r];
+				const float temp = ndu[r][j - 1] / ndu[j][r];
+				ndu[r][j] = saved + right[r + 1] * temp;
+				saved = left[j - r] * temp;
+			}
+			ndu[j][j] = saved;
+		}
+		for (int r = 0; r <= degree; ++r)
+		{
+			values[r] = ndu[r][degree];
+			float d = 0.0f;
+			if (r >= 1) d += ndu[r - 1][degree - 1] / ndu[degree][r - 1];
+			if (r <= degree - 1) d -= ndu[r][degree - 1] / ndu[degree][r];
+			derivs[r] = d * degree;
+		}
+	}
+
+	/**
+	 * get segments per knot span from the second differences of the control net.
+	 * a degree p span deviates from its chords by at most p(p-1)/8 * max|d2P| / n^2.
+	 */
+	int flatness_segments(float second_difference, int order, float tolerance, int max_segments)
+	{
+		const int degree = order - 1;
+		if (degree < 2 || second_difference <= 0.0f) return 1;
+		const float bound = degree * (degree - 1) / 8.0f * second_difference;
+		const float tol = std::max(tolerance, 1.0e-6f);
+		const int segments = static_cast<int>(std::ceil(std::sqrt(bound / tol)));
+		return std::max(1, std::min(segments, std::max(1, max_segments)));
+	}
+
+	/**
+	 * round segments up to a power of two, so that the flatness of a moving patch
+	 * changes the basis tables only when it crosses a power of two.
+	 */
+	int quantized_segments(int segments, int max_segments)
+	{
+		int result = 1;
+		while (result < segments) result *= 2;
+		return std::min(result, std::max(segments, max_segments));
+	}
+
+} // anonymous namespace
+
+/**
+ * update basis table. kept as is for the same knots and order
+ * while its segments are at least the requested and at most twice of them.
+ */
+bool UMAbcNurbsTessellator::update_basis(
+	BasisTable& table,
+	const float* knots,
+	size_t knot_size,
+	int control_count,
+	int order,
+	int segments)
+{
+	if (!knots || order < 1 || order > kMaxOrder || control_count < order) return false;
+	if (knot_size < static_cast<size_t>(control_count + order)) return false;
+
+	if (table.order == order
+		&& table.control_count == control_count
+		&& table.segments >= segments
+		&& table.segments <= segments * 2
+		&& table.knots.size() == static_cast<size_t>(control_count + order)
+		&& std::equal(table.knots.begin(), table.knots.end(), knots))
+	{
+		return !table.params.empty();
+	}
+
+	table.knots.assign(knots, knots + control_count + order);
+	table.order = order;
+	table.control_count = control_count;
+	table.segments = segments;
+	table.params.clear();
+	table.first.clear();
+	table.values.clear();
+	table.derivs.clear();
+
+	const int degree = order - 1;
+	int last_span = -1;
+	for (int span = degree; span < control_count; ++span)
+	{
+		const float k0 = knots[span];
+		const float k1 = knots[span + 1];
+		if (!(k1 > k0)) continue;
+		for (int s = 0; s < segments; ++s)
+		{
+			table.params.push_back(k0 + (k1 - k0) * s / segments);
+			table.first.push_back(span);
+		}
+		last_span = span;
+	}
+	if (last_span < 0) return false;
+	table.params.push_back(knots[last_span + 1]);
+	table.first.push_back(last_span);
+
+	const size_t count = table.params.size();
+	table.values.resize(count * order);
+	table.derivs.resize(count * order);
+	for (size_t i = 0; i < count; ++i)
+	{
+		basis_functions(knots, table.first[i], degree, table.params[i], &table.values[i * order], &table.derivs[i * order]);
+		table.first[i] -= degree;
+	}
+	return true;
+}
+
+/**
+ * tessellate patch
+ */
+bool UMAbcNurbsTessellator::tessellate(const Patch& patch, const Setting& setting)
+{
+	vertices_.clear();
+	normals_.clear();
+	uvs_.clear();
+	triangle_index_.clear();
+
+	const int nu = patch.u_size;
+	const int nv = patch.v_size;
+	if (!patch.positions || nu <= 0 || nv <= 0) return false;
+	if (patch.position_size < static_cast<size_t>(nu) * nv) return false;
+
+	// homogeneous world space control points
+	world_points_.resize(static_cast<size_t>(nu) * nv);
+	for (size_t i = 0, size = world_points_.size(); i < size; ++i)
+	{
+		const Imath::V3f p = patch.positions[i] * setting.matrix;
+		const float w = patch.weights ? patch.weights[i] : 1.0f;
+		world_points_[i] = Imath::V4f(p.x * w, p.y * w, p.z * w, w);
+	}
+
+	// flatness of the control net in each direction
+	float u_difference = 0.0f;
+	float v_difference = 0.0f;
+	for (int v = 0; v < nv; ++v)
+	{
+		for (int u = 0; u < nu; ++u)
+		{
+			const Imath::V3f p = patch.positions[v * nu + u] * setting.matrix;
+			if (u > 0 && u + 1 < nu)
+			{
+				const Imath::V3f d = patch.positions[v * nu + u - 1] * setting.matrix - p * 2.0f
+					+ patch.positions[v * nu + u + 1] * setting.matrix;
+				u_difference = std::max(u_difference, d.length());
+			}
+			if (v > 0 && v + 1 < nv)
+			{
+				const Imath::V3f d = patch.positions[(v - 1) * nu + u] * setting.matrix - p * 2.0f
+					+ patch.positions[(v + 1) * nu + u] * setting.matrix;
+				v_difference = std::max(v_difference, d.length());
+			}
+		}
+	}
+	const int u_segments = quantized_segments(
+		flatness_segments(u_difference, patch.u_order, setting.tolerance, setting.max_segments), setting.max_segments);
+	const int v_segments = quantized_segments(
+		flatness_segments(v_difference, patch.v_order, setting.tolerance, setting.max_segments), setting.max_segments);
+
+	if (!update_basis(u_basis_, patch.u_knots, patch.u_knot_size, nu, patch.u_order, u_segments)) return false;
+	if (!update_basis(v_basis_, patch.v_knots, patch.v_knot_size, nv, patch.v_order, v_segments)) return false;
+
+	const int grid_u = grid_u_size();
+	const int grid_v = grid_v_size();
+	const float u_min = u_basis_.params.front();
+	const float u_range = u_basis_.params.back() - u_min;
+	const float v_min = v_basis_.params.front();
+	const float v_range = v_basis_.params.back() - v_min;
+	vertices_.resize(static_cast<size_t>(grid_u) * grid_v);
+	normals_.resize(vertices_.size());
+	uvs_.resize(vertices_.size());
+
+	// evaluate grid rows
+	parallel_for(grid_v, 4, [&](size_t begin, size_t end) {
+		const int u_order = u_basis_.order;
+		const int v_order = v_basis_.order;
+		for (size_t j = begin; j < end; ++j)
+		{
+			const int v_first = v_basis_.first[j];
+			const float* v_values = &v_basis_.values[j * v_order];
+			const float* v_derivs = &v_basis_.derivs[j * v_order];
+			for (int i = 0; i < grid_u; ++i)
+			{
+				const int u_first = u_basis_.first[i];
+				const float* u_values = &u_basis_.values[i * u_order];
+				const float* u_derivs = &u_basis_.derivs[i * u_order];
+
+				Imath::V4f s(0, 0, 0, 0);
+				Imath::V4f su(0, 0, 0, 0);
+				Imath::V4f sv(0, 0, 0, 0);
+				for (int b = 0; b < v_order; ++b)
+				{
+					const Imath::V4f* row = &world_points_[(v_first + b) * nu + u_first];
+					Imath::V4f r(0, 0, 0, 0);
+					Imath::V4f ru(0, 0, 0, 0);
+					for (int a = 0; a < u_order; ++a)
+					{
+						r += row[a] * u_values[a];
+						ru += row[a] * u_derivs[a];
+					}
+					s += r * v_values[b];
+					su += ru * v_values[b];
+					sv += r * v_derivs[b];
+				}
+
+				const size_t index = j * grid_u + i;
+				const float w = std::fabs(s.w) > 1.0e-12f ? s.w : 1.0e-12f;
+				const Imath::V3f p(s.x / w, s.y / w, s.z / w);
+				const Imath::V3f du = (Imath::V3f(su.x, su.y, su.z) - p * su.w) / w;
+				const Imath::V3f dv = (Imath::V3f(sv.x, sv.y, sv.z) - p * sv.w) / w;
+				vertices_[index] = p;
+				normals_[index] = du.cross(dv);
+				uvs_[index] = Imath::V2f(
+					u_range > 0.0f ? (u_basis_.params[i] - u_min) / u_range : 0.0f,
+					v_range > 0.0f ? (v_basis_.params[j] - v_min) / v_range : 0.0f);
+			}
+		}
+	});
+
+	// degenerate normals (poles) are made from the surrounding quads
+	for (int j = 0; j < grid_v; ++j)
+	{
+		for (int i = 0; i < grid_u; ++i)
+		{
+			const size_t index = j * grid_u + i;
+			if (normals_[index].length2() > 1.0e-20f) continue;
+			Imath::V3f n(0, 0, 0);
+			for (int qj = std::max(0, j - 1); qj <= std::min(j, grid_v - 2); ++qj)
+			{
+				for (int qi = std::max(0, i - 1); qi <= std::min(i, grid_u - 2); ++qi)
+				{
+					const Imath::V3f& p00 = vertices_[qj * grid_u + qi];
+					const Imath::V3f& p10 = vertices_[qj * grid_u + qi + 1];
+					const Imath::V3f& p01 = vertices_[(qj + 1) * grid_u + qi];
+					const Imath::V3f& p11 = vertices_[(qj + 1) * grid_u + qi + 1];
+					n += (p11 - p00).cross(p01 - p10);
+				}
+			}
+			normals_[index] = n;
+		}
+	}
+	for (size_t i = 0, size = normals_.size(); i < size; ++i)
+	{
+		normals_[i].normalize();
+	}
+
+	// two triangles per grid cell
+	triangle_index_.reserve(static_cast<size_t>(grid_u - 1) * (grid_v - 1) * 2);
+	for (int j = 0; j + 1 < grid_v; ++j)
+	{
+		for (int i = 0; i + 1 < grid_u; ++i)
+		{
+			const int a = j * grid_u + i;
+			const int b = a + 1;
+			const int c = a + 1 + grid_u;
+			const int d = a + grid_u;
+			triangle_index_.push_back(Imath::V3i(a, b, c));
+			triangle_index_.push_back(Imath::V3i(a, c, d));
+		}
+	}
+	return true;
+}
+
+/**
+ * get allocated bytes
+ */
+size_t UMAbcNurbsTessellator::byte_size() const
+{
+	return u_basis_.byte_size() + v_basis_.byte_size()
+		+ world_points_.capacity() * sizeof(Imath::V4f)
+		+ (vertices_.capacity() + normals_.capacity()) * sizeof(Imath::V3f)
+		+ uvs_.capacity() * sizeof(Imath::V2f)
+		+ triangle_index_.capacity() * sizeof(Imath::V3i);
+}
+
+} // umabc
@@ -0,0 +1,168 @@
+/**
+ * @file UMAbcNurbsTessellator.h
+ * nurbs patch tessellator
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "ImathVec.h"
+#include "ImathMatrix.h"
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+class UMAbcNurbsTessellator;
+typedef std::shared_ptr<UMAbcNurbsTessellator> UMAbcNurbsTessellatorPtr;
+
+/**
+ * tessellates a rational nurbs patch into an indexed triangle mesh.
+ * basis function tables are kept while knots and order are unchanged,
+ * and segments per span are rounded up to powers of two so that animated patches reuse them.
+ */
+class UMAbcNurbsTessellator
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcNurbsTessellator);
+public:
+	typedef std::vector<Imath::V3i > IndexList;
+
+	/**
+	 * source patch. pointers are not owned.
+	 * control points are stored u first.
+	 */
+	struct Patch
+	{
+		Patch()
+			: positions(NULL), position_size(0)
+			, weights(NULL)
+			, u_size(0), v_size(0)
+			, u_order(0), v_order(0)
+			, u_knots(NULL), u_knot_size(0)
+			, v_knots(NULL), v_knot_size(0)
+		{}
+		const Imath::V3f* positions;
+		size_t position_size;
+		// per control point weights. NULL means 1
+		const float* weights;
+		int u_size;
+		int v_size;
+		int u_order;
+		int v_order;
+		const float* u_knots;
+		size_t u_knot_size;
+		const float* v_knots;
+		size_t v_knot_size;
+	};
+
+	/**
+	 * tessellation setting
+	 */
+	struct Setting
+	{
+		Setting()
+			: tolerance(0.01f)
+			, max_segments(32)
+		{
+			matrix.makeIdentity();
+		}
+		// flatness tolerance in world space
+		float tolerance;
+		// maximum segments per knot span
+		int max_segments;
+		// local to world matrix
+		Imath::M44d matrix;
+	};
+
+	UMAbcNurbsTessellator() {}
+	~UMAbcNurbsTessellator() {}
+
+	/**
+	 * tessellate patch
+	 * @param [in] patch source patch
+	 * @param [in] setting tessellation setting
+	 * @retval succsess or fail
+	 */
+	bool tessellate(const Patch& patch, const Setting& setting);
+
+	/**
+	 * get vertices
+	 */
+	const std::vector<Imath::V3f>& vertices() const { return vertices_; }
+
+	/**
+	 * get normals
+	 */
+	const std::vector<Imath::V3f>& normals() const { return normals_; }
+
+	/**
+	 * get normalized uv
+	 */
+	const std::vector<Imath::V2f>& uvs() const { return uvs_; }
+
+	/**
+	 * get triangle index list
+	 */
+	const IndexList& triangle_index() const { return triangle_index_; }
+
+	/**
+	 * get grid size
+	 */
+	int grid_u_size() const { return static_cast<int>(u_basis_.params.size()); }
+	int grid_v_size() const { return static_cast<int>(v_basis_.params.size()); }
+
+	/**
+	 * get allocated bytes
+	 */
+	size_t byte_size() const;
+
+private:
+	/**
+	 * basis functions and first derivatives at each grid parameter
+	 */
+	struct BasisTable
+	{
+		BasisTable() : order(0), control_count(0), segments(0) {}
+		std::vector<float> knots;
+		int order;
+		int control_count;
+		int segments;
+		std::vector<float> params;
+		// first control point of each parameter
+		std::vector<int> first;
+		// order values per parameter
+		std::vector<float> values;
+		std::vector<float> derivs;
+
+		size_t byte_size() const
+		{
+			return (knots.capacity() + params.capacity() + values.capacity() + derivs.capacity()) * sizeof(float)
+				+ first.capacity() * sizeof(int);
+		}
+	};
+
+	bool update_basis(
+		BasisTable& table,
+		const float* knots,
+		size_t knot_size,
+		int control_count,
+		int order,
+		int segments);
+
+	BasisTable u_basis_;
+	BasisTable v_basis_;
+
+	std::vector<Imath::V4f> world_points_;
+	std::vector<Imath::V3f> vertices_;
+	std::vector<Imath::V3f> normals_;
+	std::vector<Imath::V2f> uvs_;
+	IndexList triangle_index_;
+};
+
+} // umabc
@@ -419,6 +419,32 @@ void UMAbcObject::update_box(bool recursive)
 	impl_->update_box(recursive);
 }
 
+/**
+* add bytes held by this object, without children
+*/
+void UMAbcObject::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	usage.node += sizeof(UMAbcObject) + sizeof(Impl)
+		+ impl_->name().capacity()
+		+ impl_->children().capacity() * sizeof(UMAbcObjectPtr)
+		+ UMAbcNode::name().capacity()
+		+ UMAbcNode::children().capacity() * sizeof(UMAbcNodePtr);
+}
+
+/**
+* release buffers derived from samples
+* @param [in] recursive do children recursively
+*/
+void UMAbcObject::release_buffers(bool recursive)
+{
+	if (!recursive) return;
+	UMAbcObjectList::iterator it = mutable_children().begin();
+	for (; it != mutable_children().end(); ++it)
+	{
+		(*it)->release_buffers(recursive);
+	}
+}
+
 /**
 * get children
 */
@@ -12,6 +12,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "ImathBox.h"
 
 #include "UMMacro.h"
@@ -29,10 +30,43 @@ namespace umabc
 {
 typedef std::shared_ptr<Alembic::Abc::v7::IObject> IObjectPtr;
 
+class UMAbcPrefetcher;
+
 class UMAbcObject;
 typedef std::shared_ptr<UMAbcObject> UMAbcObjectPtr;
 typedef std::weak_ptr<UMAbcObject> UMAbcObjectWeakPtr;
 typedef std::vector<UMAbcObjectPtr> UMAbcObjectList;
+
+/**
+ * bytes held by an object by category
+ */
+struct UMAbcMemoryUsage
+{
+	UMAbcMemoryUsage() : node(0), sample(0), geometry(0), bvh(0), derived(0), geometry_record(NULL) {}
+	size_t node; // object, transforms, bounds and names
+	size_t sample; // decoded samples. may be shared with the sample cache
+	size_t geometry; // triangulated geometry record. may be shared with other meshes
+	size_t bvh; // acceleration structures
+	size_t derived; // tessellation, lod and other buffers derived from samples
+	const void* geometry_record; // identity of the geometry record
+	std::vector<std::pair<const void*, size_t> > samples; // identity and bytes of each counted sample
+
+	size_t total() const { return node + sample + geometry + bvh + derived; }
+
+	/**
+	 * add bytes of a decoded sample. a sample already added is not counted again.
+	 */
+	void add_sample(const void* identity, size_t byte_size)
+	{
+		if (!identity) return;
+		for (size_t i = 0, size = samples.size(); i < size; ++i)
+		{
+			if (samples[i].first == identity) return;
+		}
+		samples.push_back(std::make_pair(identity, byte_size));
+		sample += byte_size;
+	}
+};
 class UMAbcObject : public UMAbcNode
 {
 	DISALLOW_COPY_AND_ASSIGN(UMAbcObject);
@@ -101,6 +135,24 @@ public:
 	 */
 	virtual void update_box(bool recursive);
 
+	/**
+	 * release buffers derived from samples. they are rebuilt on next access.
+	 * @param [in] recursive do children recursively
+	 */
+	virtual void release_buffers(bool recursive);
+
+	/**
+	 * add bytes held by this object, without children
+	 * @param [out] usage memory usage
+	 */
+	virtual void memory_usage(UMAbcMemoryUsage& usage) const;
+
+	/**
+	 * add animated array properties to the prefetcher, without children
+	 * @param [out] prefetcher prefetcher
+	 */
+	virtual void add_prefetch_properties(UMAbcPrefetcher&) const {}
+
 	///**
 	// * draw
 	// */
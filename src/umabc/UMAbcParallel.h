@@ -0,0 +1,89 @@
+/**
+ * @file UMAbcParallel.h
+ * parallel loop helper
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+/**
+ * process wide worker count set by set_parallel_worker_count. 0 is one per hardware thread.
+ */
+inline std::atomic<unsigned int>& parallel_worker_limit()
+{
+	static std::atomic<unsigned int> limit(0);
+	return limit;
+}
+
+/**
+ * set worker count of loops and archive streams opened afterwards.
+ * 0 is one per hardware thread.
+ */
+inline void set_parallel_worker_count(unsigned int count)
+{
+	parallel_worker_limit() = count;
+}
+
+/**
+ * get worker count
+ */
+inline unsigned int parallel_worker_count()
+{
+	const unsigned int limit = parallel_worker_limit();
+	if (limit > 0) return limit;
+	const unsigned int count = std::thread::hardware_concurrency();
+	return count > 0 ? count : 1;
+}
+
+/**
+ * call func(begin, end) for chunks of [0, count) on worker threads.
+ * runs on the calling thread when count is smaller than grain.
+ * @param [in] count number of items
+ * @param [in] grain minimum items per chunk
+ * @param [in] func void(size_t begin, size_t end)
+ */
+template <class Func>
+void parallel_for(size_t count, size_t grain, Func func)
+{
+	if (count == 0) return;
+	if (grain == 0) grain = 1;
+
+	const size_t max_chunks = (count + grain - 1) / grain;
+	const size_t chunks = std::min<size_t>(max_chunks, parallel_worker_count());
+	if (chunks <= 1)
+	{
+		func(static_cast<size_t>(0), count);
+		return;
+	}
+
+	const size_t chunk_size = (count + chunks - 1) / chunks;
+	std::vector<std::thread> workers;
+	workers.reserve(chunks - 1);
+	for (size_t i = 1; i < chunks; ++i)
+	{
+		const size_t begin = i * chunk_size;
+		const size_t end = std::min(count, begin + chunk_size);
+		if (begin >= end) break;
+		workers.push_back(std::thread(func, begin, end));
+	}
+	func(static_cast<size_t>(0), std::min(count, chunk_size));
+	for (size_t i = 0, size = workers.size(); i < size; ++i)
+	{
+		workers[i].join();
+	}
+}
+
+} // umabc
@@ -14,6 +14,9 @@
 #include <Alembic/AbcCoreFactory/All.h>
 
 #include "UMAbcPoint.h"
+#include "UMAbcSampleCache.h"
+#include "UMAbcPrefetcher.h"
+#include "UMAbcParallel.h"
 
 namespace umabc
 {
@@ -27,10 +30,23 @@ namespace umabc
 		Impl(IPointsPtr points)
 			: UMAbcObject(points)
 			, points_(points)
+			, decimate_target_(0)
+			, decimate_point_count_(0)
+			, decimate_has_key_(false)
 		{}
 
 		~Impl() {}
 
+		/**
+		* add bytes held by this points
+		*/
+		void memory_usage(UMAbcMemoryUsage& usage) const;
+
+		/**
+		* add animated array properties to the prefetcher
+		*/
+		void add_prefetch_properties(UMAbcPrefetcher& prefetcher) const;
+
 		virtual UMAbcObjectPtr self_reference()
 		{
 			return self_reference_.lock();
@@ -61,6 +77,11 @@ namespace umabc
 		*/
 		void update_point_all();
 
+		/**
+		* get decimated point index list
+		*/
+		const std::vector<unsigned int>& decimated_index(unsigned int target_count);
+
 		UMAbcPointWeakPtr self_reference_;
 
 		Alembic::AbcGeom::P3fArraySamplePtr positions() { return positions_; }
@@ -91,8 +112,16 @@ namespace umabc
 		Alembic::AbcGeom::IN3fArrayProperty normal_prop_;
 
 		Alembic::AbcGeom::P3fArraySamplePtr positions_;
+		Alembic::AbcGeom::UInt64ArraySamplePtr ids_;
 		Alembic::AbcGeom::C3fArraySamplePtr colors_;
 		Alembic::AbcGeom::N3fArraySamplePtr normals_;
+
+		// decimation cache
+		unsigned int decimate_target_;
+		size_t decimate_point_count_;
+		bool decimate_has_key_;
+		Alembic::AbcCoreAbstract::ArraySampleKey decimate_ids_key_;
+		std::vector<unsigned int> decimated_index_;
 	};
 
 /**
@@ -215,10 +244,33 @@ void UMAbcPoint::Impl::update_point()
 {
 	if (!is_valid()) return;
 	ISampleSelector selector(self_reference()->current_time(), ISampleSelector::kNearIndex);
-	IPointsSchema::Sample sample;
-	points_->getSchema().get(sample, selector);
-	positions_ = sample.getPositions();
+	IPointsSchema& schema = points_->getSchema();
+	UMAbcSampleCache& cache = UMAbcSampleCache::instance();
+	positions_ = std::static_pointer_cast<P3fArraySample>(
+		cache.read(schema.getPositionsProperty(), selector, "P"));
+	ids_ = UInt64ArraySamplePtr();
+	if (schema.getIdsProperty().valid())
+	{
+		ids_ = std::static_pointer_cast<UInt64ArraySample>(
+			cache.read(schema.getIdsProperty(), selector, "D"));
+	}
+}
 
+/**
+ * add animated array properties to the prefetcher. tags are same as update_point.
+ */
+void UMAbcPoint::Impl::add_prefetch_properties(UMAbcPrefetcher& prefetcher) const
+{
+	IPointsSchema& schema = points_->getSchema();
+	if (schema.isConstant()) return;
+	if (!schema.getPositionsProperty().isConstant())
+	{
+		prefetcher.add_property(schema.getPositionsProperty(), "P");
+	}
+	if (schema.getIdsProperty().valid() && !schema.getIdsProperty().isConstant())
+	{
+		prefetcher.add_property(schema.getIdsProperty(), "D");
+	}
 }
 
 /** 
@@ -232,6 +284,75 @@ void UMAbcPoint::Impl::update_point_all()
 	update_normal();
 }
 
+/**
+ * get decimated point index list
+ */
+const std::vector<unsigned int>& UMAbcPoint::Impl::decimated_index(unsigned int target_count)
+{
+	const size_t point_count = positions_ ? positions_->size() : 0;
+	const bool use_ids = ids_ && ids_->size() == point_count;
+
+	// ids digest identifies the point set without touching the ids.
+	ArraySampleKey ids_key;
+	bool has_key = false;
+	if (use_ids)
+	{
+		IUInt64ArrayProperty ids_prop = points_->getSchema().getIdsProperty();
+		ISampleSelector selector(self_reference()->current_time(), ISampleSelector::kNearIndex);
+		has_key = ids_prop.getKey(ids_key, selector);
+	}
+
+	if (decimate_target_ == target_count
+		&& decimate_point_count_ == point_count
+		&& decimate_has_key_ == has_key
+		&& (!has_key || decimate_ids_key_ == ids_key))
+	{
+		return decimated_index_;
+	}
+	decimate_target_ = target_count;
+	decimate_point_count_ = point_count;
+	decimate_has_key_ = has_key;
+	decimate_ids_key_ = ids_key;
+	decimated_index_.clear();
+
+	if (target_count >= point_count)
+	{
+		decimated_index_.resize(point_count);
+		for (size_t i = 0; i < point_count; ++i)
+		{
+			decimated_index_[i] = static_cast<unsigned int>(i);
+		}
+		return decimated_index_;
+	}
+	if (target_count == 0) return decimated_index_;
+
+	// keep the points which have the target_count smallest id hashes.
+	// a point is kept or dropped by its own id, so the selection is stable
+	// while points are born or die.
+	const Alembic::Util::uint64_t* ids = use_ids ? ids_->get() : NULL;
+	std::vector<Alembic::Util::uint64_t> hashes(point_count);
+	parallel_for(point_count, 16384, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; ++i)
+		{
+			hashes[i] = hash_index(ids ? ids[i] : static_cast<Alembic::Util::uint64_t>(i));
+		}
+	});
+
+	std::vector<Alembic::Util::uint64_t> sorted(hashes);
+	std::nth_element(sorted.begin(), sorted.begin() + (target_count - 1), sorted.end());
+	const Alembic::Util::uint64_t threshold = sorted[target_count - 1];
+
+	decimated_index_.reserve(target_count);
+	for (size_t i = 0; i < point_count && decimated_index_.size() < target_count; ++i)
+	{
+		if (hashes[i] <= threshold)
+		{
+			decimated_index_.push_back(static_cast<unsigned int>(i));
+		}
+	}
+	return decimated_index_;
+}
+
 /**
 * initialize
 * @param [in] recursive do children recursively
@@ -255,6 +376,23 @@ void UMAbcPoint::set_current_time(unsigned long time, bool recursive)
 	impl_->set_current_time(time, recursive);
 }
 
+/**
+ * add bytes held by this points
+ */
+void UMAbcPoint::Impl::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(Impl) - sizeof(UMAbcObject);
+	UMAbcSampleCache::add_usage(usage, positions_);
+	UMAbcSampleCache::add_usage(usage, ids_);
+	UMAbcSampleCache::add_usage(usage, colors_);
+	UMAbcSampleCache::add_usage(usage, normals_);
+	UMAbcSampleCache::add_usage(usage, sample_.getVelocities());
+	UMAbcSampleCache::add_usage(usage, sample_.getPositions());
+	UMAbcSampleCache::add_usage(usage, sample_.getIds());
+	usage.derived += decimated_index_.capacity() * sizeof(unsigned int);
+}
+
 /**
 * update box
 * @param [in] recursive do children recursively
@@ -262,6 +400,25 @@ void UMAbcPoint::set_current_time(unsigned long time, bool recursive)
 void UMAbcPoint::update_box(bool recursive)
 {
 	impl_->update_box(recursive);
+	mutable_box() = impl_->box();
+}
+
+/**
+ * add animated array properties of this points to the prefetcher
+ */
+void UMAbcPoint::add_prefetch_properties(UMAbcPrefetcher& prefetcher) const
+{
+	if (impl_->is_valid()) impl_->add_prefetch_properties(prefetcher);
+}
+
+/**
+ * add bytes held by this points
+ */
+void UMAbcPoint::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(UMAbcPoint) - sizeof(UMAbcObject);
+	impl_->memory_usage(usage);
 }
 
 /**
@@ -332,6 +489,14 @@ unsigned int UMAbcPoint::normal_size() const
 	return 0;
 }
 
+/**
+ * get decimated point index list
+ */
+const std::vector<unsigned int>& UMAbcPoint::decimated_index(unsigned int target_count)
+{
+	return impl_->decimated_index(target_count);
+}
+
 UMAbcObjectPtr UMAbcPoint::self_reference()
 {
 	return impl_->self_reference();
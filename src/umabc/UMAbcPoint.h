@@ -70,6 +70,18 @@ public:
 	 * @param [in] recursive do children recursively
 	 */
 	virtual void update_box(bool recursive);
+
+	/**
+	 * add bytes held by this points, without children
+	 * @param [out] usage memory usage
+	 */
+	virtual void memory_usage(UMAbcMemoryUsage& usage) const;
+
+	/**
+	 * add animated array properties of this points to the prefetcher
+	 * @param [out] prefetcher prefetcher
+	 */
+	virtual void add_prefetch_properties(UMAbcPrefetcher& prefetcher) const;
 	
 	/** 
 	 * update point all
@@ -106,6 +118,14 @@ public:
 	*/
 	unsigned int color_size() const;
 
+	/**
+	* get decimated point index list.
+	* points are selected by hashing their ids, so the same points are
+	* kept on every frame while the ids are unchanged.
+	* @param [in] target_count number of points to keep
+	*/
+	const std::vector<unsigned int>& decimated_index(unsigned int target_count);
+
 protected:
 	UMAbcPoint(IPointsPtr points);
 
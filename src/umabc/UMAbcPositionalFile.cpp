@@ -0,0 +1,293 @@
+/**
+ * @file UMAbcPositionalFile.cpp
+ * file read with positional reads served as istreams
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcPositionalFile.h"
+
+#include <algorithm>
+#include <streambuf>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace umabc
+{
+
+namespace
+{
+	/**
+	 * unbuffered streambuf reading the file at its own position.
+	 * only single characters pass through the one byte get area.
+	 */
+	class PositionalStreamBuf : public std::streambuf
+	{
+	public:
+		PositionalStreamBuf(const UMAbcPositionalFile& file)
+			: file_(file)
+			, position_(0)
+			, byte_(0)
+		{
+			setg(&byte_, &byte_ + 1, &byte_ + 1);
+		}
+
+	protected:
+		virtual std::streamsize xsgetn(char* s, std::streamsize n)
+		{
+			std::streamsize count = 0;
+			// a character taken by underflow is not consumed yet
+			if (gptr() < egptr() && n > 0)
+			{
+				*s++ = *gptr();
+				gbump(1);
+				++position_;
+				++count;
+				--n;
+			}
+			const unsigned long long size = file_.size();
+			if (n <= 0 || position_ >= size) return count;
+			const size_t read_size = static_cast<size_t>(
+				std::min<unsigned long long>(static_cast<unsigned long long>(n), size - position_));
+			if (!file_.read(position_, read_size, s)) return count;
+			position_ += read_size;
+			return count + static_cast<std::streamsize>(read_size);
+		}
+
+		virtual int_type underflow()
+		{
+			if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+			if (position_ >= file_.size() || !file_.read(position_, 1, &byte_))
+			{
+				return traits_type::eof();
+			}
+			setg(&byte_, &byte_, &byte_ + 1);
+			return traits_type::to_int_type(byte_);
+		}
+
+		virtual int_type uflow()
+		{
+			const int_type c = underflow();
+			if (!traits_type::eq_int_type(c, traits_type::eof()))
+			{
+				gbump(1);
+				++position_;
+			}
+			return c;
+		}
+
+		virtual std::streamsize showmanyc()
+		{
+			const unsigned long long size = file_.size();
+			return position_ < size ? static_cast<std::streamsize>(size - position_) : -1;
+		}
+
+		virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+		{
+			if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+			off_type base = 0;
+			if (dir == std::ios_base::cur)
+			{
+				base = static_cast<off_type>(position_);
+			}
+			else if (dir == std::ios_base::end)
+			{
+				base = static_cast<off_type>(file_.size());
+			}
+			return seekpos(pos_type(base + off), which);
+		}
+
+		virtual pos_type seekpos(pos_type pos, std::ios_base::openmode which)
+		{
+			const off_type offset = off_type(pos);
+			if (!(which & std::ios_base::in) || offset < 0
+				|| static_cast<unsigned long long>(offset) > file_.size())
+			{
+				return pos_type(off_type(-1));
+			}
+			position_ = static_cast<unsigned long long>(offset);
+			setg(&byte_, &byte_ + 1, &byte_ + 1);
+			return pos;
+		}
+
+	private:
+		const UMAbcPositionalFile& file_;
+		unsigned long long position_;
+		char byte_;
+	};
+} // anonymous namespace
+
+UMAbcPositionalFile::UMAbcPositionalFile()
+	: handle_(NULL)
+	, fd_(-1)
+	, size_(0)
+	, block_size_(0)
+	, shard_block_count_(0)
+{}
+
+/**
+ * open the file
+ */
+UMAbcPositionalFilePtr UMAbcPositionalFile::open(const std::string& path)
+{
+	UMAbcPositionalFilePtr file(new UMAbcPositionalFile());
+#ifdef _WIN32
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (handle == INVALID_HANDLE_VALUE) return UMAbcPositionalFilePtr();
+	file->handle_ = handle;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size)) return UMAbcPositionalFilePtr();
+	file->size_ = static_cast<size_t>(size.QuadPart);
+#else
+	file->fd_ = ::open(path.c_str(), O_RDONLY);
+	if (file->fd_ < 0) return UMAbcPositionalFilePtr();
+	struct stat st;
+	if (fstat(file->fd_, &st) != 0) return UMAbcPositionalFilePtr();
+	file->size_ = static_cast<size_t>(st.st_size);
+#endif
+	return file;
+}
+
+UMAbcPositionalFile::~UMAbcPositionalFile()
+{
+	clear_streams();
+#ifdef _WIN32
+	if (handle_) CloseHandle(handle_);
+#else
+	if (fd_ >= 0) ::close(fd_);
+#endif
+}
+
+/**
+ * set block cache for small reads
+ */
+void UMAbcPositionalFile::set_block_cache(size_t block_size, size_t block_count)
+{
+	std::lock_guard<std::mutex> setting_lock(setting_mutex_);
+	block_size_ = 0;
+	for (size_t i = 0; i < kBlockShardCount; ++i)
+	{
+		std::lock_guard<std::mutex> lock(shards_[i].mutex);
+		shards_[i].order.clear();
+		shards_[i].blocks.clear();
+	}
+	shard_block_count_ = (block_count + kBlockShardCount - 1) / kBlockShardCount;
+	block_size_ = block_count > 0 ? block_size : 0;
+}
+
+/**
+ * read bytes at the offset
+ */
+bool UMAbcPositionalFile::read(unsigned long long offset, size_t size, void* data) const
+{
+	const size_t block_size = block_size_;
+	if (block_size == 0 || size >= block_size)
+	{
+		return read_direct(offset, size, data);
+	}
+	if (offset > size_ || size > size_ - offset) return false;
+
+	// copy the slices of the blocks covering the range
+	char* dst = static_cast<char*>(data);
+	while (size > 0)
+	{
+		const unsigned long long index = offset / block_size;
+		const size_t block_offset = static_cast<size_t>(offset - index * block_size);
+		BlockPtr data_block = block(index, block_size);
+		if (!data_block || block_offset >= data_block->size()) return false;
+		const size_t count = std::min(size, data_block->size() - block_offset);
+		std::copy(data_block->begin() + block_offset, data_block->begin() + block_offset + count, dst);
+		dst += count;
+		offset += count;
+		size -= count;
+	}
+	return true;
+}
+
+/**
+ * get the block, reading it on miss
+ */
+UMAbcPositionalFile::BlockPtr UMAbcPositionalFile::block(unsigned long long index, size_t block_size) const
+{
+	BlockShard& shard = shards_[index % kBlockShardCount];
+	{
+		// blocks of another block size are never found
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		BlockMap::iterator it = shard.blocks.find(index);
+		if (it != shard.blocks.end() && block_size == block_size_)
+		{
+			shard.order.splice(shard.order.begin(), shard.order, it->second.second);
+			return it->second.first;
+		}
+	}
+
+	// read outside of the lock. streams missing the same block may read it twice.
+	const unsigned long long offset = index * block_size;
+	if (offset >= size_) return BlockPtr();
+	BlockPtr data_block = std::make_shared<std::vector<char> >(
+		static_cast<size_t>(std::min<unsigned long long>(block_size, size_ - offset)));
+	if (!read_direct(offset, data_block->size(), &(*data_block)[0])) return BlockPtr();
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	if (block_size != block_size_) return data_block;
+	if (shard.blocks.find(index) == shard.blocks.end())
+	{
+		shard.order.push_front(index);
+		shard.blocks[index] = std::make_pair(data_block, shard.order.begin());
+		while (shard.blocks.size() > shard_block_count_)
+		{
+			shard.blocks.erase(shard.order.back());
+			shard.order.pop_back();
+		}
+	}
+	return data_block;
+}
+
+/**
+ * read bytes at the offset from the file
+ */
+bool UMAbcPositionalFile::read_direct(unsigned long long offset, size_t size, void* data) const
+{
+	char* dst = static_cast<char*>(data);
+	while (size > 0)
+	{
+#ifdef _WIN32
+		// an offset in overlapped makes the read positional on a synchronous handle
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFULL);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		const DWORD request = static_cast<DWORD>(std::min<size_t>(size, 0x40000000));
+		DWORD count = 0;
+		if (!ReadFile(handle_, dst, request, &count, &overlapped) || count == 0) return false;
+#else
+		const ssize_t count = pread(fd_, dst, size, static_cast<off_t>(offset));
+		if (count < 0 && errno == EINTR) continue;
+		if (count <= 0) return false;
+#endif
+		dst += count;
+		offset += static_cast<unsigned long long>(count);
+		size -= static_cast<size_t>(count);
+	}
+	return true;
+}
+
+/**
+ * create buffer of a stream
+ */
+std::shared_ptr<std::streambuf> UMAbcPositionalFile::create_buffer()
+{
+	return std::make_shared<PositionalStreamBuf>(*this);
+}
+
+} // umabc
@@ -0,0 +1,105 @@
+/**
+ * @file UMAbcPositionalFile.h
+ * file read with positional reads served as istreams
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include "UMMacro.h"
+#include "UMAbcArchiveSource.h"
+
+namespace umabc
+{
+
+class UMAbcPositionalFile;
+typedef std::shared_ptr<UMAbcPositionalFile> UMAbcPositionalFilePtr;
+
+/**
+ * one descriptor shared by all streams.
+ * each stream keeps its own position and reads with pread,
+ * so streams never seek the descriptor and never wait for each other.
+ * small reads are served from aligned blocks shared by all streams,
+ * so neighbouring properties of an object cost one read of the device.
+ * blocks are spread over shards by index, each with its own lock,
+ * so streams reading different blocks do not wait for each other.
+ */
+class UMAbcPositionalFile : public UMAbcArchiveSource
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcPositionalFile);
+public:
+
+	/**
+	 * open the file
+	 * @param [in] path file path
+	 * @retval opened file or null
+	 */
+	static UMAbcPositionalFilePtr open(const std::string& path);
+
+	virtual ~UMAbcPositionalFile();
+
+	/**
+	 * get file size
+	 */
+	virtual size_t size() const { return size_; }
+
+	/**
+	 * read bytes at the offset. safe to call from any thread.
+	 */
+	virtual bool read(unsigned long long offset, size_t size, void* data) const;
+
+	/**
+	 * set block cache for small reads. reads smaller than a block read whole blocks.
+	 * @param [in] block_size block size in bytes. 0 reads every request directly
+	 * @param [in] block_count maximum number of blocks kept
+	 */
+	void set_block_cache(size_t block_size, size_t block_count);
+
+protected:
+	virtual std::shared_ptr<std::streambuf> create_buffer();
+
+private:
+	UMAbcPositionalFile();
+
+	typedef std::shared_ptr<std::vector<char> > BlockPtr;
+	typedef std::list<unsigned long long> BlockList;
+	typedef std::map<unsigned long long, std::pair<BlockPtr, BlockList::iterator> > BlockMap;
+
+	/**
+	 * least recently used blocks of the indices falling in the shard
+	 */
+	struct BlockShard
+	{
+		std::mutex mutex;
+		// most recently used first
+		BlockList order;
+		BlockMap blocks;
+	};
+	static const size_t kBlockShardCount = 16;
+
+	bool read_direct(unsigned long long offset, size_t size, void* data) const;
+	BlockPtr block(unsigned long long index, size_t block_size) const;
+
+	void* handle_; // HANDLE on windows
+	int fd_;
+	size_t size_;
+
+	// serializes set_block_cache only. reads take the shard locks
+	std::mutex setting_mutex_;
+	std::atomic<size_t> block_size_;
+	std::atomic<size_t> shard_block_count_;
+	mutable BlockShard shards_[kBlockShardCount];
+};
+
+} // umabc
@@ -0,0 +1,420 @@
+/**
+ * @file UMAbcPrefetcher.cpp
+ * playback prefetch of animated samples
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcPrefetcher.h"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cmath>
+#include <Alembic/Abc/All.h>
+
+#include "UMAbcSampleCache.h"
+#include "UMAbcParallel.h"
+
+namespace umabc
+{
+	using namespace Alembic::Abc;
+
+namespace
+{
+	const unsigned int kDefaultFrameCount = 8;
+	// default budget is 128MB
+	const size_t kDefaultByteBudget = 128 * 1024 * 1024;
+	// a step longer than this times the previous step is a seek
+	const double kSeekRatio = 4.0;
+	// properties per task of a frame read
+	const size_t kFrameReadGrain = 8;
+} // anonymous namespace
+
+class UMAbcPrefetcher::Impl
+{
+	DISALLOW_COPY_AND_ASSIGN(Impl);
+public:
+	Impl()
+		: frame_count_(kDefaultFrameCount)
+		, byte_budget_(kDefaultByteBudget)
+		, is_stopped_(false)
+		, has_time_(false)
+		, has_plan_(false)
+		, time_(0)
+		, step_(0)
+		, generation_(0)
+		, done_generation_(0)
+	{
+		stats_.request_count = 0;
+		stats_.seek_count = 0;
+		stats_.read_count = 0;
+		stats_.read_byte_size = 0;
+		stats_.frame_read_count = 0;
+	}
+
+	~Impl()
+	{
+		stop();
+	}
+
+	void add_property(const IArrayProperty& property, const char* tag)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		Target target;
+		target.property = property;
+		target.tag = tag;
+		targets_.push_back(target);
+	}
+
+	size_t property_size() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return targets_.size();
+	}
+
+	void set_frame_count(unsigned int frame_count)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		frame_count_ = frame_count;
+		++generation_;
+	}
+
+	void set_byte_budget(size_t byte_budget)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		byte_budget_ = byte_budget;
+		++generation_;
+	}
+
+	void request(unsigned long time)
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		++stats_.request_count;
+		if (is_stopped_ || targets_.empty() || frame_count_ == 0) return;
+		if (!has_time_)
+		{
+			has_time_ = true;
+			time_ = time;
+			return;
+		}
+		const double step = static_cast<double>(time) - static_cast<double>(time_);
+		if (step == 0) return;
+		time_ = time;
+
+		const bool is_seek = step_ == 0
+			|| (step > 0) != (step_ > 0)
+			|| std::fabs(step) > std::fabs(step_) * kSeekRatio;
+		step_ = step;
+		// a new plan always replaces the running one
+		++generation_;
+		if (is_seek)
+		{
+			// wait for one more step to know the rate
+			++stats_.seek_count;
+			has_plan_ = false;
+			return;
+		}
+		has_plan_ = true;
+		if (!thread_.joinable())
+		{
+			thread_ = std::thread(&Impl::run, this);
+		}
+		lock.unlock();
+		condition_.notify_one();
+	}
+
+	void read_frame(unsigned long time)
+	{
+		std::vector<Target> targets;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (is_stopped_ || targets_.empty()) return;
+			targets = targets_;
+		}
+		const double frame_time = static_cast<double>(time);
+		const size_t target_size = targets.size();
+
+		// each worker takes a stream of the archive, so reads are issued side by side
+		std::vector<index_t> indices(target_size, -1);
+		std::vector<AbcA::ArraySampleKey> sample_keys(target_size);
+		parallel_for(target_size, kFrameReadGrain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				try
+				{
+					const index_t index = near_index(targets[i], frame_time);
+					if (index < 0) continue;
+					if (!targets[i].property.getKey(sample_keys[i], ISampleSelector(index))) continue;
+					indices[i] = index;
+				}
+				catch (...)
+				{
+					// leave the failed read to the object
+				}
+			}
+		});
+
+		// samples evicted before the objects decode them would be read twice,
+		// so the frame reads at most half of the cache budget ahead as playback does
+		const size_t byte_budget = UMAbcSampleCache::instance().stats().byte_budget / 2;
+		size_t byte_size = 0;
+		for (size_t i = 0; i < target_size; ++i)
+		{
+			if (indices[i] < 0) continue;
+			const size_t sample_size = static_cast<size_t>(sample_keys[i].numBytes);
+			if (byte_size + sample_size > byte_budget)
+			{
+				indices[i] = -1;
+				continue;
+			}
+			byte_size += sample_size;
+		}
+
+		parallel_for(target_size, kFrameReadGrain, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (indices[i] < 0) continue;
+				try
+				{
+					read_sample(targets[i], ISampleSelector(indices[i]), sample_keys[i]);
+				}
+				catch (...)
+				{
+					// leave the failed read to the object
+				}
+			}
+		});
+		std::lock_guard<std::mutex> lock(mutex_);
+		++stats_.frame_read_count;
+	}
+
+	void stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			is_stopped_ = true;
+			++generation_;
+		}
+		condition_.notify_one();
+		if (thread_.joinable())
+		{
+			thread_.join();
+		}
+	}
+
+	UMAbcPrefetcher::Stats stats() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		return stats_;
+	}
+
+private:
+	struct Target
+	{
+		IArrayProperty property;
+		std::string tag;
+	};
+
+	/**
+	 * worker loop
+	 */
+	void run()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		for (;;)
+		{
+			condition_.wait(lock, [this] {
+				return is_stopped_ || (has_plan_ && generation_ != done_generation_);
+			});
+			if (is_stopped_) return;
+
+			const unsigned int generation = generation_;
+			const double time = static_cast<double>(time_);
+			const double step = step_;
+			const unsigned int frame_count = frame_count_;
+			size_t byte_budget = byte_budget_;
+			const std::vector<Target> targets = targets_;
+			lock.unlock();
+
+			const size_t cache_budget = UMAbcSampleCache::instance().stats().byte_budget / 2;
+			if (byte_budget > cache_budget)
+			{
+				byte_budget = cache_budget;
+			}
+			try
+			{
+				prefetch(targets, generation, time, step, frame_count, byte_budget);
+			}
+			catch (...)
+			{
+				// leave the failed read to the playback
+			}
+
+			lock.lock();
+			done_generation_ = generation;
+		}
+	}
+
+	/**
+	 * read samples of following frames until the plan is replaced
+	 */
+	void prefetch(
+		const std::vector<Target>& targets,
+		unsigned int generation,
+		double time,
+		double step,
+		unsigned int frame_count,
+		size_t byte_budget)
+	{
+		const size_t target_size = targets.size();
+		std::vector<index_t> last_index(target_size, -1);
+		size_t byte_size = 0;
+		for (unsigned int frame = 1; frame <= frame_count; ++frame)
+		{
+			const double frame_time = time + step * frame;
+			if (frame_time < 0) return;
+			for (size_t i = 0; i < target_size; ++i)
+			{
+				if (generation_ != generation) return;
+
+				const Target& target = targets[i];
+				const index_t index = near_index(target, frame_time);
+				if (index < 0 || index == last_index[i]) continue;
+				last_index[i] = index;
+
+				const ISampleSelector selector(index);
+				AbcA::ArraySampleKey sample_key;
+				if (!target.property.getKey(sample_key, selector)) continue;
+				byte_size += static_cast<size_t>(sample_key.numBytes);
+				if (byte_size > byte_budget) return;
+				read_sample(target, selector, sample_key);
+			}
+		}
+	}
+
+	/**
+	 * get sample index at the time. -1 when the property has no sample.
+	 */
+	static index_t near_index(const Target& target, double time)
+	{
+		const size_t sample_count = target.property.getNumSamples();
+		if (sample_count == 0) return -1;
+		return target.property.getTimeSampling()->getNearIndex(time / 1000.0, sample_count).first;
+	}
+
+	/**
+	 * read the sample into the sample cache unless it is cached
+	 */
+	void read_sample(const Target& target, const ISampleSelector& selector, const AbcA::ArraySampleKey& sample_key)
+	{
+		UMAbcSampleCache& cache = UMAbcSampleCache::instance();
+		std::string key = target.tag;
+		UMAbcSampleCache::append_key(key, sample_key);
+		if (cache.contains(key)) return;
+
+		AbcA::ArraySamplePtr sample;
+		target.property.get(sample, selector);
+		if (!sample) return;
+		cache.insert(key, sample, static_cast<size_t>(sample_key.numBytes));
+		std::lock_guard<std::mutex> lock(mutex_);
+		++stats_.read_count;
+		stats_.read_byte_size += static_cast<size_t>(sample_key.numBytes);
+	}
+
+	std::vector<Target> targets_;
+	unsigned int frame_count_;
+	size_t byte_budget_;
+
+	std::thread thread_;
+	mutable std::mutex mutex_;
+	std::condition_variable condition_;
+	bool is_stopped_;
+	bool has_time_;
+	bool has_plan_;
+	unsigned long time_; // milliseconds
+	double step_; // milliseconds per request
+	std::atomic<unsigned int> generation_;
+	unsigned int done_generation_;
+	UMAbcPrefetcher::Stats stats_;
+};
+
+UMAbcPrefetcher::UMAbcPrefetcher()
+	: impl_(new UMAbcPrefetcher::Impl())
+{}
+
+UMAbcPrefetcher::~UMAbcPrefetcher()
+{
+}
+
+/**
+ * add animated property
+ */
+void UMAbcPrefetcher::add_property(const IArrayProperty& property, const char* tag)
+{
+	impl_->add_property(property, tag);
+}
+
+/**
+ * get number of properties
+ */
+size_t UMAbcPrefetcher::property_size() const
+{
+	return impl_->property_size();
+}
+
+/**
+ * set number of frames read ahead
+ */
+void UMAbcPrefetcher::set_frame_count(unsigned int frame_count)
+{
+	impl_->set_frame_count(frame_count);
+}
+
+/**
+ * set bytes of samples read ahead
+ */
+void UMAbcPrefetcher::set_byte_budget(size_t byte_budget)
+{
+	impl_->set_byte_budget(byte_budget);
+}
+
+/**
+ * notify the current time
+ */
+void UMAbcPrefetcher::request(unsigned long time)
+{
+	impl_->request(time);
+}
+
+/**
+ * read samples of the frame on worker threads
+ */
+void UMAbcPrefetcher::read_frame(unsigned long time)
+{
+	impl_->read_frame(time);
+}
+
+/**
+ * stop the worker thread
+ */
+void UMAbcPrefetcher::stop()
+{
+	impl_->stop();
+}
+
+/**
+ * get statistics
+ */
+UMAbcPrefetcher::Stats UMAbcPrefetcher::stats() const
+{
+	return impl_->stats();
+}
+
+} // umabc
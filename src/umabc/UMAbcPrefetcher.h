@@ -0,0 +1,108 @@
+/**
+ * @file UMAbcPrefetcher.h
+ * playback prefetch of animated samples
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include "UMMacro.h"
+
+namespace Alembic
+{
+	namespace Abc {
+		namespace v7 {
+			class IArrayProperty;
+		}
+	}
+}
+
+namespace umabc
+{
+
+class UMAbcPrefetcher;
+typedef std::shared_ptr<UMAbcPrefetcher> UMAbcPrefetcherPtr;
+
+/**
+ * reads samples of the current frame side by side and samples of following frames
+ * into the sample cache on a worker thread.
+ * direction and step are taken from successive requested times.
+ * a jump larger than a few steps or a reversal is a seek and drops the pending frames.
+ */
+class UMAbcPrefetcher
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcPrefetcher);
+public:
+
+	/**
+	 * prefetch statistics
+	 */
+	struct Stats
+	{
+		size_t request_count;
+		size_t seek_count;
+		size_t read_count;
+		size_t read_byte_size;
+		size_t frame_read_count;
+	};
+
+	UMAbcPrefetcher();
+	~UMAbcPrefetcher();
+
+	/**
+	 * add animated property. samples are cached with the tag as read_cached does.
+	 * @param [in] property array property
+	 * @param [in] tag kind of the sample
+	 */
+	void add_property(const Alembic::Abc::v7::IArrayProperty& property, const char* tag);
+
+	/**
+	 * get number of properties
+	 */
+	size_t property_size() const;
+
+	/**
+	 * set number of frames read ahead. 0 disables prefetch.
+	 */
+	void set_frame_count(unsigned int frame_count);
+
+	/**
+	 * set bytes of samples read ahead. it is also limited to half of the sample cache budget.
+	 */
+	void set_byte_budget(size_t byte_budget);
+
+	/**
+	 * notify the current time
+	 * @param [in] time time in milliseconds
+	 */
+	void request(unsigned long time);
+
+	/**
+	 * read samples of the frame into the sample cache on worker threads
+	 * and wait for them. objects then decode the frame from the cache.
+	 * samples over half of the cache budget in total are left to the objects.
+	 * @param [in] time time in milliseconds
+	 */
+	void read_frame(unsigned long time);
+
+	/**
+	 * stop the worker thread. call this function before the archive is closed.
+	 */
+	void stop();
+
+	/**
+	 * get statistics
+	 */
+	Stats stats() const;
+
+private:
+	class Impl;
+	std::unique_ptr<Impl> impl_;
+};
+
+} // umabc
@@ -0,0 +1,202 @@
+/**
+ * @file UMAbcSampleCache.cpp
+ * process wide cache of decoded samples
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include <Alembic/AbcCoreAbstract/All.h>
+#include <Alembic/Abc/All.h>
+
+#include "UMAbcSampleCache.h"
+#include "UMAbcObject.h"
+
+namespace umabc
+{
+
+namespace
+{
+	// default budget is 256MB
+	const size_t kDefaultByteBudget = 256 * 1024 * 1024;
+} // anonymous namespace
+
+/**
+ * get process wide instance
+ */
+UMAbcSampleCache& UMAbcSampleCache::instance()
+{
+	static UMAbcSampleCache instance;
+	return instance;
+}
+
+UMAbcSampleCache::UMAbcSampleCache()
+	: byte_size_(0)
+	, byte_budget_(kDefaultByteBudget)
+	, hit_count_(0)
+	, miss_count_(0)
+	, eviction_count_(0)
+{}
+
+/**
+ * append sample digest to the key
+ */
+void UMAbcSampleCache::append_key(std::string& key, const Alembic::AbcCoreAbstract::ArraySampleKey& sample_key)
+{
+	key.append(reinterpret_cast<const char*>(&sample_key.numBytes), sizeof(sample_key.numBytes));
+	key.push_back(static_cast<char>(sample_key.origPOD));
+	key.push_back(static_cast<char>(sample_key.readPOD));
+	key.append(reinterpret_cast<const char*>(sample_key.digest.d), sizeof(sample_key.digest.d));
+}
+
+/**
+ * get memory size of decoded sample
+ */
+size_t UMAbcSampleCache::sample_byte_size(const Alembic::AbcCoreAbstract::ArraySamplePtr& sample)
+{
+	if (!sample) return 0;
+	return sample->getDimensions().numPoints() * sample->getDataType().getNumBytes();
+}
+
+/**
+ * add bytes of decoded sample to the usage
+ */
+void UMAbcSampleCache::add_usage(UMAbcMemoryUsage& usage, const Alembic::AbcCoreAbstract::ArraySamplePtr& sample)
+{
+	usage.add_sample(sample.get(), sample_byte_size(sample));
+}
+
+/**
+ * read array sample through the cache
+ */
+Alembic::AbcCoreAbstract::ArraySamplePtr UMAbcSampleCache::read(
+	const Alembic::Abc::IArrayProperty& property,
+	const Alembic::Abc::ISampleSelector& selector,
+	const char* tag)
+{
+	Alembic::AbcCoreAbstract::ArraySamplePtr result;
+	Alembic::AbcCoreAbstract::ArraySampleKey sample_key;
+	std::string key;
+	if (property.getKey(sample_key, selector))
+	{
+		key = tag;
+		append_key(key, sample_key);
+		result = std::static_pointer_cast<Alembic::AbcCoreAbstract::ArraySample>(find(key));
+		if (result) return result;
+	}
+	property.get(result, selector);
+	if (!key.empty() && result)
+	{
+		insert(key, result, static_cast<size_t>(sample_key.numBytes));
+	}
+	return result;
+}
+
+/**
+ * find value and mark it recently used
+ */
+std::shared_ptr<void> UMAbcSampleCache::find(const std::string& key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	EntryMap::iterator it = entry_map_.find(key);
+	if (it == entry_map_.end())
+	{
+		++miss_count_;
+		return std::shared_ptr<void>();
+	}
+	++hit_count_;
+	entries_.splice(entries_.begin(), entries_, it->second);
+	return it->second->value;
+}
+
+/**
+ * is cached or not
+ */
+bool UMAbcSampleCache::contains(const std::string& key)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	return entry_map_.find(key) != entry_map_.end();
+}
+
+/**
+ * add value
+ */
+void UMAbcSampleCache::insert(const std::string& key, std::shared_ptr<void> value, size_t byte_size)
+{
+	if (!value) return;
+	std::lock_guard<std::mutex> lock(mutex_);
+	// budget 0 disables the cache
+	if (byte_budget_ == 0 || byte_size > byte_budget_) return;
+
+	EntryMap::iterator it = entry_map_.find(key);
+	if (it != entry_map_.end())
+	{
+		byte_size_ -= it->second->byte_size;
+		entries_.erase(it->second);
+		entry_map_.erase(it);
+	}
+	Entry entry;
+	entry.key = key;
+	entry.value = value;
+	entry.byte_size = byte_size;
+	entries_.push_front(entry);
+	entry_map_[key] = entries_.begin();
+	byte_size_ += byte_size;
+	evict();
+}
+
+/**
+ * evict least recently used values over the budget
+ */
+void UMAbcSampleCache::evict()
+{
+	while (byte_size_ > byte_budget_ && !entries_.empty())
+	{
+		const Entry& last = entries_.back();
+		byte_size_ -= last.byte_size;
+		entry_map_.erase(last.key);
+		entries_.pop_back();
+		++eviction_count_;
+	}
+}
+
+/**
+ * set byte budget
+ */
+void UMAbcSampleCache::set_byte_budget(size_t byte_budget)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	byte_budget_ = byte_budget;
+	evict();
+}
+
+/**
+ * remove all values
+ */
+void UMAbcSampleCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	entries_.clear();
+	entry_map_.clear();
+	byte_size_ = 0;
+}
+
+/**
+ * get statistics
+ */
+UMAbcSampleCache::Stats UMAbcSampleCache::stats()
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	Stats stats;
+	stats.hit_count = hit_count_;
+	stats.miss_count = miss_count_;
+	stats.eviction_count = eviction_count_;
+	stats.entry_count = entries_.size();
+	stats.byte_size = byte_size_;
+	stats.byte_budget = byte_budget_;
+	return stats;
+}
+
+} // umabc
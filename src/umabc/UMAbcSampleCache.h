@@ -0,0 +1,158 @@
+/**
+ * @file UMAbcSampleCache.h
+ * process wide cache of decoded samples
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <list>
+#include <map>
+#include <mutex>
+#include "UMMacro.h"
+
+namespace Alembic
+{
+	namespace AbcCoreAbstract {
+		namespace v7 {
+			struct ArraySampleKey;
+			class ArraySample;
+		}
+	}
+	namespace Abc {
+		namespace v7 {
+			class IArrayProperty;
+			class ISampleSelector;
+		}
+	}
+}
+
+namespace umabc
+{
+
+struct UMAbcMemoryUsage;
+
+/**
+ * least recently used cache of array samples and derived geometry by sample digest.
+ * values are shared with their users, so eviction only drops the cache reference.
+ */
+class UMAbcSampleCache
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcSampleCache);
+public:
+
+	/**
+	 * cache statistics
+	 */
+	struct Stats
+	{
+		size_t hit_count;
+		size_t miss_count;
+		size_t eviction_count;
+		size_t entry_count;
+		size_t byte_size;
+		size_t byte_budget;
+	};
+
+	/**
+	 * get process wide instance
+	 */
+	static UMAbcSampleCache& instance();
+
+	/**
+	 * append sample digest to the key
+	 */
+	static void append_key(std::string& key, const Alembic::AbcCoreAbstract::v7::ArraySampleKey& sample_key);
+
+	/**
+	 * get memory size of decoded sample. 0 for null.
+	 */
+	static size_t sample_byte_size(const std::shared_ptr<Alembic::AbcCoreAbstract::v7::ArraySample>& sample);
+
+	/**
+	 * add bytes of decoded sample to the usage. samples shared with others are identified by address.
+	 */
+	static void add_usage(
+		UMAbcMemoryUsage& usage,
+		const std::shared_ptr<Alembic::AbcCoreAbstract::v7::ArraySample>& sample);
+
+	/**
+	 * read array sample through the cache. key is the tag and the sample digest.
+	 * @param [in] property array property
+	 * @param [in] selector sample selector
+	 * @param [in] tag kind of the sample
+	 * @retval sample or null
+	 */
+	std::shared_ptr<Alembic::AbcCoreAbstract::v7::ArraySample> read(
+		const Alembic::Abc::v7::IArrayProperty& property,
+		const Alembic::Abc::v7::ISampleSelector& selector,
+		const char* tag);
+
+	/**
+	 * find value and mark it recently used
+	 * @param [in] key key
+	 * @retval value or null
+	 */
+	std::shared_ptr<void> find(const std::string& key);
+
+	/**
+	 * is cached or not. does not change the order or statistics.
+	 */
+	bool contains(const std::string& key);
+
+	/**
+	 * add value. it is not cached when it is larger than the budget or the budget is 0.
+	 * @param [in] key key
+	 * @param [in] value value
+	 * @param [in] byte_size memory size of the value
+	 */
+	void insert(const std::string& key, std::shared_ptr<void> value, size_t byte_size);
+
+	/**
+	 * set byte budget and evict values over it
+	 */
+	void set_byte_budget(size_t byte_budget);
+
+	/**
+	 * remove all values
+	 */
+	void clear();
+
+	/**
+	 * get statistics
+	 */
+	Stats stats();
+
+private:
+	UMAbcSampleCache();
+	~UMAbcSampleCache() {}
+
+	struct Entry
+	{
+		std::string key;
+		std::shared_ptr<void> value;
+		size_t byte_size;
+	};
+	typedef std::list<Entry> EntryList;
+	typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+	void evict();
+
+	std::mutex mutex_;
+	// most recently used first
+	EntryList entries_;
+	EntryMap entry_map_;
+	size_t byte_size_;
+	size_t byte_budget_;
+	size_t hit_count_;
+	size_t miss_count_;
+	size_t eviction_count_;
+};
+
+} // umabc
@@ -12,9 +12,15 @@
 
 #include <memory>
 #include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <map>
 #include <Alembic/Abc/All.h>
 #include <Alembic/AbcGeom/All.h>
 #include <Alembic/AbcCoreFactory/All.h>
+#include "ImathBoxAlgo.h"
 
 #include "UMAbcObject.h"
 #include "UMAbcSoftwareIO.h"
@@ -24,12 +30,68 @@
 #include "UMAbcNurbsPatch.h"
 #include "UMAbcCamera.h"
 #include "UMAbcXform.h"
+#include "UMAbcSceneBVH.h"
+#include "UMAbcParallel.h"
+#include "UMAbcPrefetcher.h"
 
 namespace umabc
 {
 	using namespace Alembic::Abc;
 	using namespace Alembic::AbcGeom;
 
+	namespace
+	{
+		/**
+		 * all properties are constant or not
+		 */
+		bool is_constant_properties(const ICompoundProperty& props)
+		{
+			if (!props.valid()) return true;
+			for (size_t i = 0, size = props.getNumProperties(); i < size; ++i)
+			{
+				const PropertyHeader& header = props.getPropertyHeader(i);
+				if (header.isCompound())
+				{
+					if (!is_constant_properties(ICompoundProperty(props, header.getName()))) return false;
+				}
+				else if (header.isScalar())
+				{
+					if (!IScalarProperty(props, header.getName()).isConstant()) return false;
+				}
+				else if (header.isArray())
+				{
+					if (!IArrayProperty(props, header.getName()).isConstant()) return false;
+				}
+			}
+			return true;
+		}
+
+		/**
+		 * upper bound of the length scale of the upper 3x3 of the matrix
+		 */
+		double max_scale(const Imath::M44d& m)
+		{
+			double sum = 0.0;
+			for (int i = 0; i < 3; ++i)
+			{
+				for (int k = 0; k < 3; ++k)
+				{
+					sum += m[i][k] * m[i][k];
+				}
+			}
+			return std::sqrt(sum);
+		}
+
+		/**
+		 * maximum distance in the space of the matrix
+		 */
+		float local_max_distance(double max_distance, const Imath::M44d& world_to_local)
+		{
+			const double distance = max_distance * max_scale(world_to_local);
+			return distance < FLT_MAX ? static_cast<float>(distance) : FLT_MAX;
+		}
+	} // anonymous namespace
+
 class UMAbcScene::SceneImpl
 {
 	DISALLOW_COPY_AND_ASSIGN(SceneImpl);
@@ -38,17 +100,22 @@ public:
 	SceneImpl(UMAbcObjectPtr root)
 		: object_(root)
 		, pre_time_(-1)
+		, geometry_cache_(new UMAbcMeshGeometryCache())
+		, bvh_time_(-1.0)
 		{}
 	~SceneImpl() {}
 
 	/**
 	 * initialize
 	 */
-	bool init()
+	bool init(bool is_concurrent_read)
 	{
 		unsigned long current = object_->current_time_ms();
 		if (object_->init(true, UMAbcObjectPtr()))
 		{
+			// share triangulated geometry between meshes with same samples
+			set_geometry_cache_recursive(object_);
+
 			unsigned long min_time_ = object_->min_time();
 			unsigned long max_time_ = object_->max_time();
 
@@ -65,7 +132,11 @@ public:
 			// calculate bounding box
 			object_->update_box(true);
 			object_->set_current_time(current, true);
+
+			build_bvh();
 		}
+		build_hierarchy();
+		build_prefetcher(is_concurrent_read);
 		return true;
 	}
 	
@@ -77,14 +148,30 @@ public:
 		{
 			return false;
 		}
-		if (object_)
-		{
-			object_->set_current_time(time, true);
-		}
+		set_current_time(time);
 		pre_time_ = time;
 		return true;
 	}
 
+	/**
+	 * set current time of all objects and prefetch following frames
+	 */
+	void set_current_time(unsigned long time)
+	{
+		if (!object_) return;
+		if (prefetcher_)
+		{
+			prefetcher_->read_frame(time);
+		}
+		object_->set_current_time(time, true);
+		if (prefetcher_)
+		{
+			prefetcher_->request(time);
+		}
+	}
+
+	UMAbcPrefetcherPtr prefetcher() const { return prefetcher_; }
+
 	bool clear() 
 	{
 		return true;
@@ -166,6 +253,8 @@ public:
 	}
 
 	UMAbcObjectPtr root_object() const { return object_; }
+
+	const UMAbcScene::Hierarchy& hierarchy() const { return hierarchy_; }
 	
 	/**
 	 * get total polygons
@@ -177,9 +266,856 @@ public:
 		return total_size;
 	}
 
+	/**
+	 * get paths of objects overlapping the box
+	 */
+	void box_query(const Imath::Box3d& box, std::vector<std::string>& path_list)
+	{
+		update_bvh();
+		std::vector<unsigned int> result;
+		bvh_.query_box(box, result);
+		to_path_list(result, path_list);
+	}
+
+	/**
+	 * get paths of objects inside or intersecting the planes
+	 */
+	void frustum_query(const std::vector<Imath::V4d>& planes, std::vector<std::string>& path_list)
+	{
+		update_bvh();
+		std::vector<unsigned int> result;
+		bvh_.query_frustum(planes, result);
+		to_path_list(result, path_list);
+	}
+
+	/**
+	 * get world bounds
+	 */
+	Imath::Box3d world_box()
+	{
+		update_bvh();
+		return bvh_.bounds();
+	}
+
+	/**
+	 * get closest point on the mesh.
+	 * the search is in mesh local space, so it is exact for rigid and uniformly scaled meshes.
+	 */
+	bool closest_point(
+		const std::string& mesh_path,
+		const Imath::V3d& point,
+		double max_distance,
+		UMAbcScene::ClosestHit& hit)
+	{
+		UMAbcMeshPtr mesh = std::dynamic_pointer_cast<UMAbcMesh>(find_object(mesh_path));
+		if (!mesh) return false;
+		const UMAbcMeshBVH& mesh_bvh = mesh->bvh();
+		if (mesh_bvh.is_empty()) return false;
+
+		const Imath::M44d& global = mesh->global_transform();
+		const Imath::M44d inverse = global.inverse();
+		Imath::V3d local_point;
+		inverse.multVecMatrix(point, local_point);
+
+		UMAbcMeshBVH::ClosestHit local_hit;
+		if (!mesh_bvh.closest_point(Imath::V3f(local_point), local_max_distance(max_distance, inverse), local_hit))
+		{
+			return false;
+		}
+		global.multVecMatrix(Imath::V3d(local_hit.position), hit.position);
+		hit.distance = (hit.position - point).length();
+		if (hit.distance > max_distance) return false;
+		hit.triangle = local_hit.triangle;
+		hit.u = local_hit.u;
+		hit.v = local_hit.v;
+		return true;
+	}
+
+	/**
+	 * get distance from each source vertex to the target mesh
+	 */
+	bool mesh_distance(
+		const std::string& source_path,
+		const std::string& target_path,
+		double max_distance,
+		bool is_signed,
+		UMAbcScene::MeshDistance& result)
+	{
+		UMAbcMeshPtr source = std::dynamic_pointer_cast<UMAbcMesh>(find_object(source_path));
+		UMAbcMeshPtr target = std::dynamic_pointer_cast<UMAbcMesh>(find_object(target_path));
+		if (!source || !target) return false;
+		const UMAbcMeshBVH& target_bvh = target->bvh();
+		if (target_bvh.is_empty()) return false;
+
+		const size_t vertex_size = source->vertex_size();
+		result.distance.assign(vertex_size, std::numeric_limits<float>::infinity());
+		result.triangle.assign(vertex_size, -1);
+		result.barycentric.assign(vertex_size * 2, 0.0f);
+		if (vertex_size == 0) return true;
+
+		const Imath::M44d& source_global = source->global_transform();
+		const Imath::M44d& target_global = target->global_transform();
+		const Imath::M44d target_inverse = target_global.inverse();
+		const Imath::M44d source_to_target = source_global * target_inverse;
+		const float local_max = local_max_distance(max_distance, target_inverse);
+
+		const Imath::V3f* source_vertex = source->vertex();
+		const Imath::V3f* target_vertex = target->vertex();
+		const UMAbcMesh::IndexList& target_index = target->triangle_index();
+		const std::vector<Imath::V3f>& target_normal = target->normals();
+		const bool is_vertex_normal = target_normal.size() == target->vertex_size();
+
+		parallel_for(vertex_size, 1024, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+			{
+				Imath::V3d local_point;
+				source_to_target.multVecMatrix(Imath::V3d(source_vertex[i]), local_point);
+				UMAbcMeshBVH::ClosestHit hit;
+				if (!target_bvh.closest_point(Imath::V3f(local_point), local_max, hit)) continue;
+
+				Imath::V3d world_point;
+				Imath::V3d world_position;
+				source_global.multVecMatrix(Imath::V3d(source_vertex[i]), world_point);
+				target_global.multVecMatrix(Imath::V3d(hit.position), world_position);
+				double distance = (world_position - world_point).length();
+				if (distance > max_distance) continue;
+
+				if (is_signed)
+				{
+					// the sign does not change by transforming both sides to local space
+					const Imath::V3i& index = target_index[hit.triangle];
+					Imath::V3f normal;
+					if (is_vertex_normal)
+					{
+						normal = target_normal[index[0]] * (1.0f - hit.u - hit.v)
+							+ target_normal[index[1]] * hit.u
+							+ target_normal[index[2]] * hit.v;
+					}
+					else
+					{
+						const Imath::V3f& v0 = target_vertex[index[0]];
+						const Imath::V3f& v1 = target_vertex[index[1]];
+						const Imath::V3f& v2 = target_vertex[index[2]];
+						normal = (v0 - v1).cross(v2 - v1);
+					}
+					if ((Imath::V3f(local_point) - hit.position).dot(normal) < 0.0f)
+					{
+						distance = -distance;
+					}
+				}
+				result.distance[i] = static_cast<float>(distance);
+				result.triangle[i] = hit.triangle;
+				result.barycentric[i * 2 + 0] = hit.u;
+				result.barycentric[i * 2 + 1] = hit.v;
+			}
+		});
+		return true;
+	}
+
+	/**
+	 * get meshes sharing same geometry record
+	 */
+	void instance_groups(size_t min_count, std::vector<UMAbcScene::InstanceGroup>& groups)
+	{
+		std::map<const UMAbcMeshGeometry*, size_t> group_map;
+		std::vector<UMAbcScene::InstanceGroup> all_groups;
+		for (size_t i = 0, size = items_.size(); i < size; ++i)
+		{
+			UMAbcMeshPtr mesh = std::dynamic_pointer_cast<UMAbcMesh>(items_[i].object);
+			if (!mesh || mesh->vertex_size() == 0 || mesh->triangle_index().empty()) continue;
+			const UMAbcMeshGeometry* geometry = mesh->geometry().get();
+			std::map<const UMAbcMeshGeometry*, size_t>::iterator it = group_map.find(geometry);
+			if (it == group_map.end())
+			{
+				it = group_map.insert(std::make_pair(geometry, all_groups.size())).first;
+				UMAbcScene::InstanceGroup group;
+				group.vertex_size = mesh->vertex_size();
+				group.triangle_size = static_cast<unsigned int>(mesh->triangle_index().size());
+				all_groups.push_back(group);
+			}
+			all_groups[it->second].paths.push_back(items_[i].path);
+			all_groups[it->second].transforms.push_back(mesh->global_transform());
+		}
+		for (size_t i = 0, size = all_groups.size(); i < size; ++i)
+		{
+			if (all_groups[i].paths.size() >= min_count)
+			{
+				groups.push_back(all_groups[i]);
+			}
+		}
+	}
+
+	/**
+	 * merge meshes into world space buffers
+	 */
+	void batch(const UMAbcScene::BatchSetting& setting, UMAbcScene::Batch& batch)
+	{
+		batch.vertices.clear();
+		batch.normals.clear();
+		batch.indices.clear();
+		batch.groups.clear();
+		batch.ranges.clear();
+
+		// update slices
+		std::vector<BatchEntry> entries;
+		std::vector<size_t> changed;
+		for (size_t i = 0, size = items_.size(); i < size; ++i)
+		{
+			UMAbcMeshPtr mesh = std::dynamic_pointer_cast<UMAbcMesh>(items_[i].object);
+			if (!mesh) continue;
+			if (setting.is_visible_only && !mesh->is_visible()) continue;
+			if (mesh->vertex_size() == 0 || mesh->triangle_index().empty()) continue;
+
+			BatchSlice& slice = batch_cache_[items_[i].path];
+			// animated vertices keep the grouping of triangles
+			const bool is_topology_changed = !slice.is_valid || slice.topology_revision != mesh->topology_revision();
+			const bool is_mesh_changed = is_topology_changed || slice.revision != mesh->revision();
+			if (is_topology_changed || slice.group != setting.group)
+			{
+				group_slice(mesh, setting.group, slice);
+			}
+			BatchEntry entry;
+			entry.item = &items_[i];
+			entry.mesh = mesh;
+			entry.slice = &slice;
+			entry.is_changed = is_mesh_changed || slice.matrix != mesh->global_transform();
+			if (entry.is_changed)
+			{
+				slice.is_valid = true;
+				slice.revision = mesh->revision();
+				slice.topology_revision = mesh->topology_revision();
+				slice.matrix = mesh->global_transform();
+				slice.vertices.resize(mesh->vertex_size());
+				slice.normals.resize(mesh->vertex_size());
+				changed.push_back(entries.size());
+			}
+			entries.push_back(entry);
+		}
+
+		// transform changed slices over all their vertices
+		std::vector<size_t> changed_offset(changed.size() + 1, 0);
+		for (size_t i = 0, size = changed.size(); i < size; ++i)
+		{
+			changed_offset[i + 1] = changed_offset[i] + entries[changed[i]].mesh->vertex_size();
+		}
+		parallel_for(changed_offset.back(), 16384, [&](size_t begin, size_t end) {
+			size_t c = std::upper_bound(changed_offset.begin(), changed_offset.end(), begin) - changed_offset.begin() - 1;
+			for (size_t i = begin; i < end; ++c)
+			{
+				const BatchEntry& entry = entries[changed[c]];
+				const size_t local_begin = i - changed_offset[c];
+				const size_t local_end = std::min(end, changed_offset[c + 1]) - changed_offset[c];
+				transform_slice(entry, local_begin, local_end);
+				i += local_end - local_begin;
+			}
+		});
+
+		// group order is by name
+		std::map<std::string, unsigned int> group_map;
+		for (size_t i = 0, size = entries.size(); i < size; ++i)
+		{
+			const std::vector<std::string>& names = entries[i].slice->group_names;
+			for (size_t k = 0, ksize = names.size(); k < ksize; ++k)
+			{
+				group_map.insert(std::make_pair(names[k], 0));
+			}
+		}
+		for (std::map<std::string, unsigned int>::iterator it = group_map.begin(); it != group_map.end(); ++it)
+		{
+			it->second = static_cast<unsigned int>(batch.groups.size());
+			UMAbcScene::BatchGroupRange group;
+			group.name = it->first;
+			group.index_offset = 0;
+			group.index_count = 0;
+			batch.groups.push_back(group);
+		}
+
+		// vertex ranges
+		std::vector<unsigned int> vertex_offset(entries.size());
+		size_t vertex_size = 0;
+		for (size_t i = 0, size = entries.size(); i < size; ++i)
+		{
+			vertex_offset[i] = static_cast<unsigned int>(vertex_size);
+			vertex_size += entries[i].slice->vertices.size();
+		}
+		batch.vertices.resize(vertex_size);
+		batch.normals.resize(vertex_size);
+		for (size_t i = 0, size = entries.size(); i < size; ++i)
+		{
+			const BatchSlice& slice = *entries[i].slice;
+			std::copy(slice.vertices.begin(), slice.vertices.end(), batch.vertices.begin() + vertex_offset[i]);
+			std::copy(slice.normals.begin(), slice.normals.end(), batch.normals.begin() + vertex_offset[i]);
+		}
+
+		// index ranges sorted by group then object
+		std::vector<std::pair<size_t, size_t> > range_source;
+		size_t index_size = 0;
+		for (size_t g = 0, gsize = batch.groups.size(); g < gsize; ++g)
+		{
+			batch.groups[g].index_offset = static_cast<unsigned int>(index_size);
+			for (size_t i = 0, size = entries.size(); i < size; ++i)
+			{
+				const BatchSlice& slice = *entries[i].slice;
+				for (size_t k = 0, ksize = slice.group_names.size(); k < ksize; ++k)
+				{
+					if (slice.group_names[k] != batch.groups[g].name) continue;
+					UMAbcScene::BatchRange range;
+					range.path = entries[i].item->path;
+					range.group = static_cast<unsigned int>(g);
+					range.vertex_offset = vertex_offset[i];
+					range.vertex_count = static_cast<unsigned int>(slice.vertices.size());
+					range.index_offset = static_cast<unsigned int>(index_size);
+					range.index_count = static_cast<unsigned int>(slice.group_triangles[k].size() * 3);
+					range.is_changed = entries[i].is_changed;
+					batch.ranges.push_back(range);
+					range_source.push_back(std::make_pair(i, k));
+					index_size += range.index_count;
+				}
+			}
+			batch.groups[g].index_count = static_cast<unsigned int>(index_size) - batch.groups[g].index_offset;
+		}
+
+		// write rebased indices over all triangles
+		std::vector<size_t> triangle_offset(batch.ranges.size() + 1, 0);
+		for (size_t r = 0, size = batch.ranges.size(); r < size; ++r)
+		{
+			triangle_offset[r + 1] = triangle_offset[r] + batch.ranges[r].index_count / 3;
+		}
+		batch.indices.resize(index_size);
+		parallel_for(triangle_offset.back(), 16384, [&](size_t begin, size_t end) {
+			size_t r = std::upper_bound(triangle_offset.begin(), triangle_offset.end(), begin) - triangle_offset.begin() - 1;
+			for (size_t i = begin; i < end; ++i)
+			{
+				while (i >= triangle_offset[r + 1]) ++r;
+				const BatchEntry& entry = entries[range_source[r].first];
+				const std::vector<unsigned int>& triangles = entry.slice->group_triangles[range_source[r].second];
+				const Imath::V3i& index = entry.mesh->triangle_index()[triangles[i - triangle_offset[r]]];
+				const unsigned int offset = batch.ranges[r].vertex_offset;
+				unsigned int* dst = &batch.indices[i * 3];
+				dst[0] = offset + index[0];
+				dst[1] = offset + index[1];
+				dst[2] = offset + index[2];
+			}
+		});
+	}
+
+	/**
+	 * get nearest mesh hit. walks object bounds then triangle bvh of each mesh.
+	 */
+	bool raycast(
+		const Imath::V3d& origin,
+		const Imath::V3d& direction,
+		double max_distance,
+		UMAbcScene::RayHit& hit)
+	{
+		update_bvh();
+		std::vector<std::pair<double, unsigned int> > candidates;
+		bvh_.query_ray(origin, direction, max_distance, candidates);
+
+		double best = max_distance;
+		bool is_hit = false;
+		for (size_t i = 0, size = candidates.size(); i < size; ++i)
+		{
+			// candidates are sorted by entry distance
+			if (candidates[i].first > best) break;
+			const SceneItem& item = items_[candidates[i].second];
+			UMAbcMeshPtr mesh = std::dynamic_pointer_cast<UMAbcMesh>(item.object);
+			if (!mesh) continue;
+			const UMAbcMeshBVH& mesh_bvh = mesh->bvh();
+			if (mesh_bvh.is_empty()) continue;
+
+			// ray in mesh local space. distance is kept by transforming the direction as is.
+			const Imath::M44d inverse = mesh->global_transform().inverse();
+			Imath::V3d local_origin;
+			Imath::V3d local_direction;
+			inverse.multVecMatrix(origin, local_origin);
+			inverse.multDirMatrix(direction, local_direction);
+
+			UMAbcMeshBVH::RayHit mesh_hit;
+			if (!mesh_bvh.raycast(
+				Imath::V3f(local_origin),
+				Imath::V3f(local_direction),
+				static_cast<float>(std::min(best, static_cast<double>(FLT_MAX))),
+				mesh_hit)) continue;
+
+			best = mesh_hit.distance;
+			is_hit = true;
+			hit.path = item.path;
+			hit.distance = mesh_hit.distance;
+			hit.triangle = mesh_hit.triangle;
+			hit.u = mesh_hit.u;
+			hit.v = mesh_hit.v;
+			hit.position = origin + direction * hit.distance;
+
+			// face normal in the same winding as UMAbcMesh::normals
+			const Imath::V3i& index = mesh->triangle_index()[mesh_hit.triangle];
+			const Imath::V3f* vertex = mesh->vertex();
+			const Imath::V3d v0(vertex[index[0]]);
+			const Imath::V3d v1(vertex[index[1]]);
+			const Imath::V3d v2(vertex[index[2]]);
+			inverse.transposed().multDirMatrix((v0 - v1).cross(v2 - v1), hit.normal);
+			hit.normal.normalize();
+		}
+		return is_hit;
+	}
+
+	/**
+	 * release derived buffers of the object and its descendants. empty path is all objects.
+	 */
+	bool release_buffers(const std::string& object_path)
+	{
+		if (object_path.empty())
+		{
+			if (!object_) return false;
+			object_->release_buffers(true);
+			std::map<std::string, BatchSlice>().swap(batch_cache_);
+			return true;
+		}
+		UMAbcObjectPtr object = find_object(object_path);
+		if (!object) return false;
+		object->release_buffers(true);
+		batch_cache_.erase(object_path);
+		const std::string prefix = object_path + "/";
+		std::map<std::string, BatchSlice>::iterator it = batch_cache_.lower_bound(prefix);
+		while (it != batch_cache_.end() && it->first.compare(0, prefix.size(), prefix) == 0)
+		{
+			batch_cache_.erase(it++);
+		}
+		return true;
+	}
+
+	/**
+	 * get bytes of derived buffers which releasing them frees.
+	 * shared geometry records are counted once, and not at all while something
+	 * outside the meshes of this scene holds them.
+	 */
+	size_t buffer_byte_size() const
+	{
+		size_t size = 0;
+		// record and number of meshes holding it
+		std::map<const UMAbcMeshGeometry*, std::pair<UMAbcMeshGeometryPtr, long> > geometries;
+		for (size_t i = 0, count = items_.size(); i < count; ++i)
+		{
+			UMAbcMeshPtr mesh = std::dynamic_pointer_cast<UMAbcMesh>(items_[i].object);
+			if (!mesh) continue;
+			size += mesh->buffer_byte_size();
+			UMAbcMeshGeometryPtr geometry = mesh->geometry();
+			if (!geometry) continue;
+			std::pair<UMAbcMeshGeometryPtr, long>& holder = geometries[geometry.get()];
+			holder.first = geometry;
+			++holder.second;
+		}
+		for (std::map<const UMAbcMeshGeometry*, std::pair<UMAbcMeshGeometryPtr, long> >::const_iterator
+			it = geometries.begin(); it != geometries.end(); ++it)
+		{
+			// the map holds one more reference
+			if (it->second.first.use_count() - 1 == it->second.second)
+			{
+				size += it->second.first->byte_size();
+			}
+		}
+		return size + batch_byte_size();
+	}
+
+	/**
+	 * get bytes held by each object and the scene
+	 */
+	void memory_report(UMAbcScene::MemoryReport& report) const
+	{
+		report = UMAbcScene::MemoryReport();
+		if (!object_) return;
+		std::set<const void*> geometries;
+		std::set<const void*> samples;
+		memory_report_recursive("/", object_, geometries, samples, report);
+		report.batch = batch_byte_size();
+		report.index = bvh_.byte_size()
+			+ items_.capacity() * sizeof(SceneItem)
+			+ item_boxes_.capacity() * sizeof(Imath::Box3d)
+			+ animated_items_.capacity() * sizeof(unsigned int);
+		for (size_t i = 0, size = items_.size(); i < size; ++i)
+		{
+			report.index += items_[i].path.capacity();
+		}
+		report.index += hierarchy_.parents.capacity() * sizeof(int)
+			+ hierarchy_.types.capacity()
+			+ hierarchy_.times.capacity() * sizeof(double)
+			+ hierarchy_.boxes.capacity() * sizeof(double)
+			+ hierarchy_.names.capacity()
+			+ hierarchy_.name_offsets.capacity() * sizeof(unsigned int);
+	}
+
 private:
+	/**
+	 * geometry object in the scene bvh
+	 */
+	struct SceneItem
+	{
+		std::string path;
+		UMAbcObjectPtr object;
+	};
+
 	UMAbcObjectPtr object_;
 	unsigned long pre_time_;
+	UMAbcMeshGeometryCachePtr geometry_cache_;
+
+	std::vector<SceneItem> items_;
+	std::vector<Imath::Box3d> item_boxes_;
+	// items which move or deform
+	std::vector<unsigned int> animated_items_;
+	UMAbcSceneBVH bvh_;
+	double bvh_time_;
+
+	/**
+	 * world space vertices and grouped triangles of a mesh kept for the next batch
+	 */
+	struct BatchSlice
+	{
+		BatchSlice() : is_valid(false), revision(0), topology_revision(0), group(UMAbcScene::kBatchGroupNone) {}
+		bool is_valid;
+		unsigned int revision;
+		unsigned int topology_revision;
+		Imath::M44d matrix;
+		UMAbcScene::BatchGroup group;
+		std::vector<Imath::V3f> vertices;
+		std::vector<Imath::V3f> normals;
+		std::vector<std::string> group_names;
+		std::vector<std::vector<unsigned int> > group_triangles;
+	};
+
+	struct BatchEntry
+	{
+		const SceneItem* item;
+		UMAbcMeshPtr mesh;
+		BatchSlice* slice;
+		bool is_changed;
+	};
+
+	std::map<std::string, BatchSlice> batch_cache_;
+
+	UMAbcScene::Hierarchy hierarchy_;
+	UMAbcPrefetcherPtr prefetcher_;
+
+	/**
+	 * get bytes of cached batch slices
+	 */
+	size_t batch_byte_size() const
+	{
+		size_t size = 0;
+		std::map<std::string, BatchSlice>::const_iterator it = batch_cache_.begin();
+		for (; it != batch_cache_.end(); ++it)
+		{
+			const BatchSlice& slice = it->second;
+			size += sizeof(BatchSlice) + it->first.capacity()
+				+ (slice.vertices.capacity() + slice.normals.capacity()) * sizeof(Imath::V3f)
+				+ slice.group_names.capacity() * sizeof(std::string)
+				+ slice.group_triangles.capacity() * sizeof(std::vector<unsigned int>);
+			for (size_t k = 0, ksize = slice.group_triangles.size(); k < ksize; ++k)
+			{
+				size += slice.group_triangles[k].capacity() * sizeof(unsigned int);
+			}
+			for (size_t k = 0, ksize = slice.group_names.size(); k < ksize; ++k)
+			{
+				size += slice.group_names[k].capacity();
+			}
+		}
+		return size;
+	}
+
+	/**
+	 * collect animated properties. the worker thread reads the archive
+	 * while playback reads it, so only archives read through streams are prefetched.
+	 */
+	void build_prefetcher(bool is_concurrent_read)
+	{
+		if (prefetcher_)
+		{
+			prefetcher_->stop();
+		}
+		prefetcher_ = UMAbcPrefetcherPtr();
+		if (!is_concurrent_read || !object_) return;
+		UMAbcPrefetcherPtr prefetcher = std::make_shared<UMAbcPrefetcher>();
+		add_prefetch_properties_recursive(*prefetcher, object_);
+		if (prefetcher->property_size() > 0)
+		{
+			prefetcher_ = prefetcher;
+		}
+	}
+
+	void add_prefetch_properties_recursive(UMAbcPrefetcher& prefetcher, UMAbcObjectPtr object)
+	{
+		object->add_prefetch_properties(prefetcher);
+		for (UMAbcObjectList::const_iterator it = object->children().begin();
+			it != object->children().end();
+			++it)
+		{
+			add_prefetch_properties_recursive(prefetcher, *it);
+		}
+	}
+
+	/**
+	 * flatten the tree into hierarchy arrays
+	 */
+	void build_hierarchy()
+	{
+		hierarchy_ = UMAbcScene::Hierarchy();
+		if (!object_) return;
+		hierarchy_.name_offsets.push_back(0);
+		build_hierarchy_recursive(-1, object_);
+	}
+
+	void build_hierarchy_recursive(int parent, UMAbcObjectPtr object)
+	{
+		const int index = static_cast<int>(hierarchy_.parents.size());
+		hierarchy_.parents.push_back(parent);
+		hierarchy_.types.push_back(static_cast<unsigned char>(object_type(object)));
+		hierarchy_.times.push_back(static_cast<double>(object->min_time()));
+		hierarchy_.times.push_back(static_cast<double>(object->max_time()));
+		const Imath::Box3d& box = object->box();
+		hierarchy_.boxes.push_back(box.min.x);
+		hierarchy_.boxes.push_back(box.min.y);
+		hierarchy_.boxes.push_back(box.min.z);
+		hierarchy_.boxes.push_back(box.max.x);
+		hierarchy_.boxes.push_back(box.max.y);
+		hierarchy_.boxes.push_back(box.max.z);
+		hierarchy_.names += object->name();
+		hierarchy_.name_offsets.push_back(static_cast<unsigned int>(hierarchy_.names.size()));
+
+		for (UMAbcObjectList::const_iterator it = object->children().begin();
+			it != object->children().end();
+			++it)
+		{
+			build_hierarchy_recursive(index, *it);
+		}
+	}
+
+	static UMAbcScene::ObjectType object_type(UMAbcObjectPtr object)
+	{
+		if (std::dynamic_pointer_cast<UMAbcMesh>(object)) return UMAbcScene::kObjectTypeMesh;
+		if (std::dynamic_pointer_cast<UMAbcPoint>(object)) return UMAbcScene::kObjectTypePoint;
+		if (std::dynamic_pointer_cast<UMAbcCurve>(object)) return UMAbcScene::kObjectTypeCurve;
+		if (std::dynamic_pointer_cast<UMAbcNurbsPatch>(object)) return UMAbcScene::kObjectTypeNurbs;
+		if (std::dynamic_pointer_cast<UMAbcCamera>(object)) return UMAbcScene::kObjectTypeCamera;
+		if (std::dynamic_pointer_cast<UMAbcXform>(object)) return UMAbcScene::kObjectTypeXform;
+		return UMAbcScene::kObjectTypeObject;
+	}
+
+	/**
+	 * add memory usage of the object and its descendants
+	 */
+	void memory_report_recursive(
+		const std::string& object_path,
+		UMAbcObjectPtr object,
+		std::set<const void*>& geometries,
+		std::set<const void*>& samples,
+		UMAbcScene::MemoryReport& report) const
+	{
+		UMAbcMemoryUsage usage;
+		object->memory_usage(usage);
+
+		// samples shared by instances or with the sample cache are counted once in total
+		UMAbcMemoryUsage& total = report.total;
+		for (size_t i = 0, size = usage.samples.size(); i < size; ++i)
+		{
+			if (samples.insert(usage.samples[i].first).second)
+			{
+				total.sample += usage.samples[i].second;
+			}
+		}
+		std::vector<std::pair<const void*, size_t> >().swap(usage.samples);
+		report.paths.push_back(object_path);
+		report.objects.push_back(usage);
+
+		total.node += usage.node;
+		total.bvh += usage.bvh;
+		total.derived += usage.derived;
+		if (usage.geometry_record && geometries.insert(usage.geometry_record).second)
+		{
+			total.geometry += usage.geometry;
+		}
+
+		const std::string prefix = object_path == "/" ? object_path : object_path + "/";
+		for (UMAbcObjectList::const_iterator it = object->children().begin();
+			it != object->children().end();
+			++it)
+		{
+			memory_report_recursive(prefix + (*it)->name(), *it, geometries, samples, report);
+		}
+	}
+
+	/**
+	 * split triangles of the mesh into groups
+	 */
+	void group_slice(UMAbcMeshPtr mesh, UMAbcScene::BatchGroup group, BatchSlice& slice)
+	{
+		slice.group = group;
+		slice.group_names.clear();
+		slice.group_triangles.clear();
+		const size_t triangle_size = mesh->triangle_index().size();
+		if (group == UMAbcScene::kBatchGroupNone)
+		{
+			slice.group_names.push_back(std::string());
+			slice.group_triangles.resize(1);
+			slice.group_triangles[0].resize(triangle_size);
+			for (size_t i = 0; i < triangle_size; ++i)
+			{
+				slice.group_triangles[0][i] = static_cast<unsigned int>(i);
+			}
+			return;
+		}
+
+		const std::vector<int>& faceset = mesh->triangle_faceset();
+		const std::vector<std::string>& faceset_names = mesh->faceset_name_list();
+		const std::vector<std::string>& faceset_materials = mesh->faceset_material_path_list();
+		std::map<std::string, size_t> group_map;
+		for (size_t i = 0; i < triangle_size; ++i)
+		{
+			const int f = i < faceset.size() ? faceset[i] : -1;
+			std::string name;
+			if (group == UMAbcScene::kBatchGroupFaceset)
+			{
+				if (f >= 0) name = faceset_names[f];
+			}
+			else
+			{
+				name = (f >= 0 && !faceset_materials[f].empty()) ? faceset_materials[f] : mesh->material_path();
+			}
+			std::map<std::string, size_t>::iterator it = group_map.find(name);
+			if (it == group_map.end())
+			{
+				it = group_map.insert(std::make_pair(name, slice.group_names.size())).first;
+				slice.group_names.push_back(name);
+				slice.group_triangles.push_back(std::vector<unsigned int>());
+			}
+			slice.group_triangles[it->second].push_back(static_cast<unsigned int>(i));
+		}
+	}
+
+	/**
+	 * transform vertices [begin, end) of the slice into world space
+	 */
+	static void transform_slice(const BatchEntry& entry, size_t begin, size_t end)
+	{
+		const Imath::V3f* vertex = entry.mesh->vertex();
+		const std::vector<Imath::V3f>& normals = entry.mesh->normals();
+		const bool has_normal = normals.size() == entry.slice->vertices.size();
+		const Imath::M44d& matrix = entry.slice->matrix;
+		const Imath::M44d normal_matrix = matrix.inverse().transposed();
+		for (size_t i = begin; i < end; ++i)
+		{
+			Imath::V3d v;
+			matrix.multVecMatrix(Imath::V3d(vertex[i]), v);
+			entry.slice->vertices[i] = Imath::V3f(v);
+			if (has_normal)
+			{
+				Imath::V3d n;
+				normal_matrix.multDirMatrix(Imath::V3d(normals[i]), n);
+				entry.slice->normals[i] = Imath::V3f(n.normalize());
+			}
+			else
+			{
+				entry.slice->normals[i] = Imath::V3f(0.0f);
+			}
+		}
+	}
+
+	void set_geometry_cache_recursive(UMAbcObjectPtr object)
+	{
+		if (UMAbcMeshPtr mesh = std::dynamic_pointer_cast<UMAbcMesh>(object))
+		{
+			mesh->set_geometry_cache(geometry_cache_);
+		}
+		for (UMAbcObjectList::const_iterator it = object->children().begin();
+			it != object->children().end();
+			++it)
+		{
+			set_geometry_cache_recursive(*it);
+		}
+	}
+
+	/**
+	 * collect geometry objects
+	 */
+	void collect_items_recursive(const std::string& object_path, UMAbcObjectPtr object, bool is_parent_animated)
+	{
+		IObjectPtr raw = object->object();
+		const bool is_animated = is_parent_animated
+			|| (raw && raw->valid() && !is_constant_properties(raw->getProperties()));
+		if (std::dynamic_pointer_cast<UMAbcMesh>(object)
+			|| std::dynamic_pointer_cast<UMAbcPoint>(object)
+			|| std::dynamic_pointer_cast<UMAbcCurve>(object)
+			|| std::dynamic_pointer_cast<UMAbcNurbsPatch>(object))
+		{
+			SceneItem item;
+			item.path = object_path;
+			item.object = object;
+			if (is_animated)
+			{
+				animated_items_.push_back(static_cast<unsigned int>(items_.size()));
+			}
+			items_.push_back(item);
+		}
+		for (UMAbcObjectList::const_iterator it = object->children().begin();
+			it != object->children().end();
+			++it)
+		{
+			collect_items_recursive(object_path + "/" + (*it)->name(), *it, is_animated);
+		}
+	}
+
+	/**
+	 * get world box of the item at current time
+	 */
+	Imath::Box3d item_box(const SceneItem& item)
+	{
+		item.object->update_box(false);
+		if (item.object->box().isEmpty()) return Imath::Box3d();
+		return Imath::transform(item.object->box(), item.object->global_transform());
+	}
+
+	/**
+	 * build scene bvh
+	 */
+	void build_bvh()
+	{
+		items_.clear();
+		animated_items_.clear();
+		for (UMAbcObjectList::const_iterator it = object_->children().begin();
+			it != object_->children().end();
+			++it)
+		{
+			collect_items_recursive("/" + (*it)->name(), *it, false);
+		}
+		item_boxes_.resize(items_.size());
+		for (size_t i = 0, size = items_.size(); i < size; ++i)
+		{
+			item_boxes_[i] = item_box(items_[i]);
+		}
+		bvh_.build(item_boxes_);
+		bvh_time_ = object_->current_time();
+	}
+
+	/**
+	 * refit animated items when the time has changed
+	 */
+	void update_bvh()
+	{
+		if (!object_ || bvh_time_ == object_->current_time()) return;
+		for (size_t i = 0, size = animated_items_.size(); i < size; ++i)
+		{
+			item_boxes_[animated_items_[i]] = item_box(items_[animated_items_[i]]);
+		}
+		bvh_.refit(animated_items_, item_boxes_);
+		bvh_time_ = object_->current_time();
+	}
+
+	void to_path_list(const std::vector<unsigned int>& result, std::vector<std::string>& path_list) const
+	{
+		path_list.reserve(path_list.size() + result.size());
+		for (size_t i = 0, size = result.size(); i < size; ++i)
+		{
+			path_list.push_back(items_[result[i]].path);
+		}
+	}
 
 	/**
 	 * is constant
@@ -301,7 +1237,7 @@ double UMAbcScene::max_time() const
  */
 bool UMAbcScene::init()
 {
-	return impl_->init();
+	return impl_->init(!!archive_source_);
 }
 
 /**
@@ -399,6 +1335,30 @@ std::vector<std::string> UMAbcScene::xform_path_list()
 	return name_list;
 }
 
+/**
+ * set current time of all objects
+ */
+void UMAbcScene::set_current_time(unsigned long time)
+{
+	impl_->set_current_time(time);
+}
+
+/**
+ * get prefetcher
+ */
+UMAbcPrefetcherPtr UMAbcScene::prefetcher() const
+{
+	return impl_->prefetcher();
+}
+
+/**
+ * get hierarchy built at init
+ */
+const UMAbcScene::Hierarchy& UMAbcScene::hierarchy() const
+{
+	return impl_->hierarchy();
+}
+
 /**
  * get root object
  */
@@ -423,4 +1383,111 @@ UMAbcObjectPtr UMAbcScene::find_object(const std::string& object_path)
 	return impl_->find_object(object_path);
 }
 
+/**
+ * get paths of geometry objects overlapping the box
+ */
+std::vector<std::string> UMAbcScene::box_query(const Imath::Box3d& box)
+{
+	std::vector<std::string> path_list;
+	impl_->box_query(box, path_list);
+	return path_list;
+}
+
+/**
+ * get paths of geometry objects inside or intersecting the planes
+ */
+std::vector<std::string> UMAbcScene::frustum_query(const std::vector<Imath::V4d>& planes)
+{
+	std::vector<std::string> path_list;
+	impl_->frustum_query(planes, path_list);
+	return path_list;
+}
+
+/**
+ * get world space bounds of all geometry objects
+ */
+Imath::Box3d UMAbcScene::world_box()
+{
+	return impl_->world_box();
+}
+
+/**
+ * get closest point on the mesh to the world space point
+ */
+bool UMAbcScene::closest_point(
+	const std::string& mesh_path,
+	const Imath::V3d& point,
+	double max_distance,
+	ClosestHit& hit)
+{
+	return impl_->closest_point(mesh_path, point, max_distance, hit);
+}
+
+/**
+ * get world space distance from each vertex of the source mesh to the target mesh
+ */
+bool UMAbcScene::mesh_distance(
+	const std::string& source_path,
+	const std::string& target_path,
+	double max_distance,
+	bool is_signed,
+	MeshDistance& result)
+{
+	return impl_->mesh_distance(source_path, target_path, max_distance, is_signed, result);
+}
+
+/**
+ * get meshes sharing same geometry at current time
+ */
+std::vector<UMAbcScene::InstanceGroup> UMAbcScene::instance_groups(size_t min_count)
+{
+	std::vector<InstanceGroup> groups;
+	impl_->instance_groups(min_count, groups);
+	return groups;
+}
+
+/**
+ * merge meshes at current time into world space buffers
+ */
+void UMAbcScene::batch(const BatchSetting& setting, Batch& batch)
+{
+	impl_->batch(setting, batch);
+}
+
+/**
+ * release derived buffers of the object and its descendants
+ */
+bool UMAbcScene::release_buffers(const std::string& object_path)
+{
+	return impl_->release_buffers(object_path);
+}
+
+/**
+ * get bytes of derived buffers
+ */
+size_t UMAbcScene::buffer_byte_size() const
+{
+	return impl_->buffer_byte_size();
+}
+
+/**
+ * get bytes held by each object and the scene
+ */
+void UMAbcScene::memory_report(MemoryReport& report) const
+{
+	impl_->memory_report(report);
+}
+
+/**
+ * get nearest mesh hit along the world space ray
+ */
+bool UMAbcScene::raycast(
+	const Imath::V3d& origin,
+	const Imath::V3d& direction,
+	double max_distance,
+	RayHit& hit)
+{
+	return impl_->raycast(origin, direction, max_distance, hit);
+}
+
 } // umabc
@@ -15,14 +15,21 @@
 #include <vector>
 #include <map>
 #include "UMMacro.h"
+#include "ImathVec.h"
+#include "ImathBox.h"
+#include "ImathMatrix.h"
 #include "UMAbcSetting.h"
+#include "UMAbcObject.h"
 
 /// uimac alembic library
 namespace umabc
 {
 	
-class UMAbcObject;
-typedef std::shared_ptr<UMAbcObject> UMAbcObjectPtr;
+class UMAbcPrefetcher;
+typedef std::shared_ptr<UMAbcPrefetcher> UMAbcPrefetcherPtr;
+
+class UMAbcArchiveSource;
+typedef std::shared_ptr<UMAbcArchiveSource> UMAbcArchiveSourcePtr;
 
 class UMAbcScene;
 typedef std::shared_ptr<UMAbcScene> UMAbcScenePtr;
@@ -33,6 +40,161 @@ class UMAbcScene //: public UMAbc
 	DISALLOW_COPY_AND_ASSIGN(UMAbcScene);
 public:
 
+	/**
+	 * ray hit on a mesh.
+	 * local position is (1 - u - v) * v0 + u * v1 + v * v2 of the triangle.
+	 */
+	struct RayHit
+	{
+		RayHit() : distance(0), triangle(-1), u(0), v(0) {}
+		std::string path;
+		double distance;
+		int triangle;
+		double u;
+		double v;
+		Imath::V3d position;
+		Imath::V3d normal;
+	};
+
+	/**
+	 * closest point on a mesh in world space.
+	 * local position is (1 - u - v) * v0 + u * v1 + v * v2 of the triangle.
+	 */
+	struct ClosestHit
+	{
+		ClosestHit() : distance(0), triangle(-1), u(0), v(0) {}
+		double distance;
+		int triangle;
+		double u;
+		double v;
+		Imath::V3d position;
+	};
+
+	/**
+	 * per vertex distance from a mesh to another mesh.
+	 * vertices without a closest point within the maximum distance have
+	 * infinite distance and triangle -1.
+	 */
+	struct MeshDistance
+	{
+		std::vector<float> distance;
+		std::vector<int> triangle;
+		std::vector<float> barycentric;
+	};
+
+	/**
+	 * triangle grouping of scene batch
+	 */
+	enum BatchGroup
+	{
+		kBatchGroupNone,
+		kBatchGroupFaceset,
+		kBatchGroupMaterial
+	};
+
+	/**
+	 * scene batch setting
+	 */
+	struct BatchSetting
+	{
+		BatchSetting() : group(kBatchGroupNone), is_visible_only(true) {}
+		BatchGroup group;
+		bool is_visible_only;
+	};
+
+	/**
+	 * triangles of an object in a group of the scene batch.
+	 * vertex range is same for all groups of the object.
+	 */
+	struct BatchRange
+	{
+		std::string path;
+		unsigned int group;
+		unsigned int vertex_offset;
+		unsigned int vertex_count;
+		unsigned int index_offset;
+		unsigned int index_count;
+		bool is_changed;
+	};
+
+	/**
+	 * indices of a group of the scene batch
+	 */
+	struct BatchGroupRange
+	{
+		std::string name;
+		unsigned int index_offset;
+		unsigned int index_count;
+	};
+
+	/**
+	 * world space vertices and rebased indices of all meshes, sorted by group
+	 */
+	struct Batch
+	{
+		std::vector<Imath::V3f> vertices;
+		std::vector<Imath::V3f> normals;
+		std::vector<unsigned int> indices;
+		std::vector<BatchGroupRange> groups;
+		std::vector<BatchRange> ranges;
+	};
+
+	/**
+	 * meshes sharing one geometry record. transforms are global transforms of each mesh.
+	 */
+	struct InstanceGroup
+	{
+		std::vector<std::string> paths;
+		std::vector<Imath::M44d> transforms;
+		unsigned int vertex_size;
+		unsigned int triangle_size;
+	};
+
+	/**
+	 * bytes held by the scene.
+	 * total counts geometry records shared between meshes once.
+	 */
+	struct MemoryReport
+	{
+		MemoryReport() : batch(0), index(0) {}
+		std::vector<std::string> paths;
+		std::vector<UMAbcMemoryUsage> objects;
+		UMAbcMemoryUsage total;
+		size_t batch; // cached batch slices
+		size_t index; // scene bvh and item lists
+	};
+
+	/**
+	 * object type code of hierarchy
+	 */
+	enum ObjectType
+	{
+		kObjectTypeObject,
+		kObjectTypeXform,
+		kObjectTypeMesh,
+		kObjectTypePoint,
+		kObjectTypeCurve,
+		kObjectTypeNurbs,
+		kObjectTypeCamera
+	};
+
+	/**
+	 * all objects in depth first order. root is the first node and its parent is -1.
+	 * time range is in milliseconds and bounds are at the initial time.
+	 * name of node i is names[name_offsets[i], name_offsets[i + 1]).
+	 */
+	struct Hierarchy
+	{
+		std::vector<int> parents;
+		std::vector<unsigned char> types;
+		std::vector<double> times; // min, max per node
+		std::vector<double> boxes; // min xyz, max xyz per node
+		std::string names; // utf8
+		std::vector<unsigned int> name_offsets; // node count + 1
+
+		size_t size() const { return parents.size(); }
+	};
+
 	UMAbcScene(UMAbcObjectPtr root);
 	~UMAbcScene();
 	
@@ -56,6 +218,17 @@ public:
 	 */
 	virtual bool clear();
 
+	/**
+	 * set current time of all objects. following frames are prefetched during playback.
+	 * @param [in] time time in milliseconds
+	 */
+	void set_current_time(unsigned long time);
+
+	/**
+	 * get prefetcher. null when the archive is not read through streams or not animated.
+	 */
+	UMAbcPrefetcherPtr prefetcher() const;
+
 	/**
 	 * get minimum time
 	 */
@@ -112,12 +285,120 @@ public:
 	 */
 	UMAbcObjectPtr root_object();
 	
+	/**
+	 * get hierarchy built at init
+	 */
+	const Hierarchy& hierarchy() const;
+
 	/**
 	 * get total polygons
 	 */
 	size_t total_polygon_size() const;
 
+	/**
+	 * get paths of geometry objects overlapping the world space box
+	 */
+	std::vector<std::string> box_query(const Imath::Box3d& box);
+
+	/**
+	 * get paths of geometry objects inside or intersecting the planes.
+	 * a point is inside when ax + by + cz + d >= 0.
+	 */
+	std::vector<std::string> frustum_query(const std::vector<Imath::V4d>& planes);
+
+	/**
+	 * get world space bounds of all geometry objects
+	 */
+	Imath::Box3d world_box();
+
+	/**
+	 * get nearest mesh hit along the world space ray
+	 * @param [in] origin ray origin
+	 * @param [in] direction ray direction. distance is in units of its length
+	 * @param [in] max_distance maximum distance
+	 * @param [out] hit nearest hit
+	 * @retval hit or not
+	 */
+	bool raycast(
+		const Imath::V3d& origin,
+		const Imath::V3d& direction,
+		double max_distance,
+		RayHit& hit);
+
+	/**
+	 * get closest point on the mesh to the world space point
+	 * @param [in] mesh_path mesh path
+	 * @param [in] point world space point
+	 * @param [in] max_distance maximum distance
+	 * @param [out] hit closest point
+	 * @retval found or not
+	 */
+	bool closest_point(
+		const std::string& mesh_path,
+		const Imath::V3d& point,
+		double max_distance,
+		ClosestHit& hit);
+
+	/**
+	 * get world space distance from each vertex of the source mesh to the target mesh.
+	 * signed distance is negative behind the target surface.
+	 * @param [in] source_path source mesh path
+	 * @param [in] target_path target mesh path
+	 * @param [in] max_distance maximum distance
+	 * @param [in] is_signed signed distance or not
+	 * @param [out] result distance, triangle and barycentric per source vertex
+	 * @retval succsess or fail
+	 */
+	bool mesh_distance(
+		const std::string& source_path,
+		const std::string& target_path,
+		double max_distance,
+		bool is_signed,
+		MeshDistance& result);
+
+	/**
+	 * merge meshes at current time into world space buffers.
+	 * unchanged meshes reuse their previous transformed vertices.
+	 * @param [in] setting batch setting
+	 * @param [out] batch merged buffers
+	 */
+	void batch(const BatchSetting& setting, Batch& batch);
+
+	/**
+	 * get meshes sharing same geometry at current time
+	 * @param [in] min_count minimum number of meshes in a group
+	 */
+	std::vector<InstanceGroup> instance_groups(size_t min_count);
+
+	/**
+	 * release triangulation, normals, uvs and bvh of the object and its descendants.
+	 * hierarchy is kept and buffers are rebuilt on next access.
+	 * @param [in] object_path object path. empty is all objects
+	 * @retval succsess or fail
+	 */
+	bool release_buffers(const std::string& object_path);
+
+	/**
+	 * get bytes of buffers derived from samples which release_buffers frees.
+	 * geometry records also held outside the scene are not counted.
+	 */
+	size_t buffer_byte_size() const;
+
+	/**
+	 * keep the file which the archive reads from
+	 */
+	void set_archive_source(UMAbcArchiveSourcePtr source) { archive_source_ = source; }
+
+	/**
+	 * get bytes held by each object and the scene
+	 * @param [out] report memory report
+	 */
+	void memory_report(MemoryReport& report) const;
+
 private:
+	// released after impl
+	UMAbcArchiveSourcePtr archive_source_;
+
 	class SceneImpl;
 	typedef std::unique_ptr<SceneImpl> SceneImplPtr;
 	SceneImplPtr impl_;
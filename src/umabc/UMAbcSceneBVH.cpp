@@ -0,0 +1,319 @@
+/**
+ * @file UMAbcSceneBVH.cpp
+ * bounding volume hierarchy over object bounds
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include <algorithm>
+
+#include "UMAbcSceneBVH.h"
+
+namespace umabc
+{
+
+namespace
+{
+	/**
+	 * get box center. empty boxes are at the origin
+	 */
+	Imath::V3d box_center(const Imath::Box3d& box)
+	{
+		return box.isEmpty() ? Imath::V3d(0, 0, 0) : box.center();
+	}
+
+	/**
+	 * box overlap test
+	 */
+	bool is_overlap(const Imath::Box3d& a, const Imath::Box3d& b)
+	{
+		return a.max.x >= b.min.x && a.min.x <= b.max.x
+			&& a.max.y >= b.min.y && a.min.y <= b.max.y
+			&& a.max.z >= b.min.z && a.min.z <= b.max.z;
+	}
+
+	enum FrustumResult
+	{
+		kOutside,
+		kIntersect,
+		kInside
+	};
+
+	/**
+	 * box and planes test
+	 */
+	FrustumResult test_frustum(const Imath::Box3d& box, const std::vector<Imath::V4d>& planes)
+	{
+		if (box.isEmpty()) return kOutside;
+		FrustumResult result = kInside;
+		for (size_t i = 0, size = planes.size(); i < size; ++i)
+		{
+			const Imath::V4d& p = planes[i];
+			// farthest corner along the plane normal
+			const double far_distance = p.x * (p.x >= 0 ? box.max.x : box.min.x)
+				+ p.y * (p.y >= 0 ? box.max.y : box.min.y)
+				+ p.z * (p.z >= 0 ? box.max.z : box.min.z) + p.w;
+			if (far_distance < 0) return kOutside;
+			// nearest corner
+			const double near_distance = p.x * (p.x >= 0 ? box.min.x : box.max.x)
+				+ p.y * (p.y >= 0 ? box.min.y : box.max.y)
+				+ p.z * (p.z >= 0 ? box.min.z : box.max.z) + p.w;
+			if (near_distance < 0) result = kIntersect;
+		}
+		return result;
+	}
+
+	/**
+	 * ray and box slab test
+	 */
+	bool intersect_ray(
+		const Imath::Box3d& box,
+		const Imath::V3d& origin,
+		const Imath::V3d& direction,
+		double max_distance,
+		double& near_distance)
+	{
+		if (box.isEmpty()) return false;
+		double t0 = 0.0;
+		double t1 = max_distance;
+		for (int i = 0; i < 3; ++i)
+		{
+			if (direction[i] == 0.0)
+			{
+				if (origin[i] < box.min[i] || origin[i] > box.max[i]) return false;
+				continue;
+			}
+			const double inv = 1.0 / direction[i];
+			double a = (box.min[i] - origin[i]) * inv;
+			double b = (box.max[i] - origin[i]) * inv;
+			if (a > b) std::swap(a, b);
+			t0 = std::max(t0, a);
+			t1 = std::min(t1, b);
+			if (t0 > t1) return false;
+		}
+		near_distance = t0;
+		return true;
+	}
+
+} // anonymous namespace
+
+/**
+ * build
+ */
+void UMAbcSceneBVH::build(const std::vector<Imath::Box3d>& boxes)
+{
+	nodes_.clear();
+	item_leaf_.assign(boxes.size(), -1);
+	dirty_.clear();
+	if (boxes.empty()) return;
+
+	std::vector<unsigned int> items(boxes.size());
+	for (size_t i = 0, size = items.size(); i < size; ++i)
+	{
+		items[i] = static_cast<unsigned int>(i);
+	}
+	nodes_.reserve(boxes.size() * 2 - 1);
+	build_recursive(items, 0, items.size(), -1, boxes);
+	dirty_.assign(nodes_.size(), 0);
+}
+
+/**
+ * build nodes of items in [begin, end)
+ */
+int UMAbcSceneBVH::build_recursive(
+	std::vector<unsigned int>& items,
+	size_t begin,
+	size_t end,
+	int parent,
+	const std::vector<Imath::Box3d>& boxes)
+{
+	const int index = static_cast<int>(nodes_.size());
+	Node node;
+	node.left = -1;
+	node.right = -1;
+	node.parent = parent;
+	node.item = -1;
+	nodes_.push_back(node);
+
+	if (end - begin == 1)
+	{
+		nodes_[index].item = items[begin];
+		nodes_[index].box = boxes[items[begin]];
+		item_leaf_[items[begin]] = index;
+		return index;
+	}
+
+	// split at the median of the longest centroid axis
+	Imath::Box3d centroid_box;
+	for (size_t i = begin; i < end; ++i)
+	{
+		centroid_box.extendBy(box_center(boxes[items[i]]));
+	}
+	const int axis = centroid_box.majorAxis();
+	const size_t mid = begin + (end - begin) / 2;
+	std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+		[&](unsigned int a, unsigned int b) {
+			return box_center(boxes[a])[axis] < box_center(boxes[b])[axis];
+		});
+
+	const int left = build_recursive(items, begin, mid, index, boxes);
+	const int right = build_recursive(items, mid, end, index, boxes);
+	nodes_[index].left = left;
+	nodes_[index].right = right;
+	nodes_[index].box = nodes_[left].box;
+	nodes_[index].box.extendBy(nodes_[right].box);
+	return index;
+}
+
+/**
+ * refit changed items
+ */
+void UMAbcSceneBVH::refit(const std::vector<unsigned int>& changed, const std::vector<Imath::Box3d>& boxes)
+{
+	dirty_nodes_.clear();
+	for (size_t i = 0, size = changed.size(); i < size; ++i)
+	{
+		if (changed[i] >= item_leaf_.size()) continue;
+		const int leaf = item_leaf_[changed[i]];
+		if (leaf < 0) continue;
+		nodes_[leaf].box = boxes[changed[i]];
+		// mark ancestors until one is already marked
+		for (int node = nodes_[leaf].parent; node >= 0 && !dirty_[node]; node = nodes_[node].parent)
+		{
+			dirty_[node] = 1;
+			dirty_nodes_.push_back(node);
+		}
+	}
+	// children have larger indices than their parents
+	std::sort(dirty_nodes_.begin(), dirty_nodes_.end());
+	for (size_t i = dirty_nodes_.size(); i > 0; --i)
+	{
+		Node& node = nodes_[dirty_nodes_[i - 1]];
+		node.box = nodes_[node.left].box;
+		node.box.extendBy(nodes_[node.right].box);
+		dirty_[dirty_nodes_[i - 1]] = 0;
+	}
+}
+
+/**
+ * get items under the node
+ */
+void UMAbcSceneBVH::collect(int node, std::vector<unsigned int>& result) const
+{
+	std::vector<int> stack(1, node);
+	while (!stack.empty())
+	{
+		const Node& current = nodes_[stack.back()];
+		stack.pop_back();
+		if (current.item >= 0)
+		{
+			if (!current.box.isEmpty()) result.push_back(current.item);
+			continue;
+		}
+		stack.push_back(current.left);
+		stack.push_back(current.right);
+	}
+}
+
+/**
+ * get items overlapping the box
+ */
+void UMAbcSceneBVH::query_box(const Imath::Box3d& box, std::vector<unsigned int>& result) const
+{
+	if (nodes_.empty() || box.isEmpty()) return;
+	std::vector<int> stack(1, 0);
+	while (!stack.empty())
+	{
+		const Node& node = nodes_[stack.back()];
+		stack.pop_back();
+		if (node.box.isEmpty() || !is_overlap(node.box, box)) continue;
+		if (node.item >= 0)
+		{
+			result.push_back(node.item);
+			continue;
+		}
+		stack.push_back(node.right);
+		stack.push_back(node.left);
+	}
+}
+
+/**
+ * get items inside or intersecting the planes
+ */
+void UMAbcSceneBVH::query_frustum(const std::vector<Imath::V4d>& planes, std::vector<unsigned int>& result) const
+{
+	if (nodes_.empty()) return;
+	std::vector<int> stack(1, 0);
+	while (!stack.empty())
+	{
+		const int index = stack.back();
+		const Node& node = nodes_[index];
+		stack.pop_back();
+		const FrustumResult test = test_frustum(node.box, planes);
+		if (test == kOutside) continue;
+		if (test == kInside)
+		{
+			// whole subtree is visible
+			collect(index, result);
+			continue;
+		}
+		if (node.item >= 0)
+		{
+			result.push_back(node.item);
+			continue;
+		}
+		stack.push_back(node.right);
+		stack.push_back(node.left);
+	}
+}
+
+/**
+ * get items hit by the ray, sorted by entry distance
+ */
+void UMAbcSceneBVH::query_ray(
+	const Imath::V3d& origin,
+	const Imath::V3d& direction,
+	double max_distance,
+	std::vector<std::pair<double, unsigned int> >& result) const
+{
+	if (nodes_.empty()) return;
+	std::vector<int> stack(1, 0);
+	while (!stack.empty())
+	{
+		const Node& node = nodes_[stack.back()];
+		stack.pop_back();
+		double near_distance = 0.0;
+		if (!intersect_ray(node.box, origin, direction, max_distance, near_distance)) continue;
+		if (node.item >= 0)
+		{
+			result.push_back(std::make_pair(near_distance, static_cast<unsigned int>(node.item)));
+			continue;
+		}
+		stack.push_back(node.right);
+		stack.push_back(node.left);
+	}
+	std::sort(result.begin(), result.end());
+}
+
+/**
+ * get bounds of all items
+ */
+Imath::Box3d UMAbcSceneBVH::bounds() const
+{
+	return nodes_.empty() ? Imath::Box3d() : nodes_[0].box;
+}
+
+/**
+ * get allocated bytes
+ */
+size_t UMAbcSceneBVH::byte_size() const
+{
+	return nodes_.capacity() * sizeof(Node)
+		+ (item_leaf_.capacity() + dirty_nodes_.capacity()) * sizeof(int)
+		+ dirty_.capacity();
+}
+
+} // umabc
@@ -0,0 +1,110 @@
+/**
+ * @file UMAbcSceneBVH.h
+ * bounding volume hierarchy over object bounds
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include "ImathVec.h"
+#include "ImathBox.h"
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+class UMAbcSceneBVH;
+typedef std::shared_ptr<UMAbcSceneBVH> UMAbcSceneBVHPtr;
+
+/**
+ * binary bvh with one item per leaf.
+ * parents are stored before their children, so refit walks nodes backwards.
+ */
+class UMAbcSceneBVH
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcSceneBVH);
+public:
+	UMAbcSceneBVH() {}
+	~UMAbcSceneBVH() {}
+
+	/**
+	 * build from item bounds
+	 * @param [in] boxes world space bounds of each item
+	 */
+	void build(const std::vector<Imath::Box3d>& boxes);
+
+	/**
+	 * refit changed items and their ancestors
+	 * @param [in] changed changed item index list
+	 * @param [in] boxes world space bounds of each item
+	 */
+	void refit(const std::vector<unsigned int>& changed, const std::vector<Imath::Box3d>& boxes);
+
+	/**
+	 * get items overlapping the box
+	 */
+	void query_box(const Imath::Box3d& box, std::vector<unsigned int>& result) const;
+
+	/**
+	 * get items inside or intersecting the planes.
+	 * a point is inside when ax + by + cz + d >= 0.
+	 */
+	void query_frustum(const std::vector<Imath::V4d>& planes, std::vector<unsigned int>& result) const;
+
+	/**
+	 * get items hit by the ray
+	 * @param [in] origin ray origin
+	 * @param [in] direction ray direction
+	 * @param [in] max_distance maximum distance
+	 * @param [out] result pairs of entry distance and item, sorted by distance
+	 */
+	void query_ray(
+		const Imath::V3d& origin,
+		const Imath::V3d& direction,
+		double max_distance,
+		std::vector<std::pair<double, unsigned int> >& result) const;
+
+	/**
+	 * get bounds of all items
+	 */
+	Imath::Box3d bounds() const;
+
+	/**
+	 * get node count
+	 */
+	size_t node_count() const { return nodes_.size(); }
+
+	/**
+	 * get allocated bytes
+	 */
+	size_t byte_size() const;
+
+private:
+	struct Node
+	{
+		Imath::Box3d box;
+		int left;
+		int right;
+		int parent;
+		int item;
+	};
+
+	int build_recursive(std::vector<unsigned int>& items, size_t begin, size_t end, int parent,
+		const std::vector<Imath::Box3d>& boxes);
+
+	void collect(int node, std::vector<unsigned int>& result) const;
+
+	std::vector<Node> nodes_;
+	std::vector<int> item_leaf_;
+	std::vector<char> dirty_;
+	std::vector<int> dirty_nodes_;
+};
+
+} // umabc
@@ -0,0 +1,253 @@
+/**
+ * @file UMAbcSceneIndex.cpp
+ * sidecar file of the object hierarchy of an archive
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcSceneIndex.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <Alembic/Abc/All.h>
+#include <Alembic/AbcCoreFactory/All.h>
+
+#include "UMAbcFileSystem.h"
+
+namespace umabc
+{
+
+namespace
+{
+	const char kMagic[8] = { 'U', 'M', 'A', 'B', 'C', 'I', 'X', '\0' };
+	const unsigned int kVersion = 2;
+	const char kIndexExtension[] = ".umabcindex";
+
+	/**
+	 * archive the index was written from
+	 */
+	struct Identity
+	{
+		unsigned long long size;
+		unsigned long long time; // modified time in 100ns or 1ns units. only compared
+		unsigned char properties_digest[16];
+		unsigned char children_digest[16];
+		unsigned int has_digest;
+		unsigned int reserved;
+	};
+
+	struct FileHeader
+	{
+		char magic[8];
+		unsigned int version;
+		unsigned int node_count;
+		unsigned long long name_size;
+		Identity identity;
+	};
+
+	/**
+	 * get size, modified time and top level digests of the archive.
+	 * opening the archive reads its header only.
+	 */
+	bool archive_identity(const std::string& path, Identity& identity)
+	{
+		std::memset(&identity, 0, sizeof(Identity));
+		if (!UMAbcFileSystem::status(path, identity.size, identity.time)) return false;
+		try
+		{
+			Alembic::AbcCoreFactory::IFactory factory;
+			Alembic::Abc::IArchive archive = factory.getArchive(path);
+			if (!archive.valid()) return false;
+			Alembic::Abc::IObject top(archive, Alembic::Abc::kTop);
+			Alembic::Util::Digest properties_digest;
+			Alembic::Util::Digest children_digest;
+			if (top.getPropertiesHash(properties_digest) && top.getChildrenHash(children_digest))
+			{
+				std::memcpy(identity.properties_digest, properties_digest.d, sizeof(identity.properties_digest));
+				std::memcpy(identity.children_digest, children_digest.d, sizeof(identity.children_digest));
+				identity.has_digest = 1;
+			}
+		}
+		catch (...)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	template <class T>
+	bool read_array(std::ifstream& ifs, std::vector<T>& values, size_t count)
+	{
+		values.resize(count);
+		if (count == 0) return true;
+		return !!ifs.read(reinterpret_cast<char*>(&values[0]), count * sizeof(T));
+	}
+
+	template <class T>
+	bool write_array(std::ofstream& ofs, const std::vector<T>& values)
+	{
+		if (values.empty()) return true;
+		return !!ofs.write(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(T));
+	}
+} // anonymous namespace
+
+/**
+ * get path of the index of the archive
+ */
+std::string UMAbcSceneIndex::index_path(const std::string& path, const std::string& directory)
+{
+	if (directory.empty()) return path + kIndexExtension;
+
+	return directory + "/" + UMAbcFileSystem::hash_name(path) + kIndexExtension;
+}
+
+/**
+ * read the index of the archive
+ */
+bool UMAbcSceneIndex::read(
+	const std::string& path,
+	const std::string& directory,
+	UMAbcScene::Hierarchy& hierarchy)
+{
+	std::ifstream ifs(index_path(path, directory).c_str(), std::ios::binary);
+	if (!ifs) return false;
+	FileHeader header;
+	if (!ifs.read(reinterpret_cast<char*>(&header), sizeof(FileHeader))) return false;
+	if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+		|| header.version != kVersion
+		|| header.node_count == 0)
+	{
+		return false;
+	}
+
+	Identity identity;
+	if (!archive_identity(path, identity)
+		|| identity.size != header.identity.size
+		|| identity.time != header.identity.time
+		|| identity.has_digest != header.identity.has_digest
+		|| std::memcmp(identity.properties_digest, header.identity.properties_digest, sizeof(identity.properties_digest)) != 0
+		|| std::memcmp(identity.children_digest, header.identity.children_digest, sizeof(identity.children_digest)) != 0)
+	{
+		return false;
+	}
+
+	const size_t count = header.node_count;
+	UMAbcScene::Hierarchy result;
+	if (!read_array(ifs, result.times, count * 2)
+		|| !read_array(ifs, result.boxes, count * 6)
+		|| !read_array(ifs, result.parents, count)
+		|| !read_array(ifs, result.name_offsets, count + 1)
+		|| !read_array(ifs, result.types, count))
+	{
+		return false;
+	}
+	result.names.resize(static_cast<size_t>(header.name_size));
+	if (header.name_size > 0 && !ifs.read(&result.names[0], result.names.size())) return false;
+
+	// reject indices which would index out of their arrays
+	if (result.parents[0] != -1 || result.name_offsets[0] != 0 || result.name_offsets[count] != header.name_size) return false;
+	for (size_t i = 1; i < count; ++i)
+	{
+		if (result.parents[i] < 0 || static_cast<size_t>(result.parents[i]) >= i) return false;
+		if (result.name_offsets[i] < result.name_offsets[i - 1]) return false;
+	}
+	if (result.name_offsets[count] < result.name_offsets[count - 1]) return false;
+
+	hierarchy.parents.swap(result.parents);
+	hierarchy.types.swap(result.types);
+	hierarchy.times.swap(result.times);
+	hierarchy.boxes.swap(result.boxes);
+	hierarchy.names.swap(result.names);
+	hierarchy.name_offsets.swap(result.name_offsets);
+	return true;
+}
+
+/**
+ * write the index of the archive
+ */
+bool UMAbcSceneIndex::write(
+	const std::string& path,
+	const std::string& directory,
+	const UMAbcScene::Hierarchy& hierarchy)
+{
+	const size_t count = hierarchy.size();
+	if (count == 0
+		|| hierarchy.types.size() != count
+		|| hierarchy.times.size() != count * 2
+		|| hierarchy.boxes.size() != count * 6
+		|| hierarchy.name_offsets.size() != count + 1)
+	{
+		return false;
+	}
+
+	FileHeader header;
+	std::memset(&header, 0, sizeof(FileHeader));
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	header.node_count = static_cast<unsigned int>(count);
+	header.name_size = hierarchy.names.size();
+	if (!archive_identity(path, header.identity)) return false;
+
+	if (!directory.empty())
+	{
+		UMAbcFileSystem::create_directory(directory);
+	}
+
+	// readers never see a partly written index
+	const std::string out_path = index_path(path, directory);
+	const std::string temporary = UMAbcFileSystem::temporary_path(out_path);
+	{
+		std::ofstream ofs(temporary.c_str(), std::ios::binary | std::ios::trunc);
+		if (!ofs
+			|| !ofs.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader))
+			|| !write_array(ofs, hierarchy.times)
+			|| !write_array(ofs, hierarchy.boxes)
+			|| !write_array(ofs, hierarchy.parents)
+			|| !write_array(ofs, hierarchy.name_offsets)
+			|| !write_array(ofs, hierarchy.types)
+			|| (!hierarchy.names.empty() && !ofs.write(hierarchy.names.data(), hierarchy.names.size()))
+			|| !ofs.flush())
+		{
+			ofs.close();
+			std::remove(temporary.c_str());
+			return false;
+		}
+	}
+	if (!UMAbcFileSystem::replace(temporary, out_path))
+	{
+		std::remove(temporary.c_str());
+		return false;
+	}
+	return true;
+}
+
+/**
+ * get paths of nodes of the type in the order of UMAbcScene path lists
+ */
+std::vector<std::string> UMAbcSceneIndex::path_list(
+	const UMAbcScene::Hierarchy& hierarchy,
+	UMAbcScene::ObjectType type)
+{
+	std::vector<std::string> result;
+	const size_t count = hierarchy.size();
+	// parents come before their children, and the root is not part of paths
+	std::vector<std::string> paths(count);
+	for (size_t i = 1; i < count; ++i)
+	{
+		const unsigned int begin = hierarchy.name_offsets[i];
+		const unsigned int end = hierarchy.name_offsets[i + 1];
+		paths[i] = paths[hierarchy.parents[i]] + "/" + hierarchy.names.substr(begin, end - begin);
+		if (hierarchy.types[i] == type)
+		{
+			result.push_back(paths[i]);
+		}
+	}
+	return result;
+}
+
+} // umabc
@@ -0,0 +1,69 @@
+/**
+ * @file UMAbcSceneIndex.h
+ * sidecar file of the object hierarchy of an archive
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include "UMMacro.h"
+#include "UMAbcScene.h"
+
+namespace umabc
+{
+
+/**
+ * hierarchy of a scene as built on init, i.e. names, types, parents, time ranges
+ * and bounds at the first time of each object, kept beside the archive.
+ * the index records size, modified time and the top level digest of the archive,
+ * and is not read once any of them changed.
+ * hdf5 archives have no digest and are checked by size and modified time only.
+ */
+class UMAbcSceneIndex
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcSceneIndex);
+public:
+
+	/**
+	 * get path of the index of the archive
+	 * @param [in] path archive path
+	 * @param [in] directory index directory. empty puts the index beside the archive
+	 */
+	static std::string index_path(const std::string& path, const std::string& directory);
+
+	/**
+	 * read the index of the archive
+	 * @retval false when the index is missing, broken or older than the archive
+	 */
+	static bool read(
+		const std::string& path,
+		const std::string& directory,
+		UMAbcScene::Hierarchy& hierarchy);
+
+	/**
+	 * write the index of the archive
+	 * @retval succsess or fail
+	 */
+	static bool write(
+		const std::string& path,
+		const std::string& directory,
+		const UMAbcScene::Hierarchy& hierarchy);
+
+	/**
+	 * get paths of nodes of the type in the order of UMAbcScene path lists
+	 */
+	static std::vector<std::string> path_list(
+		const UMAbcScene::Hierarchy& hierarchy,
+		UMAbcScene::ObjectType type);
+
+private:
+	UMAbcSceneIndex() {}
+};
+
+} // umabc
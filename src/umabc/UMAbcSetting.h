@@ -11,6 +11,8 @@
 #pragma once
 
 #include <memory>
+#include <string>
+#include <vector>
 #include "UMMacro.h"
 
 /// uimac alembic library
@@ -22,12 +24,117 @@ class UMAbcSetting
 	DISALLOW_COPY_AND_ASSIGN(UMAbcSetting);
 public:
 
-	UMAbcSetting() {}
+	/**
+	 * how archives are read
+	 */
+	enum ReadMode
+	{
+		kReadStream, // file streams opened by alembic
+		kReadMapped, // memory mapped file. falls back to stream for hdf5
+		kReadPositional // pread on one descriptor. falls back to stream for hdf5
+	};
+
+	/**
+	 * expected access pattern of mapped archives
+	 */
+	enum ReadAccess
+	{
+		kReadAccessNormal,
+		kReadAccessRandom,
+		kReadAccessSequential
+	};
+
+	UMAbcSetting()
+		: read_mode_(kReadStream)
+		, read_access_(kReadAccessRandom)
+		, read_stream_count_(0)
+		, read_block_size_(64 * 1024)
+		, read_block_count_(256)
+		, export_type_("ogawa")
+		, export_min_time_(0)
+		, export_max_time_(-1)
+		, transcode_byte_budget_(4ULL * 1024 * 1024 * 1024)
+	{}
 	~UMAbcSetting() {}
 
-	std::string export_type() const { return "ogawa"; }
+	/**
+	 * core of saved archives. "ogawa" or "hdf5".
+	 */
+	std::string export_type() const { return export_type_; }
+	void set_export_type(const std::string& type) { export_type_ = type; }
+
+	/**
+	 * objects saved with their ancestors and descendants. empty saves all objects.
+	 */
+	const std::vector<std::string>& export_paths() const { return export_paths_; }
+	void set_export_paths(const std::vector<std::string>& paths) { export_paths_ = paths; }
+
+	/**
+	 * time range of saved samples in milliseconds. max below min saves all samples.
+	 */
+	double export_min_time() const { return export_min_time_; }
+	double export_max_time() const { return export_max_time_; }
+	void set_export_time_range(double min_time, double max_time)
+	{
+		export_min_time_ = min_time;
+		export_max_time_ = max_time;
+	}
+	bool has_export_time_range() const { return export_min_time_ <= export_max_time_; }
+
+	/**
+	 * directory of ogawa copies of hdf5 archives. hdf5 archives are copied there
+	 * on first load and the copy is read instead. empty reads hdf5 directly.
+	 */
+	std::string transcode_directory() const { return transcode_directory_; }
+	void set_transcode_directory(const std::string& directory) { transcode_directory_ = directory; }
+
+	/**
+	 * maximum total bytes of the copies. least recently used copies are removed over it.
+	 */
+	unsigned long long transcode_byte_budget() const { return transcode_byte_budget_; }
+	void set_transcode_byte_budget(unsigned long long byte_budget) { transcode_byte_budget_ = byte_budget; }
+
+	/**
+	 * how archives are read. kReadStream by default, other modes are opted in.
+	 */
+	ReadMode read_mode() const { return read_mode_; }
+	void set_read_mode(ReadMode mode) { read_mode_ = mode; }
+
+	ReadAccess read_access() const { return read_access_; }
+	void set_read_access(ReadAccess access) { read_access_ = access; }
+
+	/**
+	 * streams per archive. 0 is one per worker thread.
+	 * alembic hands out at most 64 streams.
+	 */
+	unsigned int read_stream_count() const { return read_stream_count_; }
+	void set_read_stream_count(unsigned int count) { read_stream_count_ = count; }
+
+	/**
+	 * block size of positional reads. smaller reads are served from whole blocks,
+	 * which merges reads of neighbouring samples. 0 disables blocks.
+	 */
+	size_t read_block_size() const { return read_block_size_; }
+	void set_read_block_size(size_t size) { read_block_size_ = size; }
+
+	/**
+	 * maximum blocks kept per archive
+	 */
+	size_t read_block_count() const { return read_block_count_; }
+	void set_read_block_count(size_t count) { read_block_count_ = count; }
 
 private:
+	ReadMode read_mode_;
+	ReadAccess read_access_;
+	unsigned int read_stream_count_;
+	size_t read_block_size_;
+	size_t read_block_count_;
+	std::string export_type_;
+	std::vector<std::string> export_paths_;
+	double export_min_time_;
+	double export_max_time_;
+	std::string transcode_directory_;
+	unsigned long long transcode_byte_budget_;
 };
 
 } // umabc
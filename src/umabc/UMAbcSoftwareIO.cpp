@@ -17,6 +17,12 @@
 #include <iostream>
 #include <algorithm>
 #include <functional>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+#include <cstdio>
 
 #include <Alembic/Abc/All.h>
 #include <Alembic/AbcGeom/All.h>
@@ -27,19 +33,72 @@
 #include "UMAbcSoftwareIO.h"
 #include "UMAbcScene.h"
 #include "UMAbcMesh.h"
+#include "UMAbcMappedFile.h"
+#include "UMAbcPositionalFile.h"
+#include "UMAbcParallel.h"
+#include "UMAbcSampleCache.h"
+#include "UMAbcTranscodeCache.h"
+#include "UMAbcFileSystem.h"
 
 namespace umabc
 {
 	using namespace Alembic::Abc;
 	using namespace Alembic::AbcGeom;
 
+namespace
+{
+	// stream ids handed out by AbcCoreOgawa
+	const size_t kMaxReadStreamCount = 64;
+} // anonymous namespace
+
 /**
  * load 3d file to UMAbcScene
  */
 UMAbcScenePtr UMAbcSoftwareIO::load(std::string path, const UMAbcSetting& setting)
 {
+	path = transcode(path, setting);
+
 	Alembic::AbcCoreFactory::IFactory factory;
-	IArchive archive = factory.getArchive(path);
+	IArchive archive;
+	UMAbcArchiveSourcePtr source;
+	if (setting.read_mode() == UMAbcSetting::kReadMapped)
+	{
+		if (UMAbcMappedFilePtr file = UMAbcMappedFile::open(path))
+		{
+			UMAbcMappedFile::Access access = UMAbcMappedFile::kAccessNormal;
+			if (setting.read_access() == UMAbcSetting::kReadAccessRandom)
+			{
+				access = UMAbcMappedFile::kAccessRandom;
+			}
+			else if (setting.read_access() == UMAbcSetting::kReadAccessSequential)
+			{
+				access = UMAbcMappedFile::kAccessSequential;
+			}
+			file->advise(access);
+			source = file;
+		}
+	}
+	else if (setting.read_mode() == UMAbcSetting::kReadPositional)
+	{
+		if (UMAbcPositionalFilePtr file = UMAbcPositionalFile::open(path))
+		{
+			file->set_block_cache(setting.read_block_size(), setting.read_block_count());
+			source = file;
+		}
+	}
+	// alembic reads ogawa only from streams
+	if (source && source->is_ogawa())
+	{
+		const size_t stream_count = std::min<size_t>(kMaxReadStreamCount,
+			setting.read_stream_count() > 0 ? setting.read_stream_count() : parallel_worker_count());
+		Alembic::AbcCoreFactory::IFactory::CoreType core_type;
+		archive = factory.getArchive(source->create_streams(stream_count), core_type);
+	}
+	if (!archive.valid())
+	{
+		source = UMAbcArchiveSourcePtr();
+		archive = factory.getArchive(path);
+	}
 
 	if (!archive.valid()) { return UMAbcScenePtr(); }
 
@@ -51,139 +110,429 @@ UMAbcScenePtr UMAbcSoftwareIO::load(std::string path, const UMAbcSetting& settin
 	AbcA::MetaData meta_data = archive.getPtr()->getMetaData();
 
 	UMAbcScenePtr scene = std::make_shared<UMAbcScene>(object);
+	scene->set_archive_source(source);
 	scene->init();
 
 	return scene;
 }
 
-static void copy_props(Alembic::Abc::ICompoundProperty & iRead, Alembic::Abc::OCompoundProperty & iWrite)
+namespace
 {
-	std::size_t numChildren = iRead.getNumProperties();
-	for (std::size_t i = 0; i < numChildren; ++i)
+	// bytes of samples read ahead of the writer
+	const size_t kCopyQueueByteSize = 64 * 1024 * 1024;
+
+	/**
+	 * copies an archive. array samples are read on a worker thread while the
+	 * calling thread writes them. repeated samples are written from previous
+	 * by their digest without reading, and ogawa shares equal samples by digest.
+	 */
+	class ArchiveCopy
 	{
-		Alembic::AbcCoreAbstract::PropertyHeader header =
-			iRead.getPropertyHeader(i);
-		if (header.isArray())
+		DISALLOW_COPY_AND_ASSIGN(ArchiveCopy);
+	public:
+		ArchiveCopy(const UMAbcSetting& setting)
+			: paths_(setting.export_paths())
+			, has_time_range_(setting.has_export_time_range())
+			, min_time_(setting.export_min_time() / 1000.0)
+			, max_time_(setting.export_max_time() / 1000.0)
+			, queue_byte_size_(0)
+			, is_read_done_(false)
+			, is_failed_(false)
+		{}
+
+		/**
+		 * create objects and properties and copy scalar samples
+		 */
+		void copy_object(IObject& in, OObject& out, const std::string& path)
 		{
-			Alembic::Abc::IArrayProperty inProp(iRead, header.getName());
-			Alembic::Abc::OArrayProperty outProp(iWrite, header.getName(),
-				header.getDataType(), header.getMetaData(),
-				header.getTimeSampling());
+			ICompoundProperty in_props = in.getProperties();
+			OCompoundProperty out_props = out.getProperties();
+			copy_props(in_props, out_props);
 
-			std::size_t numSamples = inProp.getNumSamples();
+			for (size_t i = 0, size = in.getNumChildren(); i < size; ++i)
+			{
+				IObject child_in(in.getChild(i));
+				const std::string child_path = path + "/" + child_in.getName();
+				if (!is_exported(child_path)) continue;
+				OObject child_out(out, child_in.getName(), child_in.getMetaData());
+				copy_object(child_in, child_out, child_path);
+			}
+		}
 
-			for (std::size_t j = 0; j < numSamples; ++j)
+		/**
+		 * copy array samples. reads on a worker thread and writes on this thread.
+		 * @retval succsess or fail
+		 */
+		bool copy_arrays()
+		{
+			std::thread reader(&ArchiveCopy::read_arrays, this);
+			std::unique_lock<std::mutex> lock(mutex_);
+			for (;;)
 			{
-				Alembic::AbcCoreAbstract::ArraySamplePtr samp;
-				Alembic::Abc::ISampleSelector sel((Alembic::Abc::index_t) j);
-				inProp.get(samp, sel);
-				outProp.set(*samp);
+				condition_.wait(lock, [this] { return !queue_.empty() || is_read_done_; });
+				if (queue_.empty()) break;
+				QueueItem item = queue_.front();
+				queue_.pop_front();
+				queue_byte_size_ -= item.byte_size;
+				lock.unlock();
+				condition_.notify_all();
+
+				ArrayCopy& copy = arrays_[item.array];
+				if (item.sample)
+				{
+					copy.out.set(*item.sample);
+				}
+				else
+				{
+					copy.out.setFromPrevious();
+				}
+				lock.lock();
+			}
+			lock.unlock();
+			reader.join();
+			return !is_failed_;
+		}
+
+	private:
+		struct ArrayCopy
+		{
+			IArrayProperty in;
+			OArrayProperty out;
+			index_t first;
+			index_t last;
+		};
+
+		struct QueueItem
+		{
+			size_t array;
+			AbcA::ArraySamplePtr sample; // null writes from previous
+			size_t byte_size;
+		};
+
+		/**
+		 * is the path one of export paths, their ancestors or descendants
+		 */
+		bool is_exported(const std::string& path) const
+		{
+			if (paths_.empty()) return true;
+			for (size_t i = 0, size = paths_.size(); i < size; ++i)
+			{
+				const std::string& target = paths_[i];
+				const std::string& shorter = path.size() < target.size() ? path : target;
+				const std::string& longer = path.size() < target.size() ? target : path;
+				if (longer.compare(0, shorter.size(), shorter) == 0
+					&& (longer.size() == shorter.size() || longer[shorter.size()] == '/'))
+				{
+					return true;
+				}
 			}
+			return false;
 		}
-		else if (header.isScalar())
+
+		/**
+		 * get range of samples in the export time range and time sampling of them
+		 * @retval has samples or not
+		 */
+		bool sample_range(
+			AbcA::TimeSamplingPtr sampling,
+			size_t sample_count,
+			index_t& first,
+			index_t& last,
+			AbcA::TimeSamplingPtr& result) const
 		{
-			Alembic::Abc::IScalarProperty inProp(iRead, header.getName());
-			Alembic::Abc::OScalarProperty outProp(iWrite, header.getName(),
-				header.getDataType(), header.getMetaData(),
-				header.getTimeSampling());
-
-			std::size_t numSamples = inProp.getNumSamples();
-			std::vector<std::string> sampStrVec;
-			std::vector<std::wstring> sampWStrVec;
-			if (header.getDataType().getPod() == Alembic::AbcCoreAbstract::kStringPOD)
+			result = sampling;
+			first = 0;
+			last = static_cast<index_t>(sample_count) - 1;
+			if (sample_count == 0) return false;
+			if (!has_time_range_ || sample_count == 1 || !sampling) return true;
+
+			first = sampling->getCeilIndex(min_time_, sample_count).first;
+			last = sampling->getFloorIndex(max_time_, sample_count).first;
+			if (sampling->getSampleTime(first) < min_time_ || sampling->getSampleTime(last) > max_time_
+				|| first > last)
+			{
+				// keep one sample so that the property has a value
+				first = last = sampling->getNearIndex(min_time_, sample_count).first;
+			}
+			if (first == 0) return true;
+
+			// shift sampling so that the first kept sample is index 0
+			const AbcA::TimeSamplingType type = sampling->getTimeSamplingType();
+			std::vector<chrono_t> times;
+			if (type.isAcyclic())
 			{
-				sampStrVec.resize(header.getDataType().getExtent());
+				for (index_t i = first; i <= last; ++i)
+				{
+					times.push_back(sampling->getSampleTime(i));
+				}
 			}
-			else if (header.getDataType().getPod() == Alembic::AbcCoreAbstract::kWstringPOD)
+			else
 			{
-				sampWStrVec.resize(header.getDataType().getExtent());
+				for (uint32_t i = 0; i < type.getNumSamplesPerCycle(); ++i)
+				{
+					times.push_back(sampling->getSampleTime(first + i));
+				}
 			}
+			result = std::make_shared<AbcA::TimeSampling>(type, times);
+			return true;
+		}
 
-			char samp[4096];
+		void copy_props(ICompoundProperty& in, OCompoundProperty& out)
+		{
+			for (size_t i = 0, size = in.getNumProperties(); i < size; ++i)
+			{
+				const AbcA::PropertyHeader& header = in.getPropertyHeader(i);
+				if (header.isArray())
+				{
+					IArrayProperty in_prop(in, header.getName());
+					ArrayCopy copy;
+					AbcA::TimeSamplingPtr sampling;
+					const bool has_sample = sample_range(
+						header.getTimeSampling(), in_prop.getNumSamples(), copy.first, copy.last, sampling);
+					copy.in = in_prop;
+					copy.out = OArrayProperty(out, header.getName(),
+						header.getDataType(), header.getMetaData(), sampling);
+					if (has_sample)
+					{
+						arrays_.push_back(copy);
+					}
+				}
+				else if (header.isScalar())
+				{
+					copy_scalar(in, out, header);
+				}
+				else if (header.isCompound())
+				{
+					OCompoundProperty out_prop(out, header.getName(), header.getMetaData());
+					ICompoundProperty in_prop(in, header.getName());
+					copy_props(in_prop, out_prop);
+				}
+			}
+		}
 
-			for (std::size_t j = 0; j < numSamples; ++j)
+		void copy_scalar(ICompoundProperty& in, OCompoundProperty& out, const AbcA::PropertyHeader& header)
+		{
+			IScalarProperty in_prop(in, header.getName());
+			index_t first = 0;
+			index_t last = 0;
+			AbcA::TimeSamplingPtr sampling;
+			const bool has_sample = sample_range(
+				header.getTimeSampling(), in_prop.getNumSamples(), first, last, sampling);
+			OScalarProperty out_prop(out, header.getName(),
+				header.getDataType(), header.getMetaData(), sampling);
+			if (!has_sample) return;
+
+			const AbcA::PlainOldDataType pod = header.getDataType().getPod();
+			std::vector<std::string> strings;
+			std::vector<std::wstring> wstrings;
+			if (pod == AbcA::kStringPOD)
+			{
+				strings.resize(header.getDataType().getExtent());
+			}
+			else if (pod == AbcA::kWstringPOD)
 			{
-				Alembic::Abc::ISampleSelector sel(
-					(Alembic::Abc::index_t) j);
+				wstrings.resize(header.getDataType().getExtent());
+			}
 
-				if (header.getDataType().getPod() ==
-					Alembic::AbcCoreAbstract::kStringPOD)
+			char sample[4096];
+			for (index_t j = first; j <= last; ++j)
+			{
+				ISampleSelector selector(j);
+				if (pod == AbcA::kStringPOD)
 				{
-					inProp.get(&sampStrVec.front(), sel);
-					outProp.set(&sampStrVec.front());
+					in_prop.get(&strings.front(), selector);
+					out_prop.set(&strings.front());
 				}
-				else if (header.getDataType().getPod() ==
-					Alembic::AbcCoreAbstract::kWstringPOD)
+				else if (pod == AbcA::kWstringPOD)
 				{
-					inProp.get(&sampWStrVec.front(), sel);
-					outProp.set(&sampWStrVec.front());
+					in_prop.get(&wstrings.front(), selector);
+					out_prop.set(&wstrings.front());
 				}
 				else
 				{
-					inProp.get(samp, sel);
-					outProp.set(samp);
+					in_prop.get(sample, selector);
+					out_prop.set(sample);
 				}
 			}
 		}
-		else if (header.isCompound())
+
+		/**
+		 * worker loop reading array samples into the queue
+		 */
+		void read_arrays()
+		{
+			try
+			{
+				for (size_t i = 0, size = arrays_.size(); i < size; ++i)
+				{
+					ArrayCopy& copy = arrays_[i];
+					AbcA::ArraySampleKey previous_key;
+					bool has_previous = false;
+					for (index_t j = copy.first; j <= copy.last; ++j)
+					{
+						ISampleSelector selector(j);
+						QueueItem item;
+						item.array = i;
+						item.byte_size = 0;
+						AbcA::ArraySampleKey key;
+						const bool has_key = copy.in.getKey(key, selector);
+						if (!(has_key && has_previous && key == previous_key))
+						{
+							copy.in.get(item.sample, selector);
+							if (!item.sample)
+							{
+								// a property cut short would be saved as if complete
+								throw std::runtime_error("read");
+							}
+							item.byte_size = UMAbcSampleCache::sample_byte_size(item.sample);
+						}
+						has_previous = has_key;
+						previous_key = key;
+						push(item);
+					}
+				}
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				is_failed_ = true;
+			}
+			std::lock_guard<std::mutex> lock(mutex_);
+			is_read_done_ = true;
+			condition_.notify_all();
+		}
+
+		void push(const QueueItem& item)
 		{
-			Alembic::Abc::OCompoundProperty outProp(iWrite, header.getName(), header.getMetaData());
-			Alembic::Abc::ICompoundProperty inProp(iRead, header.getName());
-			copy_props(inProp, outProp);
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this] {
+				return queue_.empty() || queue_byte_size_ < kCopyQueueByteSize;
+			});
+			queue_.push_back(item);
+			queue_byte_size_ += item.byte_size;
+			condition_.notify_all();
 		}
-	}
-}
 
-static void copy_object(Alembic::Abc::IObject & iIn, Alembic::Abc::OObject & iOut)
+		std::vector<std::string> paths_;
+		bool has_time_range_;
+		chrono_t min_time_;
+		chrono_t max_time_;
+		std::vector<ArrayCopy> arrays_;
+
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		std::deque<QueueItem> queue_;
+		size_t queue_byte_size_;
+		bool is_read_done_;
+		bool is_failed_;
+	};
+} // anonymous namespace
+
+namespace
 {
-	std::size_t numChildren = iIn.getNumChildren();
+	/**
+	 * write the objects under the top object to a new archive
+	 */
+	bool write_archive(IObject& top_object, const std::string& path, const UMAbcSetting& setting)
+	{
+		IArchive in_archive = top_object.getArchive();
 
-	Alembic::Abc::ICompoundProperty inProps = iIn.getProperties();
-	Alembic::Abc::OCompoundProperty outProps = iOut.getProperties();
-	copy_props(inProps, outProps);
+		Alembic::Abc::OArchive archive;
+		if (setting.export_type() == "hdf5")
+		{
+			archive = Alembic::Abc::OArchive(
+				Alembic::AbcCoreHDF5::WriteArchive(),
+				path, top_object.getMetaData(),
+				Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+		}
+		else
+		{
+			archive = Alembic::Abc::OArchive(
+				Alembic::AbcCoreOgawa::WriteArchive(),
+				path, top_object.getMetaData(),
+				Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+		}
+		if (!archive.valid()) { return false; }
 
-	for (std::size_t i = 0; i < numChildren; ++i)
-	{
-		Alembic::Abc::IObject childIn(iIn.getChild(i));
-		Alembic::Abc::OObject childOut(iOut, childIn.getName(), childIn.getMetaData());
-		copy_object(childIn, childOut);
+		// keep time sampling indices of the source when samples are not shifted
+		if (!setting.has_export_time_range())
+		{
+			for (Alembic::Util::uint32_t i = 1; i < in_archive.getNumTimeSamplings(); ++i)
+			{
+				archive.addTimeSampling(*in_archive.getTimeSampling(i));
+			}
+		}
+
+		ArchiveCopy copy(setting);
+		Alembic::Abc::OObject out_top_object = archive.getTop();
+		copy.copy_object(top_object, out_top_object, std::string());
+		return copy.copy_arrays();
 	}
-}
+} // anonymous namespace
 
 /**
 * save 3d file
 */
 bool UMAbcSoftwareIO::save(std::string path, UMAbcScenePtr scene, const UMAbcSetting& setting)
 {
-	Alembic::Abc::OArchive archive;
+	if (!scene) { return false; }
 	UMAbcObjectPtr root = scene->root_object();
 	if (!root) { return false; }
 	IObject top_object = *root->object();
 
-	const std::string& out_file = path;
-	if (setting.export_type() == "ogawa")
+	// the target may be an archive mapped by a loaded scene, even the source itself.
+	// truncating it would pull pages from under the mapping, so it is replaced by rename
+	// and open mappings keep the old file.
+	const std::string temporary = UMAbcFileSystem::temporary_path(path);
+	bool is_written = false;
+	try
 	{
-		archive = Alembic::Abc::OArchive(
-			Alembic::AbcCoreHDF5::WriteArchive(),
-			out_file, top_object.getMetaData(),
-			Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+		is_written = write_archive(top_object, temporary, setting);
 	}
-	else 
+	catch (...)
 	{
-		archive = Alembic::Abc::OArchive(
-			Alembic::AbcCoreOgawa::WriteArchive(),
-			out_file, top_object.getMetaData(),
-			Alembic::Abc::ErrorHandler::kQuietNoopPolicy);
+		is_written = false;
 	}
+	if (is_written && UMAbcFileSystem::replace(temporary, path)) return true;
+	std::remove(temporary.c_str());
+	return false;
+}
 
-	for (Alembic::Util::uint32_t i = 1; i < archive.getNumTimeSamplings(); ++i)
+/**
+ * get path of the ogawa copy of an hdf5 archive
+ */
+std::string UMAbcSoftwareIO::transcode(const std::string& path, const UMAbcSetting& setting)
+{
+	if (setting.transcode_directory().empty() || !UMAbcTranscodeCache::is_hdf5(path)) return path;
+	UMAbcTranscodeCache cache(setting.transcode_directory(), setting.transcode_byte_budget());
+	const std::string copy_path = cache.copy_path(path);
+	if (copy_path.empty()) return path;
+	if (cache.find(copy_path)) return copy_path;
+
+	// the copy is complete when the output archive is closed at the end of write_archive
+	bool is_copied = false;
+	try
+	{
+		Alembic::AbcCoreFactory::IFactory factory;
+		IArchive archive = factory.getArchive(path);
+		if (archive.valid())
+		{
+			UMAbcSetting copy_setting;
+			IObject top_object = archive.getTop();
+			is_copied = write_archive(top_object, cache.temporary_path(copy_path), copy_setting);
+		}
+	}
+	catch (...)
 	{
-		archive.addTimeSampling(*archive.getTimeSampling(i));
+		is_copied = false;
 	}
-	Alembic::Abc::OObject out_top_object = archive.getTop();
-	copy_object(top_object, out_top_object);
-
-	return true;
+	if (!is_copied || !cache.commit(copy_path))
+	{
+		cache.discard(copy_path);
+		return path;
+	}
+	cache.trim(copy_path);
+	return copy_path;
 }
 
 /**
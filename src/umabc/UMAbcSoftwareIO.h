@@ -66,6 +66,11 @@ public:
 	bool save_setting(std::string path, const UMAbcSetting& setting);
 
 private:
+	/**
+	 * get path of the ogawa copy of an hdf5 archive, copying it when missing.
+	 * returns the path itself when the archive is not copied.
+	 */
+	std::string transcode(const std::string& path, const UMAbcSetting& setting);
 };
 
 } // umabc
@@ -0,0 +1,199 @@
+/**
+ * @file UMAbcTranscodeCache.cpp
+ * local directory of archives transcoded to ogawa
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcTranscodeCache.h"
+#include "UMAbcFileSystem.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <utime.h>
+#include <sys/types.h>
+#endif
+
+namespace umabc
+{
+
+namespace
+{
+	const char kCopyExtension[] = ".abc";
+
+	struct FileStatus
+	{
+		std::string path;
+		unsigned long long size;
+		unsigned long long time; // modified time in 100ns or 1ns units. only compared
+	};
+
+	bool file_status(const std::string& path, FileStatus& status)
+	{
+		status.path = path;
+		return UMAbcFileSystem::status(path, status.size, status.time);
+	}
+
+	/**
+	 * set modified time of the file to now
+	 */
+	void touch(const std::string& path)
+	{
+#ifdef _WIN32
+		HANDLE handle = CreateFileA(path.c_str(), FILE_WRITE_ATTRIBUTES,
+			FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+		if (handle == INVALID_HANDLE_VALUE) return;
+		FILETIME now;
+		GetSystemTimeAsFileTime(&now);
+		SetFileTime(handle, NULL, NULL, &now);
+		CloseHandle(handle);
+#else
+		utime(path.c_str(), NULL);
+#endif
+	}
+
+	void list_copies(const std::string& directory, std::vector<FileStatus>& copies)
+	{
+		const size_t extension_size = sizeof(kCopyExtension) - 1;
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE handle = FindFirstFileA((directory + "\\*" + kCopyExtension).c_str(), &data);
+		if (handle == INVALID_HANDLE_VALUE) return;
+		do
+		{
+			const std::string name = data.cFileName;
+#else
+		DIR* dir = opendir(directory.c_str());
+		if (!dir) return;
+		while (struct dirent* data = readdir(dir))
+		{
+			const std::string name = data->d_name;
+#endif
+			FileStatus status;
+			if (name.size() > extension_size
+				&& name.compare(name.size() - extension_size, extension_size, kCopyExtension) == 0
+				&& file_status(directory + "/" + name, status))
+			{
+				copies.push_back(status);
+			}
+#ifdef _WIN32
+		} while (FindNextFileA(handle, &data));
+		FindClose(handle);
+#else
+		}
+		closedir(dir);
+#endif
+	}
+
+	bool is_older(const FileStatus& a, const FileStatus& b)
+	{
+		return a.time < b.time;
+	}
+} // anonymous namespace
+
+UMAbcTranscodeCache::UMAbcTranscodeCache(const std::string& directory, unsigned long long byte_budget)
+	: directory_(directory)
+	, byte_budget_(byte_budget)
+{
+	UMAbcFileSystem::create_directory(directory_);
+}
+
+/**
+ * is the file an hdf5 archive
+ */
+bool UMAbcTranscodeCache::is_hdf5(const std::string& path)
+{
+	static const char kSignature[8] = { '\x89', 'H', 'D', 'F', '\r', '\n', '\x1a', '\n' };
+	char signature[8] = {};
+	std::ifstream ifs(path.c_str(), std::ios::binary);
+	if (!ifs.read(signature, sizeof(signature))) return false;
+	return std::memcmp(signature, kSignature, sizeof(signature)) == 0;
+}
+
+/**
+ * get path of the copy of the source
+ */
+std::string UMAbcTranscodeCache::copy_path(const std::string& source_path) const
+{
+	FileStatus status;
+	if (!file_status(source_path, status)) return std::string();
+
+	// named by the source identity
+	std::ostringstream identity;
+	identity << source_path << '\n' << status.size << '\n' << status.time;
+	return directory_ + "/" + UMAbcFileSystem::hash_name(identity.str()) + kCopyExtension;
+}
+
+/**
+ * find the copy and mark it used
+ */
+bool UMAbcTranscodeCache::find(const std::string& copy_path) const
+{
+	FileStatus status;
+	if (copy_path.empty() || !file_status(copy_path, status)) return false;
+	touch(copy_path);
+	return true;
+}
+
+/**
+ * get path to write the copy to
+ */
+std::string UMAbcTranscodeCache::temporary_path(const std::string& copy_path) const
+{
+	// processes sharing the directory write their own temporary files
+	return UMAbcFileSystem::temporary_path(copy_path);
+}
+
+/**
+ * move the written temporary file to the copy path
+ */
+bool UMAbcTranscodeCache::commit(const std::string& copy_path) const
+{
+	return UMAbcFileSystem::replace(temporary_path(copy_path), copy_path);
+}
+
+/**
+ * remove the temporary file of a failed copy
+ */
+void UMAbcTranscodeCache::discard(const std::string& copy_path) const
+{
+	std::remove(temporary_path(copy_path).c_str());
+}
+
+/**
+ * remove least recently used copies over the byte budget
+ */
+void UMAbcTranscodeCache::trim(const std::string& keep_path) const
+{
+	std::vector<FileStatus> copies;
+	list_copies(directory_, copies);
+	unsigned long long total_size = 0;
+	for (size_t i = 0, size = copies.size(); i < size; ++i)
+	{
+		total_size += copies[i].size;
+	}
+	std::sort(copies.begin(), copies.end(), is_older);
+	for (size_t i = 0, size = copies.size(); i < size && total_size > byte_budget_; ++i)
+	{
+		if (copies[i].path == keep_path) continue;
+		// a copy still opened elsewhere may fail to be removed on windows
+		if (std::remove(copies[i].path.c_str()) == 0)
+		{
+			total_size -= copies[i].size;
+		}
+	}
+}
+
+} // umabc
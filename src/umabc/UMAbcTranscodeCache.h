@@ -0,0 +1,81 @@
+/**
+ * @file UMAbcTranscodeCache.h
+ * local directory of archives transcoded to ogawa
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <string>
+#include "UMMacro.h"
+
+namespace umabc
+{
+
+/**
+ * names transcoded copies by source path, size and modified time,
+ * so a changed source gets a new copy and the stale one ages out.
+ * a used copy is touched, and the least recently used copies are removed
+ * while the directory is over its byte budget.
+ */
+class UMAbcTranscodeCache
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcTranscodeCache);
+public:
+
+	/**
+	 * @param [in] directory cache directory. created when missing
+	 * @param [in] byte_budget maximum total bytes of copies
+	 */
+	UMAbcTranscodeCache(const std::string& directory, unsigned long long byte_budget);
+	~UMAbcTranscodeCache() {}
+
+	/**
+	 * is the file an hdf5 archive
+	 */
+	static bool is_hdf5(const std::string& path);
+
+	/**
+	 * get path of the copy of the source
+	 * @retval copy path or empty when the source is missing
+	 */
+	std::string copy_path(const std::string& source_path) const;
+
+	/**
+	 * find the copy and mark it used
+	 * @retval exists or not
+	 */
+	bool find(const std::string& copy_path) const;
+
+	/**
+	 * get path to write the copy to before it is complete
+	 */
+	std::string temporary_path(const std::string& copy_path) const;
+
+	/**
+	 * move the written temporary file to the copy path
+	 * @retval succsess or fail
+	 */
+	bool commit(const std::string& copy_path) const;
+
+	/**
+	 * remove the temporary file of a failed copy
+	 */
+	void discard(const std::string& copy_path) const;
+
+	/**
+	 * remove least recently used copies over the byte budget
+	 * @param [in] keep_path copy never removed
+	 */
+	void trim(const std::string& keep_path) const;
+
+private:
+	std::string directory_;
+	unsigned long long byte_budget_;
+};
+
+} // umabc
@@ -0,0 +1,564 @@
+/**
+ * @file UMAbcWriter.cpp
+ * archive written frame by frame
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#include "UMAbcWriter.h"
+
+#include <vector>
+#include <cmath>
+#include <Alembic/Abc/All.h>
+#include <Alembic/AbcGeom/All.h>
+#include <Alembic/AbcCoreHDF5/All.h>
+#include <Alembic/AbcCoreOgawa/All.h>
+
+namespace umabc
+{
+	using namespace Alembic::Abc;
+	using namespace Alembic::AbcGeom;
+
+namespace
+{
+	/**
+	 * keeps the key of the last written topology, so that an equal topology
+	 * is written from previous instead of being stored again.
+	 * the sample is digested once here, as alembic would digest it on storing.
+	 */
+	class TopologyKey
+	{
+	public:
+		TopologyKey() : has_key_(false) {}
+
+		/**
+		 * get the sample to write. empty when it equals the previous sample.
+		 */
+		template <class T>
+		T next(const T& sample)
+		{
+			if (!sample.getData()) return sample;
+			const AbcA::ArraySampleKey key = sample.getKey();
+			if (has_key_ && key == key_) return T();
+			key_ = key;
+			has_key_ = true;
+			return sample;
+		}
+
+	private:
+		AbcA::ArraySampleKey key_;
+		bool has_key_;
+	};
+
+	GeometryScope width_scope(size_t width_count, size_t vertex_count, size_t curve_size)
+	{
+		if (width_count == 1) return kConstantScope;
+		if (width_count == vertex_count) return kVertexScope;
+		if (width_count == curve_size) return kUniformScope;
+		return kVertexScope;
+	}
+
+	/**
+	 * get scope of mesh normals or uvs from their count.
+	 * face vertex scope is taken when the count matches both.
+	 * @retval false when the count matches neither
+	 */
+	bool mesh_scope(size_t count, size_t vertex_count, size_t index_count, GeometryScope& scope)
+	{
+		if (count == index_count)
+		{
+			scope = kFacevaryingScope;
+			return true;
+		}
+		if (count == vertex_count)
+		{
+			scope = kVertexScope;
+			return true;
+		}
+		return false;
+	}
+
+	enum ObjectType
+	{
+		kTypeTop,
+		kTypeXform,
+		kTypeMesh,
+		kTypePoint,
+		kTypeCurve
+	};
+} // anonymous namespace
+
+class UMAbcWriter::Impl
+{
+	DISALLOW_COPY_AND_ASSIGN(Impl);
+public:
+	Impl(double start_time, double frame_time)
+		: start_time_(start_time)
+		, frame_time_(frame_time)
+	{}
+
+	~Impl()
+	{
+		close();
+	}
+
+	bool open(const std::string& path, const UMAbcSetting& setting)
+	{
+		try
+		{
+			if (setting.export_type() == "hdf5")
+			{
+				archive_ = OArchive(Alembic::AbcCoreHDF5::WriteArchive(), path);
+			}
+			else
+			{
+				archive_ = OArchive(Alembic::AbcCoreOgawa::WriteArchive(), path);
+			}
+		}
+		catch (...)
+		{
+			return false;
+		}
+		if (!archive_.valid()) return false;
+
+		ObjectEntryPtr top = std::make_shared<ObjectEntry>(kTypeTop);
+		top->object = archive_.getTop();
+		objects_.push_back(top);
+		return true;
+	}
+
+	int add_object(int parent, const std::string& name, ObjectType type)
+	{
+		ObjectEntryPtr parent_entry = find(parent);
+		if (!parent_entry || (parent_entry->type != kTypeTop && parent_entry->type != kTypeXform)) return -1;
+		if (name.empty()) return -1;
+
+		ObjectEntryPtr entry = std::make_shared<ObjectEntry>(type);
+		try
+		{
+			OObject& parent_object = parent_entry->object;
+			switch (type)
+			{
+			case kTypeXform:
+				entry->xform = OXform(parent_object, name);
+				entry->object = entry->xform;
+				break;
+			case kTypeMesh:
+				entry->mesh = OPolyMesh(parent_object, name);
+				entry->object = entry->mesh;
+				break;
+			case kTypePoint:
+				entry->point = OPoints(parent_object, name);
+				entry->object = entry->point;
+				break;
+			case kTypeCurve:
+				entry->curve = OCurves(parent_object, name);
+				entry->object = entry->curve;
+				break;
+			default:
+				return -1;
+			}
+		}
+		catch (...)
+		{
+			// name is taken
+			return -1;
+		}
+		objects_.push_back(entry);
+		return static_cast<int>(objects_.size() - 1);
+	}
+
+	bool write_xform(int object, double time, const double* matrix)
+	{
+		ObjectEntryPtr entry = find(object, kTypeXform);
+		if (!entry || !matrix) return false;
+		OXformSchema& schema = entry->xform.getSchema();
+		if (!advance(*entry, schema, time)) return false;
+
+		M44d local;
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int k = 0; k < 4; ++k)
+			{
+				local[i][k] = matrix[i * 4 + k];
+			}
+		}
+		XformSample sample;
+		sample.setMatrix(local);
+		return set(*entry, schema, sample);
+	}
+
+	bool write_mesh(int object, double time, const MeshSample& sample)
+	{
+		ObjectEntryPtr entry = find(object, kTypeMesh);
+		if (!entry) return false;
+		if (entry->frame_count == 0 && (!sample.vertex || !sample.index)) return false;
+		if (sample.index && !sample.face_count && sample.index_count % 3 != 0) return false;
+		const size_t vertex_count = sample.vertex ? sample.vertex_count : entry->vertex_count;
+		const size_t index_count = sample.index ? sample.index_count : entry->index_count;
+		// face counts without index are faces of the last written index
+		if (sample.face_count)
+		{
+			size_t face_index_count = 0;
+			for (size_t i = 0; i < sample.face_size; ++i)
+			{
+				if (sample.face_count[i] < 0) return false;
+				face_index_count += static_cast<size_t>(sample.face_count[i]);
+			}
+			if (face_index_count != index_count) return false;
+		}
+		GeometryScope normal_scope = kFacevaryingScope;
+		GeometryScope uv_scope = kFacevaryingScope;
+		if ((sample.normal && !mesh_scope(sample.normal_count, vertex_count, index_count, normal_scope))
+			|| (sample.uv && !mesh_scope(sample.uv_count, vertex_count, index_count, uv_scope)))
+		{
+			return false;
+		}
+		OPolyMeshSchema& schema = entry->mesh.getSchema();
+		if (!advance(*entry, schema, time)) return false;
+		entry->vertex_count = vertex_count;
+		entry->index_count = index_count;
+
+		OPolyMeshSchema::Sample mesh_sample;
+		if (sample.vertex)
+		{
+			mesh_sample.setPositions(P3fArraySample(
+				reinterpret_cast<const V3f*>(sample.vertex), sample.vertex_count));
+		}
+		if (sample.index)
+		{
+			mesh_sample.setFaceIndices(entry->index_key.next(
+				Int32ArraySample(sample.index, sample.index_count)));
+		}
+		if (sample.face_count)
+		{
+			entry->is_generated = false;
+			mesh_sample.setFaceCounts(entry->count_key.next(
+				Int32ArraySample(sample.face_count, sample.face_size)));
+		}
+		else if (sample.index)
+		{
+			// counts of triangles change only with the number of faces
+			const size_t face_size = sample.index_count / 3;
+			if (!entry->is_generated || entry->counts.size() != face_size || entry->frame_count == 0)
+			{
+				entry->counts.assign(face_size, 3);
+				entry->is_generated = true;
+				mesh_sample.setFaceCounts(entry->count_key.next(
+					Int32ArraySample(entry->counts.empty() ? NULL : &entry->counts[0], face_size)));
+			}
+		}
+		if (sample.normal)
+		{
+			mesh_sample.setNormals(ON3fGeomParam::Sample(N3fArraySample(
+				reinterpret_cast<const N3f*>(sample.normal), sample.normal_count), normal_scope));
+		}
+		if (sample.uv)
+		{
+			mesh_sample.setUVs(OV2fGeomParam::Sample(V2fArraySample(
+				reinterpret_cast<const V2f*>(sample.uv), sample.uv_count), uv_scope));
+		}
+		return set(*entry, schema, mesh_sample);
+	}
+
+	bool write_point(int object, double time, const PointSample& sample)
+	{
+		ObjectEntryPtr entry = find(object, kTypePoint);
+		if (!entry) return false;
+		if (entry->frame_count == 0 && !sample.vertex) return false;
+		const size_t vertex_count = sample.vertex ? sample.vertex_count : entry->vertex_count;
+		OPointsSchema& schema = entry->point.getSchema();
+		if (!advance(*entry, schema, time)) return false;
+		entry->vertex_count = vertex_count;
+
+		OPointsSchema::Sample point_sample;
+		if (sample.vertex)
+		{
+			point_sample.setPositions(P3fArraySample(
+				reinterpret_cast<const V3f*>(sample.vertex), sample.vertex_count));
+		}
+		// alembic ids are 64 bit, so given ids are widened into the reused buffer
+		if (sample.id)
+		{
+			entry->ids.assign(sample.id, sample.id + sample.id_count);
+			entry->is_generated = false;
+			point_sample.setIds(entry->index_key.next(
+				UInt64ArraySample(entry->ids.empty() ? NULL : &entry->ids[0], entry->ids.size())));
+		}
+		else if (sample.vertex && (!entry->is_generated
+			|| entry->ids.size() != sample.vertex_count || entry->frame_count == 0))
+		{
+			entry->ids.resize(sample.vertex_count);
+			for (size_t i = 0; i < sample.vertex_count; ++i)
+			{
+				entry->ids[i] = i;
+			}
+			entry->is_generated = true;
+			point_sample.setIds(entry->index_key.next(
+				UInt64ArraySample(entry->ids.empty() ? NULL : &entry->ids[0], entry->ids.size())));
+		}
+		if (sample.width)
+		{
+			point_sample.setWidths(OFloatGeomParam::Sample(
+				FloatArraySample(sample.width, sample.width_count),
+				width_scope(sample.width_count, vertex_count, 0)));
+		}
+		return set(*entry, schema, point_sample);
+	}
+
+	bool write_curve(int object, double time, const CurveSample& sample)
+	{
+		ObjectEntryPtr entry = find(object, kTypeCurve);
+		if (!entry) return false;
+		if (entry->frame_count == 0 && (!sample.vertex || !sample.curve_count)) return false;
+		const size_t vertex_count = sample.vertex ? sample.vertex_count : entry->vertex_count;
+		const size_t curve_size = sample.curve_count ? sample.curve_size : entry->index_count;
+		OCurvesSchema& schema = entry->curve.getSchema();
+		if (!advance(*entry, schema, time)) return false;
+		entry->vertex_count = vertex_count;
+		entry->index_count = curve_size;
+
+		OCurvesSchema::Sample curve_sample;
+		if (sample.vertex)
+		{
+			curve_sample.setPositions(P3fArraySample(
+				reinterpret_cast<const V3f*>(sample.vertex), sample.vertex_count));
+		}
+		if (sample.curve_count)
+		{
+			curve_sample.setCurvesNumVertices(entry->count_key.next(
+				Int32ArraySample(sample.curve_count, sample.curve_size)));
+		}
+		curve_sample.setType(sample.basis == CurveSample::kBasisLinear ? kLinear : kCubic);
+		curve_sample.setWrap(sample.is_periodic ? kPeriodic : kNonPeriodic);
+		switch (sample.basis)
+		{
+		case CurveSample::kBasisBspline: curve_sample.setBasis(kBsplineBasis); break;
+		case CurveSample::kBasisCatmullrom: curve_sample.setBasis(kCatmullromBasis); break;
+		case CurveSample::kBasisBezier: curve_sample.setBasis(kBezierBasis); break;
+		default: curve_sample.setBasis(kNoBasis); break;
+		}
+		if (sample.width)
+		{
+			curve_sample.setWidths(OFloatGeomParam::Sample(
+				FloatArraySample(sample.width, sample.width_count),
+				width_scope(sample.width_count, vertex_count, curve_size)));
+		}
+		return set(*entry, schema, curve_sample);
+	}
+
+	size_t object_size() const
+	{
+		return objects_.size();
+	}
+
+	void close()
+	{
+		// objects refer to the archive, which is written when the last reference is gone
+		objects_.clear();
+		archive_.reset();
+	}
+
+private:
+	struct ObjectEntry
+	{
+		ObjectEntry(ObjectType object_type)
+			: type(object_type)
+			, start_frame(0)
+			, frame_count(0)
+			, is_generated(false)
+			, vertex_count(0)
+			, index_count(0)
+		{}
+		ObjectType type;
+		OObject object;
+		OXform xform;
+		OPolyMesh mesh;
+		OPoints point;
+		OCurves curve;
+		long long start_frame;
+		long long frame_count;
+		TopologyKey index_key;
+		TopologyKey count_key;
+		std::vector<int32_t> counts;
+		std::vector<uint64_t> ids;
+		bool is_generated; // counts or ids are made by the writer
+		// of the last written sample, for samples which omit them
+		size_t vertex_count;
+		size_t index_count; // curve count of curves
+	};
+	typedef std::shared_ptr<ObjectEntry> ObjectEntryPtr;
+
+	ObjectEntryPtr find(int object) const
+	{
+		if (object < 0 || static_cast<size_t>(object) >= objects_.size()) return ObjectEntryPtr();
+		return objects_[object];
+	}
+
+	ObjectEntryPtr find(int object, ObjectType type) const
+	{
+		ObjectEntryPtr entry = find(object);
+		if (!entry || entry->type != type) return ObjectEntryPtr();
+		return entry;
+	}
+
+	/**
+	 * start the object at the first frame or repeat the previous sample over skipped frames
+	 * @retval false when the time is not after the last written frame
+	 */
+	template <class Schema>
+	bool advance(ObjectEntry& entry, Schema& schema, double time)
+	{
+		if (!(frame_time_ > 0) || !archive_.valid()) return false;
+		const long long frame = static_cast<long long>(std::floor((time - start_time_) / frame_time_ + 0.5));
+		try
+		{
+			if (entry.frame_count == 0)
+			{
+				entry.start_frame = frame;
+				schema.setTimeSampling(std::make_shared<TimeSampling>(
+					frame_time_ / 1000.0, (start_time_ + frame * frame_time_) / 1000.0));
+				return true;
+			}
+			const long long next_frame = entry.start_frame + entry.frame_count;
+			if (frame < next_frame) return false;
+			for (; entry.frame_count < frame - entry.start_frame; ++entry.frame_count)
+			{
+				schema.setFromPrevious();
+			}
+		}
+		catch (...)
+		{
+			return false;
+		}
+		return true;
+	}
+
+	template <class Schema, class Sample>
+	bool set(ObjectEntry& entry, Schema& schema, Sample& sample)
+	{
+		try
+		{
+			schema.set(sample);
+		}
+		catch (...)
+		{
+			return false;
+		}
+		++entry.frame_count;
+		return true;
+	}
+
+	double start_time_;
+	double frame_time_;
+	OArchive archive_;
+	std::vector<ObjectEntryPtr> objects_;
+};
+
+UMAbcWriter::UMAbcWriter()
+{}
+
+UMAbcWriter::~UMAbcWriter()
+{
+}
+
+/**
+ * create archive
+ */
+UMAbcWriterPtr UMAbcWriter::create(
+	const std::string& path,
+	const UMAbcSetting& setting,
+	double start_time,
+	double frame_time)
+{
+	if (!(frame_time > 0)) return UMAbcWriterPtr();
+	UMAbcWriterPtr writer(new UMAbcWriter());
+	writer->impl_.reset(new UMAbcWriter::Impl(start_time, frame_time));
+	if (!writer->impl_->open(path, setting)) return UMAbcWriterPtr();
+	return writer;
+}
+
+/**
+ * add xform
+ */
+int UMAbcWriter::add_xform(int parent, const std::string& name)
+{
+	return impl_->add_object(parent, name, kTypeXform);
+}
+
+/**
+ * add mesh
+ */
+int UMAbcWriter::add_mesh(int parent, const std::string& name)
+{
+	return impl_->add_object(parent, name, kTypeMesh);
+}
+
+/**
+ * add point
+ */
+int UMAbcWriter::add_point(int parent, const std::string& name)
+{
+	return impl_->add_object(parent, name, kTypePoint);
+}
+
+/**
+ * add curve
+ */
+int UMAbcWriter::add_curve(int parent, const std::string& name)
+{
+	return impl_->add_object(parent, name, kTypeCurve);
+}
+
+/**
+ * append local matrix of the xform
+ */
+bool UMAbcWriter::write_xform(int object, double time, const double* matrix)
+{
+	return impl_->write_xform(object, time, matrix);
+}
+
+/**
+ * append sample of the mesh
+ */
+bool UMAbcWriter::write_mesh(int object, double time, const MeshSample& sample)
+{
+	return impl_->write_mesh(object, time, sample);
+}
+
+/**
+ * append sample of the point
+ */
+bool UMAbcWriter::write_point(int object, double time, const PointSample& sample)
+{
+	return impl_->write_point(object, time, sample);
+}
+
+/**
+ * append sample of the curve
+ */
+bool UMAbcWriter::write_curve(int object, double time, const CurveSample& sample)
+{
+	return impl_->write_curve(object, time, sample);
+}
+
+/**
+ * get number of objects
+ */
+size_t UMAbcWriter::object_size() const
+{
+	return impl_->object_size();
+}
+
+/**
+ * finish the file
+ */
+void UMAbcWriter::close()
+{
+	impl_->close();
+}
+
+} // umabc
@@ -0,0 +1,178 @@
+/**
+ * @file UMAbcWriter.h
+ * archive written frame by frame
+ *
+ * @author tori31001 at gmail.com
+ *
+ * Copyright (C) 2013 Kazuma Hatta
+ * Licensed  under the MIT license.
+ *
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include "UMMacro.h"
+#include "UMAbcSetting.h"
+
+namespace umabc
+{
+
+class UMAbcWriter;
+typedef std::shared_ptr<UMAbcWriter> UMAbcWriterPtr;
+
+/**
+ * creates a new archive and appends samples as they arrive.
+ * samples are written to the file by each write call, so memory does not grow
+ * with the animation length. sample data is passed by pointer and is not copied.
+ * objects are numbered in order of creation and 0 is the top object.
+ * times are snapped to frames of the frame time. frames skipped between writes
+ * repeat the previous sample and the first written frame starts the object.
+ */
+class UMAbcWriter
+{
+	DISALLOW_COPY_AND_ASSIGN(UMAbcWriter);
+public:
+
+	/**
+	 * mesh sample. null arrays repeat the previous sample of the mesh.
+	 * topology equal to the previous sample is written from previous.
+	 */
+	struct MeshSample
+	{
+		MeshSample()
+			: vertex(NULL), vertex_count(0)
+			, index(NULL), index_count(0)
+			, face_count(NULL), face_size(0)
+			, normal(NULL), normal_count(0)
+			, uv(NULL), uv_count(0)
+		{}
+		const float* vertex; // xyz
+		size_t vertex_count;
+		const int* index;
+		size_t index_count;
+		const int* face_count; // vertices of each face. null is triangles, or the last counts without index
+		size_t face_size;
+		const float* normal; // xyz per face vertex, or per vertex
+		size_t normal_count;
+		const float* uv; // uv per face vertex, or per vertex
+		size_t uv_count;
+	};
+
+	/**
+	 * point sample. null ids number points from 0.
+	 */
+	struct PointSample
+	{
+		PointSample()
+			: vertex(NULL), vertex_count(0)
+			, id(NULL), id_count(0)
+			, width(NULL), width_count(0)
+		{}
+		const float* vertex; // xyz
+		size_t vertex_count;
+		const unsigned int* id;
+		size_t id_count;
+		const float* width;
+		size_t width_count;
+	};
+
+	/**
+	 * curve sample
+	 */
+	struct CurveSample
+	{
+		enum Basis
+		{
+			kBasisLinear,
+			kBasisBezier,
+			kBasisBspline,
+			kBasisCatmullrom
+		};
+
+		CurveSample()
+			: vertex(NULL), vertex_count(0)
+			, curve_count(NULL), curve_size(0)
+			, width(NULL), width_count(0)
+			, basis(kBasisLinear)
+			, is_periodic(false)
+		{}
+		const float* vertex; // xyz
+		size_t vertex_count;
+		const int* curve_count; // vertices of each curve
+		size_t curve_size;
+		const float* width;
+		size_t width_count;
+		Basis basis;
+		bool is_periodic;
+	};
+
+	/**
+	 * create archive
+	 * @param [in] path file path
+	 * @param [in] setting export type is used
+	 * @param [in] start_time time of frame 0 in milliseconds
+	 * @param [in] frame_time milliseconds per frame
+	 * @retval created writer or null
+	 */
+	static UMAbcWriterPtr create(
+		const std::string& path,
+		const UMAbcSetting& setting,
+		double start_time,
+		double frame_time);
+
+	~UMAbcWriter();
+
+	/**
+	 * add object under the parent. the parent is the top object or an xform.
+	 * @retval object number or -1
+	 */
+	int add_xform(int parent, const std::string& name);
+	int add_mesh(int parent, const std::string& name);
+	int add_point(int parent, const std::string& name);
+	int add_curve(int parent, const std::string& name);
+
+	/**
+	 * append local matrix of the xform
+	 * @param [in] matrix 16 values, row major with translation in 12, 13, 14
+	 * @retval succsess or fail
+	 */
+	bool write_xform(int object, double time, const double* matrix);
+
+	/**
+	 * append sample of the mesh. the first sample needs vertex and index.
+	 * face counts given without index describe the last written index, and must add up to its count.
+	 * normals and uvs are per face vertex when their count is the index count,
+	 * per vertex when it is the vertex count, and the sample fails otherwise.
+	 */
+	bool write_mesh(int object, double time, const MeshSample& sample);
+
+	/**
+	 * append sample of the point. the first sample needs vertex.
+	 * widths are scoped by the last written vertex count when vertex is omitted.
+	 */
+	bool write_point(int object, double time, const PointSample& sample);
+
+	/**
+	 * append sample of the curve. the first sample needs vertex and curve_count.
+	 */
+	bool write_curve(int object, double time, const CurveSample& sample);
+
+	/**
+	 * get number of objects including the top object
+	 */
+	size_t object_size() const;
+
+	/**
+	 * finish the file. writers are also closed on delete.
+	 */
+	void close();
+
+private:
+	UMAbcWriter();
+
+	class Impl;
+	std::unique_ptr<Impl> impl_;
+};
+
+} // umabc
@@ -28,6 +28,7 @@ namespace umabc
 		Impl(IXformPtr xform)
 			: UMAbcObject(xform)
 			, xform_(xform)
+			, is_inherit_(true)
 		{}
 
 		~Impl() {}
@@ -52,6 +53,16 @@ namespace umabc
 		*/
 		virtual void update_box(bool recursive);
 
+		/**
+		* get local transform at time
+		*/
+		const Imath::M44d& local_transform_at(unsigned long time);
+
+		/**
+		* add bytes held by this xform
+		*/
+		void memory_usage(UMAbcMemoryUsage& usage) const;
+
 		virtual UMAbcObjectPtr self_reference()
 		{
 			return self_reference_.lock();
@@ -64,6 +75,10 @@ namespace umabc
 
 		Imath::M44d static_matrix_;
 		bool is_inherit_;
+
+		// local transform table by sample index
+		std::vector<Imath::M44d> sample_table_;
+		std::vector<bool> sample_loaded_;
 	};
 
 
@@ -140,6 +155,34 @@ void UMAbcXform::Impl::set_current_time(unsigned long time, bool recursive)
 	}
 }
 
+/**
+ * get local transform at time
+ */
+const Imath::M44d& UMAbcXform::Impl::local_transform_at(unsigned long time)
+{
+	if (!is_valid() || xform_->getSchema().isConstant())
+	{
+		return static_matrix_;
+	}
+	const size_t num_samples = xform_->getSchema().getNumSamples();
+	if (num_samples == 0)
+	{
+		return static_matrix_;
+	}
+	if (sample_table_.size() != num_samples)
+	{
+		sample_table_.assign(num_samples, Imath::M44d());
+		sample_loaded_.assign(num_samples, false);
+	}
+	const size_t index = xform_->getSchema().getTimeSampling()->getNearIndex(time / 1000.0, num_samples).first;
+	if (!sample_loaded_[index])
+	{
+		sample_table_[index] = xform_->getSchema().getValue(ISampleSelector(static_cast<index_t>(index))).getMatrix();
+		sample_loaded_[index] = true;
+	}
+	return sample_table_[index];
+}
+
 /**
  * update box
  */
@@ -201,6 +244,16 @@ void UMAbcXform::set_current_time(unsigned long time, bool recursive)
 	UMAbcObject::set_current_time(time, recursive);
 }
 
+/**
+ * add bytes held by this xform
+ */
+void UMAbcXform::Impl::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(Impl) - sizeof(UMAbcObject);
+	usage.sample += sample_table_.capacity() * sizeof(Imath::M44d) + sample_loaded_.capacity() / 8;
+}
+
 /**
 * update box
 * @param [in] recursive do children recursively
@@ -210,6 +263,16 @@ void UMAbcXform::update_box(bool recursive)
 	impl_->update_box(recursive);
 }
 
+/**
+ * add bytes held by this xform
+ */
+void UMAbcXform::memory_usage(UMAbcMemoryUsage& usage) const
+{
+	UMAbcObject::memory_usage(usage);
+	usage.node += sizeof(UMAbcXform) - sizeof(UMAbcObject);
+	impl_->memory_usage(usage);
+}
+
 UMAbcObjectPtr UMAbcXform::self_reference()
 {
 	return impl_->self_reference();
@@ -223,4 +286,12 @@ double UMAbcXform::current_time() const
 	return impl_->current_time();
 }
 
+/**
+* get local transform at time
+*/
+const Imath::M44d& UMAbcXform::local_transform_at(unsigned long time)
+{
+	return impl_->local_transform_at(time);
+}
+
 } // umabc
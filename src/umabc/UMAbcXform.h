@@ -65,12 +65,25 @@ public:
 	 * @param [in] recursive do children recursively
 	 */
 	virtual void update_box(bool recursive);
+
+	/**
+	 * add bytes held by this xform, without children
+	 * @param [out] usage memory usage
+	 */
+	virtual void memory_usage(UMAbcMemoryUsage& usage) const;
 	
 	/**
 	* get current time
 	*/
 	virtual double current_time() const;
 
+	/**
+	 * get local transform at any time without changing the current time.
+	 * read samples are kept in a table by sample index.
+	 * @param [in] time time in milliseconds
+	 */
+	const Imath::M44d& local_transform_at(unsigned long time);
+
 protected:
 	UMAbcXform(IXformPtr xform);
 	
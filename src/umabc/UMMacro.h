@@ -38,4 +38,16 @@ namespace umabc
 #define M_PI_INV 0.31830988618379069
 #endif
 
+	/**
+	 * hash index or id. (splitmix64 finalizer)
+	 * keeps the same elements on any frame, for strand and point decimation.
+	 */
+	inline unsigned long long hash_index(unsigned long long index)
+	{
+		index += 0x9E3779B97F4A7C15ULL;
+		index = (index ^ (index >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		index = (index ^ (index >> 27)) * 0x94D049BB133111EBULL;
+		return index ^ (index >> 31);
+	}
+
 }
\ No newline at end of file
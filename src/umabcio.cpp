@@ -3,10 +3,13 @@
 #include <memory>
 #include "node.h"
 #include "node_buffer.h"
+#include "node_object_wrap.h"
 
 #include <vector>
 #include <string>
 #include <algorithm>
+#include <limits>
+#include <chrono>
 #include <Alembic/Abc/All.h>
 #include <Alembic/AbcGeom/All.h>
 #include <Alembic/AbcCoreHDF5/All.h>
@@ -21,33 +24,348 @@ namespace AbcA = Alembic::AbcCoreAbstract;
 #include "UMAbcNurbsPatch.h"
 #include "UMAbcCamera.h"
 #include "UMAbcXform.h"
+#include "UMAbcSampleCache.h"
+#include "UMAbcPrefetcher.h"
+#include "UMAbcWriter.h"
+#include "UMAbcBakedFile.h"
+#include "UMAbcSceneIndex.h"
+#include "UMAbcParallel.h"
 
 using namespace v8;
 
 class UMAbcIO {
 public:
-	typedef std::map<std::string, umabc::UMAbcScenePtr> SceneMap;
+	/**
+	 * loaded file. scene is null while evicted and reopened on next access.
+	 * generation is incremented on each reopen so that handles find their objects again.
+	 * file loaded from its scene index keeps the indexed hierarchy, and its scene is
+	 * built on first access which needs objects.
+	 */
+	struct SceneEntry {
+		SceneEntry() : ref_count(0), time(0), last_access(0), generation(0) {}
+		std::string path;
+		umabc::UMAbcScenePtr scene;
+		unsigned int ref_count;
+		unsigned long time; // current time in milliseconds kept while evicted
+		double last_access; // seconds
+		unsigned int generation;
+		std::shared_ptr<const umabc::UMAbcScene::Hierarchy> index;
+	};
+	typedef std::shared_ptr<SceneEntry> SceneEntryPtr;
+	typedef std::map<std::string, SceneEntryPtr> SceneMap;
+
+	/**
+	 * object of an archive being written. archive is the handle of its top object.
+	 */
+	struct WriterHandle {
+		WriterHandle() : object(0), archive(0) {}
+		umabc::UMAbcWriterPtr writer;
+		int object;
+		unsigned int archive;
+	};
+	typedef std::map<unsigned int, WriterHandle> WriterHandleMap;
+
+	/**
+	 * opened baked file. buffer is one array buffer over the whole mapping,
+	 * which typed arrays of frames view.
+	 */
+	struct BakedEntry {
+		umabc::UMAbcBakedFilePtr file;
+		Persistent<ArrayBuffer> buffer;
+	};
+	typedef std::shared_ptr<BakedEntry> BakedEntryPtr;
+	typedef std::map<std::string, BakedEntryPtr> BakedMap;
+
+	/**
+	 * maximum times of a get_camera_range call. an hour at 24 fps.
+	 */
+	static const unsigned int kMaxCameraSampleCount = 24 * 60 * 60;
+
+	/**
+	 * keeps the mapping until the array buffer over it is collected,
+	 * so views handed out stay valid after the baked file is closed.
+	 */
+	struct MappingHolder {
+		umabc::UMAbcBakedFilePtr file;
+		Persistent<ArrayBuffer> buffer;
+	};
 
 	static UMAbcIO& instance() {
 		static UMAbcIO abcio;
 		return abcio;
 	}
 
-	umabc::UMAbcScenePtr get_scene(Isolate* isolate, const FunctionCallbackInfo<Value>& args) {
+	UMAbcIO()
+		: idle_seconds_(0)
+		, memory_ceiling_(0)
+		, last_collect_(0)
+		, has_prefetch_setting_(false)
+		, prefetch_frame_count_(0)
+		, prefetch_byte_budget_(0)
+		, next_writer_handle_(1)
+		, transcode_byte_budget_(0)
+		, is_scene_index_enabled_(false)
+		, has_read_setting_(false)
+		, read_mode_(umabc::UMAbcSetting::kReadStream)
+		, read_stream_count_(0)
+	{}
+
+	static double now() {
+		return std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	/**
+	 * setting to load archives with
+	 */
+	void scene_setting(umabc::UMAbcSetting& setting) const {
+		setting.set_transcode_directory(transcode_directory_);
+		if (transcode_byte_budget_ > 0) {
+			setting.set_transcode_byte_budget(transcode_byte_budget_);
+		}
+		if (has_read_setting_) {
+			setting.set_read_mode(read_mode_);
+			setting.set_read_stream_count(read_stream_count_);
+		}
+	}
+
+	umabc::UMAbcScenePtr open_scene(const std::string& path) {
+		umabc::UMAbcSoftwareIO abcio;
+		umabc::UMAbcSetting setting;
+		scene_setting(setting);
+		umabc::UMAbcScenePtr scene = abcio.load(path, setting);
+		if (scene && scene->init()) {
+			apply_prefetch(scene);
+			return scene;
+		}
+		return umabc::UMAbcScenePtr();
+	}
+
+	void apply_prefetch(umabc::UMAbcScenePtr scene) {
+		if (!has_prefetch_setting_) return;
+		if (umabc::UMAbcPrefetcherPtr prefetcher = scene->prefetcher()) {
+			prefetcher->set_frame_count(prefetch_frame_count_);
+			prefetcher->set_byte_budget(prefetch_byte_budget_);
+		}
+	}
+
+	static void close_scene(SceneEntry& entry) {
+		if (!entry.scene) return;
+		entry.time = static_cast<unsigned long>(entry.scene->root_object()->current_time() * 1000.0 + 0.5);
+		entry.scene->dispose();
+		entry.scene = umabc::UMAbcScenePtr();
+	}
+
+	/**
+	 * close idle scenes and release buffers of least recently used scenes over the memory ceiling.
+	 * runs at most once a second.
+	 */
+	void collect(const std::string& current_path) {
+		if (idle_seconds_ <= 0 && memory_ceiling_ == 0) return;
+		const double current = now();
+		if (current - last_collect_ < 1.0) return;
+		last_collect_ = current;
+
+		std::vector<std::pair<double, SceneEntry*> > resident;
+		size_t total_size = 0;
+		for (SceneMap::iterator it = scene_map_.begin(); it != scene_map_.end(); ++it) {
+			SceneEntry& entry = *it->second;
+			if (!entry.scene || it->first == current_path) continue;
+			if (idle_seconds_ > 0 && current - entry.last_access > idle_seconds_) {
+				close_scene(entry);
+				continue;
+			}
+			resident.push_back(std::make_pair(entry.last_access, &entry));
+		}
+		if (memory_ceiling_ == 0) return;
+
+		std::vector<size_t> sizes(resident.size());
+		for (size_t i = 0; i < resident.size(); ++i) {
+			sizes[i] = resident[i].second->scene->buffer_byte_size();
+			total_size += sizes[i];
+		}
+		SceneMap::iterator current_it = scene_map_.find(current_path);
+		if (current_it != scene_map_.end() && current_it->second->scene) {
+			total_size += current_it->second->scene->buffer_byte_size();
+		}
+		std::vector<size_t> order(resident.size());
+		for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+		std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+			return resident[a].first < resident[b].first;
+		});
+		for (size_t i = 0; i < order.size() && total_size > memory_ceiling_; ++i) {
+			umabc::UMAbcScenePtr scene = resident[order[i]].second->scene;
+			scene->release_buffers(std::string());
+			// only bytes no longer held count as reclaimed
+			const size_t remaining = std::min(sizes[order[i]], scene->buffer_byte_size());
+			total_size -= sizes[order[i]] - remaining;
+		}
+	}
+
+	/**
+	 * add a reference of the file. opens it when not loaded.
+	 * @retval entry or null when failed to open
+	 */
+	SceneEntryPtr acquire(const std::string& path) {
+		SceneMap::iterator it = scene_map_.find(path);
+		if (it != scene_map_.end()) {
+			++it->second->ref_count;
+			return it->second;
+		}
+		SceneEntryPtr entry(new SceneEntry());
+		entry->path = path;
+		entry->ref_count = 1;
+		entry->last_access = now();
+		if (is_scene_index_enabled_) {
+			std::shared_ptr<umabc::UMAbcScene::Hierarchy> index(new umabc::UMAbcScene::Hierarchy());
+			if (umabc::UMAbcSceneIndex::read(path, scene_index_directory_, *index)) {
+				// the scene starts at its first time as init does
+				entry->time = static_cast<unsigned long>(index->times[0]);
+				entry->index = index;
+				scene_map_[path] = entry;
+				return entry;
+			}
+		}
+		umabc::UMAbcScenePtr scene = open_scene(path);
+		if (!scene) return SceneEntryPtr();
+		if (is_scene_index_enabled_) {
+			umabc::UMAbcSceneIndex::write(path, scene_index_directory_, scene->hierarchy());
+		}
+		entry->scene = scene;
+		scene_map_[path] = entry;
+		collect(path);
+		return entry;
+	}
+
+	/**
+	 * release a reference of the file. scene is closed when no reference remains.
+	 * @retval remaining reference count
+	 */
+	unsigned int release(const std::string& path) {
+		SceneMap::iterator it = scene_map_.find(path);
+		if (it == scene_map_.end()) return 0;
+		return release(it->second);
+	}
+
+	/**
+	 * release a reference of the entry. does nothing when the entry was already unloaded,
+	 * even if the same file is loaded again as another entry.
+	 * @retval remaining reference count
+	 */
+	unsigned int release(const SceneEntryPtr& entry) {
+		SceneMap::iterator it = scene_map_.find(entry->path);
+		if (it == scene_map_.end() || it->second != entry) return 0;
+		const unsigned int ref_count = --entry->ref_count;
+		if (ref_count == 0) {
+			close_scene(*entry);
+			scene_map_.erase(it);
+		}
+		return ref_count;
+	}
+
+	/**
+	 * get scene of the entry. evicted scene is reopened at its last time.
+	 */
+	umabc::UMAbcScenePtr resident_scene(Isolate* isolate, SceneEntry& entry) {
+		if (entry.ref_count == 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Not Loaded")));
+			return umabc::UMAbcScenePtr();
+		}
+		if (!entry.scene) {
+			entry.scene = open_scene(entry.path);
+			if (!entry.scene) {
+				isolate->ThrowException(Exception::Error(
+					String::NewFromUtf8(isolate, "Failed to reopen")));
+				return umabc::UMAbcScenePtr();
+			}
+			entry.scene->root_object()->set_current_time(entry.time, true);
+			++entry.generation;
+		}
+		entry.last_access = now();
+		umabc::UMAbcScenePtr scene = entry.scene;
+		collect(entry.path);
+		return scene;
+	}
+
+	/**
+	 * get loaded entry of the file path of args[0]
+	 */
+	SceneEntry* get_entry(Isolate* isolate, const FunctionCallbackInfo<Value>& args) {
 		if (args.Length() < 1) {
 			isolate->ThrowException(Exception::TypeError(
 				String::NewFromUtf8(isolate, "Wrong number of arguments")));
-			return umabc::UMAbcScenePtr();
+			return NULL;
 		}
 		if (!args[0]->IsString()) {
 			isolate->ThrowException(Exception::TypeError(
 				String::NewFromUtf8(isolate, "Wrong arguments")));
-			return umabc::UMAbcScenePtr();
+			return NULL;
 		}
 
 		v8::String::Utf8Value utf8path(args[0]->ToString());
 		const std::string path = *utf8path;
-		return scene_map_[path];
+		SceneMap::iterator it = scene_map_.find(path);
+		if (it == scene_map_.end() || it->second->ref_count == 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Not Loaded")));
+			return NULL;
+		}
+		return it->second.get();
+	}
+
+	umabc::UMAbcScenePtr get_scene(Isolate* isolate, const FunctionCallbackInfo<Value>& args) {
+		SceneEntry* entry = get_entry(isolate, args);
+		if (!entry) return umabc::UMAbcScenePtr();
+		return resident_scene(isolate, *entry);
+	}
+
+	/**
+	 * get hierarchy of the file path of args[0].
+	 * served from the scene index without building the scene when it is not built.
+	 */
+	const umabc::UMAbcScene::Hierarchy* get_hierarchy_of(Isolate* isolate, const FunctionCallbackInfo<Value>& args) {
+		SceneEntry* entry = get_entry(isolate, args);
+		if (!entry) return NULL;
+		if (!entry->scene && entry->index) {
+			entry->last_access = now();
+			return entry->index.get();
+		}
+		umabc::UMAbcScenePtr scene = resident_scene(isolate, *entry);
+		if (!scene) return NULL;
+		return &scene->hierarchy();
+	}
+
+	/**
+	 * get path list of the type of the file path of args[0]
+	 */
+	void get_path_list(const FunctionCallbackInfo<Value>& args, umabc::UMAbcScene::ObjectType type) {
+		Isolate* isolate = Isolate::GetCurrent();
+		SceneEntry* entry = get_entry(isolate, args);
+		if (!entry) return;
+		std::vector<std::string> path_list;
+		if (!entry->scene && entry->index) {
+			entry->last_access = now();
+			path_list = umabc::UMAbcSceneIndex::path_list(*entry->index, type);
+		} else {
+			umabc::UMAbcScenePtr scene = resident_scene(isolate, *entry);
+			if (!scene) return;
+			switch (type) {
+			case umabc::UMAbcScene::kObjectTypeMesh: path_list = scene->mesh_path_list(); break;
+			case umabc::UMAbcScene::kObjectTypePoint: path_list = scene->point_path_list(); break;
+			case umabc::UMAbcScene::kObjectTypeCurve: path_list = scene->curve_path_list(); break;
+			case umabc::UMAbcScene::kObjectTypeNurbs: path_list = scene->nurbs_path_list(); break;
+			case umabc::UMAbcScene::kObjectTypeCamera: path_list = scene->camera_path_list(); break;
+			case umabc::UMAbcScene::kObjectTypeXform: path_list = scene->xform_path_list(); break;
+			default: break;
+			}
+		}
+		const int list_size = static_cast<int>(path_list.size());
+		Local<Array> result = Array::New(isolate, list_size);
+		for (int i = 0; i < list_size; ++i) {
+			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+		}
+		args.GetReturnValue().Set(result);
 	}
 
 	void load(const FunctionCallbackInfo<Value>& args) {
@@ -67,172 +385,920 @@ public:
 
 		v8::String::Utf8Value utf8path(args[0]->ToString());
 		const std::string path = *utf8path;
-		if (scene_map_.find(path) != scene_map_.end()) {
+
+		// loading same file again adds a reference
+		args.GetReturnValue().Set(Boolean::New(isolate, !!acquire(path)));
+	}
+
+	/**
+	 * release a reference of the file. scene is closed when no reference remains.
+	 * returns remaining reference count.
+	 */
+	void unload(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsString()) {
 			isolate->ThrowException(Exception::TypeError(
-				String::NewFromUtf8(isolate, "Already Loaded")));
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
-
-		umabc::UMAbcSoftwareIO abcio;
-		umabc::UMAbcSetting setting;
-		umabc::UMAbcScenePtr scene = abcio.load(path, setting);
-		if (scene && scene->init()) {
-			scene_map_[path] = scene;
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		const std::string path = *utf8path;
+		if (scene_map_.find(path) == scene_map_.end()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Not Loaded")));
+			return;
 		}
+		args.GetReturnValue().Set(Integer::NewFromUnsigned(isolate, release(path)));
 	}
 
-	void save(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * set scene eviction policy.
+	 * args[0] is { idle_seconds, memory_ceiling }. scenes not accessed for idle_seconds are closed
+	 * and reopened on next access. derived buffers of least recently used scenes are released
+	 * while their total exceeds memory_ceiling bytes. 0 disables each.
+	 */
+	void set_scene_policy(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		HandleScope scope(isolate);
-
-		if (args.Length() < 2) {
+		if (args.Length() < 1 || !args[0]->IsObject()) {
 			isolate->ThrowException(Exception::TypeError(
-				String::NewFromUtf8(isolate, "Wrong number of arguments")));
+				String::NewFromUtf8(isolate, "Wrong arguments")));
 			return;
 		}
-		if (!args[1]->IsString()) {
+		Local<Object> policy = args[0]->ToObject();
+		Local<Value> idle_seconds = policy->Get(String::NewFromUtf8(isolate, "idle_seconds"));
+		Local<Value> memory_ceiling = policy->Get(String::NewFromUtf8(isolate, "memory_ceiling"));
+		if ((!idle_seconds->IsUndefined() && (!idle_seconds->IsNumber() || idle_seconds->NumberValue() < 0))
+			|| (!memory_ceiling->IsUndefined() && (!memory_ceiling->IsNumber() || memory_ceiling->NumberValue() < 0))) {
 			isolate->ThrowException(Exception::TypeError(
 				String::NewFromUtf8(isolate, "Wrong arguments")));
 			return;
 		}
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-
-		v8::String::Utf8Value utf8path(args[1]->ToString());
-		const std::string path = *utf8path;
-
-		umabc::UMAbcSoftwareIO abcio;
-		umabc::UMAbcSetting setting;
-
-		abcio.save(path, scene, setting);
+		if (idle_seconds->IsNumber()) {
+			idle_seconds_ = idle_seconds->NumberValue();
+		}
+		if (memory_ceiling->IsNumber()) {
+			memory_ceiling_ = static_cast<size_t>(memory_ceiling->NumberValue());
+		}
+		last_collect_ = 0;
+		collect(std::string());
 	}
 
-	void get_total_time(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * set playback prefetch of all scenes. args[0] is { frame_count, byte_budget }.
+	 * frame_count 0 disables prefetch.
+	 */
+	void set_prefetch(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-
-		Local<Object> time = Object::New(isolate);
-		Local<Number> min_time = Number::New(isolate, scene->min_time());
-		Local<Number> max_time = Number::New(isolate, scene->max_time());
-
-		time->Set(String::NewFromUtf8(isolate, "min"), min_time);
-		time->Set(String::NewFromUtf8(isolate, "max"), max_time);
-		args.GetReturnValue().Set(time);
+		if (args.Length() < 1 || !args[0]->IsObject()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		Local<Object> prefetch = args[0]->ToObject();
+		Local<Value> frame_count = prefetch->Get(String::NewFromUtf8(isolate, "frame_count"));
+		Local<Value> byte_budget = prefetch->Get(String::NewFromUtf8(isolate, "byte_budget"));
+		if (!frame_count->IsNumber() || frame_count->NumberValue() < 0
+			|| !byte_budget->IsNumber() || byte_budget->NumberValue() < 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		has_prefetch_setting_ = true;
+		prefetch_frame_count_ = frame_count->Uint32Value();
+		prefetch_byte_budget_ = static_cast<size_t>(byte_budget->NumberValue());
+		for (SceneMap::iterator it = scene_map_.begin(); it != scene_map_.end(); ++it) {
+			if (it->second->scene) {
+				apply_prefetch(it->second->scene);
+			}
+		}
 	}
 
-	void get_time(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * set cache of ogawa copies of hdf5 archives. args[0] is { directory, byte_budget }.
+	 * hdf5 archives loaded afterwards are copied into the directory once and read from the copy.
+	 * an empty directory reads hdf5 archives directly. byte_budget 0 is the default 4GB.
+	 */
+	void set_transcode_cache(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		Local<Number> time = Number::New(isolate, scene->root_object()->current_time_ms());
-		args.GetReturnValue().Set(time);
+		if (args.Length() < 1 || !args[0]->IsObject()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		Local<Object> cache = args[0]->ToObject();
+		Local<Value> directory = cache->Get(String::NewFromUtf8(isolate, "directory"));
+		Local<Value> byte_budget = cache->Get(String::NewFromUtf8(isolate, "byte_budget"));
+		if (!directory->IsString()
+			|| (!byte_budget->IsUndefined() && (!byte_budget->IsNumber() || byte_budget->NumberValue() < 0))) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8directory(directory->ToString());
+		transcode_directory_ = *utf8directory;
+		if (byte_budget->IsNumber()) {
+			transcode_byte_budget_ = static_cast<unsigned long long>(byte_budget->NumberValue());
+		}
 	}
 
-	void set_time(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * set how archives loaded afterwards are read. args[0] is { mode, stream_count }.
+	 * mode is "stream", "mapped" or "positional". archives are read through streams until set.
+	 * stream_count 0 or missing is one per worker.
+	 */
+	void set_read_mode(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		double time = args[1]->NumberValue();
-		scene->root_object()->set_current_time(static_cast<unsigned long>(time), true);
+		if (args.Length() < 1 || !args[0]->IsObject()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		Local<Object> read = args[0]->ToObject();
+		Local<Value> mode = read->Get(String::NewFromUtf8(isolate, "mode"));
+		Local<Value> stream_count = read->Get(String::NewFromUtf8(isolate, "stream_count"));
+		if (!mode->IsString()
+			|| (!stream_count->IsUndefined() && (!stream_count->IsNumber() || stream_count->NumberValue() < 0))) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8mode(mode->ToString());
+		const std::string mode_name = *utf8mode;
+		umabc::UMAbcSetting::ReadMode read_mode = umabc::UMAbcSetting::kReadStream;
+		if (mode_name == "mapped") {
+			read_mode = umabc::UMAbcSetting::kReadMapped;
+		} else if (mode_name == "positional") {
+			read_mode = umabc::UMAbcSetting::kReadPositional;
+		} else if (mode_name != "stream") {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		has_read_setting_ = true;
+		read_mode_ = read_mode;
+		read_stream_count_ = stream_count->IsNumber() ? stream_count->Uint32Value() : 0;
 	}
 
-	void get_mesh_path_list(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * set worker threads of parallel loops and frame reads. args[0] is the count.
+	 * 0 is one per hardware thread.
+	 */
+	void set_worker_count(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		std::vector<std::string> path_list = scene->mesh_path_list();
-		const int list_size = static_cast<int>(path_list.size());
-		Local<Array> result = Array::New(isolate, list_size);
-		for (int i = 0; i < list_size; ++i) {
-			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+		if (args.Length() < 1 || !args[0]->IsNumber() || args[0]->NumberValue() < 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
-		args.GetReturnValue().Set(result);
+		umabc::set_parallel_worker_count(args[0]->Uint32Value());
 	}
 
-	void get_point_path_list(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * set scene index of archives. args[0] is { enabled, directory }.
+	 * archives loaded afterwards write an index of their hierarchy, and when the archive is
+	 * unchanged on later loads, the scene is built on first access which needs objects.
+	 * hierarchy, total time and path lists are served from the index until then.
+	 * an empty or missing directory puts the index beside the archive.
+	 */
+	void set_scene_index(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		std::vector<std::string> path_list = scene->point_path_list();
-		const int list_size = static_cast<int>(path_list.size());
-		Local<Array> result = Array::New(isolate, list_size);
-		for (int i = 0; i < list_size; ++i) {
-			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+		if (args.Length() < 1 || !args[0]->IsObject()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		Local<Object> index = args[0]->ToObject();
+		Local<Value> enabled = index->Get(String::NewFromUtf8(isolate, "enabled"));
+		Local<Value> directory = index->Get(String::NewFromUtf8(isolate, "directory"));
+		if (!enabled->IsBoolean() || (!directory->IsUndefined() && !directory->IsString())) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		is_scene_index_enabled_ = enabled->BooleanValue();
+		scene_index_directory_.clear();
+		if (directory->IsString()) {
+			v8::String::Utf8Value utf8directory(directory->ToString());
+			scene_index_directory_ = *utf8directory;
 		}
-		args.GetReturnValue().Set(result);
 	}
 
-	void get_curve_path_list(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * get playback prefetch statistics. args[0] is file path.
+	 * returns { request, seek, read, read_byte_size, frame_read } or null when the scene is not prefetched.
+	 */
+	void get_prefetch_stats(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
 		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		std::vector<std::string> path_list = scene->curve_path_list();
-		const int list_size = static_cast<int>(path_list.size());
-		Local<Array> result = Array::New(isolate, list_size);
-		for (int i = 0; i < list_size; ++i) {
-			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+		if (!scene) return;
+		umabc::UMAbcPrefetcherPtr prefetcher = scene->prefetcher();
+		if (!prefetcher) {
+			args.GetReturnValue().SetNull();
+			return;
 		}
+		const umabc::UMAbcPrefetcher::Stats stats = prefetcher->stats();
+		Local<Object> result = Object::New(isolate);
+		result->Set(String::NewFromUtf8(isolate, "request"), Number::New(isolate, static_cast<double>(stats.request_count)));
+		result->Set(String::NewFromUtf8(isolate, "seek"), Number::New(isolate, static_cast<double>(stats.seek_count)));
+		result->Set(String::NewFromUtf8(isolate, "read"), Number::New(isolate, static_cast<double>(stats.read_count)));
+		result->Set(String::NewFromUtf8(isolate, "read_byte_size"), Number::New(isolate, static_cast<double>(stats.read_byte_size)));
+		result->Set(String::NewFromUtf8(isolate, "frame_read"), Number::New(isolate, static_cast<double>(stats.frame_read_count)));
 		args.GetReturnValue().Set(result);
 	}
 
-	void get_nurbs_path_list(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * release triangulation, normals, uvs and bvh. hierarchy is kept and buffers are rebuilt on next access.
+	 * args[1] is an object path. all objects when omitted.
+	 */
+	void release_buffers(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() >= 2 && !args[1]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
 		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		std::vector<std::string> path_list = scene->nurbs_path_list();
-		const int list_size = static_cast<int>(path_list.size());
-		Local<Array> result = Array::New(isolate, list_size);
-		for (int i = 0; i < list_size; ++i) {
-			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+		if (!scene) return;
+		std::string object_path;
+		if (args.Length() >= 2) {
+			v8::String::Utf8Value utf8path(args[1]->ToString());
+			object_path = *utf8path;
 		}
-		args.GetReturnValue().Set(result);
+		args.GetReturnValue().Set(Boolean::New(isolate, scene->release_buffers(object_path)));
 	}
 
-	void get_camera_path_list(const FunctionCallbackInfo<Value>& args) {
+	void save(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
+		HandleScope scope(isolate);
+
+		if (args.Length() < 2) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong number of arguments")));
+			return;
+		}
+		if (!args[1]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
 		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		std::vector<std::string> path_list = scene->camera_path_list();
-		const int list_size = static_cast<int>(path_list.size());
-		Local<Array> result = Array::New(isolate, list_size);
-		for (int i = 0; i < list_size; ++i) {
-			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		const std::string path = *utf8path;
+
+		umabc::UMAbcSoftwareIO abcio;
+		umabc::UMAbcSetting setting;
+		if (args.Length() > 2 && !read_export_setting(isolate, args[2], setting)) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
-		args.GetReturnValue().Set(result);
+
+		args.GetReturnValue().Set(Boolean::New(isolate, abcio.save(path, scene, setting)));
 	}
 
-	void get_xform_path_list(const FunctionCallbackInfo<Value>& args) {
-		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-		std::vector<std::string> path_list = scene->xform_path_list();
-		const int list_size = static_cast<int>(path_list.size());
-		Local<Array> result = Array::New(isolate, list_size);
-		for (int i = 0; i < list_size; ++i) {
-			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+	/**
+	 * read { type, paths, min_time, max_time } of save options. all keys are optional.
+	 * type is "ogawa" or "hdf5", paths are object paths and times are in milliseconds.
+	 */
+	static bool read_export_setting(Isolate* isolate, Local<Value> value, umabc::UMAbcSetting& setting) {
+		if (value->IsUndefined()) return true;
+		if (!value->IsObject()) return false;
+		Local<Object> options = value->ToObject();
+		Local<Value> type = options->Get(String::NewFromUtf8(isolate, "type"));
+		Local<Value> paths = options->Get(String::NewFromUtf8(isolate, "paths"));
+		Local<Value> min_time = options->Get(String::NewFromUtf8(isolate, "min_time"));
+		Local<Value> max_time = options->Get(String::NewFromUtf8(isolate, "max_time"));
+		if (!type->IsUndefined()) {
+			if (!type->IsString()) return false;
+			v8::String::Utf8Value utf8type(type->ToString());
+			const std::string type_name = *utf8type;
+			if (type_name != "ogawa" && type_name != "hdf5") return false;
+			setting.set_export_type(type_name);
 		}
-		args.GetReturnValue().Set(result);
+		if (!paths->IsUndefined()) {
+			if (!paths->IsArray()) return false;
+			Local<Array> path_list = Local<Array>::Cast(paths);
+			std::vector<std::string> export_paths;
+			for (uint32_t i = 0; i < path_list->Length(); ++i) {
+				Local<Value> path = path_list->Get(i);
+				if (!path->IsString()) return false;
+				v8::String::Utf8Value utf8path(path->ToString());
+				export_paths.push_back(*utf8path);
+			}
+			setting.set_export_paths(export_paths);
+		}
+		if (!min_time->IsUndefined() || !max_time->IsUndefined()) {
+			if (!min_time->IsNumber() || !max_time->IsNumber()) return false;
+			setting.set_export_time_range(min_time->NumberValue(), max_time->NumberValue());
+		}
+		return true;
 	}
 
-	void assign_transform(Local<Object>& result, umabc::UMAbcNodePtr node)
-	{
+	/**
+	 * create an archive written frame by frame.
+	 * args[0] is the path and args[1] is optional { type, fps, start_time }.
+	 * type is "ogawa" or "hdf5", fps is 30 by default and start_time is in milliseconds.
+	 * returns the handle of the top object or null.
+	 */
+	void create_archive(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		{
-			const Imath::M44d& global_transform = node->global_transform();
-			Local<Array> trans = Array::New(isolate, 16);
-			for (int i = 0; i < 4; ++i) {
-				for (int k = 0; k < 4; ++k) {
-					trans->Set(i * 4 + k, Number::New(isolate, global_transform[i][k]));
-				}
-			}
-			result->Set(String::NewFromUtf8(isolate, "global_transform"), trans);
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
-		{
-			const Imath::M44d& local_transform = node->local_transform();
-			Local<Array> trans = Array::New(isolate, 16);
-			for (int i = 0; i < 4; ++i) {
-				for (int k = 0; k < 4; ++k) {
-					trans->Set(i * 4 + k, Number::New(isolate, local_transform[i][k]));
-				}
+		umabc::UMAbcSetting setting;
+		double fps = 30.0;
+		double start_time = 0.0;
+		if (args.Length() > 1 && !args[1]->IsUndefined()) {
+			Local<Value> fps_value;
+			Local<Value> start_value;
+			if (args[1]->IsObject()) {
+				Local<Object> options = args[1]->ToObject();
+				fps_value = options->Get(String::NewFromUtf8(isolate, "fps"));
+				start_value = options->Get(String::NewFromUtf8(isolate, "start_time"));
 			}
-			result->Set(String::NewFromUtf8(isolate, "local_transform"), trans);
+			if (!args[1]->IsObject()
+				|| !read_export_setting(isolate, args[1], setting)
+				|| (!fps_value->IsUndefined() && (!fps_value->IsNumber() || !(fps_value->NumberValue() > 0)))
+				|| (!start_value->IsUndefined() && !start_value->IsNumber())) {
+				isolate->ThrowException(Exception::TypeError(
+					String::NewFromUtf8(isolate, "Wrong arguments")));
+				return;
+			}
+			if (!fps_value->IsUndefined()) fps = fps_value->NumberValue();
+			if (!start_value->IsUndefined()) start_time = start_value->NumberValue();
+		}
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		umabc::UMAbcWriterPtr writer = umabc::UMAbcWriter::create(*utf8path, setting, start_time, 1000.0 / fps);
+		if (!writer) {
+			args.GetReturnValue().SetNull();
+			return;
 		}
+		const unsigned int handle = next_writer_handle_++;
+		WriterHandle& top = writer_handles_[handle];
+		top.writer = writer;
+		top.object = 0;
+		top.archive = handle;
+		args.GetReturnValue().Set(Number::New(isolate, handle));
 	}
 
-	void get_xform(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * add object under args[0], the handle of the top object or an xform. args[1] is the name.
+	 * returns the handle of the object or null.
+	 */
+	void add_object(const FunctionCallbackInfo<Value>& args, const std::string& type) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-
+		if (args.Length() < 2 || !args[0]->IsNumber() || !args[1]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		WriterHandle* parent = find_writer_handle(isolate, args[0]);
+		if (!parent) return;
+		v8::String::Utf8Value utf8name(args[1]->ToString());
+		const std::string name = *utf8name;
+		int object = -1;
+		if (type == "xform") object = parent->writer->add_xform(parent->object, name);
+		if (type == "mesh") object = parent->writer->add_mesh(parent->object, name);
+		if (type == "point") object = parent->writer->add_point(parent->object, name);
+		if (type == "curve") object = parent->writer->add_curve(parent->object, name);
+		if (object < 0) {
+			args.GetReturnValue().SetNull();
+			return;
+		}
+		const unsigned int handle = next_writer_handle_++;
+		WriterHandle& entry = writer_handles_[handle];
+		entry.writer = parent->writer;
+		entry.object = object;
+		entry.archive = parent->archive;
+		args.GetReturnValue().Set(Number::New(isolate, handle));
+	}
+
+	/**
+	 * append local matrix of an xform.
+	 * args[0] is the handle, args[1] is time in milliseconds and args[2] is 16 values.
+	 */
+	void write_xform_sample(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 3 || !args[0]->IsNumber() || !args[1]->IsNumber() || !args[2]->IsObject()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		WriterHandle* entry = find_writer_handle(isolate, args[0]);
+		if (!entry) return;
+		double matrix[16];
+		if (args[2]->IsFloat64Array() && Local<Float64Array>::Cast(args[2])->Length() == 16) {
+			Local<Float64Array>::Cast(args[2])->CopyContents(matrix, sizeof(matrix));
+		}
+		else if (args[2]->IsArray() && Local<Array>::Cast(args[2])->Length() == 16) {
+			Local<Array> values = Local<Array>::Cast(args[2]);
+			for (uint32_t i = 0; i < 16; ++i) {
+				matrix[i] = values->Get(i)->NumberValue();
+			}
+		}
+		else {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		args.GetReturnValue().Set(Boolean::New(isolate,
+			entry->writer->write_xform(entry->object, args[1]->NumberValue(), matrix)));
+	}
+
+	/**
+	 * append sample of a mesh. args[0] is the handle, args[1] is time in milliseconds and
+	 * args[2] is { vertex: Float32Array, index: Int32Array, face_count: Int32Array, normal: Float32Array, uv: Float32Array }.
+	 * the first sample needs vertex and index. missing face_count is triangles, and face_count
+	 * without index gives the faces of the last index.
+	 * normal and uv are per face vertex or per vertex by their count.
+	 * typed arrays are written without copy.
+	 */
+	void write_mesh_sample(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		Local<Object> values;
+		WriterHandle* entry = sample_arguments(isolate, args, values);
+		if (!entry) return;
+		umabc::UMAbcWriter::MeshSample sample;
+		if (!float_array_data(isolate, values, "vertex", 3, sample.vertex, sample.vertex_count)
+			|| !index_array_data(isolate, values, "index", sample.index, sample.index_count)
+			|| !index_array_data(isolate, values, "face_count", sample.face_count, sample.face_size)
+			|| !float_array_data(isolate, values, "normal", 3, sample.normal, sample.normal_count)
+			|| !float_array_data(isolate, values, "uv", 2, sample.uv, sample.uv_count)) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		args.GetReturnValue().Set(Boolean::New(isolate,
+			entry->writer->write_mesh(entry->object, args[1]->NumberValue(), sample)));
+	}
+
+	/**
+	 * append sample of a point. args[0] is the handle, args[1] is time in milliseconds and
+	 * args[2] is { vertex: Float32Array, id: Uint32Array, width: Float32Array }.
+	 */
+	void write_point_sample(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		Local<Object> values;
+		WriterHandle* entry = sample_arguments(isolate, args, values);
+		if (!entry) return;
+		umabc::UMAbcWriter::PointSample sample;
+		if (!float_array_data(isolate, values, "vertex", 3, sample.vertex, sample.vertex_count)
+			|| !id_array_data(isolate, values, "id", sample.id, sample.id_count)
+			|| !float_array_data(isolate, values, "width", 1, sample.width, sample.width_count)) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		args.GetReturnValue().Set(Boolean::New(isolate,
+			entry->writer->write_point(entry->object, args[1]->NumberValue(), sample)));
+	}
+
+	/**
+	 * append sample of curves. args[0] is the handle, args[1] is time in milliseconds and
+	 * args[2] is { vertex: Float32Array, count: Int32Array, width: Float32Array, basis, periodic }.
+	 * basis is "linear", "bezier", "bspline" or "catmullrom".
+	 */
+	void write_curve_sample(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		Local<Object> values;
+		WriterHandle* entry = sample_arguments(isolate, args, values);
+		if (!entry) return;
+		umabc::UMAbcWriter::CurveSample sample;
+		Local<Value> basis = values->Get(String::NewFromUtf8(isolate, "basis"));
+		Local<Value> periodic = values->Get(String::NewFromUtf8(isolate, "periodic"));
+		bool is_valid = float_array_data(isolate, values, "vertex", 3, sample.vertex, sample.vertex_count)
+			&& index_array_data(isolate, values, "count", sample.curve_count, sample.curve_size)
+			&& float_array_data(isolate, values, "width", 1, sample.width, sample.width_count);
+		if (is_valid && !basis->IsUndefined()) {
+			v8::String::Utf8Value utf8basis(basis->ToString());
+			const std::string basis_name = basis->IsString() ? *utf8basis : "";
+			if (basis_name == "linear") sample.basis = umabc::UMAbcWriter::CurveSample::kBasisLinear;
+			else if (basis_name == "bezier") sample.basis = umabc::UMAbcWriter::CurveSample::kBasisBezier;
+			else if (basis_name == "bspline") sample.basis = umabc::UMAbcWriter::CurveSample::kBasisBspline;
+			else if (basis_name == "catmullrom") sample.basis = umabc::UMAbcWriter::CurveSample::kBasisCatmullrom;
+			else is_valid = false;
+		}
+		if (!is_valid) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		sample.is_periodic = periodic->BooleanValue();
+		args.GetReturnValue().Set(Boolean::New(isolate,
+			entry->writer->write_curve(entry->object, args[1]->NumberValue(), sample)));
+	}
+
+	/**
+	 * finish the archive. args[0] is any handle of the archive. all its handles are released.
+	 */
+	void close_archive(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsNumber()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		WriterHandle* entry = find_writer_handle(isolate, args[0]);
+		if (!entry) return;
+		umabc::UMAbcWriterPtr writer = entry->writer;
+		for (WriterHandleMap::iterator it = writer_handles_.begin(); it != writer_handles_.end();) {
+			if (it->second.writer == writer) {
+				writer_handles_.erase(it++);
+			}
+			else {
+				++it;
+			}
+		}
+		writer->close();
+	}
+
+	WriterHandle* find_writer_handle(Isolate* isolate, Local<Value> value) {
+		WriterHandleMap::iterator it = writer_handles_.find(value->Uint32Value());
+		if (it == writer_handles_.end()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return NULL;
+		}
+		return &it->second;
+	}
+
+	/**
+	 * check (handle, time, values) of a sample
+	 */
+	WriterHandle* sample_arguments(Isolate* isolate, const FunctionCallbackInfo<Value>& args, Local<Object>& values) {
+		if (args.Length() < 3 || !args[0]->IsNumber() || !args[1]->IsNumber() || !args[2]->IsObject()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return NULL;
+		}
+		values = args[2]->ToObject();
+		return find_writer_handle(isolate, args[0]);
+	}
+
+	/**
+	 * get the contents of a typed array member without copy. a missing member is null.
+	 * @retval false when the member is another type or not a multiple of the extent
+	 */
+	static bool array_data(
+		Isolate* isolate,
+		Local<Object> values,
+		const char* key,
+		bool (Value::*is_type)() const,
+		unsigned int extent,
+		const void*& data,
+		size_t& count)
+	{
+		Local<Value> value = values->Get(String::NewFromUtf8(isolate, key));
+		if (value->IsUndefined() || value->IsNull()) return true;
+		if (!((*value)->*is_type)()) return false;
+		Local<TypedArray> array = Local<TypedArray>::Cast(value);
+		if (array->Length() % extent != 0) return false;
+		data = static_cast<const char*>(array->Buffer()->GetContents().Data()) + array->ByteOffset();
+		count = array->Length() / extent;
+		return true;
+	}
+
+	static bool float_array_data(
+		Isolate* isolate, Local<Object> values, const char* key, unsigned int extent, const float*& data, size_t& count)
+	{
+		const void* contents = NULL;
+		if (!array_data(isolate, values, key, &Value::IsFloat32Array, extent, contents, count)) return false;
+		data = static_cast<const float*>(contents);
+		return true;
+	}
+
+	/**
+	 * Int32Array or Uint32Array below 2^31
+	 */
+	static bool index_array_data(
+		Isolate* isolate, Local<Object> values, const char* key, const int*& data, size_t& count)
+	{
+		const void* contents = NULL;
+		if (!array_data(isolate, values, key, &Value::IsInt32Array, 1, contents, count)
+			&& !array_data(isolate, values, key, &Value::IsUint32Array, 1, contents, count)) {
+			return false;
+		}
+		data = static_cast<const int*>(contents);
+		return true;
+	}
+
+	static bool id_array_data(
+		Isolate* isolate, Local<Object> values, const char* key, const unsigned int*& data, size_t& count)
+	{
+		const void* contents = NULL;
+		if (!array_data(isolate, values, key, &Value::IsUint32Array, 1, contents, count)) return false;
+		data = static_cast<const unsigned int*>(contents);
+		return true;
+	}
+
+	/**
+	 * bake meshes of the archive for playback. args[0] is the archive path,
+	 * args[1] is the baked file path or undefined for the archive path with ".bake",
+	 * and args[2] is optional { fps, quantize }. fps is 30 by default.
+	 * quantized files store vertices as 16 bit and normals as 8 bit.
+	 */
+	void bake(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsString()
+			|| (args.Length() > 1 && !args[1]->IsUndefined() && !args[1]->IsString())
+			|| (args.Length() > 2 && !args[2]->IsUndefined() && !args[2]->IsObject())) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		const std::string path = *utf8path;
+		std::string out_path = path + ".bake";
+		if (args.Length() > 1 && args[1]->IsString()) {
+			v8::String::Utf8Value utf8out(args[1]->ToString());
+			out_path = *utf8out;
+		}
+		double fps = 30.0;
+		bool is_quantized = false;
+		if (args.Length() > 2 && args[2]->IsObject()) {
+			Local<Object> options = args[2]->ToObject();
+			Local<Value> fps_value = options->Get(String::NewFromUtf8(isolate, "fps"));
+			Local<Value> quantize = options->Get(String::NewFromUtf8(isolate, "quantize"));
+			if (!fps_value->IsUndefined() && (!fps_value->IsNumber() || !(fps_value->NumberValue() > 0))) {
+				isolate->ThrowException(Exception::TypeError(
+					String::NewFromUtf8(isolate, "Wrong arguments")));
+				return;
+			}
+			if (fps_value->IsNumber()) fps = fps_value->NumberValue();
+			is_quantized = quantize->BooleanValue();
+		}
+		umabc::UMAbcSetting setting;
+		scene_setting(setting);
+		args.GetReturnValue().Set(Boolean::New(isolate,
+			umabc::UMAbcBakedFile::bake(path, out_path, setting, 1000.0 / fps, is_quantized)));
+	}
+
+	static void release_mapping(const WeakCallbackInfo<MappingHolder>& info) {
+		MappingHolder* holder = info.GetParameter();
+		holder->buffer.Reset();
+		delete holder;
+	}
+
+	/**
+	 * open a baked file. args[0] is its path. opening it again returns the opened file.
+	 * returns { paths, frame_count, start_time, frame_time, quantized } or null.
+	 */
+	void open_bake(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		const std::string path = *utf8path;
+		BakedEntryPtr entry;
+		BakedMap::iterator it = baked_map_.find(path);
+		if (it != baked_map_.end()) {
+			entry = it->second;
+		}
+		else {
+			umabc::UMAbcBakedFilePtr file = umabc::UMAbcBakedFile::open(path);
+			if (!file) {
+				args.GetReturnValue().SetNull();
+				return;
+			}
+			// frames are views into the mapping, never copies
+			Local<ArrayBuffer> buffer = ArrayBuffer::New(isolate, file->data(), file->size());
+			MappingHolder* holder = new MappingHolder();
+			holder->file = file;
+			holder->buffer.Reset(isolate, buffer);
+			holder->buffer.SetWeak(holder, release_mapping, WeakCallbackType::kParameter);
+			entry = std::make_shared<BakedEntry>();
+			entry->file = file;
+			entry->buffer.Reset(isolate, buffer);
+			baked_map_[path] = entry;
+		}
+		umabc::UMAbcBakedFilePtr file = entry->file;
+		Local<Object> result = Object::New(isolate);
+		result->Set(String::NewFromUtf8(isolate, "paths"), path_array(isolate, file->mesh_path_list()));
+		result->Set(String::NewFromUtf8(isolate, "frame_count"), Integer::NewFromUnsigned(isolate, file->frame_count()));
+		result->Set(String::NewFromUtf8(isolate, "start_time"), Number::New(isolate, file->start_time()));
+		result->Set(String::NewFromUtf8(isolate, "frame_time"), Number::New(isolate, file->frame_time()));
+		result->Set(String::NewFromUtf8(isolate, "quantized"), Boolean::New(isolate, file->is_quantized()));
+		args.GetReturnValue().Set(result);
+	}
+
+	/**
+	 * get a baked mesh frame. args[0] is the baked file path, args[1] is the mesh path
+	 * and args[2] is time in milliseconds. returns { vertex, normal, index, uv, global_transform, frame }
+	 * as views into the file. quantized files return vertex as Uint16Array with
+	 * vertex_scale and vertex_offset, and normal as Int8Array.
+	 */
+	void get_baked_mesh(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 3 || !args[0]->IsString() || !args[1]->IsString() || !args[2]->IsNumber()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		BakedMap::iterator it = baked_map_.find(*utf8path);
+		if (it == baked_map_.end()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Not Loaded")));
+			return;
+		}
+		umabc::UMAbcBakedFilePtr file = it->second->file;
+		v8::String::Utf8Value utf8mesh(args[1]->ToString());
+		const unsigned int frame = file->frame_at(args[2]->NumberValue());
+		umabc::UMAbcBakedFile::MeshFrame mesh_frame;
+		Local<Object> result = Object::New(isolate);
+		if (!file->mesh_frame(*utf8mesh, frame, mesh_frame)) {
+			args.GetReturnValue().Set(result);
+			return;
+		}
+		Local<ArrayBuffer> buffer = Local<ArrayBuffer>::New(isolate, it->second->buffer);
+		const char* data = file->data();
+		const unsigned int vertex_count = mesh_frame.vertex_count;
+		const bool is_quantized = file->is_quantized();
+		if (mesh_frame.vertex) {
+			const size_t offset = static_cast<const char*>(mesh_frame.vertex) - data;
+			result->Set(String::NewFromUtf8(isolate, "vertex"), is_quantized
+				? Local<Value>(Uint16Array::New(buffer, offset, vertex_count * 3))
+				: Local<Value>(Float32Array::New(buffer, offset, vertex_count * 3)));
+		}
+		if (mesh_frame.normal) {
+			const size_t offset = static_cast<const char*>(mesh_frame.normal) - data;
+			result->Set(String::NewFromUtf8(isolate, "normal"), is_quantized
+				? Local<Value>(Int8Array::New(buffer, offset, vertex_count * 3))
+				: Local<Value>(Float32Array::New(buffer, offset, vertex_count * 3)));
+		}
+		if (mesh_frame.index && mesh_frame.triangle_count > 0) {
+			const size_t offset = reinterpret_cast<const char*>(mesh_frame.index) - data;
+			result->Set(String::NewFromUtf8(isolate, "index"),
+				Int32Array::New(buffer, offset, mesh_frame.triangle_count * 3));
+		}
+		if (mesh_frame.uv) {
+			const size_t offset = reinterpret_cast<const char*>(mesh_frame.uv) - data;
+			result->Set(String::NewFromUtf8(isolate, "uv"), Float32Array::New(buffer, offset, mesh_frame.uv_count * 2));
+		}
+		if (is_quantized) {
+			Local<Array> scale = Array::New(isolate, 3);
+			Local<Array> offset = Array::New(isolate, 3);
+			for (int i = 0; i < 3; ++i) {
+				scale->Set(i, Number::New(isolate, mesh_frame.vertex_scale[i]));
+				offset->Set(i, Number::New(isolate, mesh_frame.vertex_offset[i]));
+			}
+			result->Set(String::NewFromUtf8(isolate, "vertex_scale"), scale);
+			result->Set(String::NewFromUtf8(isolate, "vertex_offset"), offset);
+		}
+		result->Set(String::NewFromUtf8(isolate, "global_transform"), Float64Array::New(buffer,
+			reinterpret_cast<const char*>(mesh_frame.global_transform) - data, 16));
+		result->Set(String::NewFromUtf8(isolate, "frame"), Integer::NewFromUnsigned(isolate, frame));
+		args.GetReturnValue().Set(result);
+	}
+
+	/**
+	 * close a baked file. args[0] is its path.
+	 * the mapping is released when no view of it remains.
+	 */
+	void close_bake(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		BakedMap::iterator it = baked_map_.find(*utf8path);
+		if (it == baked_map_.end()) return;
+		it->second->buffer.Reset();
+		baked_map_.erase(it);
+	}
+
+	void get_total_time(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		// time range of the scene is the range of its root
+		const umabc::UMAbcScene::Hierarchy* hierarchy = get_hierarchy_of(isolate, args);
+		if (!hierarchy) return;
+		const double scene_min_time = hierarchy->size() > 0 ? hierarchy->times[0] : 0.0;
+		const double scene_max_time = hierarchy->size() > 0 ? hierarchy->times[1] : 0.0;
+
+		Local<Object> time = Object::New(isolate);
+		Local<Number> min_time = Number::New(isolate, scene_min_time);
+		Local<Number> max_time = Number::New(isolate, scene_max_time);
+
+		time->Set(String::NewFromUtf8(isolate, "min"), min_time);
+		time->Set(String::NewFromUtf8(isolate, "max"), max_time);
+		args.GetReturnValue().Set(time);
+	}
+
+	void get_time(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+		Local<Number> time = Number::New(isolate, scene->root_object()->current_time_ms());
+		args.GetReturnValue().Set(time);
+	}
+
+	void set_time(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+		double time = args[1]->NumberValue();
+		scene->set_current_time(static_cast<unsigned long>(time));
+	}
+
+	void get_mesh_path_list(const FunctionCallbackInfo<Value>& args) {
+		get_path_list(args, umabc::UMAbcScene::kObjectTypeMesh);
+	}
+
+	void get_point_path_list(const FunctionCallbackInfo<Value>& args) {
+		get_path_list(args, umabc::UMAbcScene::kObjectTypePoint);
+	}
+
+	void get_curve_path_list(const FunctionCallbackInfo<Value>& args) {
+		get_path_list(args, umabc::UMAbcScene::kObjectTypeCurve);
+	}
+
+	void get_nurbs_path_list(const FunctionCallbackInfo<Value>& args) {
+		get_path_list(args, umabc::UMAbcScene::kObjectTypeNurbs);
+	}
+
+	void get_camera_path_list(const FunctionCallbackInfo<Value>& args) {
+		get_path_list(args, umabc::UMAbcScene::kObjectTypeCamera);
+	}
+
+	void get_xform_path_list(const FunctionCallbackInfo<Value>& args) {
+		get_path_list(args, umabc::UMAbcScene::kObjectTypeXform);
+	}
+
+	void assign_transform(Local<Object>& result, umabc::UMAbcNodePtr node)
+	{
+		Isolate* isolate = Isolate::GetCurrent();
+		{
+			const Imath::M44d& global_transform = node->global_transform();
+			Local<Array> trans = Array::New(isolate, 16);
+			for (int i = 0; i < 4; ++i) {
+				for (int k = 0; k < 4; ++k) {
+					trans->Set(i * 4 + k, Number::New(isolate, global_transform[i][k]));
+				}
+			}
+			result->Set(String::NewFromUtf8(isolate, "global_transform"), trans);
+		}
+		{
+			const Imath::M44d& local_transform = node->local_transform();
+			Local<Array> trans = Array::New(isolate, 16);
+			for (int i = 0; i < 4; ++i) {
+				for (int k = 0; k < 4; ++k) {
+					trans->Set(i * 4 + k, Number::New(isolate, local_transform[i][k]));
+				}
+			}
+			result->Set(String::NewFromUtf8(isolate, "local_transform"), trans);
+		}
+	}
+
+	static Local<Array> matrix_array(Isolate* isolate, const Imath::M44d& matrix)
+	{
+		Local<Array> values = Array::New(isolate, 16);
+		for (int i = 0; i < 4; ++i) {
+			for (int k = 0; k < 4; ++k) {
+				values->Set(i * 4 + k, Number::New(isolate, matrix[i][k]));
+			}
+		}
+		return values;
+	}
+
+	void assign_camera_view(Local<Object>& result, const umabc::UMAbcCamera::View& view)
+	{
+		Isolate* isolate = Isolate::GetCurrent();
+		result->Set(String::NewFromUtf8(isolate, "view_matrix"), matrix_array(isolate, view.view_matrix));
+		result->Set(String::NewFromUtf8(isolate, "projection_matrix"), matrix_array(isolate, view.projection_matrix));
+
+		Local<Array> planes = Array::New(isolate, 24);
+		for (int i = 0; i < 24; ++i) {
+			planes->Set(i, Number::New(isolate, view.planes[i / 4][i % 4]));
+		}
+		result->Set(String::NewFromUtf8(isolate, "frustum"), planes);
+
+		Local<Array> screen_window = Array::New(isolate, 4);
+		for (int i = 0; i < 4; ++i) {
+			screen_window->Set(i, Number::New(isolate, view.screen_window[i]));
+		}
+		result->Set(String::NewFromUtf8(isolate, "screen_window"), screen_window);
+		result->Set(String::NewFromUtf8(isolate, "focal_length"), Number::New(isolate, view.focal_length));
+		result->Set(String::NewFromUtf8(isolate, "horizontal_aperture"), Number::New(isolate, view.horizontal_aperture));
+		result->Set(String::NewFromUtf8(isolate, "vertical_aperture"), Number::New(isolate, view.vertical_aperture));
+		result->Set(String::NewFromUtf8(isolate, "near"), Number::New(isolate, view.near_clipping));
+		result->Set(String::NewFromUtf8(isolate, "far"), Number::New(isolate, view.far_clipping));
+		result->Set(String::NewFromUtf8(isolate, "fov"), Number::New(isolate, view.field_of_view));
+	}
+
+	void get_xform(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
 		v8::String::Utf8Value utf8path(args[1]->ToString());
 		std::string object_path(*utf8path);
 		Local<Object> result = Object::New(isolate);
@@ -245,341 +1311,1657 @@ public:
 		args.GetReturnValue().Set(result);
 	}
 
-	static Imath::M33f rotation_matrix(Imath::M44d mat)
-	{
-		Imath::removeScaling(mat);
-		return Imath::M33f(
-			mat[0][0], mat[0][1], mat[0][2],
-			mat[1][0], mat[1][1], mat[1][2],
-			mat[2][0], mat[2][1], mat[2][2]);
+	static Imath::M33f rotation_matrix(Imath::M44d mat)
+	{
+		Imath::removeScaling(mat);
+		return Imath::M33f(
+			mat[0][0], mat[0][1], mat[0][2],
+			mat[1][0], mat[1][1], mat[1][2],
+			mat[2][0], mat[2][1], mat[2][2]);
+	}
+
+	static double number_option(Isolate* isolate, Local<Object> options, const char* name, double default_value)
+	{
+		Local<Value> value = options->Get(String::NewFromUtf8(isolate, name));
+		return value->IsNumber() ? value->NumberValue() : default_value;
+	}
+
+	static bool bool_option(Isolate* isolate, Local<Object> options, const char* name, bool default_value)
+	{
+		Local<Value> value = options->Get(String::NewFromUtf8(isolate, name));
+		return value->IsBoolean() ? value->BooleanValue() : default_value;
+	}
+
+	static bool vector_option(Isolate* isolate, Local<Object> options, const char* name, Imath::V3f& dst)
+	{
+		Local<Value> value = options->Get(String::NewFromUtf8(isolate, name));
+		if (!value->IsArray()) return false;
+		Local<Array> values = Local<Array>::Cast(value);
+		if (values->Length() < 3) return false;
+		for (int i = 0; i < 3; ++i) {
+			dst[i] = static_cast<float>(values->Get(i)->NumberValue());
+		}
+		return true;
+	}
+
+	/**
+	 * read strand reduction options. "fraction", "box" [minx, miny, minz, maxx, maxy, maxz]
+	 * and "frustum" [a, b, c, d, ...] planes, where ax + by + cz + d >= 0 is inside.
+	 * @retval true if any reduction is requested
+	 */
+	static bool reduce_option(Isolate* isolate, Local<Object> options, umabc::UMAbcCurve::ReduceSetting& dst)
+	{
+		dst.fraction = static_cast<float>(number_option(isolate, options, "fraction", dst.fraction));
+
+		Local<Value> box = options->Get(String::NewFromUtf8(isolate, "box"));
+		if (box->IsArray() && Local<Array>::Cast(box)->Length() >= 6) {
+			Local<Array> values = Local<Array>::Cast(box);
+			for (int i = 0; i < 3; ++i) {
+				dst.box.min[i] = values->Get(i)->NumberValue();
+				dst.box.max[i] = values->Get(i + 3)->NumberValue();
+			}
+			dst.is_box_cull = true;
+		}
+
+		Local<Value> frustum = options->Get(String::NewFromUtf8(isolate, "frustum"));
+		if (frustum->IsArray()) {
+			Local<Array> values = Local<Array>::Cast(frustum);
+			dst.planes.clear();
+			for (unsigned int i = 0; i + 3 < values->Length(); i += 4) {
+				dst.planes.push_back(Imath::V4d(
+					values->Get(i)->NumberValue(),
+					values->Get(i + 1)->NumberValue(),
+					values->Get(i + 2)->NumberValue(),
+					values->Get(i + 3)->NumberValue()));
+			}
+			dst.is_frustum_cull = !dst.planes.empty();
+		}
+		return dst.fraction < 1.0f || dst.is_box_cull || dst.is_frustum_cull;
+	}
+
+	/**
+	 * write vertices, normals, triangle indices, uvs and transforms of the mesh into result
+	 */
+	void assign_mesh(Local<Object>& result, umabc::UMAbcMeshPtr mesh, bool is_apply_matrix)
+	{
+		Isolate* isolate = Isolate::GetCurrent();
+		if (mesh->vertex_size() > 0)
+		{
+			Local<ArrayBuffer> vertices = v8::ArrayBuffer::New(isolate, mesh->vertex_size() * sizeof(Imath::V3f));
+			ArrayBuffer::Contents contents = vertices->GetContents();
+
+			if (is_apply_matrix) {
+				float* data = static_cast<float*>(contents.Data());
+				for (int i = 0, isize = mesh->vertex_size(); i < isize; ++i) {
+					const Imath::V3f v = mesh->vertex()[i] * mesh->global_transform();
+					memcpy(&data[i * 3], &v, sizeof(Imath::V3f));
+				}
+			}
+			else 
+			{
+				memcpy(contents.Data(), mesh->vertex(), mesh->vertex_size() * sizeof(Imath::V3f));
+			}
+			result->Set(String::NewFromUtf8(isolate, "vertex"), Float32Array::New(vertices, 0, mesh->vertex_size() * 3));
+		}
+
+		if (mesh->normals().size() > 0)
+		{
+			Local<ArrayBuffer> normals = v8::ArrayBuffer::New(isolate, mesh->normals().size() * sizeof(Imath::V3f));
+			ArrayBuffer::Contents contents = normals->GetContents();
+
+			if (is_apply_matrix) {
+				float* data = static_cast<float*>(contents.Data());
+				for (int i = 0, isize = mesh->normals().size(); i < isize; ++i) {
+					const Imath::V3f n = mesh->normals()[i] * rotation_matrix(mesh->global_transform());
+					memcpy(&data[i * 3], &n, sizeof(Imath::V3f));
+				}
+			}
+			else
+			{
+				memcpy(contents.Data(), &mesh->normals()[0], mesh->normals().size() * sizeof(Imath::V3f));
+			}
+			result->Set(String::NewFromUtf8(isolate, "normal"), Float32Array::New(normals, 0, mesh->normals().size() * 3));
+		}
+
+		if (mesh->triangle_index().size() > 0)
+		{
+			Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, mesh->triangle_index().size() * sizeof(Imath::V3i));
+			ArrayBuffer::Contents contents = indices->GetContents();
+			memcpy(contents.Data(), &mesh->triangle_index()[0], mesh->triangle_index().size() * sizeof(Imath::V3i));
+			result->Set(String::NewFromUtf8(isolate, "index"), Int32Array::New(indices, 0, mesh->triangle_index().size() * 3));
+		}
+
+		if (mesh->uv_size() > 0) 
+		{
+			Local<ArrayBuffer> uvs = v8::ArrayBuffer::New(isolate, mesh->uv_size() * sizeof(Imath::V2f));
+			ArrayBuffer::Contents contents = uvs->GetContents();
+			Imath::V2f* data = reinterpret_cast<Imath::V2f*>(contents.Data());
+			for (int i = 0, size = mesh->uv_size(); i < size; ++i) {
+				const Imath::V2f* uv = &mesh->uv()[i];
+				Imath::V2f flip(uv->x, 1.0 - uv->y);
+				memcpy(&data[i], &flip, sizeof(Imath::V2f));
+			}
+			result->Set(String::NewFromUtf8(isolate, "uv"), Float32Array::New(uvs, 0, mesh->uv_size() * 2));
+		}
+		assign_transform(result, mesh);
+	}
+
+	void get_mesh(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		bool is_apply_matrix = false;
+		if (args.Length() > 2 && args[2]->IsBoolean()) {
+			is_apply_matrix = args[2]->BooleanValue();
+		}
+
+		umabc::UMAbcMeshPtr mesh = std::dynamic_pointer_cast<umabc::UMAbcMesh>(scene->find_object(object_path));
+		if (mesh) {
+			assign_mesh(result, mesh, is_apply_matrix);
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	/**
+	 * write positions, normals, colors and transforms of the points into result.
+	 * target_count decimates the points. 0 means all points.
+	 */
+	void assign_point(Local<Object>& result, umabc::UMAbcPointPtr point, bool is_apply_matrix, unsigned int target_count)
+	{
+		Isolate* isolate = Isolate::GetCurrent();
+		const unsigned int position_size = point->position_size();
+		const std::vector<unsigned int>* decimated = NULL;
+		if (target_count > 0 && target_count < position_size)
+		{
+			decimated = &point->decimated_index(target_count);
+		}
+		const unsigned int count = decimated ? static_cast<unsigned int>(decimated->size()) : position_size;
+
+		if (count > 0)
+		{
+			Local<ArrayBuffer> positions = v8::ArrayBuffer::New(isolate, count * sizeof(Imath::V3f));
+			ArrayBuffer::Contents contents = positions->GetContents();
+			Imath::V3f* data = static_cast<Imath::V3f*>(contents.Data());
+			for (unsigned int i = 0; i < count; ++i) {
+				const unsigned int src = decimated ? (*decimated)[i] : i;
+				data[i] = is_apply_matrix ? point->positions()[src] * point->global_transform() : point->positions()[src];
+			}
+			result->Set(String::NewFromUtf8(isolate, "position"), Float32Array::New(positions, 0, count * 3));
+
+			if (decimated)
+			{
+				Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, count * sizeof(unsigned int));
+				memcpy(indices->GetContents().Data(), &(*decimated)[0], count * sizeof(unsigned int));
+				result->Set(String::NewFromUtf8(isolate, "index"), Uint32Array::New(indices, 0, count));
+			}
+		}
+
+		// per point attributes follow the decimated index, others are copied as is.
+		if (point->normal_size() > 0)
+		{
+			const bool is_per_point = point->normal_size() == position_size;
+			const unsigned int normal_count = (decimated && is_per_point) ? count : point->normal_size();
+			const Imath::M33f rotation = rotation_matrix(point->global_transform());
+			Local<ArrayBuffer> normals = v8::ArrayBuffer::New(isolate, normal_count * sizeof(Imath::V3f));
+			ArrayBuffer::Contents contents = normals->GetContents();
+			Imath::V3f* data = static_cast<Imath::V3f*>(contents.Data());
+			for (unsigned int i = 0; i < normal_count; ++i) {
+				const unsigned int src = (decimated && is_per_point) ? (*decimated)[i] : i;
+				data[i] = is_apply_matrix ? point->normals()[src] * rotation : point->normals()[src];
+			}
+			result->Set(String::NewFromUtf8(isolate, "normal"), Float32Array::New(normals, 0, normal_count * 3));
+		}
+
+		if (point->color_size() > 0)
+		{
+			const bool is_per_point = point->color_size() == position_size;
+			const unsigned int color_count = (decimated && is_per_point) ? count : point->color_size();
+			Local<ArrayBuffer> colors = v8::ArrayBuffer::New(isolate, color_count * sizeof(Imath::V3f));
+			ArrayBuffer::Contents contents = colors->GetContents();
+			Imath::V3f* data = static_cast<Imath::V3f*>(contents.Data());
+			for (unsigned int i = 0; i < color_count; ++i) {
+				data[i] = point->colors()[(decimated && is_per_point) ? (*decimated)[i] : i];
+			}
+			result->Set(String::NewFromUtf8(isolate, "color"), Float32Array::New(colors, 0, color_count * 3));
+		}
+		assign_transform(result, point);
+	}
+
+	void get_point(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		bool is_apply_matrix = false;
+		if (args.Length() > 2 && args[2]->IsBoolean()) {
+			is_apply_matrix = args[2]->BooleanValue();
+		}
+
+		// decimated read. 0 means all points.
+		unsigned int target_count = 0;
+		if (args.Length() > 3 && args[3]->IsNumber()) {
+			target_count = args[3]->Uint32Value();
+		}
+
+		umabc::UMAbcPointPtr point = std::dynamic_pointer_cast<umabc::UMAbcPoint>(scene->find_object(object_path));
+		if (point)
+		{
+			assign_point(result, point, is_apply_matrix, target_count);
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	/**
+	 * write the reduced strands of the curve into result.
+	 * widths are widened by 1 / fraction to keep the coverage.
+	 */
+	static void get_reduced_curve(
+		Isolate* isolate,
+		Local<Object> result,
+		umabc::UMAbcCurvePtr curve,
+		const umabc::UMAbcCurve::ReduceSetting& reduce,
+		bool is_apply_matrix)
+	{
+		const std::vector<unsigned int>& curve_index = curve->reduced_curve_index(reduce);
+		const std::vector<int>& vertex_count_list = curve->vertex_count_list();
+		const size_t curve_count = vertex_count_list.size();
+		const size_t strand_count = curve_index.size();
+		const float width_scale = reduce.fraction > 0.0f ? 1.0f / std::min(1.0f, reduce.fraction) : 1.0f;
+
+		std::vector<unsigned int> first_vertex(curve_count + 1, 0);
+		for (size_t i = 0; i < curve_count; ++i) {
+			first_vertex[i + 1] = first_vertex[i] + std::max(0, vertex_count_list[i]);
+		}
+		if (first_vertex[curve_count] > static_cast<unsigned int>(curve->position_size())) return;
+
+		size_t point_count = 0;
+		for (size_t i = 0; i < strand_count; ++i) {
+			point_count += first_vertex[curve_index[i] + 1] - first_vertex[curve_index[i]];
+		}
+
+		{
+			Local<ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, strand_count * sizeof(unsigned int));
+			if (strand_count > 0) {
+				memcpy(buffer->GetContents().Data(), &curve_index[0], strand_count * sizeof(unsigned int));
+			}
+			result->Set(String::NewFromUtf8(isolate, "curve_index"), Uint32Array::New(buffer, 0, strand_count));
+
+			Local<ArrayBuffer> counts = v8::ArrayBuffer::New(isolate, strand_count * sizeof(int));
+			int* data = static_cast<int*>(counts->GetContents().Data());
+			for (size_t i = 0; i < strand_count; ++i) {
+				data[i] = vertex_count_list[curve_index[i]];
+			}
+			result->Set(String::NewFromUtf8(isolate, "vertex_count_list"), Int32Array::New(counts, 0, strand_count));
+		}
+
+		if (point_count > 0)
+		{
+			Local<ArrayBuffer> positions = v8::ArrayBuffer::New(isolate, point_count * sizeof(Imath::V3f));
+			Imath::V3f* data = static_cast<Imath::V3f*>(positions->GetContents().Data());
+			for (size_t i = 0, k = 0; i < strand_count; ++i) {
+				for (unsigned int v = first_vertex[curve_index[i]]; v < first_vertex[curve_index[i] + 1]; ++v, ++k) {
+					data[k] = is_apply_matrix ? curve->positions()[v] * curve->global_transform() : curve->positions()[v];
+				}
+			}
+			result->Set(String::NewFromUtf8(isolate, "position"), Float32Array::New(positions, 0, point_count * 3));
+		}
+
+		// constant, per curve or per vertex widths
+		const size_t width_size = curve->width_size();
+		const bool is_per_vertex = width_size == first_vertex[curve_count] && width_size != curve_count;
+		const bool is_per_curve = width_size == curve_count && width_size > 1;
+		if (width_size > 0)
+		{
+			const size_t size = is_per_vertex ? point_count : (is_per_curve ? strand_count : width_size);
+			Local<ArrayBuffer> widths = v8::ArrayBuffer::New(isolate, size * sizeof(float));
+			float* data = static_cast<float*>(widths->GetContents().Data());
+			if (is_per_vertex) {
+				for (size_t i = 0, k = 0; i < strand_count; ++i) {
+					for (unsigned int v = first_vertex[curve_index[i]]; v < first_vertex[curve_index[i] + 1]; ++v, ++k) {
+						data[k] = curve->widths()[v] * width_scale;
+					}
+				}
+			}
+			else {
+				for (size_t i = 0; i < size; ++i) {
+					data[i] = curve->widths()[is_per_curve ? curve_index[i] : i] * width_scale;
+				}
+			}
+			result->Set(String::NewFromUtf8(isolate, "width"), Float32Array::New(widths, 0, size));
+		}
+		result->Set(String::NewFromUtf8(isolate, "width_scale"), Number::New(isolate, width_scale));
+		result->Set(String::NewFromUtf8(isolate, "curve"), Int32::New(isolate, static_cast<int>(strand_count)));
+	}
+
+	void get_curve(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		bool is_apply_matrix = false;
+		if (args.Length() > 2 && args[2]->IsBoolean()) {
+			is_apply_matrix = args[2]->BooleanValue();
+		}
+
+		// strand reduction
+		umabc::UMAbcCurve::ReduceSetting reduce;
+		bool is_reduce = false;
+		if (args.Length() > 3 && args[3]->IsObject()) {
+			is_reduce = reduce_option(isolate, args[3]->ToObject(), reduce);
+		}
+
+		umabc::UMAbcCurvePtr curve = std::dynamic_pointer_cast<umabc::UMAbcCurve>(scene->find_object(object_path));
+		if (curve && is_reduce)
+		{
+			if (is_apply_matrix) {
+				reduce.matrix = curve->global_transform();
+			}
+			get_reduced_curve(isolate, result, curve, reduce, is_apply_matrix);
+			assign_transform(result, curve);
+		}
+		else if (curve)
+		{
+			if (curve->position_size() > 0)
+			{
+				Local<ArrayBuffer> positions = v8::ArrayBuffer::New(isolate, curve->position_size() * sizeof(Imath::V3f));
+				ArrayBuffer::Contents contents = positions->GetContents();
+
+				if (is_apply_matrix) {
+					Imath::V3f* data = static_cast<Imath::V3f*>(contents.Data());
+					for (int i = 0, size = curve->position_size(); i < size; ++i) {
+						data[i] = curve->positions()[i] * curve->global_transform();
+					}
+				}
+				else
+				{
+					memcpy(contents.Data(), curve->positions(), curve->position_size() * sizeof(Imath::V3f));
+				}
+				result->Set(String::NewFromUtf8(isolate, "position"), Float32Array::New(positions, 0, curve->position_size() * 3));
+			}
+
+			if (curve->width_size() > 0)
+			{
+				Local<ArrayBuffer> widths = v8::ArrayBuffer::New(isolate, curve->width_size() * sizeof(float));
+				memcpy(widths->GetContents().Data(), curve->widths(), curve->width_size() * sizeof(float));
+				result->Set(String::NewFromUtf8(isolate, "width"), Float32Array::New(widths, 0, curve->width_size()));
+			}
+
+			if (curve->vertex_count_list().size() > 0)
+			{
+				Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, curve->vertex_count_list().size() * sizeof(int));
+				ArrayBuffer::Contents contents = indices->GetContents();
+				memcpy(contents.Data(), &curve->vertex_count_list()[0], curve->vertex_count_list().size() * sizeof(int));
+				result->Set(String::NewFromUtf8(isolate, "vertex_count_list"), Int32Array::New(indices, 0, curve->vertex_count_list().size()));
+			}
+
+			result->Set(String::NewFromUtf8(isolate, "curve"), Int32::New(isolate, curve->curve_count()));
+
+			assign_transform(result, curve);
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	void tessellate_curve(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		umabc::UMAbcCurveTessellator::Setting setting;
+		umabc::UMAbcCurve::ReduceSetting reduce;
+		bool is_reduce = false;
+		bool is_apply_matrix = true;
+		if (args.Length() > 2 && args[2]->IsObject()) {
+			Local<Object> options = args[2]->ToObject();
+			is_reduce = reduce_option(isolate, options, reduce);
+			setting.tolerance = static_cast<float>(number_option(isolate, options, "tolerance", setting.tolerance));
+			setting.max_segments = static_cast<int>(number_option(isolate, options, "max_segments", setting.max_segments));
+			setting.default_width = static_cast<float>(number_option(isolate, options, "width", setting.default_width));
+			setting.is_ribbon = bool_option(isolate, options, "ribbon", setting.is_ribbon);
+			vector_option(isolate, options, "camera", setting.camera_position);
+			is_apply_matrix = bool_option(isolate, options, "apply_matrix", is_apply_matrix);
+		}
+
+		umabc::UMAbcCurvePtr curve = std::dynamic_pointer_cast<umabc::UMAbcCurve>(scene->find_object(object_path));
+		if (curve)
+		{
+			if (is_apply_matrix) {
+				setting.matrix = curve->global_transform();
+			}
+			const std::vector<unsigned int>* curve_index = NULL;
+			if (is_reduce) {
+				reduce.matrix = setting.matrix;
+				curve_index = &curve->reduced_curve_index(reduce);
+				if (reduce.fraction > 0.0f && reduce.fraction < 1.0f) {
+					setting.width_scale = 1.0f / reduce.fraction;
+				}
+				Local<ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, curve_index->size() * sizeof(unsigned int));
+				if (!curve_index->empty()) {
+					memcpy(buffer->GetContents().Data(), &(*curve_index)[0], curve_index->size() * sizeof(unsigned int));
+				}
+				result->Set(String::NewFromUtf8(isolate, "curve_index"), Uint32Array::New(buffer, 0, curve_index->size()));
+			}
+			const umabc::UMAbcCurveTessellator& tessellator = curve->tessellate(setting, curve_index);
+
+			const std::vector<unsigned int>& offsets = tessellator.offsets();
+			{
+				Local<ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, offsets.size() * sizeof(unsigned int));
+				if (!offsets.empty()) {
+					memcpy(buffer->GetContents().Data(), &offsets[0], offsets.size() * sizeof(unsigned int));
+				}
+				result->Set(String::NewFromUtf8(isolate, "offset"), Uint32Array::New(buffer, 0, offsets.size()));
+			}
+
+			const size_t point_count = tessellator.positions().size();
+			if (point_count > 0)
+			{
+				Local<ArrayBuffer> positions = v8::ArrayBuffer::New(isolate, point_count * sizeof(Imath::V3f));
+				memcpy(positions->GetContents().Data(), &tessellator.positions()[0], point_count * sizeof(Imath::V3f));
+				result->Set(String::NewFromUtf8(isolate, "position"), Float32Array::New(positions, 0, point_count * 3));
+
+				Local<ArrayBuffer> widths = v8::ArrayBuffer::New(isolate, point_count * sizeof(float));
+				memcpy(widths->GetContents().Data(), &tessellator.widths()[0], point_count * sizeof(float));
+				result->Set(String::NewFromUtf8(isolate, "width"), Float32Array::New(widths, 0, point_count));
+			}
+
+			// ribbons use the same layout as get_mesh
+			const size_t vertex_count = tessellator.ribbon_vertices().size();
+			const size_t triangle_count = tessellator.ribbon_triangle_index().size();
+			if (vertex_count > 0)
+			{
+				Local<ArrayBuffer> vertices = v8::ArrayBuffer::New(isolate, vertex_count * sizeof(Imath::V3f));
+				memcpy(vertices->GetContents().Data(), &tessellator.ribbon_vertices()[0], vertex_count * sizeof(Imath::V3f));
+				result->Set(String::NewFromUtf8(isolate, "vertex"), Float32Array::New(vertices, 0, vertex_count * 3));
+
+				Local<ArrayBuffer> normals = v8::ArrayBuffer::New(isolate, vertex_count * sizeof(Imath::V3f));
+				memcpy(normals->GetContents().Data(), &tessellator.ribbon_normals()[0], vertex_count * sizeof(Imath::V3f));
+				result->Set(String::NewFromUtf8(isolate, "normal"), Float32Array::New(normals, 0, vertex_count * 3));
+			}
+			if (triangle_count > 0)
+			{
+				Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, triangle_count * sizeof(Imath::V3i));
+				memcpy(indices->GetContents().Data(), &tessellator.ribbon_triangle_index()[0], triangle_count * sizeof(Imath::V3i));
+				result->Set(String::NewFromUtf8(isolate, "index"), Int32Array::New(indices, 0, triangle_count * 3));
+			}
+			assign_transform(result, curve);
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	void get_nurbs(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		bool is_apply_matrix = false;
+		if (args.Length() > 2 && args[2]->IsBoolean()) {
+			is_apply_matrix = args[2]->BooleanValue();
+		}
+
+		umabc::UMAbcNurbsPatchPtr nurbs = std::dynamic_pointer_cast<umabc::UMAbcNurbsPatch>(scene->find_object(object_path));
+		if (nurbs)
+		{
+			if (nurbs->position_size() > 0)
+			{
+				Local<Array> positions = Array::New(isolate, nurbs->position_size() * 3);
+				if (is_apply_matrix) {
+					for (int i = 0, size = nurbs->position_size(); i < size; ++i) {
+						Imath::V3f pos = nurbs->positions()[i] * nurbs->global_transform();
+						positions->Set(i * 3 + 0, Number::New(isolate, pos[0]));
+						positions->Set(i * 3 + 1, Number::New(isolate, pos[1]));
+						positions->Set(i * 3 + 2, Number::New(isolate, pos[2]));
+					}
+				}
+				else
+				{
+					for (int i = 0, size = nurbs->position_size(); i < size; ++i) {
+						positions->Set(i * 3 + 0, Number::New(isolate, nurbs->positions()[i][0]));
+						positions->Set(i * 3 + 1, Number::New(isolate, nurbs->positions()[i][1]));
+						positions->Set(i * 3 + 2, Number::New(isolate, nurbs->positions()[i][2]));
+					}
+				}
+				result->Set(String::NewFromUtf8(isolate, "position"), positions);
+			}
+
+			if (nurbs->u_knot_size() > 0)
+			{
+				Local<Array> u_knots = Array::New(isolate, nurbs->u_knot_size());
+				for (int i = 0, size = nurbs->u_knot_size(); i < size; ++i) {
+					u_knots->Set(i, Number::New(isolate, nurbs->u_knots()[i]));
+				}
+				result->Set(String::NewFromUtf8(isolate, "u_knot"), u_knots);
+			}
+
+			if (nurbs->v_knot_size() > 0)
+			{
+				Local<Array> v_knots = Array::New(isolate, nurbs->v_knot_size());
+				for (int i = 0, size = nurbs->v_knot_size(); i < size; ++i) {
+					v_knots->Set(i, Number::New(isolate, nurbs->v_knots()[i]));
+				}
+				result->Set(String::NewFromUtf8(isolate, "v_knot"), v_knots);
+			}
+
+			result->Set(String::NewFromUtf8(isolate, "u_size"), Uint32::New(isolate, nurbs->u_size()));
+			result->Set(String::NewFromUtf8(isolate, "v_size"), Uint32::New(isolate, nurbs->v_size()));
+			result->Set(String::NewFromUtf8(isolate, "u_order"), Uint32::New(isolate, nurbs->u_order()));
+			result->Set(String::NewFromUtf8(isolate, "v_order"), Uint32::New(isolate, nurbs->v_order()));
+
+			assign_transform(result, nurbs);
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	void tessellate_nurbs(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		umabc::UMAbcNurbsTessellator::Setting setting;
+		bool is_apply_matrix = true;
+		if (args.Length() > 2 && args[2]->IsObject()) {
+			Local<Object> options = args[2]->ToObject();
+			setting.tolerance = static_cast<float>(number_option(isolate, options, "tolerance", setting.tolerance));
+			setting.max_segments = static_cast<int>(number_option(isolate, options, "max_segments", setting.max_segments));
+			is_apply_matrix = bool_option(isolate, options, "apply_matrix", is_apply_matrix);
+		}
+
+		umabc::UMAbcNurbsPatchPtr nurbs = std::dynamic_pointer_cast<umabc::UMAbcNurbsPatch>(scene->find_object(object_path));
+		if (nurbs)
+		{
+			if (is_apply_matrix) {
+				setting.matrix = nurbs->global_transform();
+			}
+			const umabc::UMAbcNurbsTessellator& tessellator = nurbs->tessellate(setting);
+
+			// same layout as get_mesh
+			const size_t vertex_count = tessellator.vertices().size();
+			const size_t triangle_count = tessellator.triangle_index().size();
+			if (vertex_count > 0)
+			{
+				Local<ArrayBuffer> vertices = v8::ArrayBuffer::New(isolate, vertex_count * sizeof(Imath::V3f));
+				memcpy(vertices->GetContents().Data(), &tessellator.vertices()[0], vertex_count * sizeof(Imath::V3f));
+				result->Set(String::NewFromUtf8(isolate, "vertex"), Float32Array::New(vertices, 0, vertex_count * 3));
+
+				Local<ArrayBuffer> normals = v8::ArrayBuffer::New(isolate, vertex_count * sizeof(Imath::V3f));
+				memcpy(normals->GetContents().Data(), &tessellator.normals()[0], vertex_count * sizeof(Imath::V3f));
+				result->Set(String::NewFromUtf8(isolate, "normal"), Float32Array::New(normals, 0, vertex_count * 3));
+
+				Local<ArrayBuffer> uvs = v8::ArrayBuffer::New(isolate, vertex_count * sizeof(Imath::V2f));
+				Imath::V2f* data = static_cast<Imath::V2f*>(uvs->GetContents().Data());
+				for (size_t i = 0; i < vertex_count; ++i) {
+					const Imath::V2f& uv = tessellator.uvs()[i];
+					data[i] = Imath::V2f(uv.x, 1.0f - uv.y);
+				}
+				result->Set(String::NewFromUtf8(isolate, "uv"), Float32Array::New(uvs, 0, vertex_count * 2));
+			}
+			if (triangle_count > 0)
+			{
+				Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, triangle_count * sizeof(Imath::V3i));
+				memcpy(indices->GetContents().Data(), &tessellator.triangle_index()[0], triangle_count * sizeof(Imath::V3i));
+				result->Set(String::NewFromUtf8(isolate, "index"), Int32Array::New(indices, 0, triangle_count * 3));
+			}
+			assign_transform(result, nurbs);
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	void get_camera(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		umabc::UMAbcCameraPtr camera = std::dynamic_pointer_cast<umabc::UMAbcCamera>(scene->find_object(object_path));
+		if (camera)
+		{
+			assign_transform(result, camera);
+			assign_camera_view(result, camera->view());
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	/**
+	 * get camera over many times.
+	 * args[2] is an array of times or {start, end, step} in milliseconds.
+	 * results are packed per time. more than kMaxCameraSampleCount times are rejected.
+	 */
+	void get_camera_range(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		if (args.Length() < 3 || !(args[2]->IsArray() || args[2]->IsObject())) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		std::vector<unsigned long> times;
+		if (args[2]->IsArray()) {
+			Local<Array> values = Local<Array>::Cast(args[2]);
+			if (values->Length() > kMaxCameraSampleCount) {
+				isolate->ThrowException(Exception::TypeError(
+					String::NewFromUtf8(isolate, "Wrong arguments")));
+				return;
+			}
+			times.resize(values->Length());
+			for (unsigned int i = 0; i < values->Length(); ++i) {
+				times[i] = static_cast<unsigned long>(std::max(0.0, values->Get(i)->NumberValue()));
+			}
+		}
+		else {
+			Local<Object> options = args[2]->ToObject();
+			const double start = std::max(0.0, number_option(isolate, options, "start", 0.0));
+			const double end = std::max(start, number_option(isolate, options, "end", start));
+			const double step = number_option(isolate, options, "step", 1000.0 / 24.0);
+			if (step > 0.0) {
+				if (!((end - start) / step < kMaxCameraSampleCount)) {
+					isolate->ThrowException(Exception::TypeError(
+						String::NewFromUtf8(isolate, "Wrong arguments")));
+					return;
+				}
+				for (unsigned long i = 0; start + i * step <= end; ++i) {
+					times.push_back(static_cast<unsigned long>(start + i * step + 0.5));
+				}
+			}
+		}
+
+		umabc::UMAbcCameraPtr camera = std::dynamic_pointer_cast<umabc::UMAbcCamera>(scene->find_object(object_path));
+		if (camera)
+		{
+			std::vector<umabc::UMAbcCamera::View> views;
+			camera->evaluate(times, views);
+			const size_t count = views.size();
+
+			Local<ArrayBuffer> time_buffer = v8::ArrayBuffer::New(isolate, count * sizeof(double));
+			Local<ArrayBuffer> global_buffer = v8::ArrayBuffer::New(isolate, count * 16 * sizeof(float));
+			Local<ArrayBuffer> view_buffer = v8::ArrayBuffer::New(isolate, count * 16 * sizeof(float));
+			Local<ArrayBuffer> projection_buffer = v8::ArrayBuffer::New(isolate, count * 16 * sizeof(float));
+			Local<ArrayBuffer> plane_buffer = v8::ArrayBuffer::New(isolate, count * 24 * sizeof(float));
+			Local<ArrayBuffer> lens_buffer = v8::ArrayBuffer::New(isolate, count * 6 * sizeof(float));
+			double* time_data = static_cast<double*>(time_buffer->GetContents().Data());
+			float* global_data = static_cast<float*>(global_buffer->GetContents().Data());
+			float* view_data = static_cast<float*>(view_buffer->GetContents().Data());
+			float* projection_data = static_cast<float*>(projection_buffer->GetContents().Data());
+			float* plane_data = static_cast<float*>(plane_buffer->GetContents().Data());
+			float* lens_data = static_cast<float*>(lens_buffer->GetContents().Data());
+			for (size_t i = 0; i < count; ++i) {
+				const umabc::UMAbcCamera::View& view = views[i];
+				time_data[i] = static_cast<double>(times[i]);
+				for (int k = 0; k < 16; ++k) {
+					global_data[i * 16 + k] = static_cast<float>(view.global_transform[k / 4][k % 4]);
+					view_data[i * 16 + k] = static_cast<float>(view.view_matrix[k / 4][k % 4]);
+					projection_data[i * 16 + k] = static_cast<float>(view.projection_matrix[k / 4][k % 4]);
+				}
+				for (int k = 0; k < 24; ++k) {
+					plane_data[i * 24 + k] = static_cast<float>(view.planes[k / 4][k % 4]);
+				}
+				lens_data[i * 6 + 0] = static_cast<float>(view.focal_length);
+				lens_data[i * 6 + 1] = static_cast<float>(view.horizontal_aperture);
+				lens_data[i * 6 + 2] = static_cast<float>(view.vertical_aperture);
+				lens_data[i * 6 + 3] = static_cast<float>(view.near_clipping);
+				lens_data[i * 6 + 4] = static_cast<float>(view.far_clipping);
+				lens_data[i * 6 + 5] = static_cast<float>(view.field_of_view);
+			}
+			result->Set(String::NewFromUtf8(isolate, "time"), Float64Array::New(time_buffer, 0, count));
+			result->Set(String::NewFromUtf8(isolate, "global_transform"), Float32Array::New(global_buffer, 0, count * 16));
+			result->Set(String::NewFromUtf8(isolate, "view_matrix"), Float32Array::New(view_buffer, 0, count * 16));
+			result->Set(String::NewFromUtf8(isolate, "projection_matrix"), Float32Array::New(projection_buffer, 0, count * 16));
+			result->Set(String::NewFromUtf8(isolate, "frustum"), Float32Array::New(plane_buffer, 0, count * 24));
+			// focal_length, horizontal_aperture, vertical_aperture, near, far, fov
+			result->Set(String::NewFromUtf8(isolate, "lens"), Float32Array::New(lens_buffer, 0, count * 6));
+		}
+		args.GetReturnValue().Set(result);
+	}
+
+	void get_information(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		std::string object_path(*utf8path);
+		Local<Object> result = Object::New(isolate);
+
+		umabc::UMAbcObjectPtr obj = scene->find_object(object_path);
+		const unsigned int time = obj->current_time_ms();
+		bool has_changed = false;
+		if (obj->min_time() <= time && time <= obj->max_time()) {
+			has_changed = true;
+		}
+		result->Set(String::NewFromUtf8(isolate, "has_changed"), Boolean::New(isolate, has_changed));
+		result->Set(String::NewFromUtf8(isolate, "is_valid"), Boolean::New(isolate, obj->is_valid()));
+		result->Set(String::NewFromUtf8(isolate, "is_visible"), Boolean::New(isolate, obj->is_visible()));
+		
+		Local<Array> bbox = Array::New(isolate, 6);
+		for (int i = 0; i < 3; ++i) {
+			bbox->Set(i, Number::New(isolate, obj->box().min[i]));
+			bbox->Set(i + 3, Number::New(isolate, obj->box().max[i]));
+		}
+		result->Set(String::NewFromUtf8(isolate, "bbox"), bbox);
+		
+		args.GetReturnValue().Set(result);
+	}
+
+	/**
+	 * get paths of geometry objects overlapping the box.
+	 * args[1] is [minx, miny, minz, maxx, maxy, maxz] in world space.
+	 */
+	void query_box(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		if (args.Length() < 2 || !args[1]->IsArray() || Local<Array>::Cast(args[1])->Length() < 6) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		Local<Array> values = Local<Array>::Cast(args[1]);
+		Imath::Box3d box;
+		for (int i = 0; i < 3; ++i) {
+			box.min[i] = values->Get(i)->NumberValue();
+			box.max[i] = values->Get(i + 3)->NumberValue();
+		}
+		args.GetReturnValue().Set(path_array(isolate, scene->box_query(box)));
 	}
 
-	void get_mesh(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * get paths of geometry objects inside or intersecting the frustum.
+	 * args[1] is a camera path or planes [a, b, c, d, ...] where ax + by + cz + d >= 0 is inside.
+	 */
+	void query_frustum(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		std::vector<Imath::V4d> planes;
+		if (args.Length() > 1 && args[1]->IsString()) {
+			v8::String::Utf8Value utf8path(args[1]->ToString());
+			umabc::UMAbcCameraPtr camera = std::dynamic_pointer_cast<umabc::UMAbcCamera>(scene->find_object(*utf8path));
+			if (camera && camera->view().is_valid) {
+				planes.assign(camera->view().planes, camera->view().planes + 6);
+			}
+		}
+		else if (args.Length() > 1 && args[1]->IsArray()) {
+			Local<Array> values = Local<Array>::Cast(args[1]);
+			for (unsigned int i = 0; i + 3 < values->Length(); i += 4) {
+				planes.push_back(Imath::V4d(
+					values->Get(i)->NumberValue(),
+					values->Get(i + 1)->NumberValue(),
+					values->Get(i + 2)->NumberValue(),
+					values->Get(i + 3)->NumberValue()));
+			}
+		}
+		if (planes.empty()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		args.GetReturnValue().Set(path_array(isolate, scene->frustum_query(planes)));
+	}
+
+	/**
+	 * get nearest mesh hit along the ray.
+	 * args[1] is origin [x, y, z], args[2] is direction [x, y, z] and args[3] is optional max distance.
+	 * returns an empty object when nothing is hit.
+	 */
+	void raycast(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
 		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		if (args.Length() < 3
+			|| !args[1]->IsArray() || Local<Array>::Cast(args[1])->Length() < 3
+			|| !args[2]->IsArray() || Local<Array>::Cast(args[2])->Length() < 3) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		Local<Array> origin_values = Local<Array>::Cast(args[1]);
+		Local<Array> direction_values = Local<Array>::Cast(args[2]);
+		Imath::V3d origin;
+		Imath::V3d direction;
+		for (int i = 0; i < 3; ++i) {
+			origin[i] = origin_values->Get(i)->NumberValue();
+			direction[i] = direction_values->Get(i)->NumberValue();
+		}
+		double max_distance = std::numeric_limits<double>::max();
+		if (args.Length() > 3 && args[3]->IsNumber()) {
+			max_distance = args[3]->NumberValue();
+		}
 
-		v8::String::Utf8Value utf8path(args[1]->ToString());
-		std::string object_path(*utf8path);
 		Local<Object> result = Object::New(isolate);
+		umabc::UMAbcScene::RayHit hit;
+		if (scene->raycast(origin, direction, max_distance, hit)) {
+			result->Set(String::NewFromUtf8(isolate, "path"), String::NewFromUtf8(isolate, hit.path.c_str()));
+			result->Set(String::NewFromUtf8(isolate, "distance"), Number::New(isolate, hit.distance));
+			result->Set(String::NewFromUtf8(isolate, "triangle"), Integer::New(isolate, hit.triangle));
+			Local<Array> barycentric = Array::New(isolate, 2);
+			barycentric->Set(0, Number::New(isolate, hit.u));
+			barycentric->Set(1, Number::New(isolate, hit.v));
+			result->Set(String::NewFromUtf8(isolate, "barycentric"), barycentric);
+			Local<Array> position = Array::New(isolate, 3);
+			Local<Array> normal = Array::New(isolate, 3);
+			for (int i = 0; i < 3; ++i) {
+				position->Set(i, Number::New(isolate, hit.position[i]));
+				normal->Set(i, Number::New(isolate, hit.normal[i]));
+			}
+			result->Set(String::NewFromUtf8(isolate, "position"), position);
+			result->Set(String::NewFromUtf8(isolate, "normal"), normal);
+		}
+		args.GetReturnValue().Set(result);
+	}
 
-		bool is_apply_matrix = false;
-		if (args.Length() > 2 && args[2]->IsBoolean()) {
-			is_apply_matrix = args[2]->BooleanValue();
+	/**
+	 * get closest point on the mesh.
+	 * args[1] is mesh path, args[2] is world space point [x, y, z] and args[3] is optional max distance.
+	 * returns an empty object when nothing is found.
+	 */
+	void closest_point(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		if (args.Length() < 3 || !args[1]->IsString()
+			|| !args[2]->IsArray() || Local<Array>::Cast(args[2])->Length() < 3) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8path(args[1]->ToString());
+		Local<Array> point_values = Local<Array>::Cast(args[2]);
+		Imath::V3d point;
+		for (int i = 0; i < 3; ++i) {
+			point[i] = point_values->Get(i)->NumberValue();
+		}
+		double max_distance = std::numeric_limits<double>::max();
+		if (args.Length() > 3 && args[3]->IsNumber()) {
+			max_distance = args[3]->NumberValue();
 		}
 
-		umabc::UMAbcMeshPtr mesh = std::dynamic_pointer_cast<umabc::UMAbcMesh>(scene->find_object(object_path));
-		if (mesh) {
-			if (mesh->vertex_size() > 0)
-			{
-				Local<ArrayBuffer> vertices = v8::ArrayBuffer::New(isolate, mesh->vertex_size() * sizeof(Imath::V3f));
-				ArrayBuffer::Contents contents = vertices->GetContents();
+		Local<Object> result = Object::New(isolate);
+		umabc::UMAbcScene::ClosestHit hit;
+		if (scene->closest_point(*utf8path, point, max_distance, hit)) {
+			result->Set(String::NewFromUtf8(isolate, "distance"), Number::New(isolate, hit.distance));
+			result->Set(String::NewFromUtf8(isolate, "triangle"), Integer::New(isolate, hit.triangle));
+			Local<Array> barycentric = Array::New(isolate, 2);
+			barycentric->Set(0, Number::New(isolate, hit.u));
+			barycentric->Set(1, Number::New(isolate, hit.v));
+			result->Set(String::NewFromUtf8(isolate, "barycentric"), barycentric);
+			Local<Array> position = Array::New(isolate, 3);
+			for (int i = 0; i < 3; ++i) {
+				position->Set(i, Number::New(isolate, hit.position[i]));
+			}
+			result->Set(String::NewFromUtf8(isolate, "position"), position);
+		}
+		args.GetReturnValue().Set(result);
+	}
 
-				if (is_apply_matrix) {
-					float* data = static_cast<float*>(contents.Data());
-					for (int i = 0, isize = mesh->vertex_size(); i < isize; ++i) {
-						const Imath::V3f v = mesh->vertex()[i] * mesh->global_transform();
-						memcpy(&data[i * 3], &v, sizeof(Imath::V3f));
-					}
-				}
-				else 
-				{
-					memcpy(contents.Data(), mesh->vertex(), mesh->vertex_size() * sizeof(Imath::V3f));
-				}
-				result->Set(String::NewFromUtf8(isolate, "vertex"), Float32Array::New(vertices, 0, mesh->vertex_size() * 3));
+	/**
+	 * get distance from each vertex of the source mesh to the target mesh.
+	 * args[1] is source mesh path, args[2] is target mesh path and
+	 * args[3] is optional { max_distance: number, signed: bool }.
+	 * returns distance (Float32Array), triangle (Int32Array) and barycentric (Float32Array, 2 per vertex).
+	 */
+	void mesh_distance(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		if (args.Length() < 3 || !args[1]->IsString() || !args[2]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
+		}
+		v8::String::Utf8Value utf8source(args[1]->ToString());
+		v8::String::Utf8Value utf8target(args[2]->ToString());
+		double max_distance = std::numeric_limits<double>::max();
+		bool is_signed = false;
+		if (args.Length() > 3 && args[3]->IsObject()) {
+			Local<Object> options = args[3]->ToObject();
+			Local<Value> max_value = options->Get(String::NewFromUtf8(isolate, "max_distance"));
+			if (max_value->IsNumber()) {
+				max_distance = max_value->NumberValue();
 			}
+			Local<Value> signed_value = options->Get(String::NewFromUtf8(isolate, "signed"));
+			if (signed_value->IsBoolean()) {
+				is_signed = signed_value->BooleanValue();
+			}
+		}
 
-			if (mesh->normals().size() > 0)
-			{
-				Local<ArrayBuffer> normals = v8::ArrayBuffer::New(isolate, mesh->normals().size() * sizeof(Imath::V3f));
-				ArrayBuffer::Contents contents = normals->GetContents();
+		Local<Object> result = Object::New(isolate);
+		umabc::UMAbcScene::MeshDistance distance;
+		if (scene->mesh_distance(*utf8source, *utf8target, max_distance, is_signed, distance)) {
+			const size_t size = distance.distance.size();
+			Local<ArrayBuffer> distances = v8::ArrayBuffer::New(isolate, size * sizeof(float));
+			Local<ArrayBuffer> triangles = v8::ArrayBuffer::New(isolate, size * sizeof(int));
+			Local<ArrayBuffer> barycentrics = v8::ArrayBuffer::New(isolate, size * 2 * sizeof(float));
+			if (size > 0) {
+				memcpy(distances->GetContents().Data(), &distance.distance[0], size * sizeof(float));
+				memcpy(triangles->GetContents().Data(), &distance.triangle[0], size * sizeof(int));
+				memcpy(barycentrics->GetContents().Data(), &distance.barycentric[0], size * 2 * sizeof(float));
+			}
+			result->Set(String::NewFromUtf8(isolate, "distance"), Float32Array::New(distances, 0, size));
+			result->Set(String::NewFromUtf8(isolate, "triangle"), Int32Array::New(triangles, 0, size));
+			result->Set(String::NewFromUtf8(isolate, "barycentric"), Float32Array::New(barycentrics, 0, size * 2));
+		}
+		args.GetReturnValue().Set(result);
+	}
 
-				if (is_apply_matrix) {
-					float* data = static_cast<float*>(contents.Data());
-					for (int i = 0, isize = mesh->normals().size(); i < isize; ++i) {
-						const Imath::V3f n = mesh->normals()[i] * rotation_matrix(mesh->global_transform());
-						memcpy(&data[i * 3], &n, sizeof(Imath::V3f));
-					}
+	/**
+	 * get world space vertices and indices of all meshes merged at current time.
+	 * args[1] is optional { group: "none" | "faceset" | "material", visible_only: bool }.
+	 * returns position, normal (Float32Array), index (Uint32Array),
+	 * groups [{ name, index_offset, index_count }] and
+	 * objects [{ path, group, vertex_offset, vertex_count, index_offset, index_count, changed }].
+	 * changed is false when the vertex range has same values as the previous call.
+	 */
+	void get_scene_batch(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		umabc::UMAbcScene::BatchSetting setting;
+		if (args.Length() > 1 && args[1]->IsObject()) {
+			Local<Object> options = args[1]->ToObject();
+			Local<Value> group_value = options->Get(String::NewFromUtf8(isolate, "group"));
+			if (group_value->IsString()) {
+				v8::String::Utf8Value utf8group(group_value->ToString());
+				const std::string group(*utf8group);
+				if (group == "faceset") {
+					setting.group = umabc::UMAbcScene::kBatchGroupFaceset;
 				}
-				else
-				{
-					memcpy(contents.Data(), &mesh->normals()[0], mesh->normals().size() * sizeof(Imath::V3f));
+				else if (group == "material") {
+					setting.group = umabc::UMAbcScene::kBatchGroupMaterial;
 				}
-				result->Set(String::NewFromUtf8(isolate, "normal"), Float32Array::New(normals, 0, mesh->normals().size() * 3));
 			}
-
-			if (mesh->triangle_index().size() > 0)
-			{
-				Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, mesh->triangle_index().size() * sizeof(Imath::V3i));
-				ArrayBuffer::Contents contents = indices->GetContents();
-				memcpy(contents.Data(), &mesh->triangle_index()[0], mesh->triangle_index().size() * sizeof(Imath::V3i));
-				result->Set(String::NewFromUtf8(isolate, "index"), Int32Array::New(indices, 0, mesh->triangle_index().size() * 3));
+			Local<Value> visible_value = options->Get(String::NewFromUtf8(isolate, "visible_only"));
+			if (visible_value->IsBoolean()) {
+				setting.is_visible_only = visible_value->BooleanValue();
 			}
+		}
 
-			if (mesh->uv_size() > 0) 
-			{
-				Local<ArrayBuffer> uvs = v8::ArrayBuffer::New(isolate, mesh->uv_size() * sizeof(Imath::V2f));
-				ArrayBuffer::Contents contents = uvs->GetContents();
-				Imath::V2f* data = reinterpret_cast<Imath::V2f*>(contents.Data());
-				for (int i = 0, size = mesh->uv_size(); i < size; ++i) {
-					const Imath::V2f* uv = &mesh->uv()[i];
-					Imath::V2f flip(uv->x, 1.0 - uv->y);
-					memcpy(&data[i], &flip, sizeof(Imath::V2f));
+		umabc::UMAbcScene::Batch batch;
+		scene->batch(setting, batch);
+
+		Local<Object> result = Object::New(isolate);
+		const size_t vertex_size = batch.vertices.size();
+		const size_t index_size = batch.indices.size();
+		Local<ArrayBuffer> positions = v8::ArrayBuffer::New(isolate, vertex_size * sizeof(Imath::V3f));
+		Local<ArrayBuffer> normals = v8::ArrayBuffer::New(isolate, vertex_size * sizeof(Imath::V3f));
+		Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, index_size * sizeof(unsigned int));
+		if (vertex_size > 0) {
+			memcpy(positions->GetContents().Data(), &batch.vertices[0], vertex_size * sizeof(Imath::V3f));
+			memcpy(normals->GetContents().Data(), &batch.normals[0], vertex_size * sizeof(Imath::V3f));
+		}
+		if (index_size > 0) {
+			memcpy(indices->GetContents().Data(), &batch.indices[0], index_size * sizeof(unsigned int));
+		}
+		result->Set(String::NewFromUtf8(isolate, "position"), Float32Array::New(positions, 0, vertex_size * 3));
+		result->Set(String::NewFromUtf8(isolate, "normal"), Float32Array::New(normals, 0, vertex_size * 3));
+		result->Set(String::NewFromUtf8(isolate, "index"), Uint32Array::New(indices, 0, index_size));
+
+		Local<Array> groups = Array::New(isolate, static_cast<int>(batch.groups.size()));
+		for (size_t i = 0, size = batch.groups.size(); i < size; ++i) {
+			const umabc::UMAbcScene::BatchGroupRange& range = batch.groups[i];
+			Local<Object> group = Object::New(isolate);
+			group->Set(String::NewFromUtf8(isolate, "name"), String::NewFromUtf8(isolate, range.name.c_str()));
+			group->Set(String::NewFromUtf8(isolate, "index_offset"), Integer::NewFromUnsigned(isolate, range.index_offset));
+			group->Set(String::NewFromUtf8(isolate, "index_count"), Integer::NewFromUnsigned(isolate, range.index_count));
+			groups->Set(static_cast<uint32_t>(i), group);
+		}
+		result->Set(String::NewFromUtf8(isolate, "groups"), groups);
+
+		Local<Array> objects = Array::New(isolate, static_cast<int>(batch.ranges.size()));
+		for (size_t i = 0, size = batch.ranges.size(); i < size; ++i) {
+			const umabc::UMAbcScene::BatchRange& range = batch.ranges[i];
+			Local<Object> object = Object::New(isolate);
+			object->Set(String::NewFromUtf8(isolate, "path"), String::NewFromUtf8(isolate, range.path.c_str()));
+			object->Set(String::NewFromUtf8(isolate, "group"), Integer::NewFromUnsigned(isolate, range.group));
+			object->Set(String::NewFromUtf8(isolate, "vertex_offset"), Integer::NewFromUnsigned(isolate, range.vertex_offset));
+			object->Set(String::NewFromUtf8(isolate, "vertex_count"), Integer::NewFromUnsigned(isolate, range.vertex_count));
+			object->Set(String::NewFromUtf8(isolate, "index_offset"), Integer::NewFromUnsigned(isolate, range.index_offset));
+			object->Set(String::NewFromUtf8(isolate, "index_count"), Integer::NewFromUnsigned(isolate, range.index_count));
+			object->Set(String::NewFromUtf8(isolate, "changed"), Boolean::New(isolate, range.is_changed));
+			objects->Set(static_cast<uint32_t>(i), object);
+		}
+		result->Set(String::NewFromUtf8(isolate, "objects"), objects);
+		args.GetReturnValue().Set(result);
+	}
+
+	/**
+	 * get meshes sharing same geometry at current time.
+	 * args[1] is optional minimum number of meshes in a group. default is 2.
+	 * returns [{ paths, transforms (Float64Array, 16 per path), vertex_size, triangle_size }].
+	 */
+	void get_instance_groups(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		size_t min_count = 2;
+		if (args.Length() > 1 && args[1]->IsNumber()) {
+			min_count = args[1]->Uint32Value();
+		}
+		const std::vector<umabc::UMAbcScene::InstanceGroup> groups = scene->instance_groups(min_count);
+		Local<Array> result = Array::New(isolate, static_cast<int>(groups.size()));
+		for (size_t i = 0, size = groups.size(); i < size; ++i) {
+			const umabc::UMAbcScene::InstanceGroup& group = groups[i];
+			Local<Object> value = Object::New(isolate);
+			value->Set(String::NewFromUtf8(isolate, "paths"), path_array(isolate, group.paths));
+
+			const size_t count = group.transforms.size();
+			Local<ArrayBuffer> transforms = v8::ArrayBuffer::New(isolate, count * 16 * sizeof(double));
+			double* data = static_cast<double*>(transforms->GetContents().Data());
+			for (size_t n = 0; n < count; ++n) {
+				for (int r = 0; r < 4; ++r) {
+					for (int c = 0; c < 4; ++c) {
+						data[n * 16 + r * 4 + c] = group.transforms[n][r][c];
+					}
 				}
-				result->Set(String::NewFromUtf8(isolate, "uv"), Float32Array::New(uvs, 0, mesh->uv_size() * 2));
 			}
-			assign_transform(result, mesh);
+			value->Set(String::NewFromUtf8(isolate, "transforms"), Float64Array::New(transforms, 0, count * 16));
+			value->Set(String::NewFromUtf8(isolate, "vertex_size"), Integer::NewFromUnsigned(isolate, group.vertex_size));
+			value->Set(String::NewFromUtf8(isolate, "triangle_size"), Integer::NewFromUnsigned(isolate, group.triangle_size));
+			result->Set(static_cast<uint32_t>(i), value);
 		}
 		args.GetReturnValue().Set(result);
 	}
 
-	void get_point(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * get bytes held by the scene.
+	 * objects has node, sample, geometry, bvh and derived bytes per path.
+	 * scene totals count geometry records shared between meshes once.
+	 * samples may also be held by the process wide cache.
+	 */
+	void memory_report(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
 		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		if (!scene) return;
+
+		umabc::UMAbcScene::MemoryReport report;
+		scene->memory_report(report);
 
-		v8::String::Utf8Value utf8path(args[1]->ToString());
-		std::string object_path(*utf8path);
 		Local<Object> result = Object::New(isolate);
+		const char* categories[] = { "node", "sample", "geometry", "bvh", "derived" };
+		const int category_count = 5;
+		Local<Array> category_list = Array::New(isolate, category_count);
+		for (int i = 0; i < category_count; ++i) {
+			category_list->Set(i, String::NewFromUtf8(isolate, categories[i]));
+		}
+		result->Set(String::NewFromUtf8(isolate, "categories"), category_list);
+		result->Set(String::NewFromUtf8(isolate, "paths"), path_array(isolate, report.paths));
+
+		const size_t count = report.objects.size();
+		Local<ArrayBuffer> objects = v8::ArrayBuffer::New(isolate, count * category_count * sizeof(double));
+		double* data = static_cast<double*>(objects->GetContents().Data());
+		for (size_t i = 0; i < count; ++i) {
+			const umabc::UMAbcMemoryUsage& usage = report.objects[i];
+			data[i * category_count + 0] = static_cast<double>(usage.node);
+			data[i * category_count + 1] = static_cast<double>(usage.sample);
+			data[i * category_count + 2] = static_cast<double>(usage.geometry);
+			data[i * category_count + 3] = static_cast<double>(usage.bvh);
+			data[i * category_count + 4] = static_cast<double>(usage.derived);
+		}
+		result->Set(String::NewFromUtf8(isolate, "objects"), Float64Array::New(objects, 0, count * category_count));
+
+		const umabc::UMAbcMemoryUsage& total = report.total;
+		Local<Object> scene_total = Object::New(isolate);
+		scene_total->Set(String::NewFromUtf8(isolate, "node"), Number::New(isolate, static_cast<double>(total.node)));
+		scene_total->Set(String::NewFromUtf8(isolate, "sample"), Number::New(isolate, static_cast<double>(total.sample)));
+		scene_total->Set(String::NewFromUtf8(isolate, "geometry"), Number::New(isolate, static_cast<double>(total.geometry)));
+		scene_total->Set(String::NewFromUtf8(isolate, "bvh"), Number::New(isolate, static_cast<double>(total.bvh)));
+		scene_total->Set(String::NewFromUtf8(isolate, "derived"), Number::New(isolate, static_cast<double>(total.derived)));
+		scene_total->Set(String::NewFromUtf8(isolate, "batch"), Number::New(isolate, static_cast<double>(report.batch)));
+		scene_total->Set(String::NewFromUtf8(isolate, "index"), Number::New(isolate, static_cast<double>(report.index)));
+		scene_total->Set(String::NewFromUtf8(isolate, "total"), Number::New(isolate,
+			static_cast<double>(total.total() + report.batch + report.index)));
+		result->Set(String::NewFromUtf8(isolate, "scene"), scene_total);
+
+		const umabc::UMAbcSampleCache::Stats stats = umabc::UMAbcSampleCache::instance().stats();
+		Local<Object> cache = Object::New(isolate);
+		cache->Set(String::NewFromUtf8(isolate, "byte_size"), Number::New(isolate, static_cast<double>(stats.byte_size)));
+		cache->Set(String::NewFromUtf8(isolate, "entry_count"), Number::New(isolate, static_cast<double>(stats.entry_count)));
+		cache->Set(String::NewFromUtf8(isolate, "byte_budget"), Number::New(isolate, static_cast<double>(stats.byte_budget)));
+		result->Set(String::NewFromUtf8(isolate, "cache"), cache);
+
+		// array buffers handed to javascript are external memory of the isolate
+		HeapStatistics heap;
+		isolate->GetHeapStatistics(&heap);
+		Local<Object> js = Object::New(isolate);
+		js->Set(String::NewFromUtf8(isolate, "used_heap_size"), Number::New(isolate, static_cast<double>(heap.used_heap_size())));
+		js->Set(String::NewFromUtf8(isolate, "external"), Number::New(isolate,
+			static_cast<double>(isolate->AdjustAmountOfExternalAllocatedMemory(0))));
+		result->Set(String::NewFromUtf8(isolate, "js"), js);
+
+		size_t scene_count = 0;
+		for (SceneMap::const_iterator it = scene_map_.begin(); it != scene_map_.end(); ++it) {
+			if (it->second->scene) ++scene_count;
+		}
+		result->Set(String::NewFromUtf8(isolate, "resident_scene_count"), Number::New(isolate, static_cast<double>(scene_count)));
+		args.GetReturnValue().Set(result);
+	}
 
-		bool is_apply_matrix = false;
-		if (args.Length() > 2 && args[2]->IsBoolean()) {
-			is_apply_matrix = args[2]->BooleanValue();
+	/**
+	 * get whole hierarchy as flat arrays. args[0] is file path.
+	 * returns { type_names, parent, type, time, box, names, name_offset }.
+	 * time is min, max per node and box is min xyz, max xyz per node.
+	 * name of node i is utf8 names[name_offset[i], name_offset[i + 1]).
+	 */
+	void get_hierarchy(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		const umabc::UMAbcScene::Hierarchy* hierarchy_of = get_hierarchy_of(isolate, args);
+		if (!hierarchy_of) return;
+
+		const umabc::UMAbcScene::Hierarchy& hierarchy = *hierarchy_of;
+		const size_t count = hierarchy.size();
+		Local<Object> result = Object::New(isolate);
+
+		const char* type_names[] = { "object", "xform", "mesh", "point", "curve", "nurbs", "camera" };
+		const int type_count = 7;
+		Local<Array> type_list = Array::New(isolate, type_count);
+		for (int i = 0; i < type_count; ++i) {
+			type_list->Set(i, String::NewFromUtf8(isolate, type_names[i]));
 		}
+		result->Set(String::NewFromUtf8(isolate, "type_names"), type_list);
 
-		umabc::UMAbcPointPtr point = std::dynamic_pointer_cast<umabc::UMAbcPoint>(scene->find_object(object_path));
-		if (point)
-		{
-			if (point->position_size() > 0)
-			{
-				Local<Array> positions = Array::New(isolate, point->position_size() * 3);
-				//Local<ArrayBuffer> positions = v8::ArrayBuffer::New(isolate, point->position_size() * sizeof(Imath::V3f));
-				if (is_apply_matrix)
-				{
-					for (int i = 0, isize = point->position_size(); i < isize; ++i) {
-						Imath::V3f pos = point->positions()[i] * point->global_transform();
-						positions->Set(i * 3 + 0, Number::New(isolate, pos[0]));
-						positions->Set(i * 3 + 1, Number::New(isolate, pos[1]));
-						positions->Set(i * 3 + 2, Number::New(isolate, pos[2]));
-					}
-				}
-				else
-				{
-					for (int i = 0, isize = point->position_size(); i < isize; ++i) {
-						const Imath::V3f& pos = point->positions()[i];
-						positions->Set(i * 3 + 0, Number::New(isolate, pos[0]));
-						positions->Set(i * 3 + 1, Number::New(isolate, pos[1]));
-						positions->Set(i * 3 + 2, Number::New(isolate, pos[2]));
-					}
-				}
-			}
+		Local<ArrayBuffer> parents = v8::ArrayBuffer::New(isolate, count * sizeof(int));
+		if (count > 0) {
+			memcpy(parents->GetContents().Data(), &hierarchy.parents[0], count * sizeof(int));
+		}
+		result->Set(String::NewFromUtf8(isolate, "parent"), Int32Array::New(parents, 0, count));
 
-			if (point->normal_size() > 0)
-			{
-				Local<Array> normals = Array::New(isolate, point->position_size() * 3);
-				//Local<ArrayBuffer> normals = v8::ArrayBuffer::New(isolate, point->normal_size() * sizeof(Imath::V3f));
-				if (is_apply_matrix)
-				{
-					for (int i = 0, isize = point->normal_size(); i < isize; ++i) {
-						const Imath::V3f& normal = point->normals()[i] * rotation_matrix(point->global_transform());
-						normals->Set(i * 3 + 0, Number::New(isolate, normal[0]));
-						normals->Set(i * 3 + 1, Number::New(isolate, normal[1]));
-						normals->Set(i * 3 + 2, Number::New(isolate, normal[2]));
-					}
-				}
-				else
-				{
-					for (int i = 0, isize = point->normal_size(); i < isize; ++i) {
-						const Imath::V3f& normal = point->normals()[i];
-						normals->Set(i * 3 + 0, Number::New(isolate, normal[0]));
-						normals->Set(i * 3 + 1, Number::New(isolate, normal[1]));
-						normals->Set(i * 3 + 2, Number::New(isolate, normal[2]));
-					}
-				}
-			}
+		Local<ArrayBuffer> types = v8::ArrayBuffer::New(isolate, count);
+		if (count > 0) {
+			memcpy(types->GetContents().Data(), &hierarchy.types[0], count);
+		}
+		result->Set(String::NewFromUtf8(isolate, "type"), Uint8Array::New(types, 0, count));
 
-			if (point->color_size() > 0)
-			{
-				Local<ArrayBuffer> colors = v8::ArrayBuffer::New(isolate, point->color_size() * sizeof(Imath::V3f));
-				ArrayBuffer::Contents contents = colors->GetContents();
-				memcpy(contents.Data(), &point->colors()[0], point->color_size() * sizeof(Imath::V3f));
-				result->Set(String::NewFromUtf8(isolate, "color"), Float32Array::New(colors, 0, point->color_size() * 3));
-			}
-			assign_transform(result, point);
+		Local<ArrayBuffer> times = v8::ArrayBuffer::New(isolate, count * 2 * sizeof(double));
+		if (count > 0) {
+			memcpy(times->GetContents().Data(), &hierarchy.times[0], count * 2 * sizeof(double));
+		}
+		result->Set(String::NewFromUtf8(isolate, "time"), Float64Array::New(times, 0, count * 2));
+
+		Local<ArrayBuffer> boxes = v8::ArrayBuffer::New(isolate, count * 6 * sizeof(double));
+		if (count > 0) {
+			memcpy(boxes->GetContents().Data(), &hierarchy.boxes[0], count * 6 * sizeof(double));
+		}
+		result->Set(String::NewFromUtf8(isolate, "box"), Float64Array::New(boxes, 0, count * 6));
+
+		const size_t name_size = hierarchy.names.size();
+		Local<ArrayBuffer> names = v8::ArrayBuffer::New(isolate, name_size);
+		if (name_size > 0) {
+			memcpy(names->GetContents().Data(), hierarchy.names.data(), name_size);
 		}
+		result->Set(String::NewFromUtf8(isolate, "names"), Uint8Array::New(names, 0, name_size));
+
+		const size_t offset_count = hierarchy.name_offsets.size();
+		Local<ArrayBuffer> offsets = v8::ArrayBuffer::New(isolate, offset_count * sizeof(unsigned int));
+		if (offset_count > 0) {
+			memcpy(offsets->GetContents().Data(), &hierarchy.name_offsets[0], offset_count * sizeof(unsigned int));
+		}
+		result->Set(String::NewFromUtf8(isolate, "name_offset"), Uint32Array::New(offsets, 0, offset_count));
 		args.GetReturnValue().Set(result);
 	}
 
-	void get_curve(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * get statistics of the process wide sample cache.
+	 * returns { hit, miss, eviction, entry_count, byte_size, byte_budget }.
+	 */
+	void get_cache_stats(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-
-		v8::String::Utf8Value utf8path(args[1]->ToString());
-		std::string object_path(*utf8path);
+		const umabc::UMAbcSampleCache::Stats stats = umabc::UMAbcSampleCache::instance().stats();
 		Local<Object> result = Object::New(isolate);
+		result->Set(String::NewFromUtf8(isolate, "hit"), Number::New(isolate, static_cast<double>(stats.hit_count)));
+		result->Set(String::NewFromUtf8(isolate, "miss"), Number::New(isolate, static_cast<double>(stats.miss_count)));
+		result->Set(String::NewFromUtf8(isolate, "eviction"), Number::New(isolate, static_cast<double>(stats.eviction_count)));
+		result->Set(String::NewFromUtf8(isolate, "entry_count"), Number::New(isolate, static_cast<double>(stats.entry_count)));
+		result->Set(String::NewFromUtf8(isolate, "byte_size"), Number::New(isolate, static_cast<double>(stats.byte_size)));
+		result->Set(String::NewFromUtf8(isolate, "byte_budget"), Number::New(isolate, static_cast<double>(stats.byte_budget)));
+		args.GetReturnValue().Set(result);
+	}
 
-		bool is_apply_matrix = false;
-		if (args.Length() > 2 && args[2]->IsBoolean()) {
-			is_apply_matrix = args[2]->BooleanValue();
+	/**
+	 * set byte budget of the process wide sample cache. 0 disables the cache.
+	 * args[0] is the budget in bytes.
+	 */
+	void set_cache_budget(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsNumber() || args[0]->NumberValue() < 0) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
+		umabc::UMAbcSampleCache::instance().set_byte_budget(static_cast<size_t>(args[0]->NumberValue()));
+	}
 
-		umabc::UMAbcCurvePtr curve = std::dynamic_pointer_cast<umabc::UMAbcCurve>(scene->find_object(object_path));
-		if (curve)
-		{
-			if (curve->position_size() > 0)
-			{
-				Local<ArrayBuffer> positions = v8::ArrayBuffer::New(isolate, curve->position_size() * sizeof(Imath::V3f));
-				ArrayBuffer::Contents contents = positions->GetContents();
+	static Local<Array> path_array(Isolate* isolate, const std::vector<std::string>& path_list)
+	{
+		const int list_size = static_cast<int>(path_list.size());
+		Local<Array> result = Array::New(isolate, list_size);
+		for (int i = 0; i < list_size; ++i) {
+			result->Set(i, String::NewFromUtf8(isolate, path_list[i].c_str()));
+		}
+		return result;
+	}
 
-				float* data = static_cast<float*>(contents.Data());
-				if (is_apply_matrix) {
-					for (int i = 0, size = curve->position_size(); i < size; ++i) {
-						positions->Set(i * 3 + 0, Number::New(isolate, curve->positions()[i][0]));
-						positions->Set(i * 3 + 1, Number::New(isolate, curve->positions()[i][1]));
-						positions->Set(i * 3 + 2, Number::New(isolate, curve->positions()[i][2]));
-					}
-				}
-				else
-				{
-					memcpy(contents.Data(), curve->positions(), curve->position_size() * sizeof(Imath::V3f));
-					result->Set(String::NewFromUtf8(isolate, "position"), Float32Array::New(positions, 0, curve->position_size() * 3));
-				}
-			}
+	void dispose() {
+		SceneMap::iterator it = scene_map_.begin();
+		for (; it != scene_map_.end(); ++it) {
+			close_scene(*it->second);
+		}
+		scene_map_.clear();
+		WriterHandleMap::iterator wt = writer_handles_.begin();
+		for (; wt != writer_handles_.end(); ++wt) {
+			wt->second.writer->close();
+		}
+		writer_handles_.clear();
+		for (BakedMap::iterator bt = baked_map_.begin(); bt != baked_map_.end(); ++bt) {
+			bt->second->buffer.Reset();
+		}
+		baked_map_.clear();
+		umabc::UMAbcSampleCache::instance().clear();
+	}
 
-			if (curve->vertex_count_list().size() > 0)
-			{
-				Local<ArrayBuffer> indices = v8::ArrayBuffer::New(isolate, curve->vertex_count_list().size() * sizeof(int));
-				ArrayBuffer::Contents contents = indices->GetContents();
-				memcpy(contents.Data(), &curve->vertex_count_list()[0], curve->vertex_count_list().size() * sizeof(int));
-				result->Set(String::NewFromUtf8(isolate, "vertex_count_list"), Int32Array::New(indices, 0, curve->vertex_count_list().size()));
-			}
+private:
+	SceneMap scene_map_;
+	double idle_seconds_;
+	size_t memory_ceiling_;
+	double last_collect_;
+	bool has_prefetch_setting_;
+	unsigned int prefetch_frame_count_;
+	size_t prefetch_byte_budget_;
+	WriterHandleMap writer_handles_;
+	unsigned int next_writer_handle_;
+	std::string transcode_directory_;
+	unsigned long long transcode_byte_budget_;
+	bool is_scene_index_enabled_;
+	std::string scene_index_directory_;
+	bool has_read_setting_;
+	umabc::UMAbcSetting::ReadMode read_mode_;
+	unsigned int read_stream_count_;
+	BakedMap baked_map_;
+};
 
-			result->Set(String::NewFromUtf8(isolate, "curve"), Int32::New(isolate, curve->curve_count()));
+/**
+ * reference of a loaded file shared by a scene handle and the object handles taken from it.
+ * released when the scene handle is closed or the last of them is collected.
+ */
+class UMAbcSceneReference {
+	DISALLOW_COPY_AND_ASSIGN(UMAbcSceneReference);
+public:
+	explicit UMAbcSceneReference(UMAbcIO::SceneEntryPtr entry) : entry_(entry) {}
+
+	~UMAbcSceneReference() {
+		release();
+	}
+
+	/**
+	 * release the reference. release of an unloaded entry does nothing.
+	 */
+	void release() {
+		if (!entry_) return;
+		UMAbcIO::instance().release(entry_);
+		entry_ = UMAbcIO::SceneEntryPtr();
+	}
+
+	/**
+	 * get the entry. null after released.
+	 */
+	const UMAbcIO::SceneEntryPtr& entry() const { return entry_; }
+
+private:
+	UMAbcIO::SceneEntryPtr entry_;
+};
+typedef std::shared_ptr<UMAbcSceneReference> UMAbcSceneReferencePtr;
+
+/**
+ * native object handle. resolves its object once and again only after the scene is reopened.
+ * shares the reference of the scene handle it was taken from.
+ */
+class UMAbcObjectHandle : public node::ObjectWrap {
+public:
+	static void init(Isolate* isolate) {
+		Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+		tpl->SetClassName(String::NewFromUtf8(isolate, "UMAbcObject"));
+		tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "type", type);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "transform", transform);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "mesh", mesh);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "point", point);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "camera", camera);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "children", children);
+		constructor_.Reset(isolate, tpl->GetFunction());
+	}
+
+	/**
+	 * create handle of the object at the path
+	 */
+	static Local<Object> create(
+		Isolate* isolate,
+		UMAbcSceneReferencePtr reference,
+		const std::string& object_path,
+		umabc::UMAbcObjectPtr object) {
+		Local<Function> cons = Local<Function>::New(isolate, constructor_);
+		Local<Object> instance = cons->NewInstance(isolate->GetCurrentContext()).ToLocalChecked();
+		UMAbcObjectHandle* handle = ObjectWrap::Unwrap<UMAbcObjectHandle>(instance);
+		handle->reference_ = reference;
+		handle->path_ = object_path;
+		handle->object_ = object;
+		handle->generation_ = reference->entry()->generation;
+		instance->Set(String::NewFromUtf8(isolate, "path"), String::NewFromUtf8(isolate, object_path.c_str()));
+		instance->Set(String::NewFromUtf8(isolate, "name"), String::NewFromUtf8(isolate, object->name().c_str()));
+		return instance;
+	}
+
+private:
+	UMAbcObjectHandle() : generation_(0) {}
+
+	static void New(const FunctionCallbackInfo<Value>& args) {
+		UMAbcObjectHandle* handle = new UMAbcObjectHandle();
+		handle->Wrap(args.This());
+		args.GetReturnValue().Set(args.This());
+	}
+
+	/**
+	 * get object. the scene is reopened when evicted.
+	 */
+	static umabc::UMAbcObjectPtr resolve(Isolate* isolate, const FunctionCallbackInfo<Value>& args) {
+		UMAbcObjectHandle* handle = ObjectWrap::Unwrap<UMAbcObjectHandle>(args.Holder());
+		const UMAbcIO::SceneEntryPtr& entry = handle->reference_->entry();
+		if (!entry) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Closed")));
+			return umabc::UMAbcObjectPtr();
+		}
+		umabc::UMAbcScenePtr scene = UMAbcIO::instance().resident_scene(isolate, *entry);
+		if (!scene) return umabc::UMAbcObjectPtr();
+
+		umabc::UMAbcObjectPtr object = handle->object_.lock();
+		if (!object || handle->generation_ != entry->generation) {
+			object = handle->path_ == "/" ? scene->root_object() : scene->find_object(handle->path_);
+			handle->object_ = object;
+			handle->generation_ = entry->generation;
+		}
+		if (!object) {
+			isolate->ThrowException(Exception::Error(
+				String::NewFromUtf8(isolate, "Object Not Found")));
+		}
+		return object;
+	}
+
+	static void type(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcObjectPtr object = resolve(isolate, args);
+		if (!object) return;
+		const char* name = "object";
+		if (std::dynamic_pointer_cast<umabc::UMAbcMesh>(object)) name = "mesh";
+		else if (std::dynamic_pointer_cast<umabc::UMAbcPoint>(object)) name = "point";
+		else if (std::dynamic_pointer_cast<umabc::UMAbcCurve>(object)) name = "curve";
+		else if (std::dynamic_pointer_cast<umabc::UMAbcNurbsPatch>(object)) name = "nurbs";
+		else if (std::dynamic_pointer_cast<umabc::UMAbcCamera>(object)) name = "camera";
+		else if (std::dynamic_pointer_cast<umabc::UMAbcXform>(object)) name = "xform";
+		args.GetReturnValue().Set(String::NewFromUtf8(isolate, name));
+	}
+
+	static void transform(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcObjectPtr object = resolve(isolate, args);
+		if (!object) return;
+		Local<Object> result = Object::New(isolate);
+		UMAbcIO::instance().assign_transform(result, object);
+		args.GetReturnValue().Set(result);
+	}
 
-			assign_transform(result, curve);
+	/**
+	 * same as get_mesh. args[0] is apply matrix or not.
+	 */
+	static void mesh(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcObjectPtr object = resolve(isolate, args);
+		if (!object) return;
+		const bool is_apply_matrix = args.Length() > 0 && args[0]->IsBoolean() && args[0]->BooleanValue();
+		Local<Object> result = Object::New(isolate);
+		if (umabc::UMAbcMeshPtr mesh = std::dynamic_pointer_cast<umabc::UMAbcMesh>(object)) {
+			UMAbcIO::instance().assign_mesh(result, mesh, is_apply_matrix);
 		}
 		args.GetReturnValue().Set(result);
 	}
 
-	void get_nurbs(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * same as get_point. args[0] is apply matrix or not, args[1] is decimation target count.
+	 */
+	static void point(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+		umabc::UMAbcObjectPtr object = resolve(isolate, args);
+		if (!object) return;
+		const bool is_apply_matrix = args.Length() > 0 && args[0]->IsBoolean() && args[0]->BooleanValue();
+		const unsigned int target_count = (args.Length() > 1 && args[1]->IsNumber()) ? args[1]->Uint32Value() : 0;
+		Local<Object> result = Object::New(isolate);
+		if (umabc::UMAbcPointPtr point = std::dynamic_pointer_cast<umabc::UMAbcPoint>(object)) {
+			UMAbcIO::instance().assign_point(result, point, is_apply_matrix, target_count);
+		}
+		args.GetReturnValue().Set(result);
+	}
 
-		v8::String::Utf8Value utf8path(args[1]->ToString());
-		std::string object_path(*utf8path);
+	static void camera(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcObjectPtr object = resolve(isolate, args);
+		if (!object) return;
 		Local<Object> result = Object::New(isolate);
+		if (umabc::UMAbcCameraPtr camera = std::dynamic_pointer_cast<umabc::UMAbcCamera>(object)) {
+			UMAbcIO::instance().assign_transform(result, camera);
+			UMAbcIO::instance().assign_camera_view(result, camera->view());
+		}
+		args.GetReturnValue().Set(result);
+	}
 
-		bool is_apply_matrix = false;
-		if (args.Length() > 2 && args[2]->IsBoolean()) {
-			is_apply_matrix = args[2]->BooleanValue();
+	static void children(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcObjectPtr object = resolve(isolate, args);
+		if (!object) return;
+		UMAbcObjectHandle* handle = ObjectWrap::Unwrap<UMAbcObjectHandle>(args.Holder());
+		const std::string prefix = handle->path_ == "/" ? handle->path_ : handle->path_ + "/";
+		const umabc::UMAbcObjectList& children = object->children();
+		Local<Array> result = Array::New(isolate, static_cast<int>(children.size()));
+		for (size_t i = 0, size = children.size(); i < size; ++i) {
+			result->Set(static_cast<uint32_t>(i),
+				create(isolate, handle->reference_, prefix + children[i]->name(), children[i]));
 		}
+		args.GetReturnValue().Set(result);
+	}
 
-		umabc::UMAbcNurbsPatchPtr nurbs = std::dynamic_pointer_cast<umabc::UMAbcNurbsPatch>(scene->find_object(object_path));
-		if (nurbs)
-		{
-			if (nurbs->position_size() > 0)
-			{
-				Local<Array> positions = Array::New(isolate, nurbs->position_size() * 3);
-				if (is_apply_matrix) {
-					for (int i = 0, size = nurbs->position_size(); i < size; ++i) {
-						positions->Set(i * 3 + 0, Number::New(isolate, nurbs->positions()[i][0]));
-						positions->Set(i * 3 + 1, Number::New(isolate, nurbs->positions()[i][1]));
-						positions->Set(i * 3 + 2, Number::New(isolate, nurbs->positions()[i][2]));
-					}
-				}
-				else
-				{
-					for (int i = 0, size = nurbs->position_size(); i < size; ++i) {
-						Imath::V3f pos = nurbs->positions()[i] * nurbs->global_transform();
-						positions->Set(i * 3 + 0, Number::New(isolate, pos[0]));
-						positions->Set(i * 3 + 1, Number::New(isolate, pos[1]));
-						positions->Set(i * 3 + 2, Number::New(isolate, pos[2]));
-					}
-				}
-				result->Set(String::NewFromUtf8(isolate, "position"), positions);
-			}
+	static Persistent<Function> constructor_;
 
-			if (nurbs->u_knot_size() > 0)
-			{
-				Local<Array> u_knots = Array::New(isolate, nurbs->u_knot_size());
-				for (int i = 0, size = nurbs->u_knot_size(); i < size; ++i) {
-					u_knots->Set(i, Number::New(isolate, nurbs->u_knots()[i]));
-				}
-				result->Set(String::NewFromUtf8(isolate, "u_knot"), u_knots);
-			}
+	UMAbcSceneReferencePtr reference_;
+	std::string path_;
+	umabc::UMAbcObjectWeakPtr object_;
+	unsigned int generation_;
+};
 
-			if (nurbs->v_knot_size() > 0)
-			{
-				Local<Array> v_knots = Array::New(isolate, nurbs->v_knot_size());
-				for (int i = 0, size = nurbs->v_knot_size(); i < size; ++i) {
-					v_knots->Set(i, Number::New(isolate, nurbs->v_knots()[i]));
-				}
-				result->Set(String::NewFromUtf8(isolate, "v_knot"), v_knots);
-			}
+Persistent<Function> UMAbcObjectHandle::constructor_;
 
-			result->Set(String::NewFromUtf8(isolate, "u_size"), Uint32::New(isolate, nurbs->u_size()));
-			result->Set(String::NewFromUtf8(isolate, "v_size"), Uint32::New(isolate, nurbs->v_size()));
-			result->Set(String::NewFromUtf8(isolate, "u_order"), Uint32::New(isolate, nurbs->u_order()));
-			result->Set(String::NewFromUtf8(isolate, "v_order"), Uint32::New(isolate, nurbs->v_order()));
+/**
+ * native scene handle. holds a reference of the file, shared with its object handles,
+ * until closed or collected with all of them.
+ */
+class UMAbcSceneHandle : public node::ObjectWrap {
+public:
+	static void init(Isolate* isolate) {
+		Local<FunctionTemplate> tpl = FunctionTemplate::New(isolate, New);
+		tpl->SetClassName(String::NewFromUtf8(isolate, "UMAbcScene"));
+		tpl->InstanceTemplate()->SetInternalFieldCount(1);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "object", object);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "root", root);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "total_time", total_time);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "time", time);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "set_time", set_time);
+		NODE_SET_PROTOTYPE_METHOD(tpl, "close", close);
+		constructor_.Reset(isolate, tpl->GetFunction());
+	}
 
-			assign_transform(result, nurbs);
+	/**
+	 * open the file. args[0] is file path. returns null when failed.
+	 */
+	static void open(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
-		args.GetReturnValue().Set(result);
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		const std::string path = *utf8path;
+		UMAbcIO::SceneEntryPtr entry = UMAbcIO::instance().acquire(path);
+		if (!entry) {
+			args.GetReturnValue().SetNull();
+			return;
+		}
+		Local<Function> cons = Local<Function>::New(isolate, constructor_);
+		Local<Object> instance = cons->NewInstance(isolate->GetCurrentContext()).ToLocalChecked();
+		ObjectWrap::Unwrap<UMAbcSceneHandle>(instance)->reference_ = std::make_shared<UMAbcSceneReference>(entry);
+		instance->Set(String::NewFromUtf8(isolate, "file"), args[0]);
+		args.GetReturnValue().Set(instance);
 	}
 
-	void get_camera(const FunctionCallbackInfo<Value>& args) {
-		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
+private:
+	UMAbcSceneHandle() {}
 
-		v8::String::Utf8Value utf8path(args[1]->ToString());
-		std::string object_path(*utf8path);
-		Local<Object> result = Object::New(isolate);
+	static void New(const FunctionCallbackInfo<Value>& args) {
+		UMAbcSceneHandle* handle = new UMAbcSceneHandle();
+		handle->Wrap(args.This());
+		args.GetReturnValue().Set(args.This());
+	}
 
-		umabc::UMAbcCameraPtr camera = std::dynamic_pointer_cast<umabc::UMAbcCamera>(scene->find_object(object_path));
-		if (camera)
-		{
-			assign_transform(result, camera);
+	/**
+	 * get scene. the scene is reopened when evicted.
+	 */
+	static umabc::UMAbcScenePtr resolve(Isolate* isolate, const FunctionCallbackInfo<Value>& args) {
+		UMAbcSceneHandle* handle = ObjectWrap::Unwrap<UMAbcSceneHandle>(args.Holder());
+		if (!handle->reference_ || !handle->reference_->entry()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Closed")));
+			return umabc::UMAbcScenePtr();
 		}
-		args.GetReturnValue().Set(result);
+		return UMAbcIO::instance().resident_scene(isolate, *handle->reference_->entry());
 	}
 
-	void get_information(const FunctionCallbackInfo<Value>& args) {
+	/**
+	 * get object handle. args[0] is object path. returns null when not found.
+	 */
+	static void object(const FunctionCallbackInfo<Value>& args) {
 		Isolate* isolate = Isolate::GetCurrent();
-		umabc::UMAbcScenePtr scene = get_scene(isolate, args);
-
-		v8::String::Utf8Value utf8path(args[1]->ToString());
-		std::string object_path(*utf8path);
-		Local<Object> result = Object::New(isolate);
-
-		umabc::UMAbcObjectPtr obj = scene->find_object(object_path);
-		const unsigned int time = obj->current_time_ms();
-		bool has_changed = false;
-		if (obj->min_time() <= time && time <= obj->max_time()) {
-			has_changed = true;
+		if (args.Length() < 1 || !args[0]->IsString()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
-		result->Set(String::NewFromUtf8(isolate, "has_changed"), Boolean::New(isolate, has_changed));
-		result->Set(String::NewFromUtf8(isolate, "is_valid"), Boolean::New(isolate, obj->is_valid()));
-		result->Set(String::NewFromUtf8(isolate, "is_visible"), Boolean::New(isolate, obj->is_visible()));
-		
-		Local<Array> bbox = Array::New(isolate, 6);
-		for (int i = 0; i < 3; ++i) {
-			bbox->Set(i, Number::New(isolate, obj->box().min[i]));
-			bbox->Set(i + 3, Number::New(isolate, obj->box().max[i + 3]));
+		umabc::UMAbcScenePtr scene = resolve(isolate, args);
+		if (!scene) return;
+		v8::String::Utf8Value utf8path(args[0]->ToString());
+		const std::string object_path = *utf8path;
+		umabc::UMAbcObjectPtr object = object_path == "/" ? scene->root_object() : scene->find_object(object_path);
+		if (!object) {
+			args.GetReturnValue().SetNull();
+			return;
 		}
-		result->Set(String::NewFromUtf8(isolate, "bbox"), bbox);
-		
+		UMAbcSceneHandle* handle = ObjectWrap::Unwrap<UMAbcSceneHandle>(args.Holder());
+		args.GetReturnValue().Set(UMAbcObjectHandle::create(isolate, handle->reference_, object_path, object));
+	}
+
+	static void root(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = resolve(isolate, args);
+		if (!scene) return;
+		UMAbcSceneHandle* handle = ObjectWrap::Unwrap<UMAbcSceneHandle>(args.Holder());
+		args.GetReturnValue().Set(UMAbcObjectHandle::create(isolate, handle->reference_, "/", scene->root_object()));
+	}
+
+	static void total_time(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = resolve(isolate, args);
+		if (!scene) return;
+		Local<Object> result = Object::New(isolate);
+		result->Set(String::NewFromUtf8(isolate, "min"), Number::New(isolate, scene->min_time()));
+		result->Set(String::NewFromUtf8(isolate, "max"), Number::New(isolate, scene->max_time()));
 		args.GetReturnValue().Set(result);
 	}
 
-	void dispose() {
-		SceneMap::iterator it = scene_map_.begin();
-		for (; it != scene_map_.end(); ++it) {
-			it->second = umabc::UMAbcScenePtr();
+	/**
+	 * get current time in milliseconds
+	 */
+	static void time(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		umabc::UMAbcScenePtr scene = resolve(isolate, args);
+		if (!scene) return;
+		args.GetReturnValue().Set(Number::New(isolate, scene->root_object()->current_time() * 1000.0));
+	}
+
+	/**
+	 * set current time. args[0] is time in milliseconds.
+	 */
+	static void set_time(const FunctionCallbackInfo<Value>& args) {
+		Isolate* isolate = Isolate::GetCurrent();
+		if (args.Length() < 1 || !args[0]->IsNumber()) {
+			isolate->ThrowException(Exception::TypeError(
+				String::NewFromUtf8(isolate, "Wrong arguments")));
+			return;
 		}
+		umabc::UMAbcScenePtr scene = resolve(isolate, args);
+		if (!scene) return;
+		scene->set_current_time(static_cast<unsigned long>(args[0]->NumberValue()));
 	}
 
-private:
-	SceneMap scene_map_;
+	/**
+	 * release the reference of this handle and its object handles without waiting for collection.
+	 * the handles throw afterwards.
+	 */
+	static void close(const FunctionCallbackInfo<Value>& args) {
+		UMAbcSceneHandle* handle = ObjectWrap::Unwrap<UMAbcSceneHandle>(args.Holder());
+		if (!handle->reference_) return;
+		handle->reference_->release();
+	}
+
+	static Persistent<Function> constructor_;
+
+	UMAbcSceneReferencePtr reference_;
 };
 
+Persistent<Function> UMAbcSceneHandle::constructor_;
+
 using node::AtExit;
 
 static void load(const FunctionCallbackInfo<Value>& args)
@@ -592,6 +2974,121 @@ static void save(const FunctionCallbackInfo<Value>& args)
 	UMAbcIO::instance().save(args);
 }
 
+static void unload(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().unload(args);
+}
+
+static void set_scene_policy(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().set_scene_policy(args);
+}
+
+static void set_prefetch(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().set_prefetch(args);
+}
+
+static void set_transcode_cache(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().set_transcode_cache(args);
+}
+
+static void set_read_mode(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().set_read_mode(args);
+}
+
+static void set_worker_count(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().set_worker_count(args);
+}
+
+static void set_scene_index(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().set_scene_index(args);
+}
+
+static void get_prefetch_stats(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().get_prefetch_stats(args);
+}
+
+static void release_buffers(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().release_buffers(args);
+}
+
+static void create_archive(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().create_archive(args);
+}
+
+static void add_xform(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().add_object(args, "xform");
+}
+
+static void add_mesh(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().add_object(args, "mesh");
+}
+
+static void add_point(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().add_object(args, "point");
+}
+
+static void add_curve(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().add_object(args, "curve");
+}
+
+static void write_xform_sample(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().write_xform_sample(args);
+}
+
+static void write_mesh_sample(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().write_mesh_sample(args);
+}
+
+static void write_point_sample(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().write_point_sample(args);
+}
+
+static void write_curve_sample(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().write_curve_sample(args);
+}
+
+static void close_archive(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().close_archive(args);
+}
+
+static void bake(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().bake(args);
+}
+
+static void open_bake(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().open_bake(args);
+}
+
+static void get_baked_mesh(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().get_baked_mesh(args);
+}
+
+static void close_bake(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().close_bake(args);
+}
+
 static void get_total_time(const FunctionCallbackInfo<Value>& args)
 {
 	UMAbcIO::instance().get_total_time(args);
@@ -652,16 +3149,31 @@ static void get_curve(const FunctionCallbackInfo<Value>& args)
 	UMAbcIO::instance().get_curve(args);
 }
 
+static void tessellate_curve(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().tessellate_curve(args);
+}
+
 static void get_nurbs(const FunctionCallbackInfo<Value>& args)
 {
 	UMAbcIO::instance().get_nurbs(args);
 }
 
+static void tessellate_nurbs(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().tessellate_nurbs(args);
+}
+
 static void get_camera(const FunctionCallbackInfo<Value>& args)
 {
 	UMAbcIO::instance().get_camera(args);
 }
 
+static void get_camera_range(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().get_camera_range(args);
+}
+
 static void get_xform(const FunctionCallbackInfo<Value>& args)
 {
 	UMAbcIO::instance().get_xform(args);
@@ -672,6 +3184,61 @@ static void get_information(const FunctionCallbackInfo<Value>& args)
 	UMAbcIO::instance().get_information(args);
 }
 
+static void query_box(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().query_box(args);
+}
+
+static void query_frustum(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().query_frustum(args);
+}
+
+static void raycast(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().raycast(args);
+}
+
+static void closest_point(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().closest_point(args);
+}
+
+static void mesh_distance(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().mesh_distance(args);
+}
+
+static void get_scene_batch(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().get_scene_batch(args);
+}
+
+static void get_instance_groups(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().get_instance_groups(args);
+}
+
+static void memory_report(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().memory_report(args);
+}
+
+static void get_hierarchy(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().get_hierarchy(args);
+}
+
+static void get_cache_stats(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().get_cache_stats(args);
+}
+
+static void set_cache_budget(const FunctionCallbackInfo<Value>& args)
+{
+	UMAbcIO::instance().set_cache_budget(args);
+}
+
 static void dispose(void*)
 {
 	UMAbcIO::instance().dispose();
@@ -679,8 +3246,34 @@ static void dispose(void*)
 
 void Init(Handle<Object> exports) {
 	AtExit(dispose);
+	UMAbcObjectHandle::init(Isolate::GetCurrent());
+	UMAbcSceneHandle::init(Isolate::GetCurrent());
+	NODE_SET_METHOD(exports, "open", UMAbcSceneHandle::open);
 	NODE_SET_METHOD(exports, "load", load);
 	NODE_SET_METHOD(exports, "save", save);
+	NODE_SET_METHOD(exports, "unload", unload);
+	NODE_SET_METHOD(exports, "create_archive", create_archive);
+	NODE_SET_METHOD(exports, "add_xform", add_xform);
+	NODE_SET_METHOD(exports, "add_mesh", add_mesh);
+	NODE_SET_METHOD(exports, "add_point", add_point);
+	NODE_SET_METHOD(exports, "add_curve", add_curve);
+	NODE_SET_METHOD(exports, "write_xform_sample", write_xform_sample);
+	NODE_SET_METHOD(exports, "write_mesh_sample", write_mesh_sample);
+	NODE_SET_METHOD(exports, "write_point_sample", write_point_sample);
+	NODE_SET_METHOD(exports, "write_curve_sample", write_curve_sample);
+	NODE_SET_METHOD(exports, "close_archive", close_archive);
+	NODE_SET_METHOD(exports, "bake", bake);
+	NODE_SET_METHOD(exports, "open_bake", open_bake);
+	NODE_SET_METHOD(exports, "get_baked_mesh", get_baked_mesh);
+	NODE_SET_METHOD(exports, "close_bake", close_bake);
+	NODE_SET_METHOD(exports, "set_scene_policy", set_scene_policy);
+	NODE_SET_METHOD(exports, "set_prefetch", set_prefetch);
+	NODE_SET_METHOD(exports, "get_prefetch_stats", get_prefetch_stats);
+	NODE_SET_METHOD(exports, "set_transcode_cache", set_transcode_cache);
+	NODE_SET_METHOD(exports, "set_scene_index", set_scene_index);
+	NODE_SET_METHOD(exports, "set_read_mode", set_read_mode);
+	NODE_SET_METHOD(exports, "set_worker_count", set_worker_count);
+	NODE_SET_METHOD(exports, "release_buffers", release_buffers);
 	NODE_SET_METHOD(exports, "get_total_time", get_total_time);
 	NODE_SET_METHOD(exports, "get_time", get_time);
 	NODE_SET_METHOD(exports, "set_time", set_time);
@@ -693,10 +3286,24 @@ void Init(Handle<Object> exports) {
 	NODE_SET_METHOD(exports, "get_mesh", get_mesh);
 	NODE_SET_METHOD(exports, "get_point", get_point);
 	NODE_SET_METHOD(exports, "get_nurbs", get_nurbs);
+	NODE_SET_METHOD(exports, "tessellate_nurbs", tessellate_nurbs);
 	NODE_SET_METHOD(exports, "get_curve", get_curve);
+	NODE_SET_METHOD(exports, "tessellate_curve", tessellate_curve);
 	NODE_SET_METHOD(exports, "get_camera", get_camera);
+	NODE_SET_METHOD(exports, "get_camera_range", get_camera_range);
 	NODE_SET_METHOD(exports, "get_xform", get_xform);
 	NODE_SET_METHOD(exports, "get_information", get_information);
+	NODE_SET_METHOD(exports, "query_box", query_box);
+	NODE_SET_METHOD(exports, "query_frustum", query_frustum);
+	NODE_SET_METHOD(exports, "raycast", raycast);
+	NODE_SET_METHOD(exports, "closest_point", closest_point);
+	NODE_SET_METHOD(exports, "mesh_distance", mesh_distance);
+	NODE_SET_METHOD(exports, "get_scene_batch", get_scene_batch);
+	NODE_SET_METHOD(exports, "get_instance_groups", get_instance_groups);
+	NODE_SET_METHOD(exports, "memory_report", memory_report);
+	NODE_SET_METHOD(exports, "get_hierarchy", get_hierarchy);
+	NODE_SET_METHOD(exports, "get_cache_stats", get_cache_stats);
+	NODE_SET_METHOD(exports, "set_cache_budget", set_cache_budget);
 }
 
 NODE_MODULE(umnode, Init)
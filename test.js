@@ -2,7 +2,51 @@
 (function () {
 	"use strict";
 	var path = require("path"),
-		abcio = require('alembic');
+		fs = require('fs'),
+		abcio = require('alembic'),
+		assert = require('assert');
+
+	function quad_sample(offset) {
+		return {
+			vertex : new Float32Array([
+				offset, 0, 0,
+				offset + 1, 0, 0,
+				offset + 1, 1, 0,
+				offset, 1, 0
+			]),
+			index : new Int32Array([0, 1, 2, 3]),
+			face_count : new Int32Array([4])
+		};
+	}
+
+	/**
+	 * write meshes named mesh1, mesh2 ... whose quads move by 1 every frame.
+	 */
+	function write_meshes(file, options, mesh_count, frame_count, offset) {
+		var top = abcio.create_archive(file, options),
+			start_time = options.start_time || 0,
+			meshes = [],
+			i,
+			k;
+		assert.notStrictEqual(top, null);
+		for (k = 0; k < mesh_count; k = k + 1) {
+			meshes.push(abcio.add_mesh(top, "mesh" + (k + 1)));
+		}
+		for (i = 0; i < frame_count; i = i + 1) {
+			for (k = 0; k < mesh_count; k = k + 1) {
+				assert(abcio.write_mesh_sample(meshes[k], start_time + i * 1000 / 30, quad_sample(offset + i)));
+			}
+		}
+		abcio.close_archive(top);
+	}
+
+	function assert_array(actual, expected) {
+		var i;
+		assert.strictEqual(actual.length, expected.length);
+		for (i = 0; i < expected.length; i = i + 1) {
+			assert.strictEqual(actual[i], expected[i]);
+		}
+	}
 
 	function loadtest() {
 		var file = "nurbs1.abc",
@@ -21,5 +65,304 @@
 		}
 		*/
 	}
+
+	/**
+	 * two instances whose topology switches from a quad to a triangle and back.
+	 * the second instance takes the first one's geometry from the geometry cache,
+	 * and the batch must regroup it by the new triangles.
+	 */
+	function topologytest() {
+		var file = "topology_test.abc",
+			quad = {
+				vertex : new Float32Array([0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0]),
+				index : new Int32Array([0, 1, 2, 3]),
+				face_count : new Int32Array([4])
+			},
+			triangle = {
+				vertex : new Float32Array([0, 0, 0, 1, 0, 0, 0, 1, 0]),
+				index : new Int32Array([0, 1, 2]),
+				face_count : new Int32Array([3])
+			},
+			samples = [quad, triangle, quad],
+			top,
+			meshes,
+			batch,
+			range,
+			i,
+			k;
+		top = abcio.create_archive(file, { fps : 30 });
+		meshes = [abcio.add_mesh(top, "mesh1"), abcio.add_mesh(top, "mesh2")];
+		for (i = 0; i < samples.length; i = i + 1) {
+			for (k = 0; k < meshes.length; k = k + 1) {
+				assert(abcio.write_mesh_sample(meshes[k], i * 1000 / 30, samples[i]));
+			}
+		}
+		abcio.close_archive(top);
+
+		assert(abcio.load(file));
+		range = abcio.get_total_time(file);
+		for (i = 0; i < samples.length; i = i + 1) {
+			abcio.set_time(file, range.min + i * 1000 / 30);
+			batch = abcio.get_scene_batch(file, { group : "faceset" });
+			assert.strictEqual(batch.index.length, meshes.length * (samples[i].face_count[0] - 2) * 3);
+			for (k = 0; k < batch.index.length; k = k + 1) {
+				assert(batch.index[k] < batch.position.length / 3);
+			}
+		}
+		abcio.unload(file);
+		console.log("topologytest ok");
+	}
+
+	/**
+	 * write an xform, a mesh, points and curves and read them back.
+	 */
+	function writertest() {
+		var file = "writer_test.abc",
+			matrix = [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 2, 3, 4, 1],
+			points = {
+				vertex : new Float32Array([0, 0, 0, 1, 1, 1, 2, 2, 2]),
+				id : new Uint32Array([0, 1, 2]),
+				width : new Float32Array([0.1, 0.2, 0.3])
+			},
+			curves = {
+				vertex : new Float32Array([0, 0, 0, 0, 1, 0, 1, 0, 0, 1, 1, 0, 1, 2, 0]),
+				count : new Int32Array([2, 3]),
+				width : new Float32Array([0.5]),
+				basis : "linear"
+			},
+			top,
+			xform,
+			handles,
+			mesh,
+			point,
+			curve,
+			i;
+		top = abcio.create_archive(file, { fps : 30 });
+		xform = abcio.add_xform(top, "xform1");
+		handles = {
+			mesh : abcio.add_mesh(xform, "mesh1"),
+			point : abcio.add_point(top, "point1"),
+			curve : abcio.add_curve(top, "curve1")
+		};
+		for (i = 0; i < 2; i = i + 1) {
+			assert(abcio.write_xform_sample(xform, i * 1000 / 30, matrix));
+			assert(abcio.write_mesh_sample(handles.mesh, i * 1000 / 30, quad_sample(i)));
+			assert(abcio.write_point_sample(handles.point, i * 1000 / 30, points));
+			assert(abcio.write_curve_sample(handles.curve, i * 1000 / 30, curves));
+		}
+		// width without vertices is scoped by the last written vertex count
+		assert(abcio.write_point_sample(handles.point, 2 * 1000 / 30, { width : new Float32Array([1, 1, 1]) }));
+		abcio.close_archive(top);
+
+		assert(abcio.load(file));
+		assert_array(abcio.get_xform_path_list(file), ["/xform1"]);
+		assert_array(abcio.get_mesh_path_list(file), ["/xform1/mesh1"]);
+		assert_array(abcio.get_point_path_list(file), ["/point1"]);
+		assert_array(abcio.get_curve_path_list(file), ["/curve1"]);
+
+		abcio.set_time(file, 1000 / 30);
+		assert_array(abcio.get_xform(file, "/xform1").local_transform, matrix);
+		mesh = abcio.get_mesh(file, "/xform1/mesh1");
+		assert_array(mesh.vertex, quad_sample(1).vertex);
+		assert.strictEqual(mesh.index.length, 6);
+		mesh = abcio.get_mesh(file, "/xform1/mesh1", true);
+		assert.strictEqual(mesh.vertex[0], 1 + matrix[12]);
+		point = abcio.get_point(file, "/point1");
+		assert_array(point.position, points.vertex);
+		curve = abcio.get_curve(file, "/curve1");
+		assert_array(curve.position, curves.vertex);
+		assert_array(curve.vertex_count_list, curves.count);
+		assert.strictEqual(curve.curve, 2);
+		assert.throws(function () {
+			abcio.get_camera_range(file, "/xform1", { start : 0, end : 1e12, step : 1 });
+		}, TypeError);
+		abcio.unload(file);
+		console.log("writertest ok");
+	}
+
+	/**
+	 * bake an archive and read its frames from the baked file.
+	 */
+	function baketest() {
+		var file = "bake_test.abc",
+			bake_file = "bake_test.abc.bake",
+			info,
+			frame,
+			i;
+		write_meshes(file, { fps : 30 }, 2, 3, 0);
+		assert(abcio.bake(file, bake_file, { fps : 30 }));
+		info = abcio.open_bake(bake_file);
+		assert.notStrictEqual(info, null);
+		assert_array(info.paths.slice().sort(), ["/mesh1", "/mesh2"]);
+		assert.strictEqual(info.frame_count, 3);
+		assert.strictEqual(info.quantized, false);
+		for (i = 0; i < info.frame_count; i = i + 1) {
+			frame = abcio.get_baked_mesh(bake_file, "/mesh2", info.start_time + i * info.frame_time);
+			assert.strictEqual(frame.frame, i);
+			assert_array(frame.vertex, quad_sample(i).vertex);
+			assert.strictEqual(frame.index.length, 6);
+		}
+		abcio.close_bake(bake_file);
+
+		assert(abcio.bake(file, bake_file, { fps : 30, quantize : true }));
+		info = abcio.open_bake(bake_file);
+		assert.strictEqual(info.quantized, true);
+		frame = abcio.get_baked_mesh(bake_file, "/mesh1", info.start_time);
+		assert(frame.vertex instanceof Uint16Array);
+		assert.strictEqual(frame.vertex_scale.length, 3);
+		abcio.close_bake(bake_file);
+		console.log("baketest ok");
+	}
+
+	/**
+	 * load an archive through its scene index, then change the archive and load it again.
+	 */
+	function indextest() {
+		var file = "index_test.abc",
+			range;
+		abcio.set_scene_index({ enabled : true, directory : "index_test" });
+		write_meshes(file, { fps : 30 }, 1, 2, 0);
+		assert(abcio.load(file));
+		abcio.unload(file);
+
+		// unchanged archive is served from the index until objects are needed
+		assert(abcio.load(file));
+		assert_array(abcio.get_mesh_path_list(file), ["/mesh1"]);
+		range = abcio.get_total_time(file);
+		assert.strictEqual(range.min, 0);
+		assert_array(abcio.get_mesh(file, "/mesh1").vertex, quad_sample(0).vertex);
+		abcio.unload(file);
+
+		write_meshes(file, { fps : 30, start_time : 1000 }, 2, 2, 5);
+		assert(abcio.load(file));
+		assert_array(abcio.get_mesh_path_list(file), ["/mesh1", "/mesh2"]);
+		range = abcio.get_total_time(file);
+		assert.strictEqual(range.min, 1000);
+		abcio.set_time(file, range.min);
+		assert_array(abcio.get_mesh(file, "/mesh2").vertex, quad_sample(5).vertex);
+		abcio.unload(file);
+		abcio.set_scene_index({ enabled : false });
+		console.log("indextest ok");
+	}
+
+	/**
+	 * load an hdf5 archive through its ogawa copy, then change the archive and load it again.
+	 */
+	function transcodetest() {
+		var file = "transcode_test.abc";
+		abcio.set_transcode_cache({ directory : "transcode_test" });
+		write_meshes(file, { type : "hdf5", fps : 30 }, 1, 2, 0);
+		assert(abcio.load(file));
+		assert_array(abcio.get_mesh(file, "/mesh1").vertex, quad_sample(0).vertex);
+		abcio.unload(file);
+		assert(fs.readdirSync("transcode_test").length > 0);
+
+		write_meshes(file, { type : "hdf5", fps : 30 }, 1, 2, 7);
+		assert(abcio.load(file));
+		assert_array(abcio.get_mesh(file, "/mesh1").vertex, quad_sample(7).vertex);
+		abcio.unload(file);
+		abcio.set_transcode_cache({ directory : "" });
+		console.log("transcodetest ok");
+	}
+
+	/**
+	 * read every frame in each read mode.
+	 */
+	function readmodetest() {
+		var file = "readmode_test.abc",
+			modes = ["stream", "mapped", "positional"],
+			i,
+			k;
+		write_meshes(file, { fps : 30 }, 2, 4, 0);
+		for (i = 0; i < modes.length; i = i + 1) {
+			abcio.set_read_mode({ mode : modes[i], stream_count : 2 });
+			assert(abcio.load(file));
+			for (k = 0; k < 4; k = k + 1) {
+				abcio.set_time(file, k * 1000 / 30);
+				assert_array(abcio.get_mesh(file, "/mesh1").vertex, quad_sample(k).vertex);
+				assert_array(abcio.get_mesh(file, "/mesh2").vertex, quad_sample(k).vertex);
+			}
+			abcio.unload(file);
+		}
+		assert.throws(function () {
+			abcio.set_read_mode({ mode : "unknown" });
+		}, TypeError);
+		abcio.set_read_mode({ mode : "stream" });
+		console.log("readmodetest ok");
+	}
+
+	/**
+	 * play an archive read through streams with prefetch.
+	 */
+	function prefetchtest() {
+		var file = "prefetch_test.abc",
+			stats,
+			i;
+		write_meshes(file, { fps : 30 }, 1, 8, 0);
+		abcio.set_read_mode({ mode : "stream" });
+		abcio.set_prefetch({ frame_count : 4, byte_budget : 1024 * 1024 });
+		assert(abcio.load(file));
+		for (i = 0; i < 8; i = i + 1) {
+			abcio.set_time(file, i * 1000 / 30);
+			assert_array(abcio.get_mesh(file, "/mesh1").vertex, quad_sample(i).vertex);
+		}
+		stats = abcio.get_prefetch_stats(file);
+		assert.notStrictEqual(stats, null);
+		assert(stats.request > 0);
+		abcio.unload(file);
+		abcio.set_prefetch({ frame_count : 0, byte_budget : 0 });
+		console.log("prefetchtest ok");
+	}
+
+	/**
+	 * walk an archive through scene and object handles.
+	 */
+	function handletest() {
+		var file = "handle_test.abc",
+			scene,
+			root,
+			children,
+			mesh;
+		write_meshes(file, { fps : 30 }, 2, 2, 0);
+		scene = abcio.open(file);
+		assert.notStrictEqual(scene, null);
+		assert.strictEqual(scene.file, file);
+		root = scene.root();
+		children = root.children();
+		assert.strictEqual(children.length, 2);
+		assert.strictEqual(children[0].path, "/" + children[0].name);
+		mesh = scene.object("/mesh2");
+		assert.strictEqual(mesh.type(), "mesh");
+		assert.strictEqual(scene.object("/missing"), null);
+
+		scene.set_time(1000 / 30);
+		assert_array(mesh.mesh().vertex, quad_sample(1).vertex);
+		assert_array(abcio.get_mesh(file, "/mesh1").vertex, quad_sample(1).vertex);
+		// object handles share the reference of the scene handle and close with it
+		scene.close();
+		assert.throws(function () {
+			scene.root();
+		}, TypeError);
+		assert.throws(function () {
+			mesh.type();
+		}, TypeError);
+		assert.throws(function () {
+			children[0].children();
+		}, TypeError);
+		assert.throws(function () {
+			abcio.get_mesh(file, "/mesh1");
+		}, TypeError);
+		assert.strictEqual(abcio.open("missing_test.abc"), null);
+		console.log("handletest ok");
+	}
+
+	topologytest();
+	writertest();
+	baketest();
+	indextest();
+	transcodetest();
+	readmodetest();
+	prefetchtest();
+	handletest();
 	loadtest();
 }());